@@ -0,0 +1,530 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    The BBR congestion control algorithm (draft-cardwell-iccrg-bbr-congestion-control).
+
+    BBR models the network path with two estimates: the bottleneck bandwidth,
+    the windowed max of the delivery rate samples produced by loss detection,
+    and the round-trip propagation delay, the windowed min of the RTT samples.
+    Sends are paced at a multiple of the bandwidth estimate and the congestion
+    window is capped at a multiple of the bandwidth-delay product. The gains
+    are cycled through the STARTUP, DRAIN, PROBE_BW and PROBE_RTT states.
+
+    Unlike CUBIC, loss is not treated as a congestion signal beyond packet
+    conservation for the remainder of the round trip.
+
+--*/
+
+#include "precomp.h"
+
+//
+// Gains are fixed point, with QUIC_BBR_UNIT being a gain of 1.
+//
+#define QUIC_BBR_UNIT                           256
+
+//
+// 2/ln(2), the smallest gain that allows the sending rate to double each
+// round trip in STARTUP.
+//
+#define QUIC_BBR_HIGH_GAIN                      (QUIC_BBR_UNIT * 2885 / 1000 + 1)
+
+//
+// The inverse of QUIC_BBR_HIGH_GAIN, which drains the queue STARTUP created in
+// one round trip.
+//
+#define QUIC_BBR_DRAIN_GAIN                     (QUIC_BBR_UNIT * 1000 / 2885)
+
+#define QUIC_BBR_CWND_GAIN                      (QUIC_BBR_UNIT * 2)
+
+//
+// The bandwidth filter window, in round trips.
+//
+#define QUIC_BBR_BANDWIDTH_FILTER_ROUNDS        10
+
+//
+// The min RTT filter window. PROBE_RTT is entered if the min RTT wasn't
+// refreshed for this long.
+//
+#define QUIC_BBR_MIN_RTT_EXPIRATION             S_TO_US(10)
+
+#define QUIC_BBR_PROBE_RTT_DURATION             MS_TO_US(200)
+
+#define QUIC_BBR_MIN_CWND_PACKETS               4
+
+//
+// The bandwidth is considered to still be growing in STARTUP if it increased
+// by 25% in a round trip. The pipe is full after 3 rounds without growth.
+//
+#define QUIC_BBR_STARTUP_GROWTH_TARGET          (QUIC_BBR_UNIT * 5 / 4)
+#define QUIC_BBR_STARTUP_SLOW_GROW_ROUND_LIMIT  3
+
+//
+// The number of packets allowed on top of the bandwidth-delay product to keep
+// the pipe full despite delayed and aggregated ACKs.
+//
+#define QUIC_BBR_SEND_QUANTUM_PACKETS           3
+
+#define QUIC_BBR_GAIN_CYCLE_LENGTH              8
+
+const uint32_t QuicBbrPacingGainCycle[QUIC_BBR_GAIN_CYCLE_LENGTH] = {
+    QUIC_BBR_UNIT * 5 / 4,
+    QUIC_BBR_UNIT * 3 / 4,
+    QUIC_BBR_UNIT, QUIC_BBR_UNIT, QUIC_BBR_UNIT,
+    QUIC_BBR_UNIT, QUIC_BBR_UNIT, QUIC_BBR_UNIT
+};
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrBandwidthFilterReset(
+    _Out_ QUIC_BBR_BANDWIDTH_FILTER* Filter,
+    _In_ uint64_t Round,
+    _In_ uint64_t Bandwidth
+    )
+{
+    for (uint32_t i = 0; i < ARRAYSIZE(Filter->Samples); ++i) {
+        Filter->Samples[i].Bandwidth = Bandwidth;
+        Filter->Samples[i].Round = Round;
+    }
+}
+
+//
+// Adds a sample to the windowed max filter and ages out samples older than
+// QUIC_BBR_BANDWIDTH_FILTER_ROUNDS.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrBandwidthFilterUpdate(
+    _Inout_ QUIC_BBR_BANDWIDTH_FILTER* Filter,
+    _In_ uint64_t Round,
+    _In_ uint64_t Bandwidth
+    )
+{
+    const uint64_t Window = QUIC_BBR_BANDWIDTH_FILTER_ROUNDS;
+
+    if (Bandwidth >= Filter->Samples[0].Bandwidth ||
+        Round - Filter->Samples[2].Round > Window) {
+        //
+        // A new max, or nothing left in the window.
+        //
+        QuicBbrBandwidthFilterReset(Filter, Round, Bandwidth);
+        return;
+    }
+
+    if (Bandwidth >= Filter->Samples[1].Bandwidth) {
+        Filter->Samples[2].Bandwidth = Filter->Samples[1].Bandwidth = Bandwidth;
+        Filter->Samples[2].Round = Filter->Samples[1].Round = Round;
+    } else if (Bandwidth >= Filter->Samples[2].Bandwidth) {
+        Filter->Samples[2].Bandwidth = Bandwidth;
+        Filter->Samples[2].Round = Round;
+    }
+
+    uint64_t Age = Round - Filter->Samples[0].Round;
+    if (Age > Window) {
+        //
+        // The best sample expired. Promote the others and, if the second best
+        // expired too, promote again.
+        //
+        Filter->Samples[0] = Filter->Samples[1];
+        Filter->Samples[1] = Filter->Samples[2];
+        Filter->Samples[2].Bandwidth = Bandwidth;
+        Filter->Samples[2].Round = Round;
+        if (Round - Filter->Samples[0].Round > Window) {
+            Filter->Samples[0] = Filter->Samples[1];
+            Filter->Samples[1] = Filter->Samples[2];
+        }
+    } else if (Filter->Samples[1].Round == Filter->Samples[0].Round &&
+        Age > Window / 4) {
+        //
+        // A quarter of the window passed without a second best sample. Take
+        // this one, so the max doesn't collapse when the best one expires.
+        //
+        Filter->Samples[2].Bandwidth = Filter->Samples[1].Bandwidth = Bandwidth;
+        Filter->Samples[2].Round = Filter->Samples[1].Round = Round;
+    } else if (Filter->Samples[2].Round == Filter->Samples[1].Round &&
+        Age > Window / 2) {
+        Filter->Samples[2].Bandwidth = Bandwidth;
+        Filter->Samples[2].Round = Round;
+    }
+}
+
+//
+// Returns the bottleneck bandwidth estimate, in bytes per second.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+QuicBbrGetBandwidth(
+    _In_ const QUIC_CONGESTION_CONTROL_BBR* Bbr
+    )
+{
+    return Bbr->BandwidthFilter.Samples[0].Bandwidth;
+}
+
+//
+// Returns Gain times the estimated bandwidth-delay product, in bytes.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicBbrGetTargetCongestionWindow(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint32_t Gain
+    )
+{
+    const QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+    const uint16_t Mtu = QuicCongestionControlGetConnection(Cc)->Paths[0].Mtu;
+    uint64_t Bandwidth = QuicBbrGetBandwidth(Bbr);
+
+    if (!Bbr->MinRttValid || Bandwidth == 0) {
+        return Mtu * Cc->InitialWindowPackets;
+    }
+
+    uint64_t Bdp = Bandwidth * Bbr->MinRtt / S_TO_US(1);
+    uint64_t Target =
+        Bdp * Gain / QUIC_BBR_UNIT + QUIC_BBR_SEND_QUANTUM_PACKETS * Mtu;
+    if (Target < QUIC_BBR_MIN_CWND_PACKETS * Mtu) {
+        Target = QUIC_BBR_MIN_CWND_PACKETS * Mtu;
+    } else if (Target > UINT32_MAX) {
+        Target = UINT32_MAX;
+    }
+    return (uint32_t)Target;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrTransitTo(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ QUIC_BBR_STATE State,
+    _In_ uint64_t TimeNow
+    )
+{
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+
+    Bbr->State = (uint8_t)State;
+    switch (State) {
+    case QUIC_BBR_STATE_STARTUP:
+        Bbr->PacingGain = QUIC_BBR_HIGH_GAIN;
+        Bbr->CwndGain = QUIC_BBR_HIGH_GAIN;
+        break;
+    case QUIC_BBR_STATE_DRAIN:
+        Bbr->PacingGain = QUIC_BBR_DRAIN_GAIN;
+        Bbr->CwndGain = QUIC_BBR_HIGH_GAIN;
+        break;
+    case QUIC_BBR_STATE_PROBE_BW:
+        //
+        // Start anywhere in the cycle except the draining phase, so flows
+        // sharing a bottleneck don't probe in lockstep.
+        //
+        QuicRandom(sizeof(Bbr->PacingCycleIndex), &Bbr->PacingCycleIndex);
+        Bbr->PacingCycleIndex =
+            (Bbr->PacingCycleIndex % (QUIC_BBR_GAIN_CYCLE_LENGTH - 1) + 2) %
+                QUIC_BBR_GAIN_CYCLE_LENGTH;
+        Bbr->PacingGain = QuicBbrPacingGainCycle[Bbr->PacingCycleIndex];
+        Bbr->CwndGain = QUIC_BBR_CWND_GAIN;
+        Bbr->CycleStart = TimeNow;
+        break;
+    case QUIC_BBR_STATE_PROBE_RTT:
+        Bbr->PacingGain = QUIC_BBR_UNIT;
+        Bbr->CwndGain = QUIC_BBR_UNIT;
+        Bbr->ProbeRttDoneTimeValid = FALSE;
+        break;
+    }
+
+    QuicTraceLogConnInfo(
+        BbrStateChanged,
+        QuicCongestionControlGetConnection(Cc),
+        "BBR state %hhu, bandwidth %llu bytes/s, min RTT %u us",
+        Bbr->State,
+        QuicBbrGetBandwidth(Bbr),
+        Bbr->MinRtt);
+}
+
+//
+// Remembers the congestion window before it's cut for recovery or PROBE_RTT.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrSaveCongestionWindow(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+    if (!Bbr->IsInRecovery && Bbr->State != QUIC_BBR_STATE_PROBE_RTT) {
+        Bbr->PreviousCongestionWindow = Cc->CongestionWindow;
+    } else if (Bbr->PreviousCongestionWindow < Cc->CongestionWindow) {
+        Bbr->PreviousCongestionWindow = Cc->CongestionWindow;
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrInitialize(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+
+    Cc->SlowStartThreshold = UINT32_MAX;
+    Cc->CongestionWindow = Connection->Paths[0].Mtu * Cc->InitialWindowPackets;
+    Cc->BytesInFlightMax = Cc->CongestionWindow / 2;
+
+    QuicZeroMemory(Bbr, sizeof(*Bbr));
+    QuicBbrTransitTo(Cc, QUIC_BBR_STATE_STARTUP, 0);
+
+    QuicConnLogOutFlowStats(Connection);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+QuicBbrGetPacingRate(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    const QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+
+    //
+    // Pace at the gain times the bandwidth estimate. Until there is an
+    // estimate, use the window spread over the smoothed RTT.
+    //
+    uint64_t PacingRate = QuicBbrGetBandwidth(Bbr);
+    if (PacingRate == 0) {
+        PacingRate =
+            (uint64_t)Cc->CongestionWindow * S_TO_US(1) /
+            max(1, Connection->Paths[0].SmoothedRtt);
+    }
+    return PacingRate * Bbr->PacingGain / QUIC_BBR_UNIT;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrOnDataAcknowledged(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ const QUIC_ACK_EVENT* AckEvent
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+    const QUIC_RATE_SAMPLE* RateSample = AckEvent->RateSample;
+    const uint32_t MinWindow = QUIC_BBR_MIN_CWND_PACKETS * Connection->Paths[0].Mtu;
+    uint64_t TimeNow = QuicTimeUs64();
+    BOOLEAN RoundStart = FALSE;
+
+    //
+    // Count round trips and update the bandwidth estimate. App-limited samples
+    // understate the bandwidth, so they only count if they raise it.
+    //
+    if (RateSample != NULL && RateSample->Valid) {
+        if (RateSample->PriorTotalBytesAcked >= Bbr->EndOfRoundTrip) {
+            Bbr->EndOfRoundTrip = RateSample->TotalBytesAcked;
+            Bbr->RoundTripCounter++;
+            RoundStart = TRUE;
+        }
+
+        if (RateSample->DeliveryRate != 0 &&
+            (!RateSample->IsAppLimited ||
+             RateSample->DeliveryRate >= QuicBbrGetBandwidth(Bbr))) {
+            QuicBbrBandwidthFilterUpdate(
+                &Bbr->BandwidthFilter,
+                Bbr->RoundTripCounter,
+                RateSample->DeliveryRate);
+        }
+    }
+
+    //
+    // Update the min RTT. If it wasn't refreshed within the filter window,
+    // the next sample replaces it and PROBE_RTT drains the queue to get an
+    // accurate one.
+    //
+    BOOLEAN MinRttExpired =
+        Bbr->MinRttValid &&
+        QuicTimeDiff64(Bbr->MinRttTimestamp, TimeNow) > QUIC_BBR_MIN_RTT_EXPIRATION;
+    if (AckEvent->MinRttValid &&
+        (!Bbr->MinRttValid || AckEvent->MinRtt <= Bbr->MinRtt || MinRttExpired)) {
+        Bbr->MinRtt = AckEvent->MinRtt;
+        Bbr->MinRttTimestamp = TimeNow;
+        Bbr->MinRttValid = TRUE;
+    }
+
+    if (Bbr->IsInRecovery) {
+        if (AckEvent->LargestPacketNumberAcked > Bbr->EndOfRecovery) {
+            QuicTraceEvent(ConnRecoveryExit, Connection);
+            Bbr->IsInRecovery = FALSE;
+            Bbr->IsInPersistentCongestion = FALSE;
+            if (Cc->CongestionWindow < Bbr->PreviousCongestionWindow) {
+                Cc->CongestionWindow = Bbr->PreviousCongestionWindow;
+            }
+        } else {
+            //
+            // Packet conservation: send as much as was acknowledged.
+            //
+            uint32_t Window = Cc->BytesInFlight + AckEvent->NumRetransmittableBytes;
+            if (Bbr->RecoveryWindow < Window) {
+                Bbr->RecoveryWindow = Window;
+            }
+        }
+    }
+
+    //
+    // Advance the pacing gain cycle once per min RTT. The probing phase also
+    // waits for the inflight data to reach its target, and the draining phase
+    // may end early once the queue is gone.
+    //
+    if (Bbr->State == QUIC_BBR_STATE_PROBE_BW) {
+        BOOLEAN FullLength =
+            QuicTimeDiff64(Bbr->CycleStart, TimeNow) > Bbr->MinRtt;
+        uint32_t PriorBytesInFlight =
+            Cc->BytesInFlight + AckEvent->NumRetransmittableBytes;
+        BOOLEAN Advance;
+        if (Bbr->PacingGain > QUIC_BBR_UNIT) {
+            Advance =
+                FullLength &&
+                PriorBytesInFlight >= QuicBbrGetTargetCongestionWindow(Cc, Bbr->PacingGain);
+        } else if (Bbr->PacingGain < QUIC_BBR_UNIT) {
+            Advance =
+                FullLength ||
+                PriorBytesInFlight <= QuicBbrGetTargetCongestionWindow(Cc, QUIC_BBR_UNIT);
+        } else {
+            Advance = FullLength;
+        }
+        if (Advance) {
+            Bbr->PacingCycleIndex =
+                (Bbr->PacingCycleIndex + 1) % QUIC_BBR_GAIN_CYCLE_LENGTH;
+            Bbr->PacingGain = QuicBbrPacingGainCycle[Bbr->PacingCycleIndex];
+            Bbr->CycleStart = TimeNow;
+        }
+    }
+
+    //
+    // The pipe is full once the bandwidth estimate stops growing for a few
+    // round trips.
+    //
+    if (RoundStart && !Bbr->BtlbwFound && !RateSample->IsAppLimited) {
+        uint64_t Bandwidth = QuicBbrGetBandwidth(Bbr);
+        if (Bandwidth * QUIC_BBR_UNIT >=
+                Bbr->LastEstimatedStartupBandwidth * QUIC_BBR_STARTUP_GROWTH_TARGET) {
+            Bbr->LastEstimatedStartupBandwidth = Bandwidth;
+            Bbr->SlowStartupRoundCounter = 0;
+        } else if (++Bbr->SlowStartupRoundCounter >= QUIC_BBR_STARTUP_SLOW_GROW_ROUND_LIMIT) {
+            Bbr->BtlbwFound = TRUE;
+        }
+    }
+
+    if (Bbr->State == QUIC_BBR_STATE_STARTUP && Bbr->BtlbwFound) {
+        QuicBbrTransitTo(Cc, QUIC_BBR_STATE_DRAIN, TimeNow);
+    }
+
+    if (Bbr->State == QUIC_BBR_STATE_DRAIN &&
+        Cc->BytesInFlight <= QuicBbrGetTargetCongestionWindow(Cc, QUIC_BBR_UNIT)) {
+        QuicBbrTransitTo(Cc, QUIC_BBR_STATE_PROBE_BW, TimeNow);
+    }
+
+    if (Bbr->State != QUIC_BBR_STATE_PROBE_RTT && MinRttExpired) {
+        QuicBbrSaveCongestionWindow(Cc);
+        QuicBbrTransitTo(Cc, QUIC_BBR_STATE_PROBE_RTT, TimeNow);
+    }
+
+    if (Bbr->State == QUIC_BBR_STATE_PROBE_RTT) {
+        //
+        // Hold the minimum window for QUIC_BBR_PROBE_RTT_DURATION and at least
+        // one round trip once the inflight data has drained to it.
+        //
+        if (!Bbr->ProbeRttDoneTimeValid) {
+            if (Cc->BytesInFlight <= MinWindow) {
+                Bbr->ProbeRttDoneTime = TimeNow + QUIC_BBR_PROBE_RTT_DURATION;
+                Bbr->ProbeRttDoneTimeValid = TRUE;
+                Bbr->ProbeRttRound = Bbr->RoundTripCounter;
+            }
+        } else if (Bbr->RoundTripCounter > Bbr->ProbeRttRound &&
+            QuicTimeAtOrBefore64(Bbr->ProbeRttDoneTime, TimeNow)) {
+            Bbr->MinRttTimestamp = TimeNow;
+            if (Cc->CongestionWindow < Bbr->PreviousCongestionWindow) {
+                Cc->CongestionWindow = Bbr->PreviousCongestionWindow;
+            }
+            QuicBbrTransitTo(
+                Cc,
+                Bbr->BtlbwFound ? QUIC_BBR_STATE_PROBE_BW : QUIC_BBR_STATE_STARTUP,
+                TimeNow);
+        }
+    }
+
+    //
+    // Grow the congestion window towards its target. Until the pipe is full,
+    // growth isn't capped, since the target trails the bandwidth estimate.
+    //
+    if (AckEvent->NumRetransmittableBytes > 0) {
+        uint32_t TargetWindow = QuicBbrGetTargetCongestionWindow(Cc, Bbr->CwndGain);
+        if (Bbr->BtlbwFound) {
+            uint64_t Window =
+                (uint64_t)Cc->CongestionWindow + AckEvent->NumRetransmittableBytes;
+            Cc->CongestionWindow = (uint32_t)min(Window, TargetWindow);
+        } else if (Cc->CongestionWindow < TargetWindow ||
+            RateSample == NULL ||
+            RateSample->TotalBytesAcked <
+                (uint64_t)Connection->Paths[0].Mtu * Cc->InitialWindowPackets) {
+            Cc->CongestionWindow += AckEvent->NumRetransmittableBytes;
+        }
+    }
+
+    if (Cc->CongestionWindow < MinWindow) {
+        Cc->CongestionWindow = MinWindow;
+    }
+    if (Bbr->State == QUIC_BBR_STATE_PROBE_RTT && Cc->CongestionWindow > MinWindow) {
+        Cc->CongestionWindow = MinWindow;
+    }
+    if (Bbr->IsInRecovery) {
+        Cc->CongestionWindow =
+            min(Cc->CongestionWindow, max(Bbr->RecoveryWindow, MinWindow));
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicBbrOnDataLost(
+    _In_ QUIC_CONGESTION_CONTROL* Cc,
+    _In_ uint64_t LargestPacketNumberLost,
+    _In_ uint64_t LargestPacketNumberSent,
+    _In_ uint32_t NumRetransmittableBytes,
+    _In_ BOOLEAN PersistentCongestion
+    )
+{
+    QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+    const uint32_t MinWindow = QUIC_BBR_MIN_CWND_PACKETS * Connection->Paths[0].Mtu;
+    UNREFERENCED_PARAMETER(LargestPacketNumberLost);
+    UNREFERENCED_PARAMETER(NumRetransmittableBytes);
+
+    if (!Bbr->IsInRecovery) {
+        QuicTraceEvent(ConnCongestion, Connection);
+        Connection->Stats.Send.CongestionCount++;
+
+        QuicBbrSaveCongestionWindow(Cc);
+        Bbr->IsInRecovery = TRUE;
+        Bbr->EndOfRecovery = LargestPacketNumberSent;
+        Bbr->RecoveryWindow = Cc->BytesInFlight;
+    }
+
+    if (PersistentCongestion && !Bbr->IsInPersistentCongestion) {
+        QuicTraceEvent(ConnPersistentCongestion, Connection);
+        Connection->Stats.Send.PersistentCongestionCount++;
+
+        Bbr->IsInPersistentCongestion = TRUE;
+        Bbr->RecoveryWindow =
+            Connection->Paths[0].Mtu * QUIC_PERSISTENT_CONGESTION_WINDOW_PACKETS;
+    }
+
+    Cc->CongestionWindow =
+        min(Cc->CongestionWindow, max(Bbr->RecoveryWindow, MinWindow));
+}
+
+const QUIC_CONGESTION_CONTROL_VTABLE QuicCongestionControlBbr = {
+    "BBR",
+    QuicBbrInitialize,
+    QuicBbrInitialize, // Reset
+    QuicBbrGetPacingRate,
+    QuicBbrOnDataAcknowledged,
+    QuicBbrOnDataLost
+};
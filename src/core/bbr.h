@@ -0,0 +1,114 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+--*/
+
+typedef enum QUIC_BBR_STATE {
+
+    QUIC_BBR_STATE_STARTUP,
+    QUIC_BBR_STATE_DRAIN,
+    QUIC_BBR_STATE_PROBE_BW,
+    QUIC_BBR_STATE_PROBE_RTT
+
+} QUIC_BBR_STATE;
+
+//
+// Windowed max filter for the bottleneck bandwidth. It keeps the best, second
+// best and third best samples seen in the window (Kathleen Nichols' algorithm)
+// so the max can be aged out without storing every sample.
+//
+typedef struct QUIC_BBR_BANDWIDTH_FILTER {
+
+    struct {
+        uint64_t Bandwidth; // bytes per second
+        uint64_t Round;
+    } Samples[3];
+
+} QUIC_BBR_BANDWIDTH_FILTER;
+
+typedef struct QUIC_CONGESTION_CONTROL_BBR {
+
+    //
+    // TRUE once the bandwidth estimate stopped growing in STARTUP, which means
+    // the bottleneck has been filled.
+    //
+    BOOLEAN BtlbwFound : 1;
+
+    //
+    // TRUE if MinRtt holds a sample.
+    //
+    BOOLEAN MinRttValid : 1;
+
+    //
+    // TRUE while conserving packets after a loss. If TRUE, EndOfRecovery and
+    // RecoveryWindow are valid.
+    //
+    BOOLEAN IsInRecovery : 1;
+
+    //
+    // TRUE if persistent congestion was declared during the current recovery.
+    //
+    BOOLEAN IsInPersistentCongestion : 1;
+
+    //
+    // TRUE once PROBE_RTT has drained the network down to the minimum window
+    // and ProbeRttDoneTime is valid.
+    //
+    BOOLEAN ProbeRttDoneTimeValid : 1;
+
+    uint8_t State; // QUIC_BBR_STATE
+    uint8_t PacingCycleIndex;
+
+    //
+    // The number of round trips in STARTUP without significant bandwidth
+    // growth.
+    //
+    uint8_t SlowStartupRoundCounter;
+
+    //
+    // Gains applied to the bandwidth estimate (for pacing) and to the
+    // bandwidth-delay product (for the congestion window). QUIC_BBR_UNIT is a
+    // gain of 1.
+    //
+    uint32_t PacingGain;
+    uint32_t CwndGain;
+
+    //
+    // Round trips are counted from the delivery rate samples. A round ends
+    // when a packet sent after EndOfRoundTrip bytes were acknowledged is
+    // itself acknowledged.
+    //
+    uint64_t RoundTripCounter;
+    uint64_t EndOfRoundTrip; // bytes
+
+    QUIC_BBR_BANDWIDTH_FILTER BandwidthFilter;
+
+    //
+    // The bandwidth estimate the last time it grew significantly in STARTUP.
+    //
+    uint64_t LastEstimatedStartupBandwidth; // bytes per second
+
+    uint32_t MinRtt; // microsec
+    uint64_t MinRttTimestamp; // microsec
+
+    uint64_t CycleStart; // microsec
+    uint64_t ProbeRttDoneTime; // microsec
+    uint64_t ProbeRttRound;
+
+    //
+    // The congestion window before entering recovery or PROBE_RTT, restored
+    // when they end.
+    //
+    uint32_t PreviousCongestionWindow; // bytes
+
+    uint32_t RecoveryWindow; // bytes
+
+    //
+    // The largest packet number sent when recovery started. An ACK for any
+    // packet number greater than this ends recovery.
+    //
+    uint64_t EndOfRecovery;
+
+} QUIC_CONGESTION_CONTROL_BBR;
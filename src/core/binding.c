@@ -882,6 +882,61 @@ QuicBindingReleaseStatelessOperation(
     }
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicBindingReturnRecvDatagrams(
+    _In_ QUIC_RECV_DATAGRAM* DatagramChain
+    )
+{
+    QUIC_RECV_DATAGRAM* ReleaseChain = NULL;
+    QUIC_RECV_DATAGRAM** ReleaseChainTail = &ReleaseChain;
+
+    QUIC_RECV_DATAGRAM* Datagram;
+    while ((Datagram = DatagramChain) != NULL) {
+        DatagramChain = Datagram->Next;
+        QUIC_RECV_PACKET* Packet =
+            QuicDataPathRecvDatagramToRecvPacket(Datagram);
+        if (Packet->ZeroCopyRefCount != 0) {
+            Datagram->Next = NULL;
+            Packet->ReleaseDeferred = TRUE;
+        } else {
+            *ReleaseChainTail = Datagram;
+            ReleaseChainTail = &Datagram->Next;
+        }
+    }
+    *ReleaseChainTail = NULL;
+
+    if (ReleaseChain != NULL) {
+        QuicDataPathBindingReturnRecvDatagrams(ReleaseChain);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicBindingAddRefRecvDatagram(
+    _In_ QUIC_RECV_DATAGRAM* Datagram
+    )
+{
+    QUIC_RECV_PACKET* Packet = QuicDataPathRecvDatagramToRecvPacket(Datagram);
+    QUIC_DBG_ASSERT(!Packet->ReleaseDeferred);
+    QUIC_FRE_ASSERT(Packet->ZeroCopyRefCount < UINT16_MAX);
+    Packet->ZeroCopyRefCount++;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicBindingReleaseRecvDatagram(
+    _In_ QUIC_RECV_DATAGRAM* Datagram
+    )
+{
+    QUIC_RECV_PACKET* Packet = QuicDataPathRecvDatagramToRecvPacket(Datagram);
+    QUIC_DBG_ASSERT(Packet->ZeroCopyRefCount > 0);
+    if (--Packet->ZeroCopyRefCount == 0 && Packet->ReleaseDeferred) {
+        QUIC_DBG_ASSERT(Datagram->Next == NULL);
+        QuicDataPathBindingReturnRecvDatagrams(Datagram);
+    }
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
 QuicBindingQueueStatelessReset(
@@ -139,6 +139,20 @@ typedef struct QUIC_RECV_PACKET {
     //
     BOOLEAN HasNonProbingFrame : 1;
 
+    //
+    // Flag indicating the connection is done with the datagram, but it is
+    // still referenced by zero-copy stream receives.
+    //
+    BOOLEAN ReleaseDeferred : 1;
+
+    //
+    // Number of zero-copy stream receives still referencing the datagram's
+    // buffer. The datagram isn't returned to the datapath until it drops to 0.
+    // Note the datapath frees whole receive blocks, so a held datagram also
+    // pins the rest of its GRO/URO block (up to 64 datagrams).
+    //
+    uint16_t ZeroCopyRefCount;
+
 } QUIC_RECV_PACKET;
 
 typedef enum QUIC_BINDING_LOOKUP_TYPE {
@@ -389,6 +403,34 @@ QuicBindingReleaseStatelessOperation(
     _In_ BOOLEAN ReturnDatagram
     );
 
+//
+// Returns datagrams a connection is done processing to the datapath. Any still
+// referenced by zero-copy stream receives are returned once they are released.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicBindingReturnRecvDatagrams(
+    _In_ QUIC_RECV_DATAGRAM* DatagramChain
+    );
+
+//
+// Adds a zero-copy stream receive reference to a datagram.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicBindingAddRefRecvDatagram(
+    _In_ QUIC_RECV_DATAGRAM* Datagram
+    );
+
+//
+// Releases a zero-copy stream receive reference on a datagram.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicBindingReleaseRecvDatagram(
+    _In_ QUIC_RECV_DATAGRAM* Datagram
+    );
+
 //
 // Sends data to a remote host. Note, the buffer must remain valid for
 // the duration of the send operation.
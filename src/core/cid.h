@@ -147,7 +147,6 @@ typedef struct QUIC_CID_QUIC_LIST_ENTRY {
 
 typedef struct QUIC_CID_HASH_ENTRY {
 
-    QUIC_HASHTABLE_ENTRY Entry;
     QUIC_SINGLE_LIST_ENTRY Link;
     QUIC_CONNECTION* Connection;
     QUIC_CID CID;
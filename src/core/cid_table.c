@@ -0,0 +1,386 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Open addressing hash table for source connection IDs. See cid_table.h for
+    the layout and the rules that make lock-free lookups safe.
+
+--*/
+
+#include "precomp.h"
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define QUIC_CID_TABLE_SSE2 1
+#endif
+
+//
+// Control byte values. Full slots have the high bit set, and the top 7 bits of
+// the slot's (mixed) hash in the low bits.
+//
+#define QUIC_CID_TABLE_EMPTY            0x00
+#define QUIC_CID_TABLE_DELETED          0x01
+#define QUIC_CID_TABLE_FULL             0x80
+
+#define QUIC_CID_TABLE_IS_FULL(Control) (((Control) & QUIC_CID_TABLE_FULL) != 0)
+
+//
+// The storage is rebuilt once 7/8 of its slots are used, counting DELETED ones.
+//
+#define QUIC_CID_TABLE_MAX_LOAD(SlotCount) ((SlotCount) - (SlotCount) / 8)
+
+QUIC_STATIC_ASSERT(
+    QUIC_CID_TABLE_GROUP_SIZE == 16,
+    "Match masks are one bit per slot of a 16 byte group");
+
+//
+// Returns the index of the lowest set bit in a non-zero Mask.
+//
+static
+uint32_t
+QuicCidTableLowestSetBit(
+    _In_ uint32_t Mask
+    )
+{
+    static const uint8_t DeBruijnIndex[32] = {
+         0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+        31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+    };
+    QUIC_DBG_ASSERT(Mask != 0);
+    return DeBruijnIndex[((Mask & (~Mask + 1)) * 0x077CB531u) >> 27];
+}
+
+//
+// Returns a mask of the slots in the group whose control byte is Value.
+//
+static
+uint32_t
+QuicCidTableMatch(
+    _In_reads_(QUIC_CID_TABLE_GROUP_SIZE)
+        const uint8_t* Control,
+    _In_ uint8_t Value
+    )
+{
+#if QUIC_CID_TABLE_SSE2
+    __m128i Group = _mm_loadu_si128((const __m128i*)Control);
+    return
+        (uint32_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(Group, _mm_set1_epi8((char)Value)));
+#else
+    uint32_t Mask = 0;
+    for (uint32_t i = 0; i < QUIC_CID_TABLE_GROUP_SIZE; ++i) {
+        Mask |= (uint32_t)(Control[i] == Value) << i;
+    }
+    return Mask;
+#endif
+}
+
+//
+// Splits the hash into the first group to probe and the control byte. The
+// hash is mixed first, as the low bits of QuicHashSimple only depend on the
+// last few bytes of the CID.
+//
+static
+void
+QuicCidTableSplitHash(
+    _In_ uint32_t Hash,
+    _Out_ uint32_t* Group,
+    _Out_ uint8_t* Control
+    )
+{
+    Hash *= 0x9E3779B1u;
+    *Group = Hash ^ (Hash >> 15);
+    *Control = (uint8_t)(QUIC_CID_TABLE_FULL | (Hash >> 25));
+}
+
+static
+QUIC_CID_TABLE_STORAGE*
+QuicCidTableAllocStorage(
+    _In_ uint32_t GroupCount
+    )
+{
+    QUIC_DBG_ASSERT((GroupCount & (GroupCount - 1)) == 0);
+
+    const uint32_t SlotCount = GroupCount * QUIC_CID_TABLE_GROUP_SIZE;
+    QUIC_CID_TABLE_STORAGE* Storage =
+        QUIC_ALLOC_NONPAGED(
+            sizeof(QUIC_CID_TABLE_STORAGE) +
+            SlotCount * (sizeof(uint8_t) + sizeof(QUIC_CID_TABLE_SLOT)));
+
+    if (Storage != NULL) {
+        Storage->GroupMask = GroupCount - 1;
+        Storage->GrowthLeft = QUIC_CID_TABLE_MAX_LOAD(SlotCount);
+        Storage->Slots = (QUIC_CID_TABLE_SLOT*)(Storage->Control + SlotCount);
+        QuicZeroMemory(Storage->Control, SlotCount); // All QUIC_CID_TABLE_EMPTY
+    }
+
+    return Storage;
+}
+
+//
+// Copies the slot into the first EMPTY slot along its probe sequence, and then
+// publishes it by setting the control byte.
+//
+static
+BOOLEAN
+QuicCidTableStoreSlot(
+    _Inout_ QUIC_CID_TABLE_STORAGE* Storage,
+    _In_ const QUIC_CID_TABLE_SLOT* Slot,
+    _In_ uint32_t Hash
+    )
+{
+    uint32_t Group;
+    uint8_t Control;
+    QuicCidTableSplitHash(Hash, &Group, &Control);
+
+    for (uint32_t Probe = 0; Probe <= Storage->GroupMask; ++Probe) {
+        Group &= Storage->GroupMask;
+        uint32_t Empty =
+            QuicCidTableMatch(
+                Storage->Control + Group * QUIC_CID_TABLE_GROUP_SIZE,
+                QUIC_CID_TABLE_EMPTY);
+        if (Empty != 0) {
+            uint32_t Index =
+                Group * QUIC_CID_TABLE_GROUP_SIZE + QuicCidTableLowestSetBit(Empty);
+            Storage->Slots[Index] = *Slot;
+            WriteRelease8((char volatile*)&Storage->Control[Index], (char)Control);
+            if (Storage->GrowthLeft != 0) {
+                Storage->GrowthLeft--;
+            }
+            return TRUE;
+        }
+        Group += Probe + 1;
+    }
+
+    return FALSE;
+}
+
+//
+// Builds a new storage with all the CIDs currently in the table, doubling the
+// size if more than half of the current load limit is live CIDs.
+//
+static
+QUIC_CID_TABLE_STORAGE*
+QuicCidTableRebuild(
+    _In_ const QUIC_CID_TABLE* Table
+    )
+{
+    const QUIC_CID_TABLE_STORAGE* Storage = Table->Storage;
+    const uint32_t SlotCount =
+        (Storage->GroupMask + 1) * QUIC_CID_TABLE_GROUP_SIZE;
+
+    uint32_t GroupCount = Storage->GroupMask + 1;
+    if (Table->Count >= QUIC_CID_TABLE_MAX_LOAD(SlotCount) / 2) {
+        GroupCount *= 2;
+    }
+
+    QUIC_CID_TABLE_STORAGE* NewStorage = QuicCidTableAllocStorage(GroupCount);
+    if (NewStorage == NULL) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < SlotCount; ++i) {
+        if (QUIC_CID_TABLE_IS_FULL(Storage->Control[i])) {
+            const QUIC_CID_HASH_ENTRY* Entry = Storage->Slots[i].Entry;
+            BOOLEAN Stored =
+                QuicCidTableStoreSlot(
+                    NewStorage,
+                    &Storage->Slots[i],
+                    QuicHashSimple(Entry->CID.Length, Entry->CID.Data));
+            QUIC_DBG_ASSERT(Stored);
+            UNREFERENCED_PARAMETER(Stored);
+        }
+    }
+
+    return NewStorage;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+BOOLEAN
+QuicCidTableInitialize(
+    _Out_ QUIC_CID_TABLE* Table,
+    _In_ uint32_t InitialSize
+    )
+{
+    uint32_t GroupCount = 1;
+    while (QUIC_CID_TABLE_MAX_LOAD(GroupCount * QUIC_CID_TABLE_GROUP_SIZE) < InitialSize) {
+        GroupCount *= 2;
+    }
+
+    Table->Count = 0;
+    Table->Storage = QuicCidTableAllocStorage(GroupCount);
+    return Table->Storage != NULL;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCidTableUninitialize(
+    _In_ QUIC_CID_TABLE* Table
+    )
+{
+    QUIC_DBG_ASSERT(Table->Count == 0);
+    QUIC_FREE(Table->Storage);
+    Table->Storage = NULL;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CONNECTION*
+QuicCidTableLookup(
+    _In_ const QUIC_CID_TABLE* Table,
+    _In_reads_(Length)
+        const uint8_t* const Cid,
+    _In_ uint8_t Length,
+    _In_ uint32_t Hash
+    )
+{
+    //
+    // The slot is found through its control byte, so on weakly ordered
+    // processors the address dependency orders the slot reads after it.
+    //
+    const QUIC_CID_TABLE_STORAGE* Storage =
+        ReadPointerAcquire((void* const volatile*)&Table->Storage);
+    const uint8_t PrefixLength =
+        Length < QUIC_CID_TABLE_PREFIX_LENGTH ? Length : QUIC_CID_TABLE_PREFIX_LENGTH;
+
+    uint32_t Group;
+    uint8_t Control;
+    QuicCidTableSplitHash(Hash, &Group, &Control);
+
+    for (uint32_t Probe = 0; Probe <= Storage->GroupMask; ++Probe) {
+        Group &= Storage->GroupMask;
+        const uint8_t* GroupControl =
+            Storage->Control + Group * QUIC_CID_TABLE_GROUP_SIZE;
+
+        uint32_t Match = QuicCidTableMatch(GroupControl, Control);
+        while (Match != 0) {
+            const QUIC_CID_TABLE_SLOT* Slot =
+                &Storage->Slots[
+                    Group * QUIC_CID_TABLE_GROUP_SIZE + QuicCidTableLowestSetBit(Match)];
+            if (Slot->Length == Length &&
+                memcmp(Slot->Prefix, Cid, PrefixLength) == 0 &&
+                (Length == PrefixLength ||
+                 memcmp(
+                    Slot->Entry->CID.Data + PrefixLength,
+                    Cid + PrefixLength,
+                    Length - PrefixLength) == 0)) {
+                return Slot->Connection;
+            }
+            Match &= Match - 1;
+        }
+
+        if (QuicCidTableMatch(GroupControl, QUIC_CID_TABLE_EMPTY) != 0) {
+            break; // The CID would have been stored in this group.
+        }
+        Group += Probe + 1;
+    }
+
+    return NULL;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+BOOLEAN
+QuicCidTableInsert(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ QUIC_CID_HASH_ENTRY* SourceCid,
+    _In_ uint32_t Hash,
+    _Out_ QUIC_CID_TABLE_STORAGE** RetiredStorage
+    )
+{
+    QUIC_CID_TABLE_SLOT Slot;
+    QuicZeroMemory(&Slot, sizeof(Slot));
+    Slot.Length = SourceCid->CID.Length;
+    QuicCopyMemory(
+        Slot.Prefix,
+        SourceCid->CID.Data,
+        Slot.Length < QUIC_CID_TABLE_PREFIX_LENGTH ?
+            Slot.Length : QUIC_CID_TABLE_PREFIX_LENGTH);
+    Slot.Connection = SourceCid->Connection;
+    Slot.Entry = SourceCid;
+
+    *RetiredStorage = NULL;
+    if (Table->Storage->GrowthLeft == 0) {
+        QUIC_CID_TABLE_STORAGE* NewStorage = QuicCidTableRebuild(Table);
+        if (NewStorage != NULL) {
+            *RetiredStorage = Table->Storage;
+            WritePointerRelease((void* volatile*)&Table->Storage, NewStorage);
+        }
+        //
+        // On allocation failure, keep using the EMPTY slots that are left.
+        //
+    }
+
+    if (!QuicCidTableStoreSlot(Table->Storage, &Slot, Hash)) {
+        return FALSE;
+    }
+
+    Table->Count++;
+    return TRUE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCidTableRemove(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ const QUIC_CID_HASH_ENTRY* SourceCid,
+    _In_ uint32_t Hash
+    )
+{
+    QUIC_CID_TABLE_STORAGE* Storage = Table->Storage;
+
+    uint32_t Group;
+    uint8_t Control;
+    QuicCidTableSplitHash(Hash, &Group, &Control);
+
+    for (uint32_t Probe = 0; Probe <= Storage->GroupMask; ++Probe) {
+        Group &= Storage->GroupMask;
+        uint32_t Match =
+            QuicCidTableMatch(
+                Storage->Control + Group * QUIC_CID_TABLE_GROUP_SIZE,
+                Control);
+        while (Match != 0) {
+            uint32_t Index =
+                Group * QUIC_CID_TABLE_GROUP_SIZE + QuicCidTableLowestSetBit(Match);
+            if (Storage->Slots[Index].Entry == SourceCid) {
+                //
+                // Readers may still be looking at the slot, so its content is
+                // left as is, and it isn't reused until the storage is rebuilt.
+                //
+                WriteRelease8(
+                    (char volatile*)&Storage->Control[Index],
+                    (char)QUIC_CID_TABLE_DELETED);
+                Table->Count--;
+                return;
+            }
+            Match &= Match - 1;
+        }
+        Group += Probe + 1;
+    }
+
+    QUIC_FRE_ASSERTMSG(FALSE, "CID not found in table");
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CID_HASH_ENTRY*
+QuicCidTableEnumerateNext(
+    _In_ const QUIC_CID_TABLE* Table,
+    _Inout_ uint32_t* Index
+    )
+{
+    const QUIC_CID_TABLE_STORAGE* Storage = Table->Storage;
+    const uint32_t SlotCount =
+        (Storage->GroupMask + 1) * QUIC_CID_TABLE_GROUP_SIZE;
+
+    while (*Index < SlotCount) {
+        uint32_t i = (*Index)++;
+        if (QUIC_CID_TABLE_IS_FULL(Storage->Control[i])) {
+            return Storage->Slots[i].Entry;
+        }
+    }
+
+    return NULL;
+}
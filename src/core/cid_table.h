@@ -0,0 +1,159 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+--*/
+
+//
+// Open addressing hash table of source connection IDs, for the binding lookup.
+//
+// Slots are probed in groups of QUIC_CID_TABLE_GROUP_SIZE. Each slot has a one
+// byte control value, which is either EMPTY, DELETED or the top 7 bits of the
+// slot's hash. A lookup compares a whole group of control bytes at once (with
+// SSE2, where available), and then only the matching slots. A slot stores the
+// CID bytes and connection inline, so a lookup touches the control bytes and
+// the matching slot, instead of walking a chain of QUIC_CID_HASH_ENTRY.
+//
+// The table supports lock-free readers concurrent with a single writer:
+// - A slot is only written while it is EMPTY, before its control byte is
+//   published. Removal marks the slot DELETED and leaves its content intact.
+// - DELETED slots are never reused in place. Instead, the whole storage is
+//   rebuilt (and replaced) when there is no more room, which also purges them.
+// Writers must not free a removed QUIC_CID_HASH_ENTRY or a replaced storage
+// until after any concurrent readers are done with them.
+//
+// The Hash passed to the functions below is always QuicHashSimple of the CID.
+//
+
+#define QUIC_CID_TABLE_GROUP_SIZE       16
+
+//
+// Number of CID bytes stored inline in a slot. Covers all CIDs MsQuic generates,
+// so the QUIC_CID_HASH_ENTRY is only read for longer ones.
+//
+#define QUIC_CID_TABLE_PREFIX_LENGTH    15
+
+QUIC_STATIC_ASSERT(
+    MSQUIC_CID_MAX_LENGTH <= QUIC_CID_TABLE_PREFIX_LENGTH,
+    "MsQuic CIDs must fit inline in the CID table");
+
+typedef struct QUIC_CID_TABLE_SLOT {
+
+    uint8_t Length;
+    uint8_t Prefix[QUIC_CID_TABLE_PREFIX_LENGTH];
+    QUIC_CONNECTION* Connection;
+    QUIC_CID_HASH_ENTRY* Entry;
+
+} QUIC_CID_TABLE_SLOT;
+
+typedef struct QUIC_CID_TABLE_STORAGE {
+
+    //
+    // The number of groups, minus one. Always a power of two minus one.
+    //
+    uint32_t GroupMask;
+
+    //
+    // The number of EMPTY slots that may still be filled before the storage
+    // needs to be rebuilt.
+    //
+    uint32_t GrowthLeft;
+
+    //
+    // (GroupMask + 1) * QUIC_CID_TABLE_GROUP_SIZE slots, following Control in
+    // the same allocation.
+    //
+    QUIC_CID_TABLE_SLOT* Slots;
+
+    //
+    // One control byte per slot.
+    //
+    uint8_t Control[0];
+
+} QUIC_CID_TABLE_STORAGE;
+
+typedef struct QUIC_CID_TABLE {
+
+    //
+    // The current storage. Replaced as a whole when it is rebuilt, so readers
+    // always see either the old or the new one.
+    //
+    QUIC_CID_TABLE_STORAGE* Storage;
+
+    //
+    // The number of CIDs in the table.
+    //
+    uint32_t Count;
+
+} QUIC_CID_TABLE;
+
+//
+// Initializes an empty table, with room for at least InitialSize CIDs.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+BOOLEAN
+QuicCidTableInitialize(
+    _Out_ QUIC_CID_TABLE* Table,
+    _In_ uint32_t InitialSize
+    );
+
+//
+// Cleans up the table. It must be empty.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCidTableUninitialize(
+    _In_ QUIC_CID_TABLE* Table
+    );
+
+//
+// Finds the connection for the CID. Safe to call concurrently with a writer.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CONNECTION*
+QuicCidTableLookup(
+    _In_ const QUIC_CID_TABLE* Table,
+    _In_reads_(Length)
+        const uint8_t* const Cid,
+    _In_ uint8_t Length,
+    _In_ uint32_t Hash
+    );
+
+//
+// Inserts the source CID, which must not already be in the table. If the
+// storage had to be rebuilt, the previous one is returned in RetiredStorage,
+// and must be freed (with QUIC_FREE) once no reader can still be using it.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Must_inspect_result_
+BOOLEAN
+QuicCidTableInsert(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ QUIC_CID_HASH_ENTRY* SourceCid,
+    _In_ uint32_t Hash,
+    _Out_ QUIC_CID_TABLE_STORAGE** RetiredStorage
+    );
+
+//
+// Removes the source CID from the table.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicCidTableRemove(
+    _Inout_ QUIC_CID_TABLE* Table,
+    _In_ const QUIC_CID_HASH_ENTRY* SourceCid,
+    _In_ uint32_t Hash
+    );
+
+//
+// Returns the next source CID at or after *Index, and advances *Index past it.
+// Start with *Index set to 0. Returns NULL once all CIDs were returned.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CID_HASH_ENTRY*
+QuicCidTableEnumerateNext(
+    _In_ const QUIC_CID_TABLE* Table,
+    _Inout_ uint32_t* Index
+    );
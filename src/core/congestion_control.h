@@ -5,30 +5,143 @@
 
 --*/
 
-typedef struct QUIC_CONGESTION_CONTROL {
+typedef struct QUIC_CONGESTION_CONTROL QUIC_CONGESTION_CONTROL;
+
+//
+// A delivery rate sample, generated by loss detection from the packets newly
+// acknowledged by an ACK frame (see draft-cheng-iccrg-delivery-rate-estimation).
+//
+typedef struct QUIC_RATE_SAMPLE {
+
+    //
+    // TRUE if any retransmittable packet was newly acknowledged. If FALSE,
+    // only TotalBytesAcked is valid.
+    //
+    BOOLEAN Valid;
+
+    //
+    // TRUE if the sampled packet was sent while the app, rather than the
+    // network, limited the send rate.
+    //
+    BOOLEAN IsAppLimited;
+
+    //
+    // The RTT of the sampled packet, which is the most recently sent packet
+    // that was acknowledged.
+    //
+    uint32_t Rtt; // microsec
+
+    //
+    // The total retransmittable bytes acknowledged over the connection's
+    // lifetime, now and when the sampled packet was sent.
+    //
+    uint64_t TotalBytesAcked;
+    uint64_t PriorTotalBytesAcked;
 
     //
-    // TRUE if we have had at least one congestion event.
-    // If TRUE, RecoverySentPacketNumber is valid.
+    // When TotalBytesAcked reached PriorTotalBytesAcked, and how long the
+    // packets in the sampled interval took to send.
     //
-    BOOLEAN HasHadCongestionEvent : 1;
+    uint32_t PriorTotalBytesAckedTime; // microsec
+    uint32_t SendInterval; // microsec
 
     //
-    // This flag indicates a congestion event occurred and CC is attempting
-    // to recover from it.
+    // The rate the acknowledged bytes were delivered at. Zero if the interval
+    // was too short for a meaningful sample.
     //
-    BOOLEAN IsInRecovery : 1;
+    uint64_t DeliveryRate; // bytes per second
+
+} QUIC_RATE_SAMPLE;
+
+//
+// Describes the retransmittable data acknowledged by an ACK frame.
+//
+typedef struct QUIC_ACK_EVENT {
+
+    uint32_t TimeNow; // microsec
+    uint64_t LargestPacketNumberAcked;
+    uint32_t NumRetransmittableBytes;
+    uint32_t SmoothedRtt; // microsec
+
+    //
+    // The smallest RTT of the packets acknowledged, without the ACK delay
+    // removed. Only valid if MinRttValid.
+    //
+    BOOLEAN MinRttValid;
+    uint32_t MinRtt; // microsec
 
     //
-    // This flag indicates a persistent congestion event occurred and CC is
-    // attempting to recover from it.
+    // The RTT sample (with the ACK delay removed) this ACK produced, as passed
+    // to QuicConnUpdateRtt. Only valid if LatestRttSampleValid.
     //
-    BOOLEAN IsInPersistentCongestion : 1;
+    BOOLEAN LatestRttSampleValid;
+    uint32_t LatestRttSample; // microsec
 
     //
-    // TRUE if there has been at least one ACK.
+    // NULL if no sample was taken (e.g. implicit acknowledgement).
     //
-    BOOLEAN TimeOfLastAckValid : 1;
+    const QUIC_RATE_SAMPLE* RateSample;
+
+} QUIC_ACK_EVENT;
+
+//
+// The interface each congestion control algorithm implements. The common
+// code maintains BytesInFlight and the blocked state; the algorithm owns the
+// congestion window.
+//
+typedef struct QUIC_CONGESTION_CONTROL_VTABLE {
+
+    const char* Name;
+
+    //
+    // Called when the algorithm is selected and on each settings update.
+    //
+    void (*Initialize)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc
+        );
+
+    void (*Reset)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc
+        );
+
+    //
+    // Returns the rate, in bytes per second, sends are paced at. Only called
+    // once there is an RTT sample.
+    //
+    uint64_t (*GetPacingRate)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc
+        );
+
+    //
+    // Called after the acknowledged bytes are removed from BytesInFlight.
+    //
+    void (*OnDataAcknowledged)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc,
+        _In_ const QUIC_ACK_EVENT* AckEvent
+        );
+
+    //
+    // Called after the lost bytes are removed from BytesInFlight.
+    //
+    void (*OnDataLost)(
+        _In_ QUIC_CONGESTION_CONTROL* Cc,
+        _In_ uint64_t LargestPacketNumberLost,
+        _In_ uint64_t LargestPacketNumberSent,
+        _In_ uint32_t NumRetransmittableBytes,
+        _In_ BOOLEAN PersistentCongestion
+        );
+
+} QUIC_CONGESTION_CONTROL_VTABLE;
+
+extern const QUIC_CONGESTION_CONTROL_VTABLE QuicCongestionControlCubic;
+extern const QUIC_CONGESTION_CONTROL_VTABLE QuicCongestionControlBbr;
+
+typedef struct QUIC_CONGESTION_CONTROL {
+
+    //
+    // The algorithm in use.
+    //
+    const QUIC_CONGESTION_CONTROL_VTABLE* Vtbl;
 
     //
     // The size of the initial congestion window, in packets.
@@ -41,6 +154,11 @@ typedef struct QUIC_CONGESTION_CONTROL {
     uint32_t SendIdleTimeoutMs;
 
     uint32_t CongestionWindow; // bytes
+
+    //
+    // The window at which slow start ends. UINT32_MAX if the algorithm
+    // doesn't use one.
+    //
     uint32_t SlowStartThreshold; // bytes
 
     //
@@ -62,18 +180,13 @@ typedef struct QUIC_CONGESTION_CONTROL {
     //
     uint8_t Exemptions;
 
-    uint64_t TimeOfLastAck; // millisec
-    uint64_t TimeOfCongAvoidStart; // millisec
-    uint32_t KCubic; // millisec
-    uint32_t WindowMax; // bytes
-    uint32_t WindowLastMax; // bytes
-
     //
-    // This variable tracks the largest packet that was outstanding at the time
-    // the last congestion event occurred. An ACK for any packet number greater
-    // than this indicates recovery is over.
+    // State private to the algorithm in use.
     //
-    uint64_t RecoverySentPacketNumber;
+    union {
+        QUIC_CONGESTION_CONTROL_CUBIC Cubic;
+        QUIC_CONGESTION_CONTROL_BBR Bbr;
+    };
 
 } QUIC_CONGESTION_CONTROL;
 
@@ -101,6 +214,10 @@ QuicCongestionControlSetExemption(
     Cc->Exemptions = NumPackets;
 }
 
+//
+// Selects the algorithm from the settings and (re)initializes it. Switching
+// algorithms discards the previous algorithm's state.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicCongestionControlInitialize(
@@ -125,6 +242,17 @@ QuicCongestionControlGetSendAllowance(
     _In_ BOOLEAN TimeSinceLastSendValid
     );
 
+//
+// Returns the time, in milliseconds, until the pacing rate allows the next
+// chunk to be sent. Only valid after the send allowance ran out while the
+// congestion window still had room.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+QuicCongestionControlGetPacingDelay(
+    _In_ QUIC_CONGESTION_CONTROL* Cc
+    );
+
 //
 // Called when any retransmittable data is sent.
 //
@@ -147,16 +275,13 @@ QuicCongestionControlOnDataInvalidated(
     );
 
 //
-// Called when any data is acknowledged.
+// Called when any data is acknowledged. Returns TRUE if we became unblocked.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
 QuicCongestionControlOnDataAcknowledged(
     _In_ QUIC_CONGESTION_CONTROL* Cc,
-    _In_ uint64_t TimeNow, // millisec
-    _In_ uint64_t LargestPacketNumberAcked,
-    _In_ uint32_t NumRetransmittableBytes,
-    _In_ uint32_t SmoothedRtt
+    _In_ const QUIC_ACK_EVENT* AckEvent
     );
 
 //
@@ -170,4 +295,4 @@ QuicCongestionControlOnDataLost(
     _In_ uint64_t LargestPacketNumberSent,
     _In_ uint32_t NumRetransmittableBytes,
     _In_ BOOLEAN PersistentCongestion
-    );
\ No newline at end of file
+    );
@@ -93,6 +93,7 @@ QuicConnAlloc(
     Connection->PartitionID = PartitionId;
     Connection->State.Allocated = TRUE;
     Connection->State.UseSendBuffer = QUIC_DEFAULT_SEND_BUFFERING_ENABLE;
+    Connection->State.UseRecvZeroCopy = QUIC_DEFAULT_RECV_ZERO_COPY_ENABLE;
     Connection->State.EncryptionEnabled = !MsQuicLib.EncryptionDisabled;
     Connection->State.ShareBinding = IsServer;
     Connection->Stats.Timing.Start = QuicTimeUs64();
@@ -107,6 +108,7 @@ QuicConnAlloc(
     QuicOperationQueueInitialize(&Connection->OperQ);
     QuicSendInitialize(&Connection->Send);
     QuicLossDetectionInitialize(&Connection->LossDetection);
+    QuicDatagramInitialize(&Connection->Datagram);
 
     QUIC_PATH* Path = &Connection->Paths[0];
     QuicPathInitialize(Connection, Path);
@@ -316,6 +318,7 @@ QuicConnFree(
     QUIC_TEL_ASSERT(QuicListIsEmpty(&Connection->Streams.ClosedStreams));
     QuicLossDetectionUninitialize(&Connection->LossDetection);
     QuicSendUninitialize(&Connection->Send);
+    QuicDatagramUninitialize(&Connection->Datagram);
     while (!QuicListIsEmpty(&Connection->DestCids)) {
         QUIC_CID_QUIC_LIST_ENTRY *CID =
             QUIC_CONTAINING_RECORD(
@@ -1498,6 +1501,7 @@ QuicConnTryClose(
         // On initial close, we must shut down all the current streams.
         //
         QuicStreamSetShutdown(&Connection->Streams);
+        QuicDatagramSendShutdown(&Connection->Datagram);
     }
 
     if (SilentClose ||
@@ -1832,6 +1836,11 @@ QuicConnHandshakeConfigure(
             LocalTP.IdleTimeout = Connection->IdleTimeoutMs;
         }
 
+        if (Connection->Datagram.ReceiveEnabled) {
+            LocalTP.Flags |= QUIC_TP_FLAG_MAX_DATAGRAM_FRAME_SIZE;
+            LocalTP.MaxDatagramFrameSize = QUIC_DEFAULT_MAX_DATAGRAM_FRAME_SIZE;
+        }
+
         if (!Connection->Session->Settings.MigrationEnabled) {
             LocalTP.Flags |= QUIC_TP_FLAG_DISABLE_ACTIVE_MIGRATION;
         }
@@ -1946,6 +1955,11 @@ QuicConnHandshakeConfigure(
             LocalTP.IdleTimeout = Connection->IdleTimeoutMs;
         }
 
+        if (Connection->Datagram.ReceiveEnabled) {
+            LocalTP.Flags |= QUIC_TP_FLAG_MAX_DATAGRAM_FRAME_SIZE;
+            LocalTP.MaxDatagramFrameSize = QUIC_DEFAULT_MAX_DATAGRAM_FRAME_SIZE;
+        }
+
         LocalTP.MaxAckDelay =
             Connection->MaxAckDelayMs + MsQuicLib.TimerResolutionMs;
 
@@ -1967,6 +1981,7 @@ QuicConnHandshakeConfigure(
         }
     }
 
+    Connection->Datagram.MaxReceiveFrameSize = LocalTP.MaxDatagramFrameSize;
     Connection->State.Started = TRUE;
     Connection->Stats.Timing.Start = QuicTimeUs64();
     QuicTraceEvent(ConnHandshakeStart, Connection);
@@ -2088,6 +2103,8 @@ QuicConnProcessPeerTransportParameters(
     Connection->Send.PeerMaxData =
         Connection->PeerTransportParams.InitialMaxData;
 
+    QuicDatagramOnSendStateChanged(&Connection->Datagram);
+
     QuicStreamSetInitializeTransportParameters(
         &Connection->Streams,
         Connection->PeerTransportParams.InitialMaxBidiStreams,
@@ -3171,7 +3188,7 @@ QuicConnRecvFrames(
         // Read the frame type.
         //
         QUIC_FRAME_TYPE FrameType = Payload[Offset];
-        if (FrameType > MAX_QUIC_FRAME) {
+        if (!QuicIsFrameKnown(FrameType)) {
             QuicTraceEvent(ConnError, Connection, "Unknown frame type");
             QuicConnTransportError(Connection, QUIC_ERROR_FRAME_ENCODING_ERROR);
             return FALSE;
@@ -3392,7 +3409,7 @@ QuicConnRecvFrames(
                 QUIC_STATUS Status =
                     QuicStreamRecv(
                         Stream,
-                        Packet->EncryptedWith0Rtt,
+                        Packet,
                         FrameType,
                         PayloadLength,
                         Payload,
@@ -3455,6 +3472,7 @@ QuicConnRecvFrames(
                 UpdatedFlowControl = TRUE;
                 QuicConnRemoveOutFlowBlockedReason(
                     Connection, QUIC_FLOW_BLOCKED_CONN_FLOW_CONTROL);
+                QuicSendUnblockAllStreams(&Connection->Send);
                 QuicSendQueueFlush(
                     &Connection->Send, REASON_CONNECTION_FLOW_CONTROL);
             }
@@ -3756,6 +3774,23 @@ QuicConnRecvFrames(
             break;
         }
 
+        case QUIC_FRAME_DATAGRAM:
+        case QUIC_FRAME_DATAGRAM_1: {
+            if (!QuicDatagramProcessFrame(
+                    &Connection->Datagram,
+                    Packet,
+                    FrameType,
+                    PayloadLength,
+                    Payload,
+                    &Offset)) {
+                return FALSE;
+            }
+
+            AckPacketImmediately = TRUE;
+            Packet->HasNonProbingFrame = TRUE;
+            break;
+        }
+
         default:
             //
             // No default case necessary, as we have already validated the frame
@@ -4177,7 +4212,7 @@ QuicConnRecvDatagrams(
                         &RecvState);
                     BatchCount = 0;
                 }
-                QuicDataPathBindingReturnRecvDatagrams(ReleaseChain);
+                QuicBindingReturnRecvDatagrams(ReleaseChain);
                 ReleaseChain = NULL;
                 ReleaseChainTail = &ReleaseChain;
                 ReleaseChainCount = 0;
@@ -4201,7 +4236,7 @@ QuicConnRecvDatagrams(
     }
 
     if (ReleaseChain != NULL) {
-        QuicDataPathBindingReturnRecvDatagrams(ReleaseChain);
+        QuicBindingReturnRecvDatagrams(ReleaseChain);
     }
 
     //
@@ -4828,6 +4863,49 @@ QuicConnParamSet(
         Status = QUIC_STATUS_SUCCESS;
         break;
 
+    case QUIC_PARAM_CONN_RECV_ZERO_COPY:
+
+        if (BufferLength != sizeof(uint8_t)) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+        Connection->State.UseRecvZeroCopy = *(uint8_t*)Buffer;
+
+        QuicTraceLogConnInfo(
+            UpdateUseRecvZeroCopy,
+            Connection,
+            "Updated UseRecvZeroCopy = %hhu",
+            Connection->State.UseRecvZeroCopy);
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
+    case QUIC_PARAM_CONN_DATAGRAM_RECEIVE_ENABLED:
+
+        if (BufferLength != sizeof(uint8_t)) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        //
+        // Only allowed before the transport parameters are sent.
+        //
+        if (Connection->State.Started) {
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        Connection->Datagram.ReceiveEnabled = *(uint8_t*)Buffer;
+
+        QuicTraceLogConnInfo(
+            UpdateDatagramReceiveEnabled,
+            Connection,
+            "Updated datagram receive enabled to %hhu",
+            Connection->Datagram.ReceiveEnabled);
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
     case QUIC_PARAM_CONN_SEND_PACING:
 
         if (BufferLength != sizeof(uint8_t)) {
@@ -5130,7 +5208,12 @@ QuicConnParamGet(
     case QUIC_PARAM_CONN_STATISTICS:
     case QUIC_PARAM_CONN_STATISTICS_PLAT: {
 
-        if (*BufferLength < sizeof(QUIC_STATISTICS)) {
+        //
+        // Applications built before the SlowStartExit fields were appended
+        // pass the shorter length, which is still accepted.
+        //
+        const uint32_t MinStatsLength = FIELD_OFFSET(QUIC_STATISTICS, SlowStartExit);
+        if (*BufferLength < MinStatsLength) {
             *BufferLength = sizeof(QUIC_STATISTICS);
             Status = QUIC_STATUS_BUFFER_TOO_SMALL;
             break;
@@ -5179,6 +5262,16 @@ QuicConnParamGet(
             Stats->Timing.HandshakeFlightEnd = QuicTimeUs64ToPlat(Stats->Timing.HandshakeFlightEnd);
         }
 
+        if (*BufferLength < sizeof(QUIC_STATISTICS)) {
+            *BufferLength = MinStatsLength;
+            Status = QUIC_STATUS_SUCCESS;
+            break;
+        }
+
+        Stats->SlowStartExit.CongestionCount = Connection->Stats.Send.SlowStartExitCongestionCount;
+        Stats->SlowStartExit.RttIncreaseCount = Connection->Stats.Send.SlowStartExitRttIncreaseCount;
+        Stats->SlowStartExit.ThresholdCount = Connection->Stats.Send.SlowStartExitThresholdCount;
+
         *BufferLength = sizeof(QUIC_STATISTICS);
         Status = QUIC_STATUS_SUCCESS;
         break;
@@ -5319,6 +5412,63 @@ QuicConnParamGet(
         Status = QUIC_STATUS_SUCCESS;
         break;
 
+    case QUIC_PARAM_CONN_RECV_ZERO_COPY:
+
+        if (*BufferLength < sizeof(uint8_t)) {
+            *BufferLength = sizeof(uint8_t);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(uint8_t);
+        *(uint8_t*)Buffer = Connection->State.UseRecvZeroCopy;
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
+    case QUIC_PARAM_CONN_DATAGRAM_RECEIVE_ENABLED:
+
+        if (*BufferLength < sizeof(uint8_t)) {
+            *BufferLength = sizeof(uint8_t);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(uint8_t);
+        *(uint8_t*)Buffer = Connection->Datagram.ReceiveEnabled;
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
+    case QUIC_PARAM_CONN_DATAGRAM_SEND_ENABLED:
+
+        if (*BufferLength < sizeof(uint8_t)) {
+            *BufferLength = sizeof(uint8_t);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(uint8_t);
+        *(uint8_t*)Buffer = Connection->Datagram.SendEnabled;
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
     case QUIC_PARAM_CONN_SEND_PACING:
 
         if (*BufferLength < sizeof(uint8_t)) {
@@ -5471,6 +5621,10 @@ QuicConnProcessApiOperation(
                 ApiCtx->STRM_RECV_SET_ENABLED.IsEnabled);
         break;
 
+    case QUIC_API_TYPE_DATAGRAM_SEND:
+        QuicDatagramSendFlush(&Connection->Datagram);
+        break;
+
     case QUIC_API_TYPE_SET_PARAM:
         Status =
             QuicLibrarySetParam(
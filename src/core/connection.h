@@ -120,6 +120,12 @@ typedef union QUIC_CONNECTION_STATE {
         //
         BOOLEAN UseSendBuffer : 1;
 
+        //
+        // Indicates whether received stream data may be indicated to the app
+        // directly from the received datagrams, instead of being copied.
+        //
+        BOOLEAN UseRecvZeroCopy : 1;
+
         //
         // Indicates whether pacing logic is enabled for sending.
         //
@@ -224,6 +230,13 @@ typedef struct QUIC_CONN_STATS {
 
         uint32_t CongestionCount;
         uint32_t PersistentCongestionCount;
+
+        //
+        // The number of times slow start ended, by reason.
+        //
+        uint32_t SlowStartExitCongestionCount;
+        uint32_t SlowStartExitRttIncreaseCount; // HyStart++
+        uint32_t SlowStartExitThresholdCount;
     } Send;
 
     struct {
@@ -508,6 +521,11 @@ typedef struct QUIC_CONNECTION {
     QUIC_SEND Send;
     QUIC_SEND_BUFFER SendBuffer;
 
+    //
+    // Manages the unreliable datagrams sent and received.
+    //
+    QUIC_DATAGRAM Datagram;
+
     //
     // The handler for the API client's callbacks.
     //
@@ -649,6 +667,19 @@ QuicLossDetectionGetConnection(
     return QUIC_CONTAINING_RECORD(LossDetection, QUIC_CONNECTION, LossDetection);
 }
 
+//
+// Helper to get the owning QUIC_CONNECTION for the datagram state.
+//
+inline
+_Ret_notnull_
+QUIC_CONNECTION*
+QuicDatagramGetConnection(
+    _In_ const QUIC_DATAGRAM* const Datagram
+    )
+{
+    return QUIC_CONTAINING_RECORD(Datagram, QUIC_CONNECTION, Datagram);
+}
+
 inline
 void
 QuicConnLogOutFlowStats(
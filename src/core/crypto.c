@@ -1016,6 +1016,7 @@ QuicCryptoProcessDataFrame(
                 Crypto->RecvEncryptLevelStartOffset + Frame->Offset,
                 (uint16_t)Frame->Length,
                 Frame->Data,
+                NULL,
                 &FlowControlLimit,
                 DataReady);
         if (QUIC_FAILED(Status)) {
@@ -1155,6 +1156,10 @@ QuicCryptoProcessTlsCompletion(
             //
             QuicCryptoDiscardKeys(Crypto, QUIC_PACKET_KEY_INITIAL);
         }
+        //
+        // Streams blocked on the previous key may be able to send now.
+        //
+        QuicSendUnblockAllStreams(&Connection->Send);
         if (Crypto->TlsState.WriteKey == QUIC_PACKET_KEY_1_RTT) {
             if (!QuicConnIsServer(Connection)) {
                 //
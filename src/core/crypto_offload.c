@@ -0,0 +1,307 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Packet protection for bursts of short header packets, optionally offloaded
+    to a dedicated set of threads.
+
+    When crypto offload is enabled, the packet builder queues each full batch
+    of framed packets to the pool and keeps framing the next batch while one of
+    the pool's threads encrypts it. The builder waits for its outstanding job
+    before it queues another, before the send key changes, and before the
+    datagrams are handed to the datapath, so packets always go out fully
+    protected and in packet number order.
+
+    A key holds provider cipher state that isn't safe to use from several
+    threads at once, so each connection only has one job outstanding at a
+    time. The work of many connections is spread across the pool's threads.
+
+    The pool has a fixed number of jobs. When they are all in use, the worker
+    protects the batch inline, which pushes back on the senders.
+
+--*/
+
+#include "precomp.h"
+
+//
+// Thread callback for processing the jobs queued to the pool.
+//
+QUIC_THREAD_CALLBACK(QuicCryptoOffloadThread, Context);
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicCryptoBatchProtect(
+    _In_ const QUIC_CRYPTO_BATCH* Batch
+    )
+{
+    QUIC_DBG_ASSERT(Batch->Count != 0 && Batch->Count <= QUIC_MAX_CRYPTO_BATCH_COUNT);
+
+    QUIC_CRYPT_BATCH_ENTRY Entries[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint8_t CipherBatch[QUIC_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint8_t HpMask[QUIC_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
+    const uint16_t HeaderLength =
+        Batch->PacketNumberOffset + Batch->PacketNumberLength;
+
+    for (uint8_t i = 0; i < Batch->Count; ++i) {
+        uint64_t PacketNumber = Batch->PacketNumber + i;
+        Entries[i].AuthData = Batch->Headers[i];
+        Entries[i].AuthDataLength = HeaderLength;
+        Entries[i].Buffer = Batch->Headers[i] + HeaderLength;
+        Entries[i].BufferLength = Batch->PayloadLengths[i];
+        QuicCryptoCombineIvAndPacketNumber(
+            Batch->Key->Iv, (uint8_t*)&PacketNumber, Entries[i].Iv);
+    }
+
+    QUIC_STATUS Status =
+        QuicEncryptBatch(
+            Batch->Key->PacketKey,
+            Batch->Count,
+            Entries);
+    if (QUIC_FAILED(Status) || !Batch->HeaderProtectionEnabled) {
+        goto Exit;
+    }
+
+    for (uint8_t i = 0; i < Batch->Count; ++i) {
+        QuicCopyMemory(
+            CipherBatch + i * QUIC_HP_SAMPLE_LENGTH,
+            Batch->Headers[i] + Batch->PacketNumberOffset + 4,
+            QUIC_HP_SAMPLE_LENGTH);
+    }
+
+    Status =
+        QuicHpComputeMask(
+            Batch->Key->HeaderKey,
+            Batch->Count,
+            CipherBatch,
+            HpMask);
+    if (QUIC_FAILED(Status)) {
+        QUIC_TEL_ASSERT(FALSE);
+        goto Exit;
+    }
+
+    for (uint8_t i = 0; i < Batch->Count; ++i) {
+        uint16_t Offset = i * QUIC_HP_SAMPLE_LENGTH;
+        uint8_t* Header = Batch->Headers[i];
+        Header[0] ^= (HpMask[Offset] & 0x1f); // Bottom 5 bits for SH
+        Header += Batch->PacketNumberOffset;
+        for (uint8_t j = 0; j < Batch->PacketNumberLength; ++j) {
+            Header[j] ^= HpMask[Offset + 1 + j];
+        }
+    }
+
+Exit:
+
+    QuicSecureZeroMemory(Entries, Batch->Count * sizeof(QUIC_CRYPT_BATCH_ENTRY));
+    QuicSecureZeroMemory(HpMask, Batch->Count * QUIC_HP_SAMPLE_LENGTH);
+
+    return Status;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicCryptoOffloadPoolInitialize(
+    _In_ uint8_t ThreadCount,
+    _Out_ QUIC_CRYPTO_OFFLOAD_POOL** NewPool
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    uint8_t i = 0;
+
+    QUIC_DBG_ASSERT(ThreadCount > 0);
+
+    QUIC_CRYPTO_OFFLOAD_POOL* Pool =
+        QUIC_ALLOC_NONPAGED(sizeof(QUIC_CRYPTO_OFFLOAD_POOL) + ThreadCount * sizeof(QUIC_THREAD));
+    if (Pool == NULL) {
+        QuicTraceEvent(AllocFailure, "QUIC_CRYPTO_OFFLOAD_POOL", sizeof(QUIC_CRYPTO_OFFLOAD_POOL) + ThreadCount * sizeof(QUIC_THREAD));
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    Pool->Enabled = TRUE;
+    Pool->ThreadCount = ThreadCount;
+    QuicDispatchLockInitialize(&Pool->Lock);
+    QuicEventInitialize(&Pool->Ready, FALSE, FALSE);
+    QuicListInitializeHead(&Pool->Jobs);
+    QuicListInitializeHead(&Pool->FreeJobs);
+    Pool->OffloadedJobCount = 0;
+    Pool->InlineJobCount = 0;
+    for (uint16_t j = 0; j < QUIC_MAX_CRYPTO_OFFLOAD_JOB_COUNT; ++j) {
+        QUIC_CRYPTO_OFFLOAD_JOB* Job = &Pool->JobStorage[j];
+        Job->Queued = FALSE;
+        QuicEventInitialize(&Job->Complete, FALSE, FALSE);
+        QuicListInsertTail(&Pool->FreeJobs, &Job->Link);
+    }
+
+    for (; i < ThreadCount; ++i) {
+        QUIC_THREAD_CONFIG ThreadConfig = {
+            0,
+            0,
+            "quic_crypto",
+            QuicCryptoOffloadThread,
+            Pool
+        };
+
+        Status = QuicThreadCreate(&ThreadConfig, &Pool->Threads[i]);
+        if (QUIC_FAILED(Status)) {
+            QuicTraceEvent(LibraryErrorStatus, Status, "QuicThreadCreate (crypto offload)");
+            goto Error;
+        }
+    }
+
+    *NewPool = Pool;
+
+    return QUIC_STATUS_SUCCESS;
+
+Error:
+
+    Pool->ThreadCount = i;
+    QuicCryptoOffloadPoolUninitialize(Pool);
+
+    return Status;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicCryptoOffloadPoolUninitialize(
+    _In_ QUIC_CRYPTO_OFFLOAD_POOL* Pool
+    )
+{
+    QUIC_TEL_ASSERT(QuicListIsEmpty(&Pool->Jobs));
+
+    QuicDispatchLockAcquire(&Pool->Lock);
+    Pool->Enabled = FALSE;
+    QuicDispatchLockRelease(&Pool->Lock);
+
+    //
+    // Each thread kicks the next one on its way out.
+    //
+    QuicEventSet(Pool->Ready);
+    for (uint8_t i = 0; i < Pool->ThreadCount; ++i) {
+        QuicThreadWait(&Pool->Threads[i]);
+        QuicThreadDelete(&Pool->Threads[i]);
+    }
+
+    for (uint16_t i = 0; i < QUIC_MAX_CRYPTO_OFFLOAD_JOB_COUNT; ++i) {
+        QuicEventUninitialize(Pool->JobStorage[i].Complete);
+    }
+    QuicEventUninitialize(Pool->Ready);
+    QuicDispatchLockUninitialize(&Pool->Lock);
+
+    QUIC_FREE(Pool);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_CRYPTO_OFFLOAD_JOB*
+QuicCryptoOffloadQueue(
+    _In_ QUIC_CRYPTO_OFFLOAD_POOL* Pool,
+    _In_ const QUIC_CRYPTO_BATCH* Batch
+    )
+{
+    QUIC_CRYPTO_OFFLOAD_JOB* Job = NULL;
+
+    QuicDispatchLockAcquire(&Pool->Lock);
+    if (!QuicListIsEmpty(&Pool->FreeJobs)) {
+        Job =
+            QUIC_CONTAINING_RECORD(
+                QuicListRemoveHead(&Pool->FreeJobs), QUIC_CRYPTO_OFFLOAD_JOB, Link);
+    }
+    QuicDispatchLockRelease(&Pool->Lock);
+
+    if (Job == NULL) {
+        return NULL;
+    }
+
+    QuicCopyMemory(&Job->Batch, Batch, sizeof(*Batch));
+    Job->Status = QUIC_STATUS_SUCCESS;
+
+    QuicDispatchLockAcquire(&Pool->Lock);
+    Job->Queued = TRUE;
+    QuicListInsertTail(&Pool->Jobs, &Job->Link);
+    QuicDispatchLockRelease(&Pool->Lock);
+
+    QuicEventSet(Pool->Ready);
+
+    return Job;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicCryptoOffloadComplete(
+    _In_ QUIC_CRYPTO_OFFLOAD_POOL* Pool,
+    _In_ QUIC_CRYPTO_OFFLOAD_JOB* Job
+    )
+{
+    BOOLEAN RunInline = FALSE;
+
+    QuicDispatchLockAcquire(&Pool->Lock);
+    if (Job->Queued) {
+        //
+        // No thread got to it yet. Rather than waiting, take it back.
+        //
+        QuicListEntryRemove(&Job->Link);
+        Job->Queued = FALSE;
+        RunInline = TRUE;
+    }
+    QuicDispatchLockRelease(&Pool->Lock);
+
+    if (RunInline) {
+        Job->Status = QuicCryptoBatchProtect(&Job->Batch);
+    } else {
+        QuicEventWaitForever(Job->Complete);
+    }
+
+    QUIC_STATUS Status = Job->Status;
+
+    QuicDispatchLockAcquire(&Pool->Lock);
+    if (RunInline) {
+        Pool->InlineJobCount++;
+    }
+    QuicListInsertHead(&Pool->FreeJobs, &Job->Link);
+    QuicDispatchLockRelease(&Pool->Lock);
+
+    return Status;
+}
+
+QUIC_THREAD_CALLBACK(QuicCryptoOffloadThread, Context)
+{
+    QUIC_CRYPTO_OFFLOAD_POOL* Pool = (QUIC_CRYPTO_OFFLOAD_POOL*)Context;
+
+    QuicDispatchLockAcquire(&Pool->Lock);
+    while (Pool->Enabled) {
+
+        if (QuicListIsEmpty(&Pool->Jobs)) {
+            QuicDispatchLockRelease(&Pool->Lock);
+            QuicEventWaitForever(Pool->Ready);
+            QuicDispatchLockAcquire(&Pool->Lock);
+            continue;
+        }
+
+        QUIC_CRYPTO_OFFLOAD_JOB* Job =
+            QUIC_CONTAINING_RECORD(
+                QuicListRemoveHead(&Pool->Jobs), QUIC_CRYPTO_OFFLOAD_JOB, Link);
+        Job->Queued = FALSE;
+        BOOLEAN MoreJobs = !QuicListIsEmpty(&Pool->Jobs);
+        QuicDispatchLockRelease(&Pool->Lock);
+
+        if (MoreJobs) {
+            //
+            // The ready event only wakes one thread at a time, so pass the
+            // remaining work on to a sibling.
+            //
+            QuicEventSet(Pool->Ready);
+        }
+
+        Job->Status = QuicCryptoBatchProtect(&Job->Batch);
+
+        QuicDispatchLockAcquire(&Pool->Lock);
+        Pool->OffloadedJobCount++;
+        QuicEventSet(Job->Complete);
+    }
+    QuicDispatchLockRelease(&Pool->Lock);
+
+    QuicEventSet(Pool->Ready);
+
+    QUIC_THREAD_RETURN(QUIC_STATUS_SUCCESS);
+}
@@ -0,0 +1,180 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+--*/
+
+//
+// A burst of short header packets, with consecutive packet numbers, that still
+// need to be encrypted and header protected with the same key.
+//
+typedef struct QUIC_CRYPTO_BATCH {
+
+    //
+    // The key to protect the packets with.
+    //
+    QUIC_PACKET_KEY* Key;
+
+    //
+    // The packet number of the first packet in the batch.
+    //
+    uint64_t PacketNumber;
+
+    //
+    // The number of packets in the batch.
+    //
+    uint8_t Count;
+
+    //
+    // The offset of the packet number in each header, and its encoded length.
+    //
+    uint8_t PacketNumberOffset;
+    uint8_t PacketNumberLength;
+
+    //
+    // Indicates header protection should be applied after encryption.
+    //
+    BOOLEAN HeaderProtectionEnabled;
+
+    //
+    // The start of each packet (its header) and the length of the payload that
+    // follows the header, including the encryption overhead.
+    //
+    uint8_t* Headers[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint16_t PayloadLengths[QUIC_MAX_CRYPTO_BATCH_COUNT];
+
+} QUIC_CRYPTO_BATCH;
+
+//
+// Encrypts and then header protects all the packets in the batch.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicCryptoBatchProtect(
+    _In_ const QUIC_CRYPTO_BATCH* Batch
+    );
+
+//
+// A batch queued to the crypto offload pool.
+//
+typedef struct QUIC_CRYPTO_OFFLOAD_JOB {
+
+    //
+    // Link in the pool's queued or free job list.
+    //
+    QUIC_LIST_ENTRY Link;
+
+    //
+    // Indicates the job is in the queued list and hasn't been picked up by a
+    // thread yet. Protected by the pool's lock.
+    //
+    BOOLEAN Queued;
+
+    //
+    // The result of protecting the batch.
+    //
+    QUIC_STATUS Status;
+
+    //
+    // Set once a thread finishes the job.
+    //
+    QUIC_EVENT Complete;
+
+    QUIC_CRYPTO_BATCH Batch;
+
+} QUIC_CRYPTO_OFFLOAD_JOB;
+
+//
+// A set of threads that encrypt batches of packets on behalf of the workers.
+//
+typedef struct QUIC_CRYPTO_OFFLOAD_POOL {
+
+    //
+    // TRUE while the threads should keep running.
+    //
+    BOOLEAN Enabled;
+
+    //
+    // Number of threads in the pool.
+    //
+    uint8_t ThreadCount;
+
+    //
+    // Serializes access to the job lists.
+    //
+    QUIC_DISPATCH_LOCK Lock;
+
+    //
+    // An event to kick a thread.
+    //
+    QUIC_EVENT Ready;
+
+    //
+    // Queue of jobs waiting for a thread, in the order they were queued.
+    //
+    QUIC_LIST_ENTRY Jobs;
+
+    //
+    // Jobs available to be queued. The fixed number of jobs bounds the depth
+    // of the queue.
+    //
+    QUIC_LIST_ENTRY FreeJobs;
+    QUIC_CRYPTO_OFFLOAD_JOB JobStorage[QUIC_MAX_CRYPTO_OFFLOAD_JOB_COUNT];
+
+    //
+    // The number of jobs protected by the pool's threads, and the number taken
+    // back and protected inline. Protected by the lock.
+    //
+    uint64_t OffloadedJobCount;
+    uint64_t InlineJobCount;
+
+    //
+    // All the threads.
+    //
+    _Field_size_(ThreadCount)
+    QUIC_THREAD Threads[0];
+
+} QUIC_CRYPTO_OFFLOAD_POOL;
+
+//
+// Initializes the crypto offload pool.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicCryptoOffloadPoolInitialize(
+    _In_ uint8_t ThreadCount,
+    _Out_ QUIC_CRYPTO_OFFLOAD_POOL** Pool
+    );
+
+//
+// Cleans up the crypto offload pool. All queued jobs must have been completed.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicCryptoOffloadPoolUninitialize(
+    _In_ QUIC_CRYPTO_OFFLOAD_POOL* Pool
+    );
+
+//
+// Queues a copy of the batch to be protected by one of the pool's threads.
+// Returns NULL if the pool has no free jobs left, in which case the caller
+// should protect the batch itself.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_CRYPTO_OFFLOAD_JOB*
+QuicCryptoOffloadQueue(
+    _In_ QUIC_CRYPTO_OFFLOAD_POOL* Pool,
+    _In_ const QUIC_CRYPTO_BATCH* Batch
+    );
+
+//
+// Waits for the job to finish and frees it. If no thread has picked the job up
+// yet, it is completed inline instead. Returns the result of the job.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicCryptoOffloadComplete(
+    _In_ QUIC_CRYPTO_OFFLOAD_POOL* Pool,
+    _In_ QUIC_CRYPTO_OFFLOAD_JOB* Job
+    );
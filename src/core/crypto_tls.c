@@ -49,6 +49,7 @@ typedef enum eSniNameType {
 #define QUIC_TP_ID_DISABLE_ACTIVE_MIGRATION                 12  // N/A
 #define QUIC_TP_ID_PREFERRED_ADDRESS                        13  // PreferredAddress
 #define QUIC_TP_ID_ACTIVE_CONNECTION_ID_LIMIT               14  // varint
+#define QUIC_TP_ID_MAX_DATAGRAM_FRAME_SIZE                  32  // varint
 
 #define QUIC_TP_ID_MAX QUIC_TP_ID_ACTIVE_CONNECTION_ID_LIMIT
 
@@ -646,6 +647,12 @@ QuicCryptoTlsEncodeTransportParameters(
                 QUIC_TP_ID_ACTIVE_CONNECTION_ID_LIMIT,
                 QuicVarIntSize(TransportParams->ActiveConnectionIdLimit));
     }
+    if (TransportParams->Flags & QUIC_TP_FLAG_MAX_DATAGRAM_FRAME_SIZE) {
+        RequiredTPLen +=
+            TlsTransportParamLength(
+                QUIC_TP_ID_MAX_DATAGRAM_FRAME_SIZE,
+                QuicVarIntSize(TransportParams->MaxDatagramFrameSize));
+    }
     if (Connection->State.TestTransportParameterSet) {
         RequiredTPLen +=
             TlsTransportParamLength(
@@ -844,6 +851,17 @@ QuicCryptoTlsEncodeTransportParameters(
             "TP: Connection ID Limit (%llu)",
             TransportParams->ActiveConnectionIdLimit);
     }
+    if (TransportParams->Flags & QUIC_TP_FLAG_MAX_DATAGRAM_FRAME_SIZE) {
+        TPBuf =
+            TlsWriteTransportParamVarInt(
+                QUIC_TP_ID_MAX_DATAGRAM_FRAME_SIZE,
+                TransportParams->MaxDatagramFrameSize, TPBuf);
+        QuicTraceLogConnVerbose(
+            EncodeMaxDatagramFrameSize,
+            Connection,
+            "TP: Max Datagram Frame Size (%llu bytes)",
+            TransportParams->MaxDatagramFrameSize);
+    }
     if (Connection->State.TestTransportParameterSet) {
         TPBuf =
             TlsWriteTransportParam(
@@ -1175,6 +1193,26 @@ QuicCryptoTlsDecodeTransportParameters(
                 TransportParams->ActiveConnectionIdLimit);
             break;
 
+        case QUIC_TP_ID_MAX_DATAGRAM_FRAME_SIZE:
+            //
+            // Beyond QUIC_TP_ID_MAX, so duplicates are caught by the flag.
+            //
+            if (TransportParams->Flags & QUIC_TP_FLAG_MAX_DATAGRAM_FRAME_SIZE) {
+                QuicTraceEvent(ConnError, Connection, "Duplicate QUIC TP ID");
+                goto Exit;
+            }
+            if (!TRY_READ_VAR_INT(TransportParams->MaxDatagramFrameSize)) {
+                QuicTraceEvent(ConnErrorStatus, Connection, Length, "Invalid length of QUIC_TP_ID_MAX_DATAGRAM_FRAME_SIZE");
+                goto Exit;
+            }
+            TransportParams->Flags |= QUIC_TP_FLAG_MAX_DATAGRAM_FRAME_SIZE;
+            QuicTraceLogConnVerbose(
+                DecodeMaxDatagramFrameSize,
+                Connection,
+                "TP: Max Datagram Frame Size (%llu bytes)",
+                TransportParams->MaxDatagramFrameSize);
+            break;
+
         default:
             if (QuicTpIdIsReserved(Id)) {
                 QuicTraceLogConnWarning(
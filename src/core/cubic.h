@@ -0,0 +1,74 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+--*/
+
+//
+// HyStart++ (RFC 9406) phases of the initial slow start.
+//
+typedef enum QUIC_CUBIC_HYSTART_STATE {
+
+    QUIC_CUBIC_HYSTART_STATE_SLOW_START,
+    QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE,  // Conservative Slow Start (CSS)
+    QUIC_CUBIC_HYSTART_STATE_DONE
+
+} QUIC_CUBIC_HYSTART_STATE;
+
+typedef struct QUIC_CONGESTION_CONTROL_CUBIC {
+
+    //
+    // TRUE if we have had at least one congestion event.
+    // If TRUE, RecoverySentPacketNumber is valid.
+    //
+    BOOLEAN HasHadCongestionEvent : 1;
+
+    //
+    // This flag indicates a congestion event occurred and CC is attempting
+    // to recover from it.
+    //
+    BOOLEAN IsInRecovery : 1;
+
+    //
+    // This flag indicates a persistent congestion event occurred and CC is
+    // attempting to recover from it.
+    //
+    BOOLEAN IsInPersistentCongestion : 1;
+
+    //
+    // TRUE if there has been at least one ACK.
+    //
+    BOOLEAN TimeOfLastAckValid : 1;
+
+    uint64_t TimeOfLastAck; // millisec
+    uint64_t TimeOfCongAvoidStart; // millisec
+    uint32_t KCubic; // millisec
+    uint32_t WindowMax; // bytes
+    uint32_t WindowLastMax; // bytes
+
+    //
+    // This variable tracks the largest packet that was outstanding at the time
+    // the last congestion event occurred. An ACK for any packet number greater
+    // than this indicates recovery is over.
+    //
+    uint64_t RecoverySentPacketNumber;
+
+    //
+    // HyStart++ state. Only used during the initial slow start, i.e. while
+    // SlowStartThreshold is UINT32_MAX.
+    //
+    uint8_t HyStartState; // QUIC_CUBIC_HYSTART_STATE
+    uint8_t ConservativeSlowStartRounds;
+    uint32_t HyStartRttSampleCount; // samples in the current round
+    uint32_t MinRttInLastRound; // microsec
+    uint32_t MinRttInCurrentRound; // microsec
+    uint32_t CssBaselineMinRtt; // microsec
+
+    //
+    // The largest packet number sent when the current round started. An ACK
+    // for any packet number greater than this ends the round.
+    //
+    uint64_t HyStartRoundEnd;
+
+} QUIC_CONGESTION_CONTROL_CUBIC;
@@ -0,0 +1,463 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unreliable datagram (DATAGRAM frame) send and receive.
+
+    The app queues sends with the QUIC_API_TABLE's DatagramSend, which only
+    references the app's buffers. On the worker thread, the sends are moved to
+    the connection's send queue and the QUIC_CONN_SEND_FLAG_DATAGRAM flag is
+    set. QuicSendWriteFrames then copies them into 1-RTT packets, in order,
+    after which the buffers are no longer referenced (SENT is indicated).
+
+    Each send is then indicated to the app with a final state: ACKNOWLEDGED
+    once the packet is acknowledged, or LOST_DISCARDED once loss detection
+    gives up on it. A send may first be indicated as LOST_SUSPECT, in which
+    case an acknowledgement later results in ACKNOWLEDGED_SPURIOUS. DATAGRAM
+    frames are never retransmitted.
+
+--*/
+
+#include "precomp.h"
+
+//
+// The most bytes, other than the DATAGRAM frame, a 1-RTT packet may need: the
+// short header with the longest CID and packet number, and the AEAD tag.
+//
+#define QUIC_DATAGRAM_PACKET_OVERHEAD \
+( \
+    MIN_SHORT_HEADER_LENGTH_V1 + \
+    QUIC_MAX_CONNECTION_ID_LENGTH_V1 + \
+    QUIC_ENCRYPTION_OVERHEAD \
+)
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramInitialize(
+    _Inout_ QUIC_DATAGRAM* Datagram
+    )
+{
+    Datagram->ReceiveEnabled = QUIC_DEFAULT_DATAGRAM_RECEIVE_ENABLE;
+    Datagram->SendEnabled = FALSE;
+    Datagram->MaxSendLength = 0;
+    Datagram->ApiQueue = NULL;
+    Datagram->SendQueue = NULL;
+    Datagram->SendQueueTail = &Datagram->SendQueue;
+    QuicDispatchLockInitialize(&Datagram->ApiQueueLock);
+}
+
+//
+// Frees a list of send requests, without indicating them to the app.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramFreeSendRequests(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_opt_ QUIC_SEND_REQUEST* SendRequests
+    )
+{
+    while (SendRequests != NULL) {
+        QUIC_SEND_REQUEST* SendRequest = SendRequests;
+        SendRequests = SendRequests->Next;
+        QUIC_DBG_ASSERT(Connection->Worker != NULL);
+        QuicPoolFree(&Connection->Worker->SendRequestPool, SendRequest);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramUninitialize(
+    _In_ QUIC_DATAGRAM* Datagram
+    )
+{
+    QUIC_CONNECTION* Connection = QuicDatagramGetConnection(Datagram);
+    QuicDatagramFreeSendRequests(Connection, Datagram->ApiQueue);
+    Datagram->ApiQueue = NULL;
+    QuicDatagramFreeSendRequests(Connection, Datagram->SendQueue);
+    Datagram->SendQueue = NULL;
+    Datagram->SendQueueTail = &Datagram->SendQueue;
+    QuicDispatchLockUninitialize(&Datagram->ApiQueueLock);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramIndicateSendStateChange(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_opt_ void* ClientContext,
+    _In_ QUIC_DATAGRAM_SEND_STATE State
+    )
+{
+    QUIC_CONNECTION_EVENT Event;
+    Event.Type = QUIC_CONNECTION_EVENT_DATAGRAM_SEND_STATE_CHANGED;
+    Event.DATAGRAM_SEND_STATE_CHANGED.ClientContext = ClientContext;
+    Event.DATAGRAM_SEND_STATE_CHANGED.State = State;
+
+    QuicTraceLogConnVerbose(
+        IndicateDatagramSendStateChanged,
+        Connection,
+        "Indicating QUIC_CONNECTION_EVENT_DATAGRAM_SEND_STATE_CHANGED [%p] State=%u",
+        ClientContext,
+        State);
+    (void)QuicConnIndicateEvent(Connection, &Event);
+}
+
+//
+// Completes a send request that will never be framed.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramCancelSend(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ __drv_freesMem(Mem) QUIC_SEND_REQUEST* SendRequest,
+    _In_ QUIC_DATAGRAM_SEND_STATE State
+    )
+{
+    QuicDatagramIndicateSendStateChange(
+        Connection,
+        SendRequest->ClientContext,
+        State);
+    QuicPoolFree(&Connection->Worker->SendRequestPool, SendRequest);
+}
+
+//
+// Cancels everything in the send queue.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramCancelSendQueue(
+    _In_ QUIC_DATAGRAM* Datagram
+    )
+{
+    QUIC_CONNECTION* Connection = QuicDatagramGetConnection(Datagram);
+
+    QUIC_SEND_REQUEST* SendQueue = Datagram->SendQueue;
+    Datagram->SendQueue = NULL;
+    Datagram->SendQueueTail = &Datagram->SendQueue;
+    QuicSendClearSendFlag(&Connection->Send, QUIC_CONN_SEND_FLAG_DATAGRAM);
+
+    while (SendQueue != NULL) {
+        QUIC_SEND_REQUEST* SendRequest = SendQueue;
+        SendQueue = SendQueue->Next;
+        QuicDatagramCancelSend(Connection, SendRequest, QUIC_DATAGRAM_SEND_CANCELED);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramSendShutdown(
+    _In_ QUIC_DATAGRAM* Datagram
+    )
+{
+    QuicDispatchLockAcquire(&Datagram->ApiQueueLock);
+    Datagram->SendEnabled = FALSE;
+    Datagram->MaxSendLength = 0;
+    QuicDispatchLockRelease(&Datagram->ApiQueueLock);
+
+    //
+    // Anything still in the API queue is canceled when it is flushed.
+    //
+    QuicDatagramCancelSendQueue(Datagram);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramOnSendStateChanged(
+    _In_ QUIC_DATAGRAM* Datagram
+    )
+{
+    QUIC_CONNECTION* Connection = QuicDatagramGetConnection(Datagram);
+
+    BOOLEAN SendEnabled = FALSE;
+    uint16_t MaxSendLength = 0;
+
+    if (Connection->PeerTransportParams.Flags & QUIC_TP_FLAG_MAX_DATAGRAM_FRAME_SIZE &&
+        !Connection->State.ClosedLocally && !Connection->State.ClosedRemotely) {
+        //
+        // The largest payload that fits in both a single 1-RTT packet on the
+        // current path and the peer's frame size limit.
+        //
+        const QUIC_PATH* Path = &Connection->Paths[0];
+        uint16_t MaxPacketPayload =
+            MaxUdpPayloadSizeForFamily(
+                QuicAddrGetFamily(&Path->RemoteAddress),
+                Path->Mtu) - QUIC_DATAGRAM_PACKET_OVERHEAD;
+        uint64_t MaxFrameLength =
+            Connection->PeerTransportParams.MaxDatagramFrameSize;
+        if (MaxFrameLength > MaxPacketPayload) {
+            MaxFrameLength = MaxPacketPayload;
+        }
+        uint16_t FrameOverhead =
+            sizeof(uint8_t) + QuicVarIntSize(MaxFrameLength); // Type and Length
+        if (MaxFrameLength > FrameOverhead) {
+            SendEnabled = TRUE;
+            MaxSendLength = (uint16_t)(MaxFrameLength - FrameOverhead);
+        }
+    }
+
+    if (SendEnabled == Datagram->SendEnabled &&
+        MaxSendLength == Datagram->MaxSendLength) {
+        return;
+    }
+
+    QuicDispatchLockAcquire(&Datagram->ApiQueueLock);
+    Datagram->SendEnabled = SendEnabled;
+    Datagram->MaxSendLength = MaxSendLength;
+    QuicDispatchLockRelease(&Datagram->ApiQueueLock);
+
+    QuicTraceLogConnInfo(
+        DatagramSendStateChanged,
+        Connection,
+        "Datagram send enabled=%hhu, max length=%hu",
+        SendEnabled,
+        MaxSendLength);
+
+    if (!SendEnabled) {
+        QuicDatagramCancelSendQueue(Datagram);
+    }
+
+    QUIC_CONNECTION_EVENT Event;
+    Event.Type = QUIC_CONNECTION_EVENT_DATAGRAM_STATE_CHANGED;
+    Event.DATAGRAM_STATE_CHANGED.SendEnabled = SendEnabled;
+    Event.DATAGRAM_STATE_CHANGED.MaxSendLength = MaxSendLength;
+
+    QuicTraceLogConnVerbose(
+        IndicateDatagramStateChanged,
+        Connection,
+        "Indicating QUIC_CONNECTION_EVENT_DATAGRAM_STATE_CHANGED [SendEnabled=%hhu] [MaxSendLength=%hu]",
+        SendEnabled,
+        MaxSendLength);
+    (void)QuicConnIndicateEvent(Connection, &Event);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicDatagramQueueSend(
+    _In_ QUIC_DATAGRAM* Datagram,
+    _In_ __drv_aliasesMem QUIC_SEND_REQUEST* SendRequest
+    )
+{
+    QUIC_STATUS Status;
+    QUIC_OPERATION* Oper = NULL;
+    QUIC_CONNECTION* Connection = QuicDatagramGetConnection(Datagram);
+
+    QuicDispatchLockAcquire(&Datagram->ApiQueueLock);
+    if (!Datagram->SendEnabled) {
+        Status = QUIC_STATUS_INVALID_STATE;
+    } else if (SendRequest->TotalLength > Datagram->MaxSendLength) {
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+    } else if (Datagram->ApiQueue == NULL &&
+        (Oper = QuicOperationAlloc(Connection->Worker, QUIC_OPER_TYPE_API_CALL)) == NULL) {
+        //
+        // An empty queue needs an operation to flush it (later sends are
+        // flushed by the same one). Sends queued behind this one rely on
+        // that operation, so the request is only queued once it's allocated.
+        //
+        Status = QUIC_STATUS_OUT_OF_MEMORY;
+        QuicTraceEvent(AllocFailure, "DATAGRAM_SEND operation", 0);
+    } else {
+        QUIC_SEND_REQUEST** ApiQueueTail = &Datagram->ApiQueue;
+        while (*ApiQueueTail != NULL) {
+            ApiQueueTail = &((*ApiQueueTail)->Next);
+        }
+        *ApiQueueTail = SendRequest;
+        Status = QUIC_STATUS_SUCCESS;
+    }
+    QuicDispatchLockRelease(&Datagram->ApiQueueLock);
+
+    if (QUIC_FAILED(Status)) {
+        QuicPoolFree(&Connection->Worker->SendRequestPool, SendRequest);
+        goto Exit;
+    }
+
+    if (Oper != NULL) {
+        Oper->API_CALL.Context->Type = QUIC_API_TYPE_DATAGRAM_SEND;
+
+        //
+        // Queue the operation but don't wait for the completion.
+        //
+        QuicConnQueueOper(Connection, Oper);
+    }
+
+    Status = QUIC_STATUS_PENDING;
+
+Exit:
+
+    return Status;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramSendFlush(
+    _In_ QUIC_DATAGRAM* Datagram
+    )
+{
+    QUIC_CONNECTION* Connection = QuicDatagramGetConnection(Datagram);
+
+    QuicDispatchLockAcquire(&Datagram->ApiQueueLock);
+    QUIC_SEND_REQUEST* ApiQueue = Datagram->ApiQueue;
+    Datagram->ApiQueue = NULL;
+    QuicDispatchLockRelease(&Datagram->ApiQueueLock);
+
+    if (ApiQueue == NULL) {
+        return;
+    }
+
+    while (ApiQueue != NULL) {
+        QUIC_SEND_REQUEST* SendRequest = ApiQueue;
+        ApiQueue = ApiQueue->Next;
+        SendRequest->Next = NULL;
+
+        if (!Datagram->SendEnabled ||
+            SendRequest->TotalLength > Datagram->MaxSendLength) {
+            //
+            // Sending was disabled (or the limit changed) after the request
+            // was queued.
+            //
+            QuicDatagramCancelSend(Connection, SendRequest, QUIC_DATAGRAM_SEND_CANCELED);
+            continue;
+        }
+
+        *Datagram->SendQueueTail = SendRequest;
+        Datagram->SendQueueTail = &SendRequest->Next;
+    }
+
+    if (Datagram->SendQueue != NULL) {
+        QuicSendSetSendFlag(&Connection->Send, QUIC_CONN_SEND_FLAG_DATAGRAM);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicDatagramWriteFrame(
+    _In_ QUIC_DATAGRAM* Datagram,
+    _In_ QUIC_PACKET_BUILDER* Builder
+    )
+{
+    QUIC_CONNECTION* Connection = QuicDatagramGetConnection(Datagram);
+    uint16_t AvailableBufferLength =
+        (uint16_t)Builder->Datagram->Length - Builder->EncryptionOverhead;
+    BOOLEAN PacketFull = FALSE;
+
+    QUIC_DBG_ASSERT(Builder->Metadata->Flags.KeyType == QUIC_PACKET_KEY_1_RTT);
+
+    while (Datagram->SendQueue != NULL) {
+        QUIC_SEND_REQUEST* SendRequest = Datagram->SendQueue;
+
+        BOOLEAN Encoded =
+            QuicDatagramFrameEncodeEx(
+                SendRequest->Buffers,
+                SendRequest->BufferCount,
+                SendRequest->TotalLength,
+                &Builder->DatagramLength,
+                AvailableBufferLength,
+                Builder->Datagram->Buffer);
+
+        if (!Encoded &&
+            (Builder->PacketStart != 0 || Builder->Metadata->FrameCount != 0)) {
+            //
+            // Try again in the next packet.
+            //
+            PacketFull = TRUE;
+            break;
+        }
+
+        Datagram->SendQueue = SendRequest->Next;
+        if (Datagram->SendQueue == NULL) {
+            Datagram->SendQueueTail = &Datagram->SendQueue;
+        }
+
+        if (!Encoded) {
+            //
+            // Doesn't even fit in an empty packet, so it never will.
+            //
+            QuicDatagramCancelSend(Connection, SendRequest, QUIC_DATAGRAM_SEND_LOST_DISCARDED);
+            continue;
+        }
+
+        Builder->Metadata->Frames[
+            Builder->Metadata->FrameCount].DATAGRAM.ClientContext =
+                SendRequest->ClientContext;
+
+        //
+        // The data has been copied into the packet, so the app's buffers are
+        // no longer needed.
+        //
+        QuicDatagramIndicateSendStateChange(
+            Connection,
+            SendRequest->ClientContext,
+            QUIC_DATAGRAM_SEND_SENT);
+        QuicPoolFree(&Connection->Worker->SendRequestPool, SendRequest);
+
+        if (QuicPacketBuilderAddFrame(Builder, QUIC_FRAME_DATAGRAM_1, TRUE)) {
+            PacketFull = TRUE;
+            break;
+        }
+    }
+
+    if (Datagram->SendQueue == NULL) {
+        Connection->Send.SendFlags &= ~QUIC_CONN_SEND_FLAG_DATAGRAM;
+    }
+
+    return PacketFull;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Success_(return != FALSE)
+BOOLEAN
+QuicDatagramProcessFrame(
+    _In_ QUIC_DATAGRAM* Datagram,
+    _In_ const QUIC_RECV_PACKET* const Packet,
+    _In_ QUIC_FRAME_TYPE FrameType,
+    _In_ uint16_t BufferLength,
+    _In_reads_bytes_(BufferLength)
+        const uint8_t * const Buffer,
+    _Inout_ uint16_t* Offset
+    )
+{
+    QUIC_CONNECTION* Connection = QuicDatagramGetConnection(Datagram);
+    uint16_t FrameStart = *Offset - sizeof(uint8_t); // Includes the type.
+
+    QUIC_DATAGRAM_EX Frame;
+    if (!QuicDatagramFrameDecode(FrameType, BufferLength, Buffer, Offset, &Frame)) {
+        QuicTraceEvent(ConnError, Connection, "Decoding DATAGRAM frame");
+        QuicConnTransportError(Connection, QUIC_ERROR_FRAME_ENCODING_ERROR);
+        return FALSE;
+    }
+
+    //
+    // The limit covers the whole frame, including the type and length.
+    //
+    if (!Datagram->ReceiveEnabled ||
+        (QUIC_VAR_INT)(*Offset - FrameStart) > Datagram->MaxReceiveFrameSize) {
+        QuicTraceEvent(ConnError, Connection, "Received unexpected DATAGRAM frame");
+        QuicConnTransportError(Connection, QUIC_ERROR_PROTOCOL_VIOLATION);
+        return FALSE;
+    }
+
+    if (Connection->State.ClosedLocally || Connection->State.ClosedRemotely) {
+        return TRUE; // Ignore frame if we are closed.
+    }
+
+    QUIC_BUFFER QuicBuffer;
+    QuicBuffer.Length = (uint32_t)Frame.Length;
+    QuicBuffer.Buffer = (uint8_t*)Frame.Data;
+
+    QUIC_CONNECTION_EVENT Event;
+    Event.Type = QUIC_CONNECTION_EVENT_DATAGRAM_RECEIVED;
+    Event.DATAGRAM_RECEIVED.Buffer = &QuicBuffer;
+    Event.DATAGRAM_RECEIVED.Flags =
+        Packet->KeyType == QUIC_PACKET_KEY_0_RTT ?
+            QUIC_RECEIVE_FLAG_0_RTT : QUIC_RECEIVE_FLAG_NONE;
+
+    QuicTraceLogConnVerbose(
+        IndicateDatagramReceived,
+        Connection,
+        "Indicating QUIC_CONNECTION_EVENT_DATAGRAM_RECEIVED [len=%hu]",
+        (uint16_t)Frame.Length);
+    (void)QuicConnIndicateEvent(Connection, &Event);
+
+    return TRUE;
+}
@@ -0,0 +1,148 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+--*/
+
+//
+// Unreliable DATAGRAM frame state for a connection.
+//
+// Sends are queued by the app (with the buffers referenced, not copied) and
+// framed into 1-RTT packets. Once framed, the app's buffers are no longer
+// referenced, and the datagram is tracked by the frame's sent metadata only.
+// Lost DATAGRAM frames are never retransmitted.
+//
+typedef struct QUIC_DATAGRAM {
+
+    //
+    // Indicates the app wants to receive datagrams, and so the
+    // max_datagram_frame_size transport parameter is sent.
+    //
+    BOOLEAN ReceiveEnabled;
+
+    //
+    // Indicates the peer sent the max_datagram_frame_size transport parameter
+    // and so datagrams may be sent.
+    //
+    BOOLEAN SendEnabled;
+
+    //
+    // The maximum payload length of a datagram that can currently be sent.
+    //
+    uint16_t MaxSendLength;
+
+    //
+    // The max_datagram_frame_size transport parameter sent to the peer. Larger
+    // received DATAGRAM frames are a protocol violation.
+    //
+    QUIC_VAR_INT MaxReceiveFrameSize;
+
+    //
+    // Send requests queued by the app, not yet moved to the send queue.
+    //
+    QUIC_DISPATCH_LOCK ApiQueueLock;
+    QUIC_SEND_REQUEST* ApiQueue;
+
+    //
+    // Send requests waiting to be framed, in order.
+    //
+    QUIC_SEND_REQUEST* SendQueue;
+    QUIC_SEND_REQUEST** SendQueueTail;
+
+} QUIC_DATAGRAM;
+
+//
+// Initializes the datagram state.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramInitialize(
+    _Inout_ QUIC_DATAGRAM* Datagram
+    );
+
+//
+// Frees any remaining queued sends, without indicating them to the app.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramUninitialize(
+    _In_ QUIC_DATAGRAM* Datagram
+    );
+
+//
+// Cancels all queued sends and disables sending, as the connection is closed.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramSendShutdown(
+    _In_ QUIC_DATAGRAM* Datagram
+    );
+
+//
+// Updates the send state from the peer's transport parameters and indicates
+// the change to the app.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramOnSendStateChanged(
+    _In_ QUIC_DATAGRAM* Datagram
+    );
+
+//
+// Queues an app send request. Called from the app's thread.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicDatagramQueueSend(
+    _In_ QUIC_DATAGRAM* Datagram,
+    _In_ __drv_aliasesMem QUIC_SEND_REQUEST* SendRequest
+    );
+
+//
+// Moves the app's queued sends to the send queue, on the worker thread.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramSendFlush(
+    _In_ QUIC_DATAGRAM* Datagram
+    );
+
+//
+// Writes as many queued datagrams as fit into the 1-RTT packet being built.
+// Returns TRUE if the packet is full, either by bytes or frame count.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicDatagramWriteFrame(
+    _In_ QUIC_DATAGRAM* Datagram,
+    _In_ QUIC_PACKET_BUILDER* Builder
+    );
+
+//
+// Processes a received DATAGRAM frame. Returns FALSE if the frame was invalid
+// and the connection was closed.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Success_(return != FALSE)
+BOOLEAN
+QuicDatagramProcessFrame(
+    _In_ QUIC_DATAGRAM* Datagram,
+    _In_ const QUIC_RECV_PACKET* const Packet,
+    _In_ QUIC_FRAME_TYPE FrameType,
+    _In_ uint16_t BufferLength,
+    _In_reads_bytes_(BufferLength)
+        const uint8_t * const Buffer,
+    _Inout_ uint16_t* Offset
+    );
+
+//
+// Indicates a change in the send state of a datagram to the app.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicDatagramIndicateSendStateChange(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_opt_ void* ClientContext,
+    _In_ QUIC_DATAGRAM_SEND_STATE State
+    );
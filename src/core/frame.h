@@ -114,12 +114,30 @@ typedef enum QUIC_FRAME_TYPE {
     QUIC_FRAME_PATH_RESPONSE        = 0x1b,
     QUIC_FRAME_CONNECTION_CLOSE     = 0x1c, // to 0x1d
     QUIC_FRAME_CONNECTION_CLOSE_1   = 0x1d,
-    QUIC_FRAME_HANDSHAKE_DONE       = 0x1e
+    QUIC_FRAME_HANDSHAKE_DONE       = 0x1e,
+    /* 0x1f to 0x2f are unused currently */
+    QUIC_FRAME_DATAGRAM             = 0x30, // to 0x31
+    QUIC_FRAME_DATAGRAM_1           = 0x31
 
 } QUIC_FRAME_TYPE;
 
 #define MAX_QUIC_FRAME QUIC_FRAME_HANDSHAKE_DONE
 
+//
+// Returns TRUE if the frame type is one MsQuic understands.
+//
+inline
+BOOLEAN
+QuicIsFrameKnown(
+    _In_ QUIC_FRAME_TYPE FrameType
+    )
+{
+    return
+        FrameType <= MAX_QUIC_FRAME ||
+        FrameType == QUIC_FRAME_DATAGRAM ||
+        FrameType == QUIC_FRAME_DATAGRAM_1;
+}
+
 //
 // QUIC_FRAME_ACK Encoding/Decoding
 //
@@ -699,6 +717,45 @@ QuicConnCloseFrameDecode(
     _Out_ QUIC_CONNECTION_CLOSE_EX* Frame
     );
 
+//
+// QUIC_FRAME_DATAGRAM Encoding/Decoding
+//
+
+typedef struct QUIC_DATAGRAM_EX {
+
+    QUIC_VAR_INT Length;
+    _Field_size_bytes_(Length)
+    const uint8_t* Data;
+
+} QUIC_DATAGRAM_EX;
+
+//
+// Encodes a DATAGRAM frame, with an explicit length, of all the buffers.
+//
+_Success_(return != FALSE)
+BOOLEAN
+QuicDatagramFrameEncodeEx(
+    _In_reads_(BufferCount)
+        const QUIC_BUFFER* const Buffers,
+    _In_ uint32_t BufferCount,
+    _In_ uint64_t TotalLength,
+    _Inout_ uint16_t* Offset,
+    _In_ uint16_t BufferLength,
+    _Out_writes_to_(BufferLength, *Offset)
+        uint8_t* Buffer
+    );
+
+_Success_(return != FALSE)
+BOOLEAN
+QuicDatagramFrameDecode(
+    _In_ QUIC_FRAME_TYPE FrameType,
+    _In_ uint16_t BufferLength,
+    _In_reads_bytes_(BufferLength)
+        const uint8_t * const Buffer,
+    _Inout_ uint16_t* Offset,
+    _Out_ QUIC_DATAGRAM_EX* Frame
+    );
+
 //
 // Helper functions
 //
@@ -111,6 +111,11 @@ QuicFrameParseType(
     _Out_ QUIC_FRAME_TYPE* FrameType
     );
 
+BOOLEAN
+QuicIsFrameKnown(
+    _In_ QUIC_FRAME_TYPE FrameType
+    );
+
 _Success_(return != FALSE)
 BOOLEAN
 QuicStreamFramePeekID(
@@ -273,6 +278,11 @@ QuicSendGetConnection(
     _In_ QUIC_SEND* Send
     );
 
+QUIC_CONNECTION*
+QuicDatagramGetConnection(
+    _In_ const QUIC_DATAGRAM* const Datagram
+    );
+
 uint8_t
 QuicEncryptLevelToPacketType(
     QUIC_ENCRYPT_LEVEL Level
@@ -624,6 +634,22 @@ QuicPacketTraceType(
     _In_ const QUIC_SENT_PACKET_METADATA* Metadata
     );
 
+uint64_t
+QuicSentPacketRingEnd(
+    _In_ const QUIC_SENT_PACKET_RING* Ring
+    );
+
+QUIC_SENT_PACKET_SLOT*
+QuicSentPacketRingGetSlot(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    );
+
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketSlotGetMetadata(
+    _In_ QUIC_SENT_PACKET_SLOT* Slot
+    );
+
 int64_t
 QuicTimeEpochMs64(
     void
@@ -188,6 +188,29 @@ MsQuicLibraryInitialize(
             FALSE,
             sizeof(QUIC_CONNECTION),
             &MsQuicLib.PerProc[i].ConnectionPool);
+        QuicPoolInitialize(
+            FALSE,
+            sizeof(QUIC_PACKET_SPACE),
+            &MsQuicLib.PerProc[i].PacketSpacePool);
+    }
+
+    if (MsQuicLib.Settings.CryptoOffloadEnabled) {
+        uint8_t CryptoThreadCount = MsQuicLib.PartitionCount;
+        if (CryptoThreadCount > QUIC_MAX_CRYPTO_OFFLOAD_THREAD_COUNT) {
+            CryptoThreadCount = QUIC_MAX_CRYPTO_OFFLOAD_THREAD_COUNT;
+        }
+        Status =
+            QuicCryptoOffloadPoolInitialize(
+                CryptoThreadCount,
+                &MsQuicLib.CryptoOffloadPool);
+        if (QUIC_FAILED(Status)) {
+            QuicTraceLogWarning(
+                LibraryCryptoOffloadInitFailed,
+                "[ lib] Failed to create crypto offload pool, 0x%x",
+                Status);
+            MsQuicLib.CryptoOffloadPool = NULL;
+            Status = QUIC_STATUS_SUCCESS; // Non-fatal, packets are encrypted inline
+        }
     }
 
     Status =
@@ -224,9 +247,14 @@ MsQuicLibraryInitialize(
 Error:
 
     if (QUIC_FAILED(Status)) {
+        if (MsQuicLib.CryptoOffloadPool != NULL) {
+            QuicCryptoOffloadPoolUninitialize(MsQuicLib.CryptoOffloadPool);
+            MsQuicLib.CryptoOffloadPool = NULL;
+        }
         if (MsQuicLib.PerProc != NULL) {
             for (uint8_t i = 0; i < MsQuicLib.PartitionCount; ++i) {
                 QuicPoolUninitialize(&MsQuicLib.PerProc[i].ConnectionPool);
+                QuicPoolUninitialize(&MsQuicLib.PerProc[i].PacketSpacePool);
             }
             QUIC_FREE(MsQuicLib.PerProc);
             MsQuicLib.PerProc = NULL;
@@ -292,8 +320,14 @@ MsQuicLibraryUninitialize(
     //
     QUIC_TEL_ASSERT(QuicListIsEmpty(&MsQuicLib.Bindings));
 
+    if (MsQuicLib.CryptoOffloadPool != NULL) {
+        QuicCryptoOffloadPoolUninitialize(MsQuicLib.CryptoOffloadPool);
+        MsQuicLib.CryptoOffloadPool = NULL;
+    }
+
     for (uint8_t i = 0; i < MsQuicLib.PartitionCount; ++i) {
         QuicPoolUninitialize(&MsQuicLib.PerProc[i].ConnectionPool);
+        QuicPoolUninitialize(&MsQuicLib.PerProc[i].PacketSpacePool);
     }
     QUIC_FREE(MsQuicLib.PerProc);
     MsQuicLib.PerProc = NULL;
@@ -1003,6 +1037,8 @@ MsQuicOpen(
     Api->StreamReceiveComplete = MsQuicStreamReceiveComplete;
     Api->StreamReceiveSetEnabled = MsQuicStreamReceiveSetEnabled;
 
+    Api->DatagramSend = MsQuicDatagramSend;
+
     *QuicApi = Api;
 
 Error:
@@ -46,6 +46,12 @@ typedef struct QUIC_CACHEALIGN QUIC_LIBRARY_PP {
     //
     QUIC_POOL ConnectionPool;
 
+    //
+    // Pool for QUIC_PACKET_SPACEs, which every connection allocates several
+    // of up front.
+    //
+    QUIC_POOL PacketSpacePool;
+
 } QUIC_LIBRARY_PP;
 
 //
@@ -181,6 +187,12 @@ typedef struct QUIC_LIBRARY {
     //
     QUIC_WORKER_POOL* WorkerPool;
 
+    //
+    // Set of threads that encrypt packets for the workers' sends. Only created
+    // if crypto offload is enabled when the library is initialized.
+    //
+    QUIC_CRYPTO_OFFLOAD_POOL* CryptoOffloadPool;
+
     //
     // Per-processor storage. Count of `PartitionCount`.
     //
@@ -11,10 +11,29 @@ Abstract:
 
 #include "precomp.h"
 
+//
+// Once a lookup is maximally partitioned (i.e. it's on a listener's binding)
+// the set of partitions never changes, so local CID lookups from the datapath
+// can skip the lookup's RwLock and the partition locks. The partitions' CID
+// tables support this (see cid_table.h), and writers still serialize on the
+// partition locks.
+//
+// Lock-free readers count themselves in a per-processor slot for the current
+// read epoch. Before a writer frees anything a reader could still be looking
+// at, or releases the lookup table's reference on a connection, it waits for
+// a grace period (see QuicLookupSynchronize).
+//
+
+typedef struct QUIC_CACHEALIGN QUIC_LOOKUP_READERS {
+
+    long Count[2];
+
+} QUIC_LOOKUP_READERS;
+
 typedef struct QUIC_CACHEALIGN QUIC_PARTITIONED_HASHTABLE {
 
     QUIC_DISPATCH_RW_LOCK RwLock;
-    QUIC_HASHTABLE Table;
+    QUIC_CID_TABLE Table;
 
 } QUIC_PARTITIONED_HASHTABLE;
 
@@ -27,6 +46,55 @@ QuicLookupInsertLocalCid(
     _In_ BOOLEAN UpdateRefCount
     );
 
+//
+// Waits for the lock-free readers counted in one epoch slot to leave.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupWaitForReaders(
+    _In_ QUIC_LOOKUP* Lookup,
+    _In_ uint32_t Index
+    )
+{
+    for (uint32_t i = 0; i < Lookup->ReadersCount; ++i) {
+        while (ReadAcquire(&Lookup->Readers[i].Count[Index]) != 0) {
+            YieldProcessor();
+        }
+    }
+}
+
+//
+// Waits for a grace period, after which no lock-free reader can still be using
+// anything the caller unlinked beforehand. Requires Lookup->RwLock to be held
+// exclusively, so only one writer advances the read epoch at a time. Lock-free
+// readers never block, so the wait always ends, but it spins for as long as
+// readers take. Release any partition lock first, rather than stall that
+// partition's writers for the whole grace period.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupSynchronize(
+    _In_ QUIC_LOOKUP* Lookup
+    )
+{
+    if (Lookup->Readers == NULL) {
+        return;
+    }
+
+    //
+    // A reader that registered before the barrier is counted in one of the two
+    // slots, and one that didn't is guaranteed to see the unlinked state.
+    // Stragglers in the previous epoch's slot are drained first. Then new
+    // readers are switched over to it, while the current slot drains. New
+    // readers never enter the slot being waited on, so neither wait starves.
+    //
+    long Epoch = Lookup->ReadEpoch;
+    MemoryBarrier();
+    QuicLookupWaitForReaders(Lookup, (Epoch + 1) & 1);
+    InterlockedIncrement(&Lookup->ReadEpoch);
+    QuicLookupWaitForReaders(Lookup, Epoch & 1);
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicLookupInitialize(
@@ -51,13 +119,16 @@ QuicLookupUninitialize(
         QUIC_DBG_ASSERT(Lookup->HASH.Tables != NULL);
         for (uint8_t i = 0; i < Lookup->PartitionCount; i++) {
             QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[i];
-            QUIC_DBG_ASSERT(Table->Table.NumEntries == 0);
-            QuicHashtableUninitialize(&Table->Table);
+            QuicCidTableUninitialize(&Table->Table);
             QuicDispatchRwLockUninitialize(&Table->RwLock);
         }
         QUIC_FREE(Lookup->HASH.Tables);
     }
 
+    if (Lookup->Readers != NULL) {
+        QUIC_FREE(Lookup->Readers);
+    }
+
     if (Lookup->MaximizePartitioning) {
         QUIC_DBG_ASSERT(Lookup->RemoteHashTable.NumEntries == 0);
         QuicHashtableUninitialize(&Lookup->RemoteHashTable);
@@ -86,7 +157,7 @@ QuicLookupCreateHashTable(
 
         uint8_t Cleanup = 0;
         for (uint8_t i = 0; i < PartitionCount; i++) {
-            if (!QuicHashtableInitializeEx(&Lookup->HASH.Tables[i].Table, QUIC_HASH_MIN_SIZE)) {
+            if (!QuicCidTableInitialize(&Lookup->HASH.Tables[i].Table, QUIC_HASH_MIN_SIZE)) {
                 Cleanup = i;
                 break;
             }
@@ -94,7 +165,7 @@ QuicLookupCreateHashTable(
         }
         if (Cleanup != 0) {
             for (uint8_t i = 0; i < Cleanup; i++) {
-                QuicHashtableUninitialize(&Lookup->HASH.Tables[i].Table);
+                QuicCidTableUninitialize(&Lookup->HASH.Tables[i].Table);
             }
             QUIC_FREE(Lookup->HASH.Tables);
             Lookup->HASH.Tables = NULL;
@@ -106,6 +177,31 @@ QuicLookupCreateHashTable(
     return Lookup->HASH.Tables != NULL;
 }
 
+//
+// Removes all CIDs from the partitioned hash tables and frees them.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupFreeHashTable(
+    _In_ QUIC_PARTITIONED_HASHTABLE* Tables,
+    _In_range_(>, 0) uint8_t PartitionCount
+    )
+{
+    for (uint8_t i = 0; i < PartitionCount; i++) {
+        QUIC_CID_HASH_ENTRY* CID;
+        uint32_t Index = 0;
+        while ((CID = QuicCidTableEnumerateNext(&Tables[i].Table, &Index)) != NULL) {
+            QuicCidTableRemove(
+                &Tables[i].Table,
+                CID,
+                QuicHashSimple(CID->CID.Length, CID->CID.Data));
+        }
+        QuicCidTableUninitialize(&Tables[i].Table);
+        QuicDispatchRwLockUninitialize(&Tables[i].RwLock);
+    }
+    QUIC_FREE(Tables);
+}
+
 //
 // Rebalances the lookup tables to make sure they are optimal for the current
 // configuration of connections and listeners. Requires the RwLock to be held
@@ -156,9 +252,13 @@ QuicLookupRebalance(
         }
 
         //
-        // Move the CIDs to the new table.
+        // Copy the CIDs to the new table. The previous table is left intact
+        // until all of them are in, so that it can be restored if an insert
+        // fails and no CID goes missing from the lookup.
         //
 
+        BOOLEAN Success = TRUE;
+
         if (PreviousPartitionCount == 0) {
 
             //
@@ -170,17 +270,18 @@ QuicLookupRebalance(
                 QUIC_SINGLE_LIST_ENTRY* Entry =
                     ((QUIC_CONNECTION*)PreviousLookup)->SourceCids.Next;
 
-                while (Entry != NULL) {
+                while (Success && Entry != NULL) {
                     QUIC_CID_HASH_ENTRY *CID =
                         QUIC_CONTAINING_RECORD(
                             Entry,
                             QUIC_CID_HASH_ENTRY,
                             Link);
-                    (void)QuicLookupInsertLocalCid(
-                        Lookup,
-                        QuicHashSimple(CID->CID.Length, CID->CID.Data),
-                        CID,
-                        FALSE);
+                    Success =
+                        QuicLookupInsertLocalCid(
+                            Lookup,
+                            QuicHashSimple(CID->CID.Length, CID->CID.Data),
+                            CID,
+                            FALSE);
                     Entry = Entry->Next;
                 }
             }
@@ -188,37 +289,40 @@ QuicLookupRebalance(
         } else {
 
             //
-            // Changes the number of partitioned tables. Remove all the CIDs
-            // from the old tables and insert them into the new tables.
+            // Changes the number of partitioned tables. Insert all the CIDs
+            // from the old tables into the new tables.
             //
 
             QUIC_PARTITIONED_HASHTABLE* PreviousTable = PreviousLookup;
-            for (uint8_t i = 0; i < PreviousPartitionCount; i++) {
-                QUIC_HASHTABLE_ENTRY* Entry;
-                QUIC_HASHTABLE_ENUMERATOR Enumerator;
-                QuicHashtableEnumerateBegin(&PreviousTable[i].Table, &Enumerator);
-                while (TRUE) {
-                    Entry = QuicHashtableEnumerateNext(&PreviousTable[i].Table, &Enumerator);
-                    if (Entry == NULL) {
-                        QuicHashtableEnumerateEnd(&PreviousTable[i].Table, &Enumerator);
-                        break;
-                    }
-                    QuicHashtableRemove(&PreviousTable[i].Table, Entry, NULL);
-
-                    QUIC_CID_HASH_ENTRY *CID =
-                        QUIC_CONTAINING_RECORD(
-                            Entry,
-                            QUIC_CID_HASH_ENTRY,
-                            Entry);
-                    (void)QuicLookupInsertLocalCid(
-                        Lookup,
-                        QuicHashSimple(CID->CID.Length, CID->CID.Data),
-                        CID,
-                        FALSE);
+            for (uint8_t i = 0; Success && i < PreviousPartitionCount; i++) {
+                QUIC_CID_HASH_ENTRY* CID;
+                uint32_t Index = 0;
+                while (Success &&
+                    (CID = QuicCidTableEnumerateNext(&PreviousTable[i].Table, &Index)) != NULL) {
+                    Success =
+                        QuicLookupInsertLocalCid(
+                            Lookup,
+                            QuicHashSimple(CID->CID.Length, CID->CID.Data),
+                            CID,
+                            FALSE);
                 }
-                QuicHashtableUninitialize(&PreviousTable[i].Table);
             }
-            QUIC_FREE(PreviousTable);
+        }
+
+        if (!Success) {
+            //
+            // Nothing has been published to lock-free readers yet (they are
+            // only enabled once the partitions are final), so the new tables
+            // can be freed right away.
+            //
+            QuicLookupFreeHashTable(Lookup->HASH.Tables, Lookup->PartitionCount);
+            Lookup->LookupTable = PreviousLookup;
+            Lookup->PartitionCount = PreviousPartitionCount;
+            return FALSE;
+        }
+
+        if (PreviousPartitionCount != 0) {
+            QuicLookupFreeHashTable(PreviousLookup, PreviousPartitionCount);
         }
     }
 
@@ -240,11 +344,32 @@ QuicLookupMaximizePartitioning(
             QuicHashtableInitializeEx(
                 &Lookup->RemoteHashTable, QUIC_HASH_MIN_SIZE);
         if (Result) {
+            QUIC_LOOKUP_READERS* Readers = NULL;
+            if (MsQuicLib.Settings.LockFreeLookupEnabled) {
+                Lookup->ReadersCount = QuicProcMaxCount();
+                Readers =
+                    QUIC_ALLOC_NONPAGED(
+                        sizeof(QUIC_LOOKUP_READERS) * Lookup->ReadersCount);
+                if (Readers != NULL) {
+                    QuicZeroMemory(
+                        Readers,
+                        sizeof(QUIC_LOOKUP_READERS) * Lookup->ReadersCount);
+                }
+            }
             Lookup->MaximizePartitioning = TRUE;
             Result = QuicLookupRebalance(Lookup, NULL);
             if (!Result) {
-                    QuicHashtableUninitialize(&Lookup->RemoteHashTable);
+                QuicHashtableUninitialize(&Lookup->RemoteHashTable);
                 Lookup->MaximizePartitioning = FALSE;
+                if (Readers != NULL) {
+                    QUIC_FREE(Readers);
+                }
+            } else if (Readers != NULL) {
+                //
+                // The partitions are final, so local CID lookups can stop
+                // taking locks from now on.
+                //
+                WritePointerRelease((void* volatile*)&Lookup->Readers, Readers);
             }
         }
     }
@@ -284,39 +409,6 @@ QuicCidMatchConnection(
     return FALSE;
 }
 
-//
-// Uses the hash and destination connection ID to look up the connection in the
-// hash table. Returns the pointer to the connection if found; NULL otherwise.
-//
-_IRQL_requires_max_(DISPATCH_LEVEL)
-QUIC_CONNECTION*
-QuicHashLookupConnection(
-    _In_ QUIC_HASHTABLE* Table,
-    _In_reads_(Length)
-        const uint8_t* const DestCid,
-    _In_ uint8_t Length,
-    _In_ uint32_t Hash
-    )
-{
-    QUIC_HASHTABLE_LOOKUP_CONTEXT Context;
-    QUIC_HASHTABLE_ENTRY* TableEntry =
-        QuicHashtableLookup(Table, Hash, &Context);
-
-    while (TableEntry != NULL) {
-        QUIC_CID_HASH_ENTRY* CIDEntry =
-            QUIC_CONTAINING_RECORD(TableEntry, QUIC_CID_HASH_ENTRY, Entry);
-
-        if (CIDEntry->CID.Length == Length &&
-            memcmp(DestCid, CIDEntry->CID.Data, Length) == 0) {
-            return CIDEntry->Connection;
-        }
-
-        TableEntry = QuicHashtableLookupNext(Table, &Context);
-    }
-
-    return NULL;
-}
-
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_CONNECTION*
 QuicLookupFindConnectionByLocalCidInternal(
@@ -356,7 +448,7 @@ QuicLookupFindConnectionByLocalCidInternal(
 
         QuicDispatchRwLockAcquireShared(&Table->RwLock);
         Connection =
-            QuicHashLookupConnection(
+            QuicCidTableLookup(
                 &Table->Table,
                 CID,
                 CIDLen,
@@ -386,7 +478,6 @@ QuicLookupFindConnectionByLocalCidInternal(
 
 //
 // Requires Lookup->RwLock to be held (shared).
-
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_CONNECTION*
@@ -472,13 +563,23 @@ QuicLookupInsertLocalCid(
         PartitionIndex %= Lookup->PartitionCount;
         QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
 
+        QUIC_CID_TABLE_STORAGE* RetiredStorage;
         QuicDispatchRwLockAcquireExclusive(&Table->RwLock);
-        QuicHashtableInsert(
-            &Table->Table,
-            &SourceCid->Entry,
-            Hash,
-            NULL);
+        BOOLEAN Inserted =
+            QuicCidTableInsert(
+                &Table->Table,
+                SourceCid,
+                Hash,
+                &RetiredStorage);
         QuicDispatchRwLockReleaseExclusive(&Table->RwLock);
+
+        if (RetiredStorage != NULL) {
+            QuicLookupSynchronize(Lookup);
+            QUIC_FREE(RetiredStorage);
+        }
+        if (!Inserted) {
+            return FALSE;
+        }
     }
 
     if (UpdateRefCount) {
@@ -559,7 +660,8 @@ QuicLookupInsertRemoteHash(
 
 //
 // Removes a source connection ID from the lookup table. Requires the
-// Lookup->RwLock to be exlusively held.
+// Lookup->RwLock to be exlusively held. The caller must wait for a grace period
+// before freeing the entry or releasing the lookup table's reference.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
@@ -601,11 +703,61 @@ QuicLookupRemoveLocalCidInt(
         PartitionIndex %= Lookup->PartitionCount;
         QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
         QuicDispatchRwLockAcquireExclusive(&Table->RwLock);
-        QuicHashtableRemove(&Table->Table, &SourceCid->Entry, NULL);
+        QuicCidTableRemove(
+            &Table->Table,
+            SourceCid,
+            QuicHashSimple(SourceCid->CID.Length, SourceCid->CID.Data));
         QuicDispatchRwLockReleaseExclusive(&Table->RwLock);
     }
 }
 
+//
+// Looks up the connection for a local CID without taking any locks.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CONNECTION*
+QuicLookupFindConnectionByLocalCidLockFree(
+    _In_ QUIC_LOOKUP* Lookup,
+    _In_ QUIC_LOOKUP_READERS* Readers,
+    _In_reads_(CIDLen)
+        const uint8_t* const CID,
+    _In_ uint8_t CIDLen,
+    _In_ uint32_t Hash
+    )
+{
+    long* ReaderCount =
+        &Readers[QuicProcCurrentNumber() % Lookup->ReadersCount].
+            Count[ReadAcquire(&Lookup->ReadEpoch) & 1];
+    InterlockedIncrement(ReaderCount);
+
+    QUIC_DBG_ASSERT(CIDLen >= QUIC_MIN_INITIAL_CONNECTION_ID_LENGTH);
+    QUIC_DBG_ASSERT(CID != NULL);
+
+    QUIC_STATIC_ASSERT(MSQUIC_CID_PID_LENGTH == 1, "The code below assumes 1 byte");
+    uint32_t PartitionIndex = CID[MsQuicLib.CidServerIdLength];
+    PartitionIndex &= MsQuicLib.PartitionMask;
+    PartitionIndex %= Lookup->PartitionCount;
+
+    QUIC_CONNECTION* Connection =
+        QuicCidTableLookup(
+            &Lookup->HASH.Tables[PartitionIndex].Table,
+            CID,
+            CIDLen,
+            Hash);
+
+    if (Connection != NULL) {
+        //
+        // The lookup table's reference isn't released until after a grace
+        // period, so the connection is still alive here.
+        //
+        QuicConnAddRef(Connection, QUIC_CONN_REF_LOOKUP_RESULT);
+    }
+
+    InterlockedDecrement(ReaderCount);
+
+    return Connection;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_CONNECTION*
 QuicLookupFindConnectionByLocalCid(
@@ -617,6 +769,18 @@ QuicLookupFindConnectionByLocalCid(
 {
     uint32_t Hash = QuicHashSimple(CIDLen, CID);
 
+    QUIC_LOOKUP_READERS* Readers =
+        ReadPointerAcquire((void* const volatile*)&Lookup->Readers);
+    if (Readers != NULL) {
+        return
+            QuicLookupFindConnectionByLocalCidLockFree(
+                Lookup,
+                Readers,
+                CID,
+                CIDLen,
+                Hash);
+    }
+
     QuicDispatchRwLockAcquireShared(&Lookup->RwLock);
 
     QUIC_CONNECTION* ExistingConnection =
@@ -807,6 +971,7 @@ QuicLookupRemoveLocalCid(
     QuicDispatchRwLockAcquireExclusive(&Lookup->RwLock);
     QuicLookupRemoveLocalCidInt(Lookup, SourceCid);
     SourceCid->CID.IsInLookupTable = FALSE;
+    QuicLookupSynchronize(Lookup);
     QuicDispatchRwLockReleaseExclusive(&Lookup->RwLock);
     QuicConnRelease(SourceCid->Connection, QUIC_CONN_REF_LOOKUP_TABLE);
 }
@@ -848,10 +1013,12 @@ QuicLookupRemoveLocalCids(
     uint8_t ReleaseRefCount = 0;
 
     QuicDispatchRwLockAcquireExclusive(&Lookup->RwLock);
-    while (Connection->SourceCids.Next != NULL) {
+    for (QUIC_SINGLE_LIST_ENTRY* Link = Connection->SourceCids.Next;
+        Link != NULL;
+        Link = Link->Next) {
         QUIC_CID_HASH_ENTRY *CID =
             QUIC_CONTAINING_RECORD(
-                QuicListPopEntry(&Connection->SourceCids),
+                Link,
                 QUIC_CID_HASH_ENTRY,
                 Link);
         if (CID->CID.IsInLookupTable) {
@@ -859,10 +1026,21 @@ QuicLookupRemoveLocalCids(
             CID->CID.IsInLookupTable = FALSE;
             ReleaseRefCount++;
         }
-        QUIC_FREE(CID);
+    }
+    if (ReleaseRefCount != 0) {
+        QuicLookupSynchronize(Lookup);
     }
     QuicDispatchRwLockReleaseExclusive(&Lookup->RwLock);
 
+    while (Connection->SourceCids.Next != NULL) {
+        QUIC_CID_HASH_ENTRY *CID =
+            QUIC_CONTAINING_RECORD(
+                QuicListPopEntry(&Connection->SourceCids),
+                QUIC_CID_HASH_ENTRY,
+                Link);
+        QUIC_FREE(CID);
+    }
+
     for (uint8_t i = 0; i < ReleaseRefCount; i++) {
 #pragma prefast(suppress:6001, "SAL doesn't understand ref counts")
         QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_TABLE);
@@ -878,6 +1056,7 @@ QuicLookupMoveLocalConnectionIDs(
     )
 {
     QUIC_SINGLE_LIST_ENTRY* Entry = Connection->SourceCids.Next;
+    uint8_t ReleaseRefCount = 0;
 
     QuicDispatchRwLockAcquireExclusive(&LookupSrc->RwLock);
     while (Entry != NULL) {
@@ -888,12 +1067,23 @@ QuicLookupMoveLocalConnectionIDs(
                 Link);
         if (CID->CID.IsInLookupTable) {
             QuicLookupRemoveLocalCidInt(LookupSrc, CID);
-            QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_TABLE);
+            ReleaseRefCount++;
         }
         Entry = Entry->Next;
     }
+    if (ReleaseRefCount != 0) {
+        //
+        // The entries are about to be linked into the destination lookup, so
+        // readers of the source lookup must be done with them first.
+        //
+        QuicLookupSynchronize(LookupSrc);
+    }
     QuicDispatchRwLockReleaseExclusive(&LookupSrc->RwLock);
 
+    for (uint8_t i = 0; i < ReleaseRefCount; i++) {
+        QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_TABLE);
+    }
+
     QuicDispatchRwLockAcquireExclusive(&LookupDest->RwLock);
 #pragma prefast(suppress:6001, "SAL doesn't understand ref counts")
     Entry = Connection->SourceCids.Next;
@@ -6,6 +6,7 @@
 --*/
 
 typedef struct QUIC_PARTITIONED_HASHTABLE QUIC_PARTITIONED_HASHTABLE;
+typedef struct QUIC_LOOKUP_READERS QUIC_LOOKUP_READERS;
 
 typedef struct QUIC_REMOTE_HASH_ENTRY {
 
@@ -38,6 +39,24 @@ typedef struct QUIC_LOOKUP {
     //
     QUIC_DISPATCH_RW_LOCK RwLock;
 
+    //
+    // Current read epoch for lock-free readers. Only changed by writers, while
+    // holding RwLock exclusively.
+    //
+    long ReadEpoch;
+
+    //
+    // Number of entries in Readers.
+    //
+    uint32_t ReadersCount;
+
+    //
+    // Per-processor counts of lock-free readers in each epoch. Published once
+    // partitioning is maximized, after which local CID lookups don't take any
+    // locks anymore.
+    //
+    QUIC_LOOKUP_READERS* Readers;
+
     //
     // The number of partitions used for lookup tables. Value of 0 (default)
     // indicates only a single connection (may be NULL) is bound.
@@ -52,6 +52,13 @@ QuicLossDetectionRetransmitFrames(
     _In_ QUIC_SENT_PACKET_METADATA* Packet
     );
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionOnPacketDiscarded(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _In_ QUIC_SENT_PACKET_METADATA* Packet
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicLossDetectionInitializeInternalState(
@@ -68,10 +75,12 @@ QuicLossDetectionInitialize(
     _Inout_ QUIC_LOSS_DETECTION* LossDetection
     )
 {
-    LossDetection->SentPackets = NULL;
-    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-    LossDetection->LostPackets = NULL;
-    LossDetection->LostPacketsTail = &LossDetection->LostPackets;
+    QuicSentPacketRingInitialize(&LossDetection->SentPackets);
+    LossDetection->OutstandingPacketCount = 0;
+    LossDetection->LostPacketCount = 0;
+    LossDetection->FirstOutstandingPacketNumber = 0;
+    LossDetection->TotalBytesAcked = 0;
+    LossDetection->AppLimitedTotalBytesAcked = 0;
     QuicLossDetectionInitializeInternalState(LossDetection);
 }
 
@@ -82,12 +91,21 @@ QuicLossDetectionUninitialize(
     )
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+    QUIC_SENT_PACKET_RING* Ring = &LossDetection->SentPackets;
 
-    while (LossDetection->SentPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-        LossDetection->SentPackets = LossDetection->SentPackets->Next;
+    while (Ring->Count != 0) {
+        QUIC_SENT_PACKET_SLOT* Slot =
+            QuicSentPacketRingGetSlot(Ring, Ring->FirstPacketNumber);
+        QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketSlotGetMetadata(Slot);
 
-        if (Packet->Flags.IsRetransmittable) {
+        if (Slot->State == QUIC_SENT_PACKET_STATE_LOST) {
+            QuicTraceLogVerbose(
+                PacketTxLostDiscarded,
+                "[%c][TX][%llu] Thrown away on shutdown (lost packet)",
+                PtkConnPre(Connection),
+                Packet->PacketNumber);
+
+        } else if (Packet->Flags.IsRetransmittable) {
             QuicTraceLogVerbose(
                 PacketTxDiscarded,
                 "[%c][TX][%llu] Thrown away on shutdown",
@@ -96,20 +114,13 @@ QuicLossDetectionUninitialize(
 
         }
 
-        QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
+        QuicLossDetectionOnPacketDiscarded(LossDetection, Packet);
+        QuicSentPacketRingRemove(Ring, &Connection->Worker->SentPacketPool, Slot);
     }
-    while (LossDetection->LostPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->LostPackets;
-        LossDetection->LostPackets = LossDetection->LostPackets->Next;
-
-        QuicTraceLogVerbose(
-            PacketTxLostDiscarded,
-            "[%c][TX][%llu] Thrown away on shutdown (lost packet)",
-            PtkConnPre(Connection),
-            Packet->PacketNumber);
+    LossDetection->OutstandingPacketCount = 0;
+    LossDetection->LostPacketCount = 0;
 
-        QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
-    }
+    QuicSentPacketRingUninitialize(Ring);
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -128,24 +139,51 @@ QuicLossDetectionReset(
     QuicLossDetectionInitializeInternalState(LossDetection);
 
     //
-    // Throw away any outstanding packets.
+    // Throw away any outstanding and lost packets.
     //
 
-    while (LossDetection->SentPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-        LossDetection->SentPackets = LossDetection->SentPackets->Next;
+    QUIC_SENT_PACKET_RING* Ring = &LossDetection->SentPackets;
+    while (Ring->Count != 0) {
+        QUIC_SENT_PACKET_SLOT* Slot =
+            QuicSentPacketRingGetSlot(Ring, Ring->FirstPacketNumber);
+        QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketSlotGetMetadata(Slot);
         QuicLossDetectionRetransmitFrames(LossDetection, Packet);
-        QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
+        QuicLossDetectionOnPacketDiscarded(LossDetection, Packet);
+        QuicSentPacketRingRemove(Ring, &Connection->Worker->SentPacketPool, Slot);
     }
-    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
+    LossDetection->OutstandingPacketCount = 0;
+    LossDetection->LostPacketCount = 0;
+    LossDetection->FirstOutstandingPacketNumber = 0;
+}
 
-    while (LossDetection->LostPackets != NULL) {
-        QUIC_SENT_PACKET_METADATA* Packet = LossDetection->LostPackets;
-        LossDetection->LostPackets = LossDetection->LostPackets->Next;
-        QuicLossDetectionRetransmitFrames(LossDetection, Packet);
-        QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
+//
+// Returns the smallest packet number that might still be outstanding. Lost
+// and acknowledged packets in front of it are skipped once and remembered, so
+// this is cheap to call on every ACK.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+uint64_t
+QuicLossDetectionFirstOutstandingPacketNumber(
+    _In_ QUIC_LOSS_DETECTION* LossDetection
+    )
+{
+    const QUIC_SENT_PACKET_RING* Ring = &LossDetection->SentPackets;
+    uint64_t End = QuicSentPacketRingEnd(Ring);
+    uint64_t PacketNumber = End;
+
+    if (LossDetection->OutstandingPacketCount != 0) {
+        PacketNumber =
+            max(LossDetection->FirstOutstandingPacketNumber,
+                Ring->FirstPacketNumber);
+        while (PacketNumber < End &&
+               QuicSentPacketRingGetSlot(Ring, PacketNumber)->State !=
+                    QUIC_SENT_PACKET_STATE_OUTSTANDING) {
+            PacketNumber++;
+        }
     }
-    LossDetection->LostPacketsTail = &LossDetection->LostPackets;
+
+    LossDetection->FirstOutstandingPacketNumber = PacketNumber;
+    return PacketNumber;
 }
 
 //
@@ -159,11 +197,20 @@ QuicLossDetectionOldestOutstandingPacket(
     _In_ QUIC_LOSS_DETECTION* LossDetection
     )
 {
-    QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-    while (Packet != NULL && !Packet->Flags.IsRetransmittable) {
-        Packet = Packet->Next;
+    QUIC_SENT_PACKET_RING* Ring = &LossDetection->SentPackets;
+    for (uint64_t PacketNumber =
+            QuicLossDetectionFirstOutstandingPacketNumber(LossDetection);
+        PacketNumber < QuicSentPacketRingEnd(Ring);
+        ++PacketNumber) {
+        QUIC_SENT_PACKET_SLOT* Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+        if (Slot->State == QUIC_SENT_PACKET_STATE_OUTSTANDING) {
+            QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketSlotGetMetadata(Slot);
+            if (Packet->Flags.IsRetransmittable) {
+                return Packet;
+            }
+        }
     }
-    return Packet;
+    return NULL;
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -341,28 +388,22 @@ QuicLossDetectionOnPacketSent(
     QUIC_DBG_ASSERT(TempSentPacket->FrameCount != 0);
 
     //
-    // Allocate a copy of the packet metadata.
+    // Copy the packet metadata into the sent packet ring.
     //
     SentPacket =
-        QuicSentPacketPoolGetPacketMetadata(
-            &Connection->Worker->SentPacketPool, TempSentPacket->FrameCount);
+        QuicSentPacketRingInsert(
+            &LossDetection->SentPackets,
+            &Connection->Worker->SentPacketPool,
+            TempSentPacket);
     if (SentPacket == NULL) {
         return QUIC_STATUS_OUT_OF_MEMORY;
     }
-    QuicCopyMemory(
-        SentPacket,
-        TempSentPacket,
-        sizeof(QUIC_SENT_PACKET_METADATA) +
-        sizeof(QUIC_SENT_FRAME_METADATA) * TempSentPacket->FrameCount);
 
     LossDetection->LargestSentPacketNumber = TempSentPacket->PacketNumber;
 
-    //
-    // Add to the outstanding-packet queue.
-    //
-    SentPacket->Next = NULL;
-    *LossDetection->SentPacketsTail = SentPacket;
-    LossDetection->SentPacketsTail = &SentPacket->Next;
+    if (LossDetection->OutstandingPacketCount++ == 0) {
+        LossDetection->FirstOutstandingPacketNumber = SentPacket->PacketNumber;
+    }
 
     QUIC_DBG_ASSERT(
         SentPacket->Flags.KeyType != QUIC_PACKET_KEY_0_RTT ||
@@ -374,8 +415,19 @@ QuicLossDetectionOnPacketSent(
 
         if (LossDetection->PacketsInFlight == 0) {
             QuicConnResetIdleTimeout(Connection);
+
+            //
+            // Nothing is in flight, so a new delivery interval starts now.
+            //
+            LossDetection->FirstSentTime = SentPacket->SentTime;
+            LossDetection->TotalBytesAckedTime = SentPacket->SentTime;
         }
 
+        SentPacket->TotalBytesAcked = LossDetection->TotalBytesAcked;
+        SentPacket->TotalBytesAckedTime = LossDetection->TotalBytesAckedTime;
+        SentPacket->FirstSentTime = LossDetection->FirstSentTime;
+        SentPacket->Flags.IsAppLimited = LossDetection->AppLimitedTotalBytesAcked != 0;
+
         Connection->Stats.Send.RetransmittablePackets++;
         LossDetection->PacketsInFlight++;
         LossDetection->TimeOfLastPacketSent = SentPacket->SentTime;
@@ -392,12 +444,32 @@ QuicLossDetectionOnPacketSent(
     return QUIC_STATUS_SUCCESS;
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionOnAppLimited(
+    _In_ QUIC_LOSS_DETECTION* LossDetection
+    )
+{
+    QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+    uint64_t AppLimitedTotalBytesAcked =
+        LossDetection->TotalBytesAcked +
+        Connection->CongestionControl.BytesInFlight;
+    LossDetection->AppLimitedTotalBytesAcked =
+        AppLimitedTotalBytesAcked != 0 ? AppLimitedTotalBytesAcked : 1;
+}
+
+//
+// Processes a newly acknowledged packet. If RateSample is provided, the packet
+// is counted as delivered and the sample is updated.
+//
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicLossDetectionOnPacketAcknowledged(
     _In_ QUIC_LOSS_DETECTION* LossDetection,
     _In_ QUIC_ENCRYPT_LEVEL EncryptLevel,
-    _In_ QUIC_SENT_PACKET_METADATA* Packet
+    _In_ QUIC_SENT_PACKET_METADATA* Packet,
+    _In_ uint32_t TimeNow,
+    _Inout_opt_ QUIC_RATE_SAMPLE* RateSample
     )
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
@@ -407,6 +479,31 @@ QuicLossDetectionOnPacketAcknowledged(
         EncryptLevel >= QUIC_ENCRYPT_LEVEL_INITIAL &&
         EncryptLevel < QUIC_ENCRYPT_LEVEL_COUNT);
 
+    if (RateSample != NULL && Packet->Flags.IsRetransmittable) {
+        LossDetection->TotalBytesAcked += Packet->PacketLength;
+        LossDetection->TotalBytesAckedTime = TimeNow;
+        if (LossDetection->AppLimitedTotalBytesAcked != 0 &&
+            LossDetection->TotalBytesAcked > LossDetection->AppLimitedTotalBytesAcked) {
+            LossDetection->AppLimitedTotalBytesAcked = 0;
+        }
+
+        //
+        // The sample covers the interval ending with the most recently sent
+        // packet that was acknowledged.
+        //
+        if (!RateSample->Valid ||
+            Packet->TotalBytesAcked >= RateSample->PriorTotalBytesAcked) {
+            RateSample->Valid = TRUE;
+            RateSample->IsAppLimited = Packet->Flags.IsAppLimited;
+            RateSample->Rtt = QuicTimeDiff32(Packet->SentTime, TimeNow);
+            RateSample->PriorTotalBytesAcked = Packet->TotalBytesAcked;
+            RateSample->PriorTotalBytesAckedTime = Packet->TotalBytesAckedTime;
+            RateSample->SendInterval =
+                QuicTimeDiff32(Packet->FirstSentTime, Packet->SentTime);
+            LossDetection->FirstSentTime = Packet->SentTime;
+        }
+    }
+
     if (!QuicConnIsServer(Connection) &&
         !Connection->State.HandshakeConfirmed &&
         Packet->Flags.KeyType == QUIC_PACKET_KEY_1_RTT) {
@@ -503,6 +600,16 @@ QuicLossDetectionOnPacketAcknowledged(
             }
             break;
         }
+
+        case QUIC_FRAME_DATAGRAM:
+        case QUIC_FRAME_DATAGRAM_1:
+            QuicDatagramIndicateSendStateChange(
+                Connection,
+                Packet->Frames[i].DATAGRAM.ClientContext,
+                Packet->Flags.SuspectedLost ?
+                    QUIC_DATAGRAM_SEND_ACKNOWLEDGED_SPURIOUS :
+                    QUIC_DATAGRAM_SEND_ACKNOWLEDGED);
+            break;
         }
     }
 
@@ -511,6 +618,45 @@ QuicLossDetectionOnPacketAcknowledged(
     }
 }
 
+//
+// Computes the delivery rate of a sample once all the packets acknowledged by
+// an ACK frame were processed.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionCompleteRateSample(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _Inout_ QUIC_RATE_SAMPLE* RateSample,
+    _In_ uint32_t TimeNow
+    )
+{
+    QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+
+    RateSample->TotalBytesAcked = LossDetection->TotalBytesAcked;
+    RateSample->DeliveryRate = 0;
+    if (!RateSample->Valid) {
+        return;
+    }
+
+    //
+    // Use the longer of the send and ACK intervals, since ACK compression can
+    // make the ACK interval artificially short. Intervals shorter than the min
+    // RTT can't be measured reliably, so they don't produce a rate.
+    //
+    uint32_t Interval =
+        QuicTimeDiff32(RateSample->PriorTotalBytesAckedTime, TimeNow);
+    if (Interval < RateSample->SendInterval) {
+        Interval = RateSample->SendInterval;
+    }
+    if (Interval == 0 || Interval < Connection->Paths[0].MinRtt) {
+        return;
+    }
+
+    RateSample->DeliveryRate =
+        (RateSample->TotalBytesAcked - RateSample->PriorTotalBytesAcked) *
+        S_TO_US(1) / Interval;
+}
+
 //
 // Marks all the frames in the packet that can be retransmitted as needing to be
 // retransmitted.
@@ -649,6 +795,45 @@ QuicLossDetectionRetransmitFrames(
                 &Connection->Send,
                 QUIC_CONN_SEND_FLAG_HANDSHAKE_DONE);
             break;
+
+        case QUIC_FRAME_DATAGRAM:
+        case QUIC_FRAME_DATAGRAM_1:
+            //
+            // Datagrams are never retransmitted; only let the app know.
+            //
+            if (!Packet->Flags.SuspectedLost) {
+                QuicDatagramIndicateSendStateChange(
+                    Connection,
+                    Packet->Frames[i].DATAGRAM.ClientContext,
+                    QUIC_DATAGRAM_SEND_LOST_SUSPECT);
+            }
+            break;
+        }
+    }
+
+    Packet->Flags.SuspectedLost = TRUE;
+}
+
+//
+// Indicates the final state of any frames in a packet that is being freed
+// without ever having been acknowledged.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionOnPacketDiscarded(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _In_ QUIC_SENT_PACKET_METADATA* Packet
+    )
+{
+    QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+
+    for (uint8_t i = 0; i < Packet->FrameCount; i++) {
+        if (Packet->Frames[i].Type == QUIC_FRAME_DATAGRAM ||
+            Packet->Frames[i].Type == QUIC_FRAME_DATAGRAM_1) {
+            QuicDatagramIndicateSendStateChange(
+                Connection,
+                Packet->Frames[i].DATAGRAM.ClientContext,
+                QUIC_DATAGRAM_SEND_LOST_DISCARDED);
         }
     }
 }
@@ -664,36 +849,49 @@ QuicLossDetectionDetectAndHandleLostPackets(
     )
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+    QUIC_SENT_PACKET_RING* Ring = &LossDetection->SentPackets;
     uint32_t LostRetransmittableBytes = 0;
+    QUIC_SENT_PACKET_SLOT* Slot;
     QUIC_SENT_PACKET_METADATA* Packet;
 
-    if (LossDetection->LostPackets != NULL) {
+    if (LossDetection->LostPacketCount != 0) {
         //
-        // Clean out any packets in the LostPackets list that we are pretty
-        // confident will never be acknowledged.
+        // Clean out any lost packets that we are pretty confident will never
+        // be acknowledged.
         //
         uint32_t TwoPto =
             QuicLossDetectionComputeProbeTimeout(
                 LossDetection,
                 &Connection->Paths[0], // TODO - Is this right?
                 2);
-        while ((Packet = LossDetection->LostPackets) != NULL &&
-                Packet->PacketNumber < LossDetection->LargestAck &&
-                QuicTimeDiff32(Packet->SentTime, TimeNow) > TwoPto) {
+        uint32_t LostPacketsLeft = LossDetection->LostPacketCount;
+        for (uint64_t PacketNumber = QuicSentPacketRingNext(Ring, 0);
+            LostPacketsLeft != 0 && PacketNumber < QuicSentPacketRingEnd(Ring);
+            PacketNumber = QuicSentPacketRingNext(Ring, PacketNumber + 1)) {
+
+            Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+            if (Slot->State != QUIC_SENT_PACKET_STATE_LOST) {
+                continue;
+            }
+            Packet = QuicSentPacketSlotGetMetadata(Slot);
+            if (Packet->PacketNumber >= LossDetection->LargestAck ||
+                QuicTimeDiff32(Packet->SentTime, TimeNow) <= TwoPto) {
+                break;
+            }
+
             QuicTraceLogVerbose(
                 PacketTxForget,
                 "[%c][TX][%llu] Forgetting",
                 PtkConnPre(Connection),
                 Packet->PacketNumber);
-            LossDetection->LostPackets = Packet->Next;
-            QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
-        }
-        if (LossDetection->LostPackets == NULL) {
-            LossDetection->LostPacketsTail = &LossDetection->LostPackets;
+            LostPacketsLeft--;
+            LossDetection->LostPacketCount--;
+            QuicLossDetectionOnPacketDiscarded(LossDetection, Packet);
+            QuicSentPacketRingRemove(Ring, &Connection->Worker->SentPacketPool, Slot);
         }
     }
 
-    if (LossDetection->SentPackets != NULL) {
+    if (LossDetection->OutstandingPacketCount != 0) {
         //
         // Remove "suspect" packets inferred lost from out-of-order ACKs.
         // The spec has:
@@ -706,9 +904,16 @@ QuicLossDetectionDetectAndHandleLostPackets(
         uint32_t Rtt = max(Path->SmoothedRtt, Path->LatestRttSample);
         uint32_t TimeReorderThreshold = QUIC_TIME_REORDER_THRESHOLD(Rtt);
         uint64_t LargestLostPacketNumber = 0;
-        QUIC_SENT_PACKET_METADATA* PrevPacket = NULL;
-        Packet = LossDetection->SentPackets;
-        while (Packet != NULL) {
+        for (uint64_t PacketNumber =
+                QuicLossDetectionFirstOutstandingPacketNumber(LossDetection);
+            PacketNumber < QuicSentPacketRingEnd(Ring);
+            ++PacketNumber) {
+
+            Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+            if (Slot->State != QUIC_SENT_PACKET_STATE_OUTSTANDING) {
+                continue;
+            }
+            Packet = QuicSentPacketSlotGetMetadata(Slot);
 
             BOOLEAN NonretransmittableHandshakePacket =
                 !Packet->Flags.IsRetransmittable &&
@@ -717,8 +922,6 @@ QuicLossDetectionDetectAndHandleLostPackets(
                 QuicKeyTypeToEncryptLevel(Packet->Flags.KeyType);
 
             if (EncryptLevel > LossDetection->LargestAckEncryptLevel) {
-                PrevPacket = Packet;
-                Packet = Packet->Next;
                 continue;
             } else if (Packet->PacketNumber + QUIC_PACKET_REORDER_THRESHOLD < LossDetection->LargestAck) {
                 if (!NonretransmittableHandshakePacket) {
@@ -761,19 +964,11 @@ QuicLossDetectionDetectAndHandleLostPackets(
             }
 
             LargestLostPacketNumber = Packet->PacketNumber;
-            if (PrevPacket == NULL) {
-                LossDetection->SentPackets = Packet->Next;
-            } else {
-                PrevPacket->Next = Packet->Next;
-            }
-
-            *LossDetection->LostPacketsTail = Packet;
-            LossDetection->LostPacketsTail = &Packet->Next;
-            Packet = Packet->Next;
-            *LossDetection->LostPacketsTail = NULL;
+            Slot->State = QUIC_SENT_PACKET_STATE_LOST;
+            LossDetection->OutstandingPacketCount--;
+            LossDetection->LostPacketCount++;
         }
-        if (LossDetection->SentPackets == NULL) {
-            LossDetection->SentPacketsTail = &LossDetection->SentPackets;
+        if (LossDetection->OutstandingPacketCount == 0) {
             QUIC_DBG_ASSERT(LossDetection->PacketsInFlight == 0);
         }
 
@@ -791,8 +986,9 @@ QuicLossDetectionDetectAndHandleLostPackets(
         }
     }
 
-    QUIC_DBG_ASSERT(LossDetection->SentPackets != NULL || LossDetection->SentPacketsTail == &LossDetection->SentPackets);
-    QUIC_DBG_ASSERT(LossDetection->LostPackets != NULL || LossDetection->LostPacketsTail == &LossDetection->LostPackets);
+    QUIC_DBG_ASSERT(
+        Ring->Count >=
+        LossDetection->OutstandingPacketCount + LossDetection->LostPacketCount);
 
     return LostRetransmittableBytes > 0;
 }
@@ -805,108 +1001,74 @@ QuicLossDetectionDiscardPackets(
     )
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+    QUIC_SENT_PACKET_RING* Ring = &LossDetection->SentPackets;
     QUIC_ENCRYPT_LEVEL EncryptLevel = QuicKeyTypeToEncryptLevel(KeyType);
-    QUIC_SENT_PACKET_METADATA* PrevPacket;
-    QUIC_SENT_PACKET_METADATA* Packet;
     uint32_t AckedRetransmittableBytes = 0;
     uint32_t TimeNow = QuicTimeUs32();
 
     QUIC_DBG_ASSERT(KeyType == QUIC_PACKET_KEY_INITIAL || KeyType == QUIC_PACKET_KEY_HANDSHAKE);
 
     //
-    // Implicitly ACK all outstanding packets.
+    // Implicitly ACK all outstanding and lost packets.
     //
 
-    PrevPacket = NULL;
-    Packet = LossDetection->LostPackets;
-    while (Packet != NULL) {
-        QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
+    for (uint64_t PacketNumber = Ring->FirstPacketNumber;
+        PacketNumber < QuicSentPacketRingEnd(Ring);
+        ++PacketNumber) {
 
-        if (Packet->Flags.KeyType == KeyType) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->LostPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->LostPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->LostPacketsTail = &LossDetection->LostPackets;
-                }
-            }
-
-            QuicTraceLogVerbose(
-                PacketTxAckedImplicit,
-                "[%c][TX][%llu] ACKed (implicit)",
-                PtkConnPre(Connection),
-                Packet->PacketNumber);
-            QuicTraceEvent(ConnPacketACKed,
-                Connection,
-                Packet->PacketNumber,
-                QuicPacketTraceType(Packet));
-            QuicLossDetectionOnPacketAcknowledged(LossDetection, EncryptLevel, Packet);
-            QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
-
-            Packet = NextPacket;
-
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
+        QUIC_SENT_PACKET_SLOT* Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+        if (Slot == NULL || Slot->State == QUIC_SENT_PACKET_STATE_EMPTY) {
+            continue;
+        }
+        QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketSlotGetMetadata(Slot);
+        if (Packet->Flags.KeyType != KeyType) {
+            continue;
         }
-    }
-
-    PrevPacket = NULL;
-    Packet = LossDetection->SentPackets;
-    while (Packet != NULL) {
-        QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
-
-        if (Packet->Flags.KeyType == KeyType) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->SentPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            }
 
-            QuicTraceLogVerbose(
-                PacketTxAckedImplicit,
-                "[%c][TX][%llu] ACKed (implicit)",
-                PtkConnPre(Connection),
-                Packet->PacketNumber);
-            QuicTraceEvent(ConnPacketACKed,
-                Connection,
-                Packet->PacketNumber,
-                QuicPacketTraceType(Packet));
+        QuicTraceLogVerbose(
+            PacketTxAckedImplicit,
+            "[%c][TX][%llu] ACKed (implicit)",
+            PtkConnPre(Connection),
+            Packet->PacketNumber);
+        QuicTraceEvent(ConnPacketACKed,
+            Connection,
+            Packet->PacketNumber,
+            QuicPacketTraceType(Packet));
 
+        if (Slot->State == QUIC_SENT_PACKET_STATE_LOST) {
+            LossDetection->LostPacketCount--;
+        } else {
+            LossDetection->OutstandingPacketCount--;
             if (Packet->Flags.IsRetransmittable) {
                 LossDetection->PacketsInFlight--;
                 AckedRetransmittableBytes += Packet->PacketLength;
             }
-
-            QuicLossDetectionOnPacketAcknowledged(LossDetection, EncryptLevel, Packet);
-            QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
-
-            Packet = NextPacket;
-
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
         }
+
+        QuicLossDetectionOnPacketAcknowledged(
+            LossDetection, EncryptLevel, Packet, TimeNow, NULL);
+        QuicSentPacketRingRemove(Ring, &Connection->Worker->SentPacketPool, Slot);
     }
 
     if (AckedRetransmittableBytes > 0) {
+        //
+        // Implicitly acknowledged packets weren't necessarily delivered, so
+        // they don't produce a delivery rate sample.
+        //
         const QUIC_PATH* Path = &Connection->Paths[0]; // TODO - Correct?
+        QUIC_ACK_EVENT AckEvent;
+        AckEvent.TimeNow = TimeNow;
+        AckEvent.LargestPacketNumberAcked = LossDetection->LargestAck;
+        AckEvent.NumRetransmittableBytes = AckedRetransmittableBytes;
+        AckEvent.SmoothedRtt = Path->SmoothedRtt;
+        AckEvent.MinRttValid = FALSE;
+        AckEvent.MinRtt = 0;
+        AckEvent.LatestRttSampleValid = FALSE;
+        AckEvent.LatestRttSample = 0;
+        AckEvent.RateSample = NULL;
         if (QuicCongestionControlOnDataAcknowledged(
                 &Connection->CongestionControl,
-                US_TO_MS(TimeNow),
-                LossDetection->LargestAck,
-                AckedRetransmittableBytes,
-                Path->SmoothedRtt)) {
+                &AckEvent)) {
             //
             // We were previously blocked and are now unblocked.
             //
@@ -922,52 +1084,41 @@ QuicLossDetectionOnZeroRttRejected(
     )
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
-    QUIC_SENT_PACKET_METADATA* PrevPacket;
-    QUIC_SENT_PACKET_METADATA* Packet;
+    QUIC_SENT_PACKET_RING* Ring = &LossDetection->SentPackets;
     uint32_t CountRetransmittableBytes = 0;
 
     //
     // Marks all the packets as lost so they can be retransmitted immediately.
     //
 
-    PrevPacket = NULL;
-    Packet = LossDetection->SentPackets;
-    while (Packet != NULL) {
-        QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
+    for (uint64_t PacketNumber =
+            QuicLossDetectionFirstOutstandingPacketNumber(LossDetection);
+        PacketNumber < QuicSentPacketRingEnd(Ring);
+        ++PacketNumber) {
 
-        if (Packet->Flags.KeyType == QUIC_PACKET_KEY_0_RTT) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->SentPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            }
-
-            QuicTraceLogVerbose(
-                PacketTx0RttRejected,
-                "[%c][TX][%llu] Rejected",
-                PtkConnPre(Connection),
-                Packet->PacketNumber);
-
-            QUIC_DBG_ASSERT(Packet->Flags.IsRetransmittable);
+        QUIC_SENT_PACKET_SLOT* Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+        if (Slot == NULL || Slot->State != QUIC_SENT_PACKET_STATE_OUTSTANDING) {
+            continue;
+        }
+        QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketSlotGetMetadata(Slot);
+        if (Packet->Flags.KeyType != QUIC_PACKET_KEY_0_RTT) {
+            continue;
+        }
 
-            LossDetection->PacketsInFlight--;
-            CountRetransmittableBytes += Packet->PacketLength;
+        QuicTraceLogVerbose(
+            PacketTx0RttRejected,
+            "[%c][TX][%llu] Rejected",
+            PtkConnPre(Connection),
+            Packet->PacketNumber);
 
-            QuicLossDetectionRetransmitFrames(LossDetection, Packet);
-            QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
+        QUIC_DBG_ASSERT(Packet->Flags.IsRetransmittable);
 
-            Packet = NextPacket;
+        LossDetection->OutstandingPacketCount--;
+        LossDetection->PacketsInFlight--;
+        CountRetransmittableBytes += Packet->PacketLength;
 
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
-        }
+        QuicLossDetectionRetransmitFrames(LossDetection, Packet);
+        QuicSentPacketRingRemove(Ring, &Connection->Worker->SentPacketPool, Slot);
     }
 
     if (CountRetransmittableBytes > 0) {
@@ -993,93 +1144,53 @@ QuicLossDetectionProcessAckBlocks(
     _Out_ BOOLEAN* InvalidAckBlock
     )
 {
-    QUIC_SENT_PACKET_METADATA* AckedPackets = NULL;
-    QUIC_SENT_PACKET_METADATA** AckedPacketsTail = &AckedPackets;
-
+    QUIC_SENT_PACKET_RING* Ring = &LossDetection->SentPackets;
     uint32_t PacketsInFlight = 0;
     uint32_t AckedRetransmittableBytes = 0;
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
     uint32_t TimeNow = QuicTimeUs32();
     uint32_t SmallestRtt = (uint32_t)(-1);
+    QUIC_RATE_SAMPLE RateSample = { 0 };
+    BOOLEAN AnyPacketAcked = FALSE;
     BOOLEAN NewLargestAck = FALSE;
     BOOLEAN NewLargestAckRetransmittable = FALSE;
     BOOLEAN NewLargestAckDifferentPath = FALSE;
 
     *InvalidAckBlock = FALSE;
 
-    QUIC_SENT_PACKET_METADATA** LostPacketsStart = &LossDetection->LostPackets;
-    QUIC_SENT_PACKET_METADATA** SentPacketsStart = &LossDetection->SentPackets;
     QUIC_SENT_PACKET_METADATA* LargestAckedPacket = NULL;
 
+    //
+    // Each ACK block maps to a run of consecutive slots in the sent packet
+    // ring. ACK frames keep acknowledging the same packets until an ACK for
+    // them arrives, so most of those slots are usually empty already and are
+    // skipped. Make sure every acknowledged packet was sent with the same
+    // encryption level before changing any state.
+    //
     uint32_t i = 0;
     QUIC_SUBRANGE* AckBlock;
     while ((AckBlock = QuicRangeGetSafe(AckBlocks, i++)) != NULL) {
 
-        //
-        // Check to see if any packets in the LostPackets list are acknowledged,
-        // which would mean we mistakenly classified those packets as lost.
-        //
-        if (*LostPacketsStart != NULL) {
-            while (*LostPacketsStart && (*LostPacketsStart)->PacketNumber < AckBlock->Low) {
-                LostPacketsStart = &((*LostPacketsStart)->Next);
-            }
-            QUIC_SENT_PACKET_METADATA** End = LostPacketsStart;
-            while (*End && (*End)->PacketNumber <= QuicRangeGetHigh(AckBlock)) {
-                QuicTraceLogVerbose(
-                    PacketTxSpuriousLoss,
-                    "[%c][TX][%llu] Spurious loss detected",
-                    PtkConnPre(Connection),
-                    (*End)->PacketNumber);
-                Connection->Stats.Send.SpuriousLostPackets++;
+        uint64_t End =
+            min(QuicRangeGetHigh(AckBlock) + 1, QuicSentPacketRingEnd(Ring));
+        for (uint64_t PacketNumber = QuicSentPacketRingNext(Ring, AckBlock->Low);
+            PacketNumber < End;
+            PacketNumber = QuicSentPacketRingNext(Ring, PacketNumber + 1)) {
+
+            QUIC_SENT_PACKET_SLOT* Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+            QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketSlotGetMetadata(Slot);
+            if (QuicKeyTypeToEncryptLevel(Packet->Flags.KeyType) != EncryptLevel) {
                 //
-                // NOTE: we don't increment AckedRetransmittableBytes here
-                // because we already told the congestion control module that
-                // this packet left the network.
+                // The packet was not acknowledged with the same encryption level.
                 //
-                End = &((*End)->Next);
-            }
-            if (LostPacketsStart != End) {
-                *AckedPacketsTail = *LostPacketsStart;
-                AckedPacketsTail = End;
-                *LostPacketsStart = *End;
-                *End = NULL;
-                if (End == LossDetection->LostPacketsTail) {
-                    LossDetection->LostPacketsTail = LostPacketsStart;
-                }
-                QUIC_DBG_ASSERT(LossDetection->LostPackets != NULL || LossDetection->LostPacketsTail == &LossDetection->LostPackets);
-            }
-        }
-
-        //
-        // Now find all the acknowledged packets in the SentPackets list.
-        //
-        if (*SentPacketsStart != NULL) {
-            while (*SentPacketsStart && (*SentPacketsStart)->PacketNumber < AckBlock->Low) {
-                SentPacketsStart = &((*SentPacketsStart)->Next);
-            }
-            QUIC_SENT_PACKET_METADATA** End = SentPacketsStart;
-            while (*End && (*End)->PacketNumber <= QuicRangeGetHigh(AckBlock)) {
-
-                if ((*End)->Flags.IsRetransmittable) {
-                    PacketsInFlight++;
-                    AckedRetransmittableBytes += (*End)->PacketLength;
-                }
-                LargestAckedPacket = *End;
-                End = &((*End)->Next);
+                QuicTraceEvent(ConnError, Connection, "Incorrect ACK encryption level");
+                *InvalidAckBlock = TRUE;
+                return;
             }
 
-            if (SentPacketsStart != End) {
-                //
-                // Remove the ACKed packets from the outstanding packet list.
-                //
-                *AckedPacketsTail = *SentPacketsStart;
-                AckedPacketsTail = End;
-                *SentPacketsStart = *End;
-                *End = NULL;
-                if (End == LossDetection->SentPacketsTail) {
-                    LossDetection->SentPacketsTail = SentPacketsStart;
-                }
-                QUIC_DBG_ASSERT(LossDetection->SentPackets != NULL || LossDetection->SentPacketsTail == &LossDetection->SentPackets);
+            AnyPacketAcked = TRUE;
+            if (Slot->State == QUIC_SENT_PACKET_STATE_OUTSTANDING) {
+                LargestAckedPacket = Packet;
             }
         }
 
@@ -1095,47 +1206,76 @@ QuicLossDetectionProcessAckBlocks(
         }
     }
 
-    if (AckedPackets == NULL) {
+    if (!AnyPacketAcked) {
         //
         // Nothing was acknowledged, so we can exit now.
         //
         return;
     }
 
-    while (AckedPackets != NULL) {
+    //
+    // N.B. Acknowledging a packet can confirm the handshake, which discards
+    // the handshake packets from the ring. So each slot is looked up again by
+    // packet number instead of holding on to positions in the ring.
+    //
+    i = 0;
+    while ((AckBlock = QuicRangeGetSafe(AckBlocks, i++)) != NULL) {
 
-        QUIC_SENT_PACKET_METADATA* Packet = AckedPackets;
-        AckedPackets = AckedPackets->Next;
+        for (uint64_t PacketNumber = QuicSentPacketRingNext(Ring, AckBlock->Low);
+            PacketNumber <= QuicRangeGetHigh(AckBlock) &&
+                PacketNumber < QuicSentPacketRingEnd(Ring);
+            PacketNumber = QuicSentPacketRingNext(Ring, PacketNumber + 1)) {
 
-        if (QuicKeyTypeToEncryptLevel(Packet->Flags.KeyType) != EncryptLevel) {
-            //
-            // The packet was not acknowledged with the same encryption level.
-            //
-            QuicTraceEvent(ConnError, Connection, "Incorrect ACK encryption level");
-            *InvalidAckBlock = TRUE;
-            return;
-        }
+            QUIC_SENT_PACKET_SLOT* Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+            QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketSlotGetMetadata(Slot);
+            if (Slot->State == QUIC_SENT_PACKET_STATE_LOST) {
+                //
+                // We mistakenly classified this packet as lost.
+                //
+                QuicTraceLogVerbose(
+                    PacketTxSpuriousLoss,
+                    "[%c][TX][%llu] Spurious loss detected",
+                    PtkConnPre(Connection),
+                    Packet->PacketNumber);
+                Connection->Stats.Send.SpuriousLostPackets++;
+                LossDetection->LostPacketCount--;
+                //
+                // NOTE: we don't increment AckedRetransmittableBytes here
+                // because we already told the congestion control module that
+                // this packet left the network.
+                //
+            } else {
+                LossDetection->OutstandingPacketCount--;
+                if (Packet->Flags.IsRetransmittable) {
+                    PacketsInFlight++;
+                    AckedRetransmittableBytes += Packet->PacketLength;
+                }
+            }
 
-        uint32_t PacketRtt = QuicTimeDiff32(Packet->SentTime, TimeNow);
-        QuicTraceLogVerbose(
-            PacketTxAcked,
-            "[%c][TX][%llu] ACKed (%u.%03u ms)",
-            PtkConnPre(Connection),
-            Packet->PacketNumber,
-            PacketRtt / 1000,
-            PacketRtt % 1000);
-            QuicTraceEvent(ConnPacketACKed,
-                Connection,
+            uint32_t PacketRtt = QuicTimeDiff32(Packet->SentTime, TimeNow);
+            QuicTraceLogVerbose(
+                PacketTxAcked,
+                "[%c][TX][%llu] ACKed (%u.%03u ms)",
+                PtkConnPre(Connection),
                 Packet->PacketNumber,
-                QuicPacketTraceType(Packet));
+                PacketRtt / 1000,
+                PacketRtt % 1000);
+                QuicTraceEvent(ConnPacketACKed,
+                    Connection,
+                    Packet->PacketNumber,
+                    QuicPacketTraceType(Packet));
 
-        SmallestRtt = min(SmallestRtt, PacketRtt);
+            SmallestRtt = min(SmallestRtt, PacketRtt);
 
-        QuicLossDetectionOnPacketAcknowledged(LossDetection, EncryptLevel, Packet);
-        QuicSentPacketPoolReturnPacketMetadata(&Connection->Worker->SentPacketPool, Packet);
+            QuicLossDetectionOnPacketAcknowledged(
+                LossDetection, EncryptLevel, Packet, TimeNow, &RateSample);
+            QuicSentPacketRingRemove(Ring, &Connection->Worker->SentPacketPool, Slot);
+        }
     }
 
     LossDetection->PacketsInFlight -= PacketsInFlight;
+    uint32_t MinRtt = SmallestRtt;
+    BOOLEAN RttUpdated = FALSE;
 
     if (NewLargestAckRetransmittable && !NewLargestAckDifferentPath) {
         //
@@ -1150,6 +1290,7 @@ QuicLossDetectionProcessAckBlocks(
             SmallestRtt -= (uint32_t)AckDelay;
         }
         QuicConnUpdateRtt(Connection, Path, SmallestRtt);
+        RttUpdated = TRUE;
     }
 
     if (NewLargestAck) {
@@ -1162,12 +1303,20 @@ QuicLossDetectionProcessAckBlocks(
     }
 
     if (NewLargestAck || AckedRetransmittableBytes > 0) {
+        QuicLossDetectionCompleteRateSample(LossDetection, &RateSample, TimeNow);
+        QUIC_ACK_EVENT AckEvent;
+        AckEvent.TimeNow = TimeNow;
+        AckEvent.LargestPacketNumberAcked = LossDetection->LargestAck;
+        AckEvent.NumRetransmittableBytes = AckedRetransmittableBytes;
+        AckEvent.SmoothedRtt = Connection->Paths[0].SmoothedRtt;
+        AckEvent.MinRttValid = TRUE;
+        AckEvent.MinRtt = MinRtt;
+        AckEvent.LatestRttSampleValid = RttUpdated;
+        AckEvent.LatestRttSample = Path->LatestRttSample;
+        AckEvent.RateSample = &RateSample;
         if (QuicCongestionControlOnDataAcknowledged(
                 &Connection->CongestionControl,
-                US_TO_MS(TimeNow),
-                LossDetection->LargestAck,
-                AckedRetransmittableBytes,
-                Connection->Paths[0].SmoothedRtt)) {
+                &AckEvent)) {
             //
             // We were previously blocked and are now unblocked.
             //
@@ -1311,8 +1460,16 @@ QuicLossDetectionScheduleProbe(
     // Not enough new stream data exists to fill the probing packets. Schedule
     // retransmits if possible.
     //
-    QUIC_SENT_PACKET_METADATA* Packet = LossDetection->SentPackets;
-    while (Packet != NULL) {
+    QUIC_SENT_PACKET_RING* Ring = &LossDetection->SentPackets;
+    for (uint64_t PacketNumber =
+            QuicLossDetectionFirstOutstandingPacketNumber(LossDetection);
+        PacketNumber < QuicSentPacketRingEnd(Ring);
+        ++PacketNumber) {
+        QUIC_SENT_PACKET_SLOT* Slot = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+        if (Slot->State != QUIC_SENT_PACKET_STATE_OUTSTANDING) {
+            continue;
+        }
+        QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketSlotGetMetadata(Slot);
         if (Packet->Flags.IsRetransmittable) {
             QuicTraceLogVerbose(
                 PacketTxProbeRetransmit,
@@ -1329,7 +1486,6 @@ QuicLossDetectionScheduleProbe(
                 return;
             }
         }
-        Packet = Packet->Next;
     }
 
     //
@@ -1379,7 +1535,7 @@ QuicLossDetectionProcessTimerOperation(
         QuicTimeDiff32(OldestPacket->SentTime, TimeNow) >=
             Connection->DisconnectTimeoutUs) {
         //
-        // OldestPacket has been in the SentPackets list for at least
+        // OldestPacket has been outstanding for at least
         // DisconnectTimeoutUs without an ACK for either OldestPacket or for any
         // packets sent more than the reordering threshold after it. Assume the
         // path is dead and close the connection.
@@ -23,31 +23,47 @@ typedef struct QUIC_LOSS_DETECTION {
     QUIC_ENCRYPT_LEVEL LargestAckEncryptLevel;
 
     //
-    // N.B.: SentPackets and LostPackets are generally kept in ascending packet
-    // number order, and packets in the LostPackets list generally have smaller
-    // numbers than those in the SentPackets list. The only case this is not
-    // true is during the handshake. Since multiple encryption levels are used
-    // in parallel, higher numbered packets in lower encryption levels can be
-    // "lost" sooner than the higher encryption levels.
+    // N.B.: Lost packets generally have smaller numbers than outstanding
+    // packets. The only case this is not true is during the handshake. Since
+    // multiple encryption levels are used in parallel, higher numbered packets
+    // in lower encryption levels can be "lost" sooner than the higher
+    // encryption levels.
     //
 
     //
-    // Outstanding packets.
+    // Outstanding and lost packets, by packet number. Lost packets are
+    // remembered a little while after we decide they are lost, in case we were
+    // wrong and the ACK comes in later than expected. For accounting purposes
+    // we don't consider these packets to be in the network.
     //
     uint64_t LargestSentPacketNumber;
-    QUIC_SENT_PACKET_METADATA* SentPackets;
-    QUIC_SENT_PACKET_METADATA** SentPacketsTail;
+    QUIC_SENT_PACKET_RING SentPackets;
+    uint32_t OutstandingPacketCount;
+    uint32_t LostPacketCount;
+
+    //
+    // No outstanding packet has a smaller packet number than this.
+    //
+    uint64_t FirstOutstandingPacketNumber;
 
     uint32_t TimeOfLastPacketSent;
 
     //
-    // Lost packets. The purpose of this list is to remember packets a little
-    // while after we decide they are lost, in case we were wrong and the ACK
-    // comes in later than expected. For accounting purposes we don't consider
-    // these packets to be in the network.
+    // Delivery rate estimation state. TotalBytesAcked counts the
+    // retransmittable bytes acknowledged over the connection's lifetime, and
+    // TotalBytesAckedTime is when it last grew. FirstSentTime is the send time
+    // of the packet that starts the current delivery interval.
     //
-    QUIC_SENT_PACKET_METADATA* LostPackets;
-    QUIC_SENT_PACKET_METADATA** LostPacketsTail;
+    uint64_t TotalBytesAcked;
+    uint32_t TotalBytesAckedTime; // In microseconds
+    uint32_t FirstSentTime; // In microseconds
+
+    //
+    // Non-zero while the sends are limited by the app rather than the
+    // network. It is the TotalBytesAcked value at which the packets in flight
+    // when the app ran out of data are all acknowledged.
+    //
+    uint64_t AppLimitedTotalBytesAcked;
 
     //
     // Number of probes sent.
@@ -114,6 +130,16 @@ QuicLossDetectionComputeProbeTimeout(
     _In_ uint32_t Count
     );
 
+//
+// Called when the app has no more data to send while congestion control
+// would allow more, so delivery rate samples don't reflect the network.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicLossDetectionOnAppLimited(
+    _In_ QUIC_LOSS_DETECTION* LossDetection
+    );
+
 //
 // Called when a new packet is sent.
 //
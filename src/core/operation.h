@@ -50,6 +50,8 @@ typedef enum QUIC_API_TYPE {
     QUIC_API_TYPE_STRM_RECV_COMPLETE,
     QUIC_API_TYPE_STRM_RECV_SET_ENABLED,
 
+    QUIC_API_TYPE_DATAGRAM_SEND,
+
     QUIC_API_TYPE_SET_PARAM,
     QUIC_API_TYPE_GET_PARAM
 
@@ -27,6 +27,13 @@ QuicFuzzInjectHook(
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicPacketBuilderSendBatch(
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicPacketBuilderCompleteCryptoJob(
     _Inout_ QUIC_PACKET_BUILDER* Builder
     );
 
@@ -95,11 +102,18 @@ QuicPacketBuilderCleanup(
         QuicPacketBuilderFinalize(Builder, TRUE);
     }
 
+    //
+    // The last full set of datagrams may still be waiting on its crypto job.
+    //
+    QuicPacketBuilderCompleteCryptoJob(Builder);
+
+    QUIC_DBG_ASSERT(Builder->Batch.Count == 0);
+    QUIC_DBG_ASSERT(Builder->CryptoJob == NULL);
+    QUIC_DBG_ASSERT(Builder->PendingSendContext == NULL);
+
     if (Builder->PacketBatchSent && Builder->PacketBatchRetransmittable) {
         QuicLossDetectionUpdateTimer(&Builder->Connection->LossDetection);
     }
-
-    QuicSecureZeroMemory(Builder->HpMask, sizeof(Builder->HpMask));
 }
 
 //
@@ -269,6 +283,7 @@ QuicPacketBuilderPrepare(
         Builder->Metadata->Flags.IsRetransmittable = FALSE;
         Builder->Metadata->Flags.HasCrypto = FALSE;
         Builder->Metadata->Flags.IsPMTUD = IsPathMtuDiscovery;
+        Builder->Metadata->Flags.SuspectedLost = FALSE;
 
         Builder->PacketStart = Builder->DatagramLength;
         Builder->HeaderLength = 0;
@@ -497,38 +512,82 @@ QuicPacketBuilderPrepareForStreamFrames(
     return QuicPacketBuilderPrepare(Builder, PacketKeyType, IsTailLossProbe, FALSE);
 }
 
+//
+// Waits for the batch outstanding on the crypto offload pool, if any, to be
+// protected, and then sends the datagrams that were waiting on it.
+//
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
-QuicPacketBuilderFinalizeHeaderProtection(
+QuicPacketBuilderCompleteCryptoJob(
     _Inout_ QUIC_PACKET_BUILDER* Builder
     )
 {
-    QUIC_DBG_ASSERT(Builder->Key != NULL);
+    if (Builder->CryptoJob != NULL) {
+        QUIC_STATUS Status =
+            QuicCryptoOffloadComplete(MsQuicLib.CryptoOffloadPool, Builder->CryptoJob);
+        Builder->CryptoJob = NULL;
+        if (QUIC_FAILED(Status)) {
+            QuicConnFatalError(Builder->Connection, Status, "Encryption failure");
+        }
+    }
 
-    QUIC_STATUS Status;
-    if (QUIC_FAILED(
-        Status =
-        QuicHpComputeMask(
-            Builder->Key->HeaderKey,
-            Builder->BatchCount,
-            Builder->CipherBatch,
-            Builder->HpMask))) {
-        QUIC_TEL_ASSERT(FALSE);
-        QuicConnFatalError(Builder->Connection, Status, "HP failure");
-        return;
+    if (Builder->PendingSendContext != NULL) {
+        QUIC_DATAPATH_SEND_CONTEXT* SendContext = Builder->PendingSendContext;
+        Builder->PendingSendContext = NULL;
+        QuicPacketBuilderSendBatch(Builder, SendContext);
     }
+}
 
-    for (uint8_t i = 0; i < Builder->BatchCount; ++i) {
-        uint16_t Offset = i * QUIC_HP_SAMPLE_LENGTH;
-        uint8_t* Header = Builder->HeaderBatch[i];
-        Header[0] ^= (Builder->HpMask[Offset] & 0x1f); // Bottom 5 bits for SH
-        Header += 1 + Builder->Path->DestCid->CID.Length;
-        for (uint8_t j = 0; j < Builder->PacketNumberLength; ++j) {
-            Header[j] ^= Builder->HpMask[Offset + 1 + j];
+//
+// Encrypts the batched short header packets and then applies their header
+// protection, which samples the cipher text. If AllowOffload is set, the batch
+// may be handed to the crypto offload pool instead, to be completed later.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicPacketBuilderFinalizeBatch(
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
+    _In_ BOOLEAN AllowOffload
+    )
+{
+    QUIC_DBG_ASSERT(Builder->Batch.Count != 0);
+
+    //
+    // Only one batch may be in progress at a time, as the key can't be used
+    // from several threads at once. This also keeps the packets in order.
+    //
+    QuicPacketBuilderCompleteCryptoJob(Builder);
+
+    if (AllowOffload && MsQuicLib.CryptoOffloadPool != NULL) {
+        Builder->CryptoJob =
+            QuicCryptoOffloadQueue(MsQuicLib.CryptoOffloadPool, &Builder->Batch);
+        if (Builder->CryptoJob != NULL) {
+            Builder->Batch.Count = 0;
+            return;
         }
     }
 
-    Builder->BatchCount = 0;
+    QUIC_STATUS Status = QuicCryptoBatchProtect(&Builder->Batch);
+    if (QUIC_FAILED(Status)) {
+        QuicConnFatalError(Builder->Connection, Status, "Encryption failure");
+    }
+    Builder->Batch.Count = 0;
+}
+
+//
+// Makes sure all packets framed so far are fully protected.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicPacketBuilderFlushBatch(
+    _Inout_ QUIC_PACKET_BUILDER* Builder
+    )
+{
+    if (Builder->Batch.Count != 0) {
+        QuicPacketBuilderFinalizeBatch(Builder, FALSE);
+    } else {
+        QuicPacketBuilderCompleteCryptoJob(Builder);
+    }
 }
 
 //
@@ -667,77 +726,87 @@ QuicPacketBuilderFinalize(
 
     if (Connection->State.EncryptionEnabled) {
 
-        //
-        // Encrypt the data.
-        //
-
         PayloadLength += Builder->EncryptionOverhead;
         Builder->DatagramLength += Builder->EncryptionOverhead;
 
-        uint8_t* Payload = Header + Builder->HeaderLength;
-
-        uint8_t Iv[QUIC_IV_LENGTH];
-        QuicCryptoCombineIvAndPacketNumber(Builder->Key->Iv, (uint8_t*) &Builder->Metadata->PacketNumber, Iv);
-
         QUIC_STATUS Status;
-        if (QUIC_FAILED(
-            Status =
-            QuicEncrypt(
-                Builder->Key->PacketKey,
-                Iv,
-                Builder->HeaderLength,
-                Header,
-                PayloadLength,
-                Payload))) {
-            QuicConnFatalError(Connection, Status, "Encryption failure");
-            goto Exit;
-        }
+        if (Builder->PacketType == SEND_PACKET_SHORT_HEADER_TYPE) {
+            QUIC_CRYPTO_BATCH* Batch = &Builder->Batch;
+            QUIC_DBG_ASSERT(Batch->Count < QUIC_MAX_CRYPTO_BATCH_COUNT);
+            QUIC_DBG_ASSERT(
+                Batch->Count == 0 ||
+                Builder->Metadata->PacketNumber ==
+                    Batch->PacketNumber + Batch->Count);
 
-        if (Connection->State.HeaderProtectionEnabled) {
+            //
+            // Batch the encryption and header protection for short header
+            // packets. The whole burst is sealed at once before it is sent.
+            //
 
-            uint8_t* PnStart = Payload - Builder->PacketNumberLength;
+            if (Batch->Count == 0) {
+                Batch->Key = Builder->Key;
+                Batch->PacketNumber = Builder->Metadata->PacketNumber;
+                Batch->PacketNumberOffset =
+                    (uint8_t)(Builder->HeaderLength - Builder->PacketNumberLength);
+                Batch->PacketNumberLength = Builder->PacketNumberLength;
+                Batch->HeaderProtectionEnabled =
+                    Connection->State.HeaderProtectionEnabled;
+            }
+            Batch->Headers[Batch->Count] = Header;
+            Batch->PayloadLengths[Batch->Count] = PayloadLength;
 
-            if (Builder->PacketType == SEND_PACKET_SHORT_HEADER_TYPE) {
-                QUIC_DBG_ASSERT(Builder->BatchCount < QUIC_MAX_CRYPTO_BATCH_COUNT);
+            if (++Batch->Count == QUIC_MAX_CRYPTO_BATCH_COUNT) {
+                QuicPacketBuilderFinalizeBatch(Builder, TRUE);
+            }
 
-                //
-                // Batch the header protection for short header packets.
-                //
+        } else {
+            QUIC_DBG_ASSERT(Builder->Batch.Count == 0);
 
-                QuicCopyMemory(
-                    Builder->CipherBatch + Builder->BatchCount * QUIC_HP_SAMPLE_LENGTH,
-                    PnStart + 4,
-                    QUIC_HP_SAMPLE_LENGTH);
-                Builder->HeaderBatch[Builder->BatchCount] = Header;
+            //
+            // Individually encrypt and do header protection for long header
+            // packets as they generally use different keys.
+            //
 
-                if (++Builder->BatchCount == QUIC_MAX_CRYPTO_BATCH_COUNT) {
-                    QuicPacketBuilderFinalizeHeaderProtection(Builder);
-                }
+            uint8_t* Payload = Header + Builder->HeaderLength;
+
+            uint8_t Iv[QUIC_IV_LENGTH];
+            QuicCryptoCombineIvAndPacketNumber(Builder->Key->Iv, (uint8_t*) &Builder->Metadata->PacketNumber, Iv);
+
+            if (QUIC_FAILED(
+                Status =
+                QuicEncrypt(
+                    Builder->Key->PacketKey,
+                    Iv,
+                    Builder->HeaderLength,
+                    Header,
+                    PayloadLength,
+                    Payload))) {
+                QuicConnFatalError(Connection, Status, "Encryption failure");
+                goto Exit;
+            }
 
-            } else {
-                QUIC_DBG_ASSERT(Builder->BatchCount == 0);
+            if (Connection->State.HeaderProtectionEnabled) {
 
-                //
-                // Individually do header protection for long header packets as
-                // they generally use different keys.
-                //
+                uint8_t* PnStart = Payload - Builder->PacketNumberLength;
 
+                uint8_t HpMask[QUIC_HP_SAMPLE_LENGTH];
                 if (QUIC_FAILED(
                     Status =
                     QuicHpComputeMask(
                         Builder->Key->HeaderKey,
                         1,
                         PnStart + 4,
-                        Builder->HpMask))) {
+                        HpMask))) {
                     QUIC_TEL_ASSERT(FALSE);
                     QuicConnFatalError(Connection, Status, "HP failure");
                     goto Exit;
                 }
 
-                Header[0] ^= (Builder->HpMask[0] & 0x0f); // Bottom 4 bits for LH
+                Header[0] ^= (HpMask[0] & 0x0f); // Bottom 4 bits for LH
                 for (uint8_t i = 0; i < Builder->PacketNumberLength; ++i) {
-                    PnStart[i] ^= Builder->HpMask[1 + i];
+                    PnStart[i] ^= HpMask[1 + i];
                 }
+                QuicSecureZeroMemory(HpMask, sizeof(HpMask));
             }
         }
 
@@ -757,6 +826,11 @@ QuicPacketBuilderFinalize(
             !PacketSpace->AwaitingKeyPhaseConfirmation &&
             Connection->State.HandshakeConfirmed) {
 
+            //
+            // The batched packets must be sealed with the current key first.
+            //
+            QuicPacketBuilderFlushBatch(Builder);
+
             Status = QuicCryptoGenerateNewKeys(Connection);
             if (QUIC_FAILED(Status)) {
                 QuicTraceEvent(ConnErrorStatus,
@@ -823,11 +897,30 @@ Exit:
             ++Builder->TotalCountDatagrams;
         }
 
-        if (FlushBatchedDatagrams || QuicDataPathBindingIsSendContextFull(Builder->SendContext)) {
-            if (Builder->BatchCount != 0) {
-                QuicPacketBuilderFinalizeHeaderProtection(Builder);
+        if (FlushBatchedDatagrams) {
+            QuicPacketBuilderFlushBatch(Builder);
+            QuicPacketBuilderSendBatch(Builder, Builder->SendContext);
+            Builder->SendContext = NULL;
+
+        } else if (QuicDataPathBindingIsSendContextFull(Builder->SendContext)) {
+            //
+            // More datagrams are likely to follow, so the last batch of this
+            // set may be protected by the crypto offload pool while the next
+            // set is framed. The set is then sent once that completes. Without
+            // segmentation offload, a set is only a few datagrams, so this is
+            // where most batches are handed off.
+            //
+            if (Builder->Batch.Count != 0) {
+                QuicPacketBuilderFinalizeBatch(Builder, TRUE);
+            } else {
+                QuicPacketBuilderCompleteCryptoJob(Builder);
             }
-            QuicPacketBuilderSendBatch(Builder);
+            if (Builder->CryptoJob != NULL) {
+                Builder->PendingSendContext = Builder->SendContext;
+            } else {
+                QuicPacketBuilderSendBatch(Builder, Builder->SendContext);
+            }
+            Builder->SendContext = NULL;
         }
 
         if (Builder->PacketType == QUIC_RETRY) {
@@ -844,7 +937,8 @@ Exit:
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicPacketBuilderSendBatch(
-    _Inout_ QUIC_PACKET_BUILDER* Builder
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext
     )
 {
     QuicTraceLogConnVerbose(
@@ -857,16 +951,15 @@ QuicPacketBuilderSendBatch(
         QuicBindingSendTo(
             Builder->Path->Binding,
             &Builder->Path->RemoteAddress,
-            Builder->SendContext);
+            SendContext);
 
     } else {
         QuicBindingSendFromTo(
             Builder->Path->Binding,
             &Builder->Path->LocalAddress,
             &Builder->Path->RemoteAddress,
-            Builder->SendContext);
+            SendContext);
     }
 
     Builder->PacketBatchSent = TRUE;
-    Builder->SendContext = NULL;
 }
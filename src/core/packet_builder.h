@@ -42,20 +42,21 @@ typedef struct QUIC_PACKET_BUILDER {
     QUIC_PACKET_KEY* Key;
 
     //
-    // Cipher text across multiple packets to batch header protection.
+    // Short header packets that still need to be encrypted and header
+    // protected.
     //
-    uint8_t CipherBatch[QUIC_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
+    QUIC_CRYPTO_BATCH Batch;
 
     //
-    // Output header protection mask.
+    // A previous batch still being protected by the crypto offload pool.
     //
-    uint8_t HpMask[QUIC_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
-
+    QUIC_CRYPTO_OFFLOAD_JOB* CryptoJob;
 
     //
-    // Headers that need to be batched.
+    // A full set of datagrams whose last batch is still being protected by
+    // the crypto offload pool. It is sent as soon as CryptoJob completes.
     //
-    uint8_t* HeaderBatch[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    QUIC_DATAPATH_SEND_CONTEXT* PendingSendContext;
 
     //
     // Indicates a batch of packets has been sent.
@@ -68,11 +69,6 @@ typedef struct QUIC_PACKET_BUILDER {
     //
     uint8_t PacketBatchRetransmittable : 1;
 
-    //
-    // The number of batched packets to do header protection on.
-    //
-    uint8_t BatchCount : 4;
-
     //
     // The total number of datagrams that have been created.
     //
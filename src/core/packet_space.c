@@ -23,7 +23,9 @@ QuicPacketSpaceInitialize(
     QUIC_STATUS Status;
     QUIC_PACKET_SPACE* Packets;
 
-    Packets = QUIC_ALLOC_NONPAGED(sizeof(QUIC_PACKET_SPACE));
+    Packets =
+        QuicPoolAlloc(
+            &MsQuicLib.PerProc[QuicLibraryGetCurrentPartition()].PacketSpacePool);
     if (Packets == NULL) {
         QuicTraceEvent(AllocFailure, "packet space", sizeof(QUIC_PACKET_SPACE));
         Status = QUIC_STATUS_OUT_OF_MEMORY;
@@ -45,7 +47,9 @@ QuicPacketSpaceInitialize(
 Error:
 
     if (Packets != NULL) {
-        QUIC_FREE(Packets);
+        QuicPoolFree(
+            &MsQuicLib.PerProc[QuicLibraryGetCurrentPartition()].PacketSpacePool,
+            Packets);
     }
 
     return Status;
@@ -70,7 +74,9 @@ QuicPacketSpaceUninitialize(
 
     QuicAckTrackerUninitialize(&Packets->AckTracker);
 
-    QUIC_FREE(Packets);
+    QuicPoolFree(
+        &MsQuicLib.PerProc[QuicLibraryGetCurrentPartition()].PacketSpacePool,
+        Packets);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
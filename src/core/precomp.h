@@ -39,11 +39,13 @@ extern "C" {
 //
 #include "quicdef.h"
 #include "cid.h"
+#include "cid_table.h"
 #include "path.h"
 #include "transport_params.h"
 #include "lookup.h"
 #include "timer_wheel.h"
 #include "settings.h"
+#include "crypto_offload.h"
 #include "library.h"
 #include "binding.h"
 #include "api.h"
@@ -58,6 +60,8 @@ extern "C" {
 #include "worker.h"
 #include "ack_tracker.h"
 #include "packet_space.h"
+#include "cubic.h"
+#include "bbr.h"
 #include "congestion_control.h"
 #include "loss_detection.h"
 #include "send.h"
@@ -65,6 +69,7 @@ extern "C" {
 #include "crypto.h"
 #include "stream.h"
 #include "stream_set.h"
+#include "datagram.h"
 #include "connection.h"
 #include "packet_builder.h"
 #include "listener.h"
@@ -157,19 +157,57 @@ typedef struct QUIC_PATH QUIC_PATH;
 
 //
 // The number of packets we write for a single stream before going to the next
-// one in the round robin.
+// one in the round robin, for the default priority weight.
 //
 #define QUIC_STREAM_SEND_BATCH_COUNT            4
 
+//
+// The number of stream send priority levels. All streams of a lower level are
+// sent before any stream of a higher level.
+//
+#define QUIC_STREAM_PRIORITY_LEVEL_COUNT        8
+
+//
+// The default stream send priority level and weight. The weight is the number
+// of packets a stream writes on its turn in the round robin of its level.
+//
+#define QUIC_DEFAULT_STREAM_PRIORITY_LEVEL      3
+#define QUIC_DEFAULT_STREAM_PRIORITY_WEIGHT     QUIC_STREAM_SEND_BATCH_COUNT
+
 //
 // The maximum number of received packets to batch process at a time.
 //
 #define QUIC_MAX_RECEIVE_BATCH_COUNT            32
 
 //
-// The maximum number of crypto operations to batch.
+// The maximum number of crypto operations to batch. Header protection for a
+// whole batch is computed in one call, so this matches the receive batch to
+// cover a full GRO/recvmmsg receive. The per-batch arrays live on the stack
+// (over 70 bytes per entry), so kernel mode, with its small stacks, batches
+// fewer. It may be overridden at build time.
 //
+#ifndef QUIC_MAX_CRYPTO_BATCH_COUNT
+#ifdef _KERNEL_MODE
 #define QUIC_MAX_CRYPTO_BATCH_COUNT             8
+#else
+#define QUIC_MAX_CRYPTO_BATCH_COUNT             QUIC_MAX_RECEIVE_BATCH_COUNT
+#endif
+#endif
+QUIC_STATIC_ASSERT(
+    QUIC_MAX_CRYPTO_BATCH_COUNT > 0 && QUIC_MAX_CRYPTO_BATCH_COUNT <= UINT8_MAX,
+    L"Batch counts are tracked in a uint8_t");
+
+//
+// The maximum number of threads in the crypto offload pool.
+//
+#define QUIC_MAX_CRYPTO_OFFLOAD_THREAD_COUNT    8
+
+//
+// The maximum number of batches that may be queued to, or in progress on, the
+// crypto offload pool at once. When this limit is reached, additional batches
+// are encrypted inline on the connection's worker instead.
+//
+#define QUIC_MAX_CRYPTO_OFFLOAD_JOB_COUNT       64
 
 //
 // The maximum number of received packets that may be queued on a single
@@ -286,6 +324,22 @@ QUIC_STATIC_ASSERT(
 //
 #define QUIC_DEFAULT_SEND_BUFFERING_ENABLE      TRUE
 
+//
+// The default value for zero-copy receive being enabled or not.
+//
+#define QUIC_DEFAULT_RECV_ZERO_COPY_ENABLE      FALSE
+
+//
+// The default value for receiving datagrams being enabled or not.
+//
+#define QUIC_DEFAULT_DATAGRAM_RECEIVE_ENABLE    FALSE
+
+//
+// The max_datagram_frame_size transport parameter sent when receiving
+// datagrams is enabled. Large enough for any frame that fits in a packet.
+//
+#define QUIC_DEFAULT_MAX_DATAGRAM_FRAME_SIZE    0xFFFF
+
 //
 // The default ideal send buffer size (in bytes).
 //
@@ -339,15 +393,33 @@ QUIC_STATIC_ASSERT(
 #define QUIC_DEFAULT_SEND_PACING                TRUE
 
 //
-// The number of milliseconds between pacing chunks.
+// The target number of milliseconds between pacing chunks. The chunk size is
+// the pacing rate over this interval, bounded by QUIC_SEND_PACING_MIN_CHUNK
+// and QUIC_SEND_PACING_MAX_CHUNK. Connection timers have millisecond
+// granularity, so this is also the shortest pacing delay.
 //
-#define QUIC_SEND_PACING_INTERVAL               15
+#define QUIC_SEND_PACING_INTERVAL               1
 
 //
 // The minimum number of packets to send per pacing chunk.
 //
 #define QUIC_SEND_PACING_MIN_CHUNK              4u
 
+//
+// The maximum number of bytes to send per pacing chunk; the most a single
+// segmented (GSO) send can carry.
+//
+#define QUIC_SEND_PACING_MAX_CHUNK              0xFFFFu
+
+//
+// The multiple of the congestion window per smoothed RTT, in percent, that
+// window-based algorithms pace at. Slow start paces ahead of the window
+// doubling each round trip; congestion avoidance leaves headroom for ACK
+// jitter.
+//
+#define QUIC_SEND_PACING_GAIN_SLOW_START        200
+#define QUIC_SEND_PACING_GAIN_CONG_AVOID        125
+
 //
 // The maximum number of bytes to send in a given key phase
 // before performing a key phase update. Roughly, 274GB.
@@ -381,11 +453,34 @@ QUIC_STATIC_ASSERT(
 //
 #define QUIC_DEFAULT_MIGRATION_ENABLED          TRUE
 
+//
+// The default value for idle workers stealing queued connections from
+// overloaded workers in the same pool.
+//
+#define QUIC_DEFAULT_WORK_STEALING_ENABLED      FALSE
+
+//
+// The default value for reading the CID lookup tables of listener bindings
+// without locks.
+//
+#define QUIC_DEFAULT_LOCK_FREE_LOOKUP_ENABLED   TRUE
+
+//
+// The default value for handing packet encryption off to the crypto offload
+// thread pool.
+//
+#define QUIC_DEFAULT_CRYPTO_OFFLOAD_ENABLED     FALSE
+
 //
 // The default value for load balancing mode.
 //
 #define QUIC_DEFAULT_LOAD_BALANCING_MODE        QUIC_LOAD_BALANCING_DISABLED
 
+//
+// The default congestion control algorithm.
+//
+#define QUIC_DEFAULT_CONGESTION_CONTROL_ALGORITHM QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC
+
 /*************************************************************
                   PERSISTENT SETTINGS
 *************************************************************/
@@ -398,12 +493,16 @@ QUIC_STATIC_ASSERT(
 #define QUIC_SETTING_MAX_WORKER_QUEUE_DELAY     "MaxWorkerQueueDelayMs"
 #define QUIC_SETTING_MAX_STATELESS_OPERATIONS   "MaxStatelessOperations"
 #define QUIC_SETTING_MAX_OPERATIONS_PER_DRAIN   "MaxOperationsPerDrain"
+#define QUIC_SETTING_WORK_STEALING_ENABLED      "WorkStealingEnabled"
+#define QUIC_SETTING_LOCK_FREE_LOOKUP_ENABLED   "LockFreeLookupEnabled"
+#define QUIC_SETTING_CRYPTO_OFFLOAD_ENABLED     "CryptoOffloadEnabled"
 
 #define QUIC_SETTING_SEND_PACING_DEFAULT        "SendPacingDefault"
 #define QUIC_SETTING_MIGRATION_ENABLED          "MigrationEnabled"
 
 #define QUIC_SETTING_INITIAL_WINDOW_PACKETS     "InitialWindowPackets"
 #define QUIC_SETTING_SEND_IDLE_TIMEOUT_MS       "SendIdleTimeoutMs"
+#define QUIC_SETTING_CONGESTION_CONTROL_ALGORITHM "CongestionControlAlgorithm"
 
 #define QUIC_SETTING_INITIAL_RTT                "InitialRttMs"
 #define QUIC_SETTING_MAX_ACK_DELAY              "MaxAckDelayMs"
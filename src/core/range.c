@@ -12,8 +12,10 @@ Abstract:
 
 #include "precomp.h"
 
-#define INITIAL_SUBRANGE_COUNT 8
-
+//
+// N.B. Initialization can't fail, as the initial subranges are stored inline,
+// but the status is kept for the callers' sake.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
 QuicRangeInitialize(
@@ -22,14 +24,11 @@ QuicRangeInitialize(
     )
 {
     Range->UsedLength = 0;
-    Range->AllocLength = INITIAL_SUBRANGE_COUNT;
+    Range->AllocLength = QUIC_RANGE_INITIAL_SUB_COUNT;
     Range->MaxAllocSize = MaxAllocSize;
-    QUIC_FRE_ASSERT(sizeof(QUIC_SUBRANGE) * INITIAL_SUBRANGE_COUNT < MaxAllocSize);
-    Range->SubRanges = QUIC_ALLOC_NONPAGED(sizeof(QUIC_SUBRANGE) * INITIAL_SUBRANGE_COUNT);
-    if (Range->SubRanges == NULL) {
-        QuicTraceEvent(AllocFailure, "range", sizeof(QUIC_SUBRANGE) * INITIAL_SUBRANGE_COUNT);
-    }
-    return (Range->SubRanges == NULL) ? QUIC_STATUS_OUT_OF_MEMORY : QUIC_STATUS_SUCCESS;
+    QUIC_FRE_ASSERT(sizeof(QUIC_SUBRANGE) * QUIC_RANGE_INITIAL_SUB_COUNT < MaxAllocSize);
+    Range->SubRanges = Range->PreAllocSubRanges;
+    return QUIC_STATUS_SUCCESS;
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -38,7 +37,9 @@ QuicRangeUninitialize(
     _In_ QUIC_RANGE* Range
     )
 {
-    QUIC_FREE(Range->SubRanges);
+    if (Range->SubRanges != Range->PreAllocSubRanges) {
+        QUIC_FREE(Range->SubRanges);
+    }
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -104,7 +105,9 @@ QuicRangeGrow(
             (Range->UsedLength - NextIndex) * sizeof(QUIC_SUBRANGE));
     }
 
-    QUIC_FREE(Range->SubRanges);
+    if (Range->SubRanges != Range->PreAllocSubRanges) {
+        QUIC_FREE(Range->SubRanges);
+    }
     Range->SubRanges = NewSubRanges;
     Range->AllocLength = NewAllocLength;
     Range->UsedLength++; // For the next write index.
@@ -186,14 +189,16 @@ QuicRangeRemoveSubranges(
     Range->UsedLength -= Count;
 
     BOOLEAN Reallocated = FALSE;
-    if (Range->AllocLength >= INITIAL_SUBRANGE_COUNT * 2 &&
+    if (Range->AllocLength >= QUIC_RANGE_INITIAL_SUB_COUNT * 2 &&
         Range->UsedLength < Range->AllocLength / 4) {
         //
-        // Shrink
+        // Shrink, back to the inline storage if it's big enough.
         //
         uint32_t NewAllocLength = Range->AllocLength / 2;
         QUIC_SUBRANGE* NewSubRanges =
-            QUIC_ALLOC_NONPAGED(sizeof(QUIC_SUBRANGE) * NewAllocLength);
+            NewAllocLength == QUIC_RANGE_INITIAL_SUB_COUNT ?
+                Range->PreAllocSubRanges :
+                QUIC_ALLOC_NONPAGED(sizeof(QUIC_SUBRANGE) * NewAllocLength);
         if (NewSubRanges != NULL) {
             memcpy(
                 NewSubRanges,
@@ -8,6 +8,12 @@
 #define QUIC_RANGE_NO_MAX_ALLOC_SIZE    UINT32_MAX
 #define QUIC_RANGE_USE_BINARY_SEARCH    1
 
+//
+// The number of subranges stored inline in the QUIC_RANGE itself. Only ranges
+// that grow beyond this need a separate heap allocation.
+//
+#define QUIC_RANGE_INITIAL_SUB_COUNT    8
+
 typedef struct QUIC_SUBRANGE {
 
     uint64_t Low;
@@ -61,6 +67,13 @@ typedef struct QUIC_RANGE {
     _Field_range_(sizeof(QUIC_SUBRANGE), sizeof(QUIC_SUBRANGE) * QUIC_MAX_RANGE_ALLOC_SIZE)
     uint32_t MaxAllocSize;
 
+    //
+    // Inline storage used for 'SubRanges' until it needs to grow.
+    // N.B. This means a QUIC_RANGE must not be copied or moved once
+    //      initialized.
+    //
+    QUIC_SUBRANGE PreAllocSubRanges[QUIC_RANGE_INITIAL_SUB_COUNT];
+
 } QUIC_RANGE;
 
 //
@@ -83,6 +83,7 @@ QuicRecvBufferInitialize(
     RecvBuffer->CopyOnDrain = CopyOnDrain;
     RecvBuffer->ExternalBufferReference = FALSE;
     RecvBuffer->OldBuffer = NULL;
+    RecvBuffer->ZeroCopyCount = 0;
     Status = QUIC_STATUS_SUCCESS;
 
 Error:
@@ -96,6 +97,10 @@ QuicRecvBufferUninitialize(
     _In_ QUIC_RECV_BUFFER* RecvBuffer
     )
 {
+    for (uint8_t i = 0; i < RecvBuffer->ZeroCopyCount; ++i) {
+        QuicBindingReleaseRecvDatagram(RecvBuffer->ZeroCopy[i].Datagram);
+    }
+    RecvBuffer->ZeroCopyCount = 0;
     QuicRangeUninitialize(&RecvBuffer->WrittenRanges);
     QUIC_FREE(RecvBuffer->Buffer);
     RecvBuffer->Buffer = NULL;
@@ -134,6 +139,23 @@ QuicRecvBufferGetSpan(
     return (uint32_t)(QuicRecvBufferGetTotalLength(RecvBuffer) - RecvBuffer->BaseOffset);
 }
 
+//
+// Returns the number of bytes, starting at BaseOffset, that are referenced in
+// place instead of being in the buffer.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint32_t
+QuicRecvBufferGetZeroCopyLength(
+    _In_ QUIC_RECV_BUFFER* RecvBuffer
+    )
+{
+    uint32_t Length = 0;
+    for (uint8_t i = 0; i < RecvBuffer->ZeroCopyCount; ++i) {
+        Length += RecvBuffer->ZeroCopy[i].Length;
+    }
+    return Length;
+}
+
 //
 // Allocates a new contiguous buffer of the target size and copies the bytes
 // into it.
@@ -154,7 +176,15 @@ QuicRecvBufferResize(
     //
     if (TargetBufferLength != RecvBuffer->AllocBufferLength) {
 
+        //
+        // Zero-copy bytes at the front may extend past the current buffer. In
+        // that case, they are all there is, and nothing needs to be copied.
+        //
         uint32_t Span = QuicRecvBufferGetSpan(RecvBuffer);
+        if (Span > RecvBuffer->AllocBufferLength) {
+            QUIC_DBG_ASSERT(RecvBuffer->ZeroCopyCount != 0);
+            Span = 0;
+        }
 
         uint8_t* NewBuffer = QUIC_ALLOC_NONPAGED(TargetBufferLength);
         if (NewBuffer == NULL) {
@@ -234,6 +264,7 @@ QuicRecvBufferWrite(
     _In_ uint64_t BufferOffset,
     _In_ uint16_t BufferLength,
     _In_reads_bytes_(BufferLength) uint8_t const* Buffer,
+    _In_opt_ QUIC_RECV_DATAGRAM* Datagram,
     _Inout_ uint64_t* WriteLength,
     _Out_ BOOLEAN* ReadyToRead
     )
@@ -243,6 +274,7 @@ QuicRecvBufferWrite(
     QUIC_SUBRANGE* UpdatedRange = NULL;
 
     QUIC_DBG_ASSERT(BufferLength != 0);
+    QUIC_DBG_ASSERT(Datagram == NULL || !RecvBuffer->CopyOnDrain);
 
     //
     // Default the ready to read to false, as most exit cases need this.
@@ -288,6 +320,40 @@ QuicRecvBufferWrite(
         *WriteLength = 0;
     }
 
+    //
+    // Reference the bytes in place if they directly follow all the other
+    // bytes, and those are all referenced in place too. Everything else is
+    // copied.
+    //
+    if (Datagram != NULL &&
+        RecvBuffer->ZeroCopyCount < QUIC_RECV_BUFFER_MAX_ZERO_COPY &&
+        BufferOffset == CurrentMaxLength &&
+        BufferOffset == RecvBuffer->BaseOffset + QuicRecvBufferGetZeroCopyLength(RecvBuffer)) {
+
+        UpdatedRange =
+            QuicRangeAddRange(
+                &RecvBuffer->WrittenRanges,
+                BufferOffset,
+                BufferLength,
+                &WrittenRangesUpdated);
+        if (!UpdatedRange) {
+            QuicTraceEvent(AllocFailure, "recv_buffer range", 0);
+            Status = QUIC_STATUS_OUT_OF_MEMORY;
+            goto Error;
+        }
+
+        QUIC_RECV_ZERO_COPY* ZeroCopy =
+            &RecvBuffer->ZeroCopy[RecvBuffer->ZeroCopyCount++];
+        ZeroCopy->Datagram = Datagram;
+        ZeroCopy->Buffer = Buffer;
+        ZeroCopy->Length = BufferLength;
+        QuicBindingAddRefRecvDatagram(Datagram);
+
+        *ReadyToRead = UpdatedRange->Low == 0;
+        Status = QUIC_STATUS_SUCCESS;
+        goto Error;
+    }
+
     //
     // Check to see if the input buffer is trying to write beyond the
     // currently allocated length.
@@ -416,6 +482,23 @@ QuicRecvBufferRead(
 
     QUIC_DBG_ASSERT(!RecvBuffer->ExternalBufferReference);
 
+    if (RecvBuffer->ZeroCopyCount != 0) {
+        //
+        // Only return the bytes referenced in place. Any that follow in the
+        // buffer are returned once these are drained.
+        //
+        RecvBuffer->ExternalBufferReference = TRUE;
+        *BufferOffset = RecvBuffer->BaseOffset;
+        if (*BufferCount > RecvBuffer->ZeroCopyCount) {
+            *BufferCount = RecvBuffer->ZeroCopyCount;
+        }
+        for (uint32_t i = 0; i < *BufferCount; ++i) {
+            Buffers[i].Length = RecvBuffer->ZeroCopy[i].Length;
+            Buffers[i].Buffer = (uint8_t*)RecvBuffer->ZeroCopy[i].Buffer;
+        }
+        return TRUE;
+    }
+
     //
     // Query if the front of the buffer has been written.
     //
@@ -457,6 +540,39 @@ QuicRecvBufferRead(
     return TRUE;
 }
 
+//
+// Releases the datagrams of the zero-copy bytes that were drained. What is left
+// of a partially drained one is still referenced in place.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicRecvBufferDrainZeroCopy(
+    _In_ QUIC_RECV_BUFFER* RecvBuffer,
+    _In_ uint64_t BufferLength
+    )
+{
+    uint8_t DrainedCount = 0;
+    while (DrainedCount < RecvBuffer->ZeroCopyCount && BufferLength != 0) {
+        QUIC_RECV_ZERO_COPY* ZeroCopy = &RecvBuffer->ZeroCopy[DrainedCount];
+        if (BufferLength < ZeroCopy->Length) {
+            ZeroCopy->Buffer += BufferLength;
+            ZeroCopy->Length -= (uint16_t)BufferLength;
+            break;
+        }
+        BufferLength -= ZeroCopy->Length;
+        QuicBindingReleaseRecvDatagram(ZeroCopy->Datagram);
+        DrainedCount++;
+    }
+
+    if (DrainedCount != 0) {
+        RecvBuffer->ZeroCopyCount -= DrainedCount;
+        QuicMoveMemory(
+            RecvBuffer->ZeroCopy,
+            RecvBuffer->ZeroCopy + DrainedCount,
+            RecvBuffer->ZeroCopyCount * sizeof(QUIC_RECV_ZERO_COPY));
+    }
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
 QuicRecvBufferDrain(
@@ -476,6 +592,10 @@ QuicRecvBufferDrain(
         return FALSE;
     }
 
+    if (RecvBuffer->ZeroCopyCount != 0) {
+        QuicRecvBufferDrainZeroCopy(RecvBuffer, BufferLength);
+    }
+
     RecvBuffer->BaseOffset += BufferLength;
     uint64_t TotalWrittenLength = QuicRangeGetMax(&RecvBuffer->WrittenRanges) + 1;
 
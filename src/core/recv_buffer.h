@@ -5,6 +5,31 @@
 
 --*/
 
+//
+// The maximum number of received datagrams a receive buffer references data in
+// directly, instead of copying it into its own buffer.
+//
+#define QUIC_RECV_BUFFER_MAX_ZERO_COPY  4
+
+//
+// Callers size their read buffers for zero-copy bytes, which also covers the
+// two of a wrapped around buffer.
+//
+QUIC_STATIC_ASSERT(
+    QUIC_RECV_BUFFER_MAX_ZERO_COPY >= 2,
+    "Must be able to read a wrapped around buffer");
+
+//
+// In-order bytes that are still in a received datagram's buffer.
+//
+typedef struct QUIC_RECV_ZERO_COPY {
+
+    QUIC_RECV_DATAGRAM* Datagram;
+    const uint8_t* Buffer;
+    uint16_t Length;
+
+} QUIC_RECV_ZERO_COPY;
+
 typedef struct QUIC_RECV_BUFFER {
 
     //
@@ -57,6 +82,19 @@ typedef struct QUIC_RECV_BUFFER {
     //
     QUIC_RANGE WrittenRanges;
 
+    //
+    // The number of valid entries in ZeroCopy.
+    //
+    uint8_t ZeroCopyCount;
+
+    //
+    // Bytes starting at BaseOffset that were referenced in place instead of
+    // being copied, in stream offset order. They are part of WrittenRanges, but
+    // their space in Buffer is left unused, so any bytes written after them
+    // are still at their usual place in Buffer.
+    //
+    QUIC_RECV_ZERO_COPY ZeroCopy[QUIC_RECV_BUFFER_MAX_ZERO_COPY];
+
 } QUIC_RECV_BUFFER;
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -116,6 +154,11 @@ QuicRecvBufferAlreadyReadData(
 //
 // Buffers a (possibly out-of-order or duplicate) range of bytes.
 //
+// If Datagram is provided, it contains Buffer, and bytes that directly follow
+// the ones already ready to be read (and that are all zero-copy) are referenced
+// in place, instead of being copied. The datagram is then held until they are
+// drained.
+//
 // Returns TRUE if in-order bytes are ready to be delivered
 // to the client.
 //
@@ -126,6 +169,7 @@ QuicRecvBufferWrite(
     _In_ uint64_t BufferOffset,
     _In_ uint16_t BufferLength,
     _In_reads_bytes_(BufferLength) uint8_t const* Buffer,
+    _In_opt_ QUIC_RECV_DATAGRAM* Datagram,
     _Inout_ uint64_t* WriteLength,
     _Out_ BOOLEAN* ReadyToRead
     );
@@ -29,6 +29,59 @@ QuicSendInitialize(
     )
 {
     QuicListInitializeHead(&Send->SendStreams);
+    for (uint32_t i = 0; i < ARRAYSIZE(Send->ReadyStreams); ++i) {
+        QuicListInitializeHead(&Send->ReadyStreams[i]);
+    }
+    QuicListInitializeHead(&Send->BlockedStreams);
+}
+
+//
+// Adds a queued stream to the end of the ready list of its priority level, if
+// it isn't already in it.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendAddReadyStream(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    QUIC_DBG_ASSERT(Stream->SendLink.Flink != NULL);
+    if (Stream->SendBlocked) {
+        QuicListEntryRemove(&Stream->SendReadyLink);
+        Stream->SendReadyLink.Flink = NULL;
+        Stream->SendBlocked = FALSE;
+    }
+    if (Stream->SendReadyLink.Flink == NULL) {
+        QuicListInsertTail(
+            &Send->ReadyStreams[Stream->SendPriorityLevel],
+            &Stream->SendReadyLink);
+        Send->ReadyLevels |= (uint8_t)(1 << Stream->SendPriorityLevel);
+    }
+}
+
+//
+// Removes the stream from its ready or blocked list, if it's in one.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendRemoveReadyStream(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    if (Stream->SendBlocked) {
+        QuicListEntryRemove(&Stream->SendReadyLink);
+        Stream->SendReadyLink.Flink = NULL;
+        Stream->SendBlocked = FALSE;
+
+    } else if (Stream->SendReadyLink.Flink != NULL) {
+        QuicListEntryRemove(&Stream->SendReadyLink);
+        Stream->SendReadyLink.Flink = NULL;
+        if (QuicListIsEmpty(&Send->ReadyStreams[Stream->SendPriorityLevel])) {
+            Send->ReadyLevels &= (uint8_t)~(1 << Stream->SendPriorityLevel);
+        }
+    }
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -55,6 +108,7 @@ QuicSendUninitialize(
         Entry = Entry->Flink;
         Stream->SendFlags = 0;
         Stream->SendLink.Flink = NULL;
+        QuicSendRemoveReadyStream(Send, Stream);
 
         QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
     }
@@ -143,6 +197,11 @@ QuicSendQueueFlushForStream(
         QuicStreamAddRef(Stream, QUIC_STREAM_REF_SEND);
     }
 
+    //
+    // Whatever was queued may have unblocked the stream.
+    //
+    QuicSendAddReadyStream(Send, Stream);
+
     if (Stream->Connection->State.Started) {
         //
         // Schedule the flush even if we didn't just queue the stream,
@@ -152,6 +211,58 @@ QuicSendQueueFlushForStream(
     }
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendUnblockStream(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    if (Stream->SendLink.Flink != NULL) {
+        QuicSendAddReadyStream(Send, Stream);
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendUnblockAllStreams(
+    _In_ QUIC_SEND* Send
+    )
+{
+    while (!QuicListIsEmpty(&Send->BlockedStreams)) {
+        QuicSendAddReadyStream(
+            Send,
+            QUIC_CONTAINING_RECORD(
+                Send->BlockedStreams.Flink, QUIC_STREAM, SendReadyLink));
+    }
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendSetStreamPriority(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ uint8_t Level,
+    _In_ uint8_t Weight
+    )
+{
+    QUIC_DBG_ASSERT(Level < QUIC_STREAM_PRIORITY_LEVEL_COUNT);
+    QUIC_DBG_ASSERT(Weight != 0);
+
+    Stream->SendPriorityWeight = Weight;
+    if (Stream->SendPriorityLevel != Level) {
+        BOOLEAN WasReady =
+            Stream->SendReadyLink.Flink != NULL && !Stream->SendBlocked;
+        if (WasReady) {
+            QuicSendRemoveReadyStream(Send, Stream);
+        }
+        Stream->SendPriorityLevel = Level;
+        if (WasReady) {
+            QuicSendAddReadyStream(Send, Stream);
+        }
+    }
+}
+
 #if DEBUG
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
@@ -239,9 +350,11 @@ QuicSendSetSendFlag(
             QUIC_DBG_ASSERT(Stream->SendFlags != 0);
             Stream->SendFlags = 0;
             Stream->SendLink.Flink = NULL;
+            QuicSendRemoveReadyStream(Send, Stream);
 
             QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
         }
+        QUIC_DBG_ASSERT(Send->ReadyLevels == 0);
     }
 
     QuicSendValidate(Send);
@@ -357,6 +470,13 @@ QuicSendSetStreamSendFlag(
             QuicSendQueueFlushForStream(Send, Stream, Stream->SendFlags != 0);
         }
         Stream->SendFlags |= SendFlags;
+
+    } else if (SendFlags != 0) {
+        //
+        // The flags are already set, but whatever set them again (such as lost
+        // data to retransmit) may have unblocked the stream.
+        //
+        QuicSendUnblockStream(Send, Stream);
     }
 }
 
@@ -368,8 +488,6 @@ QuicSendClearStreamSendFlag(
     _In_ uint32_t SendFlags
     )
 {
-    UNREFERENCED_PARAMETER(Send);
-
     if (Stream->SendFlags & SendFlags) {
 
         QuicTraceLogStreamVerbose(
@@ -390,6 +508,7 @@ QuicSendClearStreamSendFlag(
             QUIC_DBG_ASSERT(Stream->SendLink.Flink != NULL);
             QuicListEntryRemove(&Stream->SendLink);
             Stream->SendLink.Flink = NULL;
+            QuicSendRemoveReadyStream(Send, Stream);
             QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
         }
     }
@@ -750,6 +869,18 @@ QuicSendWriteFrames(
                 return TRUE;
             }
         }
+
+        if (!IsCongestionControlBlocked &&
+            Builder->Metadata->Flags.KeyType == QUIC_PACKET_KEY_1_RTT &&
+            Send->SendFlags & QUIC_CONN_SEND_FLAG_DATAGRAM) {
+
+            if (QuicDatagramWriteFrame(&Connection->Datagram, Builder)) {
+                return TRUE;
+            }
+            if (Builder->Metadata->FrameCount == PrevFrameCount) {
+                RanOutOfRoom = TRUE; // Any datagrams that didn't fit were discarded.
+            }
+        }
     }
 
     if (Send->SendFlags & QUIC_CONN_SEND_FLAG_PING) {
@@ -805,15 +936,20 @@ QuicSendGetNextStream(
 {
     QUIC_DBG_ASSERT(!QuicConnIsClosed(QuicSendGetConnection(Send)) || QuicListIsEmpty(&Send->SendStreams));
 
-    QUIC_LIST_ENTRY* Entry = Send->SendStreams.Flink;
-    while (Entry != &Send->SendStreams) {
+    while (Send->ReadyLevels != 0) {
 
         //
-        // TODO: performance: We currently search through blocked
-        // streams repeatedly as we loop.
+        // Take the first stream from the highest priority (lowest) level that
+        // has any ready streams.
         //
+        uint8_t Level = 0;
+        while (!(Send->ReadyLevels & (1 << Level))) {
+            Level++;
+        }
 
-        QUIC_STREAM* Stream = QUIC_CONTAINING_RECORD(Entry, QUIC_STREAM, SendLink);
+        QUIC_STREAM* Stream =
+            QUIC_CONTAINING_RECORD(
+                Send->ReadyStreams[Level].Flink, QUIC_STREAM, SendReadyLink);
 
         //
         // Make sure, given the current state of the connection and the stream,
@@ -822,16 +958,23 @@ QuicSendGetNextStream(
         if (QuicSendCanSendStreamNow(Stream)) {
 
             //
-            // Move the stream to the end of the queue.
+            // Move the stream to the end of its level, so streams of the same
+            // priority take turns.
             //
-            QuicListEntryRemove(&Stream->SendLink);
-            QuicListInsertTail(&Send->SendStreams, &Stream->SendLink);
+            QuicListEntryRemove(&Stream->SendReadyLink);
+            QuicListInsertTail(&Send->ReadyStreams[Level], &Stream->SendReadyLink);
 
-            *PacketCount = QUIC_STREAM_SEND_BATCH_COUNT;
+            *PacketCount = Stream->SendPriorityWeight;
             return Stream;
         }
 
-        Entry = Entry->Flink;
+        //
+        // The stream is blocked. Park it until something unblocks it, so it
+        // isn't checked again on every call.
+        //
+        QuicSendRemoveReadyStream(Send, Stream);
+        QuicListInsertTail(&Send->BlockedStreams, &Stream->SendReadyLink);
+        Stream->SendBlocked = TRUE;
     }
 
     return NULL;
@@ -977,6 +1120,9 @@ QuicSendFlush(
             Connection->Crypto.TlsState.WriteKeys[QUIC_PACKET_KEY_0_RTT] == NULL) {
             SendFlags &= QUIC_CONN_SEND_FLAG_ALLOWED_HANDSHAKE;
         }
+        if (Connection->Crypto.TlsState.WriteKeys[QUIC_PACKET_KEY_1_RTT] == NULL) {
+            SendFlags &= ~QUIC_CONN_SEND_FLAG_DATAGRAM; // Only sent in 1-RTT packets.
+        }
 
         if (!QuicPacketBuilderHasAllowance(&Builder)) {
             //
@@ -987,19 +1133,23 @@ QuicSendFlush(
                 if (QuicCongestionControlCanSend(&Connection->CongestionControl)) {
                     //
                     // The current pacing chunk is finished. We need to schedule a
-                    // new pacing send.
+                    // new pacing send for when the pacing rate allows the next
+                    // chunk.
                     //
+                    uint64_t PacingDelay =
+                        QuicCongestionControlGetPacingDelay(
+                            &Connection->CongestionControl);
                     QuicConnAddOutFlowBlockedReason(
                         Connection, QUIC_FLOW_BLOCKED_PACING);
                     QuicTraceLogConnVerbose(
                         SetPacingTimer,
                         Connection,
-                        "Setting delayed send (PACING) timer for %u ms",
-                        QUIC_SEND_PACING_INTERVAL);
+                        "Setting delayed send (PACING) timer for %llu ms",
+                        PacingDelay);
                     QuicConnTimerSet(
                         Connection,
                         QUIC_CONN_TIMER_PACING,
-                        QUIC_SEND_PACING_INTERVAL);
+                        PacingDelay);
                     Result = QUIC_SEND_DELAYED_PACING;
                 } else {
                     //
@@ -1046,6 +1196,7 @@ QuicSendFlush(
                 //
                 QuicListEntryRemove(&Stream->SendLink);
                 Stream->SendLink.Flink = NULL;
+                QuicSendRemoveReadyStream(Send, Stream);
                 QuicStreamRelease(Stream, QUIC_STREAM_REF_SEND);
                 Stream = NULL;
 
@@ -1078,8 +1229,10 @@ QuicSendFlush(
 
         } else {
             //
-            // Nothing else left to send right now.
+            // Nothing else left to send right now, so the app (and not the
+            // network) is limiting the send rate.
             //
+            QuicLossDetectionOnAppLimited(&Connection->LossDetection);
             Result = QUIC_SEND_COMPLETE;
             break;
         }
@@ -1197,4 +1350,8 @@ QuicSendOnMtuProbePacketAcked(
         "Path[%hhu] MTU updated to %u bytes",
         Path->ID,
         Path->Mtu);
+
+    if (Path->IsActive) {
+        QuicDatagramOnSendStateChanged(&QuicSendGetConnection(Send)->Datagram);
+    }
 }
@@ -84,6 +84,7 @@ QuicPacketTypeToEncryptLevel(
 #define QUIC_CONN_SEND_FLAG_PATH_RESPONSE           0x00000800
 #define QUIC_CONN_SEND_FLAG_PING                    0x00001000
 #define QUIC_CONN_SEND_FLAG_HANDSHAKE_DONE          0x00002000
+#define QUIC_CONN_SEND_FLAG_DATAGRAM                0x00004000
 #define QUIC_CONN_SEND_FLAG_PMTUD                   0x80000000
 
 //
@@ -111,6 +112,7 @@ QuicPacketTypeToEncryptLevel(
     QUIC_CONN_SEND_FLAG_PATH_CHALLENGE | \
     QUIC_CONN_SEND_FLAG_PATH_RESPONSE | \
     QUIC_CONN_SEND_FLAG_PING | \
+    QUIC_CONN_SEND_FLAG_DATAGRAM | \
     QUIC_CONN_SEND_FLAG_PMTUD \
 )
 
@@ -223,6 +225,24 @@ typedef struct QUIC_SEND {
     //
     QUIC_LIST_ENTRY SendStreams;
 
+    //
+    // The streams in SendStreams that may be able to send now, per priority
+    // level, in round robin order. A stream found to be blocked is moved to
+    // BlockedStreams until something might unblock it, so it isn't checked
+    // again on every call.
+    //
+    QUIC_LIST_ENTRY ReadyStreams[QUIC_STREAM_PRIORITY_LEVEL_COUNT];
+
+    //
+    // The streams in SendStreams that were found to be blocked.
+    //
+    QUIC_LIST_ENTRY BlockedStreams;
+
+    //
+    // Bit mask of the ReadyStreams lists that aren't empty.
+    //
+    uint8_t ReadyLevels;
+
     //
     // The current token to send with an Initial packet.
     //
@@ -307,6 +327,38 @@ QuicSendQueueFlushForStream(
     _In_ BOOLEAN WasPreviouslyQueued
     );
 
+//
+// Indicates a queued stream that was blocked might be able to send now.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendUnblockStream(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream
+    );
+
+//
+// Indicates all queued streams that were blocked might be able to send now,
+// for changes that apply to the whole connection.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendUnblockAllStreams(
+    _In_ QUIC_SEND* Send
+    );
+
+//
+// Updates the send priority of the stream.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicSendSetStreamPriority(
+    _In_ QUIC_SEND* Send,
+    _In_ QUIC_STREAM* Stream,
+    _In_ uint8_t Level,
+    _In_ uint8_t Weight
+    );
+
 //
 // Tries to drain all queued data that needs to be sent. Returns TRUE if all the
 // data was drained.
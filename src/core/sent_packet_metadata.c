@@ -14,6 +14,11 @@ Abstract:
     contained in the packet. The allocator uses a different pool for each
     possible size.
 
+    Loss detection keeps the metadata of each connection's sent packets in a
+    QUIC_SENT_PACKET_RING, indexed by packet number. Packets with only a few
+    frames are stored in the ring's slots directly, and only larger ones are
+    allocated from the pools.
+
 --*/
 
 #include "precomp.h"
@@ -70,6 +75,16 @@ QuicSentPacketPoolReturnPacketMetadata(
         Metadata->FrameCount > 0 &&
         Metadata->FrameCount <= QUIC_MAX_FRAMES_PER_PACKET);
 
+    QuicSentPacketMetadataReleaseFrames(Metadata);
+    QuicPoolFree(Pool->Pools + Metadata->FrameCount - 1, Metadata);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketMetadataReleaseFrames(
+    _In_ QUIC_SENT_PACKET_METADATA* Metadata
+    )
+{
     for (uint8_t i = 0; i < Metadata->FrameCount; i++) {
         switch (Metadata->Frames[i].Type)
         {
@@ -95,6 +110,244 @@ QuicSentPacketPoolReturnPacketMetadata(
             break;
         }
     }
+}
 
-    QuicPoolFree(Pool->Pools + Metadata->FrameCount - 1, Metadata);
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingInitialize(
+    _Out_ QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    Ring->Slots = NULL;
+    Ring->Capacity = 0;
+    Ring->Head = 0;
+    Ring->Count = 0;
+    Ring->FirstPacketNumber = 0;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingUninitialize(
+    _In_ QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    QUIC_DBG_ASSERT(Ring->Count == 0);
+    if (Ring->Slots != NULL) {
+        QUIC_FREE(Ring->Slots);
+        Ring->Slots = NULL;
+        Ring->Capacity = 0;
+    }
+}
+
+//
+// Moves the slots into a new allocation, starting from index 0.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicSentPacketRingResize(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint32_t NewCapacity
+    )
+{
+    QUIC_DBG_ASSERT(NewCapacity >= Ring->Count);
+    QUIC_DBG_ASSERT((NewCapacity & (NewCapacity - 1)) == 0);
+
+    QUIC_SENT_PACKET_SLOT* NewSlots =
+        QUIC_ALLOC_NONPAGED(sizeof(QUIC_SENT_PACKET_SLOT) * NewCapacity);
+    if (NewSlots == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "sent packet ring",
+            sizeof(QUIC_SENT_PACKET_SLOT) * NewCapacity);
+        return FALSE;
+    }
+
+    if (Ring->Count != 0) {
+        uint32_t FirstPart = min(Ring->Count, Ring->Capacity - Ring->Head);
+        QuicCopyMemory(
+            NewSlots,
+            Ring->Slots + Ring->Head,
+            sizeof(QUIC_SENT_PACKET_SLOT) * FirstPart);
+        QuicCopyMemory(
+            NewSlots + FirstPart,
+            Ring->Slots,
+            sizeof(QUIC_SENT_PACKET_SLOT) * (Ring->Count - FirstPart));
+    }
+
+    if (Ring->Slots != NULL) {
+        QUIC_FREE(Ring->Slots);
+    }
+    Ring->Slots = NewSlots;
+    Ring->Capacity = NewCapacity;
+    Ring->Head = 0;
+
+    return TRUE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+QuicSentPacketRingNext(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    )
+{
+    uint64_t End = QuicSentPacketRingEnd(Ring);
+    if (PacketNumber < Ring->FirstPacketNumber) {
+        PacketNumber = Ring->FirstPacketNumber;
+    }
+    if (PacketNumber >= End) {
+        return End;
+    }
+
+    QUIC_SENT_PACKET_SLOT* First = QuicSentPacketRingGetSlot(Ring, PacketNumber);
+    if (First->State != QUIC_SENT_PACKET_STATE_EMPTY) {
+        return PacketNumber;
+    }
+
+    uint64_t Next = PacketNumber + First->EmptyRun;
+    while (Next < End) {
+        QUIC_SENT_PACKET_SLOT* Slot = QuicSentPacketRingGetSlot(Ring, Next);
+        if (Slot->State != QUIC_SENT_PACKET_STATE_EMPTY) {
+            break;
+        }
+        Next += Slot->EmptyRun;
+    }
+    QUIC_DBG_ASSERT(Next <= End);
+
+    //
+    // Remember the whole run, so the next walk from here skips it in one step.
+    //
+    First->EmptyRun = (uint32_t)(Next - PacketNumber);
+    return Next;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingInsert(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_POOL* Pool,
+    _In_ const QUIC_SENT_PACKET_METADATA* Metadata
+    )
+{
+    QUIC_DBG_ASSERT(
+        Metadata->FrameCount > 0 &&
+        Metadata->FrameCount <= QUIC_MAX_FRAMES_PER_PACKET);
+
+    uint64_t NewCount;
+    if (Ring->Count == 0) {
+        NewCount = 1;
+    } else {
+        QUIC_DBG_ASSERT(Metadata->PacketNumber >= QuicSentPacketRingEnd(Ring));
+        NewCount = Metadata->PacketNumber - Ring->FirstPacketNumber + 1;
+        if (NewCount > (UINT32_MAX >> 1)) {
+            return NULL;
+        }
+    }
+
+    QUIC_SENT_PACKET_METADATA* External = NULL;
+    if (Metadata->FrameCount > QUIC_SENT_PACKET_INLINE_FRAMES) {
+        External = QuicSentPacketPoolGetPacketMetadata(Pool, Metadata->FrameCount);
+        if (External == NULL) {
+            return NULL;
+        }
+    }
+
+    if (NewCount > Ring->Capacity) {
+        uint32_t NewCapacity =
+            Ring->Capacity == 0 ?
+                QUIC_SENT_PACKET_RING_INITIAL_SIZE : Ring->Capacity;
+        while (NewCapacity < NewCount) {
+            NewCapacity <<= 1;
+        }
+        if (!QuicSentPacketRingResize(Ring, NewCapacity)) {
+            if (External != NULL) {
+                QuicPoolFree(Pool->Pools + Metadata->FrameCount - 1, External);
+            }
+            return NULL;
+        }
+    }
+
+    if (Ring->Count == 0) {
+        Ring->Head = 0;
+        Ring->FirstPacketNumber = Metadata->PacketNumber;
+    }
+
+    //
+    // Packet numbers that were never sent get empty slots.
+    //
+    while (Ring->Count + 1 < NewCount) {
+        QUIC_SENT_PACKET_SLOT* Gap =
+            Ring->Slots + ((Ring->Head + Ring->Count) & (Ring->Capacity - 1));
+        Gap->State = QUIC_SENT_PACKET_STATE_EMPTY;
+        Gap->IsExternal = FALSE;
+        Gap->EmptyRun = 1;
+        Ring->Count++;
+    }
+
+    QUIC_SENT_PACKET_SLOT* Slot =
+        Ring->Slots + ((Ring->Head + Ring->Count) & (Ring->Capacity - 1));
+    Ring->Count++;
+
+    Slot->State = QUIC_SENT_PACKET_STATE_OUTSTANDING;
+    Slot->IsExternal = External != NULL;
+    if (External != NULL) {
+        Slot->External = External;
+    }
+
+    QUIC_SENT_PACKET_METADATA* Packet = QuicSentPacketSlotGetMetadata(Slot);
+    QuicCopyMemory(
+        Packet,
+        Metadata,
+        sizeof(QUIC_SENT_PACKET_METADATA) +
+        sizeof(QUIC_SENT_FRAME_METADATA) * Metadata->FrameCount);
+
+    return Packet;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingRemove(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_POOL* Pool,
+    _Inout_ QUIC_SENT_PACKET_SLOT* Slot
+    )
+{
+    QUIC_DBG_ASSERT(Slot->State != QUIC_SENT_PACKET_STATE_EMPTY);
+
+    if (Slot->IsExternal) {
+        QuicSentPacketPoolReturnPacketMetadata(Pool, Slot->External);
+        Slot->IsExternal = FALSE;
+    } else {
+        QuicSentPacketMetadataReleaseFrames(
+            (QUIC_SENT_PACKET_METADATA*)Slot->Inline);
+    }
+    Slot->State = QUIC_SENT_PACKET_STATE_EMPTY;
+
+    //
+    // Join the run of empty slots after this one, if there is one.
+    //
+    uint32_t Index = (uint32_t)(Slot - Ring->Slots);
+    QUIC_SENT_PACKET_SLOT* NextSlot = Ring->Slots + ((Index + 1) & (Ring->Capacity - 1));
+    Slot->EmptyRun = 1;
+    if (((Index - Ring->Head) & (Ring->Capacity - 1)) + 1 < Ring->Count &&
+        NextSlot->State == QUIC_SENT_PACKET_STATE_EMPTY) {
+        Slot->EmptyRun += NextSlot->EmptyRun;
+    }
+
+    while (Ring->Count != 0 &&
+           Ring->Slots[Ring->Head].State == QUIC_SENT_PACKET_STATE_EMPTY) {
+        uint32_t EmptyRun = Ring->Slots[Ring->Head].EmptyRun;
+        Ring->Head = (Ring->Head + EmptyRun) & (Ring->Capacity - 1);
+        Ring->FirstPacketNumber += EmptyRun;
+        Ring->Count -= EmptyRun;
+    }
+
+    if (Ring->Count == 0 && Ring->Capacity > QUIC_SENT_PACKET_RING_INITIAL_SIZE) {
+        //
+        // Don't hold on to the memory from a large burst of sends.
+        //
+        QUIC_FREE(Ring->Slots);
+        Ring->Slots = NULL;
+        Ring->Capacity = 0;
+    }
 }
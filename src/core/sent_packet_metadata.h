@@ -63,6 +63,9 @@ typedef struct QUIC_SENT_FRAME_METADATA {
         struct {
             uint8_t Data[8];
         } PATH_RESPONSE;
+        struct {
+            void* ClientContext;
+        } DATAGRAM;
     };
     uint8_t Type; // QUIC_FRAME_*
     uint8_t Flags; // QUIC_SENT_FRAME_FLAG_*
@@ -76,6 +79,8 @@ typedef struct QUIC_SEND_PACKET_FLAGS {
     BOOLEAN HasCrypto               : 1;
     BOOLEAN IsPMTUD                 : 1;
     BOOLEAN KeyPhase                : 1;
+    BOOLEAN SuspectedLost           : 1;
+    BOOLEAN IsAppLimited            : 1;
 
 } QUIC_SEND_PACKET_FLAGS;
 
@@ -84,13 +89,19 @@ typedef struct QUIC_SEND_PACKET_FLAGS {
 //
 typedef struct QUIC_SENT_PACKET_METADATA {
 
-    struct QUIC_SENT_PACKET_METADATA *Next;
-
     uint64_t PacketNumber;
     uint32_t SentTime; // In microseconds
     uint16_t PacketLength;
     uint8_t PathId;
 
+    //
+    // The delivery rate estimation state when the packet was sent. See
+    // QUIC_RATE_SAMPLE.
+    //
+    uint64_t TotalBytesAcked;
+    uint32_t TotalBytesAckedTime; // In microseconds
+    uint32_t FirstSentTime; // In microseconds
+
     //
     // Hints about the QUIC packet and included frames.
     //
@@ -174,3 +185,164 @@ QuicSentPacketPoolReturnPacketMetadata(
     _In_ QUIC_SENT_PACKET_POOL* Pool,
     _In_ QUIC_SENT_PACKET_METADATA* Metadata
     );
+
+//
+// Releases the references held by the frames of a sent packet metadata item.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketMetadataReleaseFrames(
+    _In_ QUIC_SENT_PACKET_METADATA* Metadata
+    );
+
+//
+// The number of frames that fit in a sent packet ring slot. The metadata for
+// packets with more frames is allocated from the sent packet pool instead.
+//
+#define QUIC_SENT_PACKET_INLINE_FRAMES 2
+
+//
+// The number of slots first allocated for a sent packet ring. The ring doubles
+// in size as needed, and goes back to nothing once it is empty again.
+//
+#define QUIC_SENT_PACKET_RING_INITIAL_SIZE 16
+
+typedef enum QUIC_SENT_PACKET_STATE {
+
+    QUIC_SENT_PACKET_STATE_EMPTY,       // Unused, acknowledged or discarded
+    QUIC_SENT_PACKET_STATE_OUTSTANDING, // Sent and not acknowledged yet
+    QUIC_SENT_PACKET_STATE_LOST         // Inferred lost, kept for a late ACK
+
+} QUIC_SENT_PACKET_STATE;
+
+//
+// Tracker for a single packet number in a sent packet ring.
+//
+typedef struct QUIC_SENT_PACKET_SLOT {
+
+    union {
+        QUIC_SENT_PACKET_METADATA* External;
+        uint8_t Inline[
+            sizeof(QUIC_SENT_PACKET_METADATA) +
+            sizeof(QUIC_SENT_FRAME_METADATA) * QUIC_SENT_PACKET_INLINE_FRAMES];
+        //
+        // For empty slots, the number of empty slots known to start here,
+        // including this one. Always at least 1.
+        //
+        uint32_t EmptyRun;
+    };
+    uint8_t State; // QUIC_SENT_PACKET_STATE
+    BOOLEAN IsExternal;
+
+} QUIC_SENT_PACKET_SLOT;
+
+//
+// Sent packets, indexed by packet number. The slot for a packet number is at a
+// fixed offset from Head, so any range of packet numbers (such as an ACK
+// block) maps to a run of consecutive slots. The first slot is never empty.
+//
+typedef struct QUIC_SENT_PACKET_RING {
+
+    QUIC_SENT_PACKET_SLOT* Slots;
+    uint32_t Capacity; // Zero or a power of 2
+    uint32_t Head;
+    uint32_t Count;
+    uint64_t FirstPacketNumber;
+
+} QUIC_SENT_PACKET_RING;
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingInitialize(
+    _Out_ QUIC_SENT_PACKET_RING* Ring
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingUninitialize(
+    _In_ QUIC_SENT_PACKET_RING* Ring
+    );
+
+//
+// Returns one past the largest packet number tracked by the ring.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+inline
+uint64_t
+QuicSentPacketRingEnd(
+    _In_ const QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    return Ring->FirstPacketNumber + Ring->Count;
+}
+
+//
+// Returns the slot for the packet number, or NULL if it's outside the ring.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+inline
+QUIC_SENT_PACKET_SLOT*
+QuicSentPacketRingGetSlot(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    )
+{
+    if (PacketNumber < Ring->FirstPacketNumber ||
+        PacketNumber - Ring->FirstPacketNumber >= Ring->Count) {
+        return NULL;
+    }
+    return
+        Ring->Slots +
+        ((Ring->Head + (uint32_t)(PacketNumber - Ring->FirstPacketNumber)) &
+         (Ring->Capacity - 1));
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+inline
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketSlotGetMetadata(
+    _In_ QUIC_SENT_PACKET_SLOT* Slot
+    )
+{
+    return
+        Slot->IsExternal ?
+            Slot->External : (QUIC_SENT_PACKET_METADATA*)Slot->Inline;
+}
+
+//
+// Returns the first packet number, at or after the given one, that has an
+// outstanding or lost packet, or the end of the ring if there is none. Runs of
+// empty slots are skipped without visiting each slot, so walking the ring is
+// cheap even when a lost packet keeps many acknowledged ones in it.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+QuicSentPacketRingNext(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    );
+
+//
+// Copies the metadata into a new outstanding slot at the end of the ring.
+// Packet numbers skipped since the last one are left as empty slots. Returns
+// NULL on allocation failure.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingInsert(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_POOL* Pool,
+    _In_ const QUIC_SENT_PACKET_METADATA* Metadata
+    );
+
+//
+// Frees the metadata in the slot and marks it empty. Slots before or after
+// this one are not moved, but the ring may drop empty slots from its front.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingRemove(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_POOL* Pool,
+    _Inout_ QUIC_SENT_PACKET_SLOT* Slot
+    );
@@ -800,6 +800,24 @@ QuicSessionParamGet(
         Status = QUIC_STATUS_SUCCESS;
         break;
 
+    case QUIC_PARAM_SESSION_CONGESTION_CONTROL_ALGORITHM:
+        if (*BufferLength < sizeof(Session->Settings.CongestionControlAlgorithm)) {
+            *BufferLength = sizeof(Session->Settings.CongestionControlAlgorithm);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(Session->Settings.CongestionControlAlgorithm);
+        *(uint16_t*)Buffer = Session->Settings.CongestionControlAlgorithm;
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
     default:
         Status = QUIC_STATUS_INVALID_PARAMETER;
         break;
@@ -995,6 +1013,26 @@ QuicSessionParamSet(
         break;
     }
 
+    case QUIC_PARAM_SESSION_CONGESTION_CONTROL_ALGORITHM: {
+        if (BufferLength != sizeof(Session->Settings.CongestionControlAlgorithm) ||
+            *(uint16_t*)Buffer > QUIC_CONGESTION_CONTROL_ALGORITHM_BBR) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        Session->Settings.AppSet.CongestionControlAlgorithm = TRUE;
+        Session->Settings.CongestionControlAlgorithm = *(uint16_t*)Buffer;
+
+        QuicTraceLogInfo(
+            SessionCongestionControlAlgorithmSet,
+            "[sess][%p] Updated congestion control algorithm to %hu",
+            Session,
+            Session->Settings.CongestionControlAlgorithm);
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
     default:
         Status = QUIC_STATUS_INVALID_PARAMETER;
         break;
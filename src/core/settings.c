@@ -23,6 +23,15 @@ QuicSettingsSetDefault(
     if (!Settings->AppSet.MigrationEnabled) {
         Settings->MigrationEnabled = QUIC_DEFAULT_MIGRATION_ENABLED;
     }
+    if (!Settings->AppSet.WorkStealingEnabled) {
+        Settings->WorkStealingEnabled = QUIC_DEFAULT_WORK_STEALING_ENABLED;
+    }
+    if (!Settings->AppSet.LockFreeLookupEnabled) {
+        Settings->LockFreeLookupEnabled = QUIC_DEFAULT_LOCK_FREE_LOOKUP_ENABLED;
+    }
+    if (!Settings->AppSet.CryptoOffloadEnabled) {
+        Settings->CryptoOffloadEnabled = QUIC_DEFAULT_CRYPTO_OFFLOAD_ENABLED;
+    }
     if (!Settings->AppSet.MaxPartitionCount) {
         Settings->MaxPartitionCount = QUIC_MAX_PARTITION_COUNT;
     }
@@ -47,6 +56,9 @@ QuicSettingsSetDefault(
     if (!Settings->AppSet.SendIdleTimeoutMs) {
         Settings->SendIdleTimeoutMs = QUIC_DEFAULT_SEND_IDLE_TIMEOUT_MS;
     }
+    if (!Settings->AppSet.CongestionControlAlgorithm) {
+        Settings->CongestionControlAlgorithm = QUIC_DEFAULT_CONGESTION_CONTROL_ALGORITHM;
+    }
     if (!Settings->AppSet.InitialRttMs) {
         Settings->InitialRttMs = QUIC_INITIAL_RTT;
     }
@@ -104,6 +116,15 @@ QuicSettingsCopy(
     if (!Settings->AppSet.MigrationEnabled) {
         Settings->MigrationEnabled = ParentSettings->MigrationEnabled;
     }
+    if (!Settings->AppSet.WorkStealingEnabled) {
+        Settings->WorkStealingEnabled = ParentSettings->WorkStealingEnabled;
+    }
+    if (!Settings->AppSet.LockFreeLookupEnabled) {
+        Settings->LockFreeLookupEnabled = ParentSettings->LockFreeLookupEnabled;
+    }
+    if (!Settings->AppSet.CryptoOffloadEnabled) {
+        Settings->CryptoOffloadEnabled = ParentSettings->CryptoOffloadEnabled;
+    }
     if (!Settings->AppSet.MaxPartitionCount) {
         Settings->MaxPartitionCount = ParentSettings->MaxPartitionCount;
     }
@@ -128,6 +149,9 @@ QuicSettingsCopy(
     if (!Settings->AppSet.SendIdleTimeoutMs) {
         Settings->SendIdleTimeoutMs = ParentSettings->SendIdleTimeoutMs;
     }
+    if (!Settings->AppSet.CongestionControlAlgorithm) {
+        Settings->CongestionControlAlgorithm = ParentSettings->CongestionControlAlgorithm;
+    }
     if (!Settings->AppSet.InitialRttMs) {
         Settings->InitialRttMs = ParentSettings->InitialRttMs;
     }
@@ -204,6 +228,39 @@ QuicSettingsLoad(
         Settings->MigrationEnabled = !!Value;
     }
 
+    if (!Settings->AppSet.WorkStealingEnabled) {
+        Value = QUIC_DEFAULT_WORK_STEALING_ENABLED;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_WORK_STEALING_ENABLED,
+            (uint8_t*)&Value,
+            &ValueLen);
+        Settings->WorkStealingEnabled = !!Value;
+    }
+
+    if (!Settings->AppSet.LockFreeLookupEnabled) {
+        Value = QUIC_DEFAULT_LOCK_FREE_LOOKUP_ENABLED;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_LOCK_FREE_LOOKUP_ENABLED,
+            (uint8_t*)&Value,
+            &ValueLen);
+        Settings->LockFreeLookupEnabled = !!Value;
+    }
+
+    if (!Settings->AppSet.CryptoOffloadEnabled) {
+        Value = QUIC_DEFAULT_CRYPTO_OFFLOAD_ENABLED;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_CRYPTO_OFFLOAD_ENABLED,
+            (uint8_t*)&Value,
+            &ValueLen);
+        Settings->CryptoOffloadEnabled = !!Value;
+    }
+
     if (!Settings->AppSet.MaxPartitionCount) {
         Value = QUIC_MAX_PARTITION_COUNT;
         ValueLen = sizeof(Value);
@@ -295,6 +352,19 @@ QuicSettingsLoad(
             &ValueLen);
     }
 
+    if (!Settings->AppSet.CongestionControlAlgorithm) {
+        Value = QUIC_DEFAULT_CONGESTION_CONTROL_ALGORITHM;
+        ValueLen = sizeof(Value);
+        QuicStorageReadValue(
+            Storage,
+            QUIC_SETTING_CONGESTION_CONTROL_ALGORITHM,
+            (uint8_t*)&Value,
+            &ValueLen);
+        if (Value <= QUIC_CONGESTION_CONTROL_ALGORITHM_BBR) {
+            Settings->CongestionControlAlgorithm = (uint16_t)Value;
+        }
+    }
+
     if (!Settings->AppSet.InitialRttMs) {
         ValueLen = sizeof(Settings->InitialRttMs);
         QuicStorageReadValue(
@@ -449,6 +519,9 @@ QuicSettingsDump(
 {
     QuicTraceLogVerbose(SettingDumpPacingDefault,           "[sett] PacingDefault          = %hhu", Settings->PacingDefault);
     QuicTraceLogVerbose(SettingDumpMigrationEnabled,        "[sett] MigrationEnabled       = %hhu", Settings->MigrationEnabled);
+    QuicTraceLogVerbose(SettingDumpWorkStealingEnabled,     "[sett] WorkStealingEnabled    = %hhu", Settings->WorkStealingEnabled);
+    QuicTraceLogVerbose(SettingDumpLockFreeLookupEnabled,   "[sett] LockFreeLookupEnabled  = %hhu", Settings->LockFreeLookupEnabled);
+    QuicTraceLogVerbose(SettingDumpCryptoOffloadEnabled,    "[sett] CryptoOffloadEnabled   = %hhu", Settings->CryptoOffloadEnabled);
     QuicTraceLogVerbose(SettingDumpMaxPartitionCount,       "[sett] MaxPartitionCount      = %hhu", Settings->MaxPartitionCount);
     QuicTraceLogVerbose(SettingDumpMaxOperationsPerDrain,   "[sett] MaxOperationsPerDrain  = %hhu", Settings->MaxOperationsPerDrain);
     QuicTraceLogVerbose(SettingDumpRetryMemoryLimit,        "[sett] RetryMemoryLimit       = %hu", Settings->RetryMemoryLimit);
@@ -457,6 +530,7 @@ QuicSettingsDump(
     QuicTraceLogVerbose(SettingDumpMaxWorkerQueueDelayUs,   "[sett] MaxWorkerQueueDelayUs  = %u", Settings->MaxWorkerQueueDelayUs);
     QuicTraceLogVerbose(SettingDumpInitialWindowPackets,    "[sett] InitialWindowPackets   = %u", Settings->InitialWindowPackets);
     QuicTraceLogVerbose(SettingDumpSendIdleTimeoutMs,       "[sett] SendIdleTimeoutMs      = %u", Settings->SendIdleTimeoutMs);
+    QuicTraceLogVerbose(SettingDumpCongestionControlAlgorithm, "[sett] CongestionControlAlgorithm = %hu", Settings->CongestionControlAlgorithm);
     QuicTraceLogVerbose(SettingDumpInitialRttMs,            "[sett] InitialRttMs           = %u", Settings->InitialRttMs);
     QuicTraceLogVerbose(SettingDumpMaxAckDelayMs,           "[sett] MaxAckDelayMs          = %u", Settings->MaxAckDelayMs);
     QuicTraceLogVerbose(SettingDumpDisconnectTimeoutMs,     "[sett] DisconnectTimeoutMs    = %u", Settings->DisconnectTimeoutMs);
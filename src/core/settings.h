@@ -9,10 +9,14 @@ typedef struct QUIC_SETTINGS {
 
     BOOLEAN PacingDefault;
     BOOLEAN MigrationEnabled;
+    BOOLEAN WorkStealingEnabled;        // Global only
+    BOOLEAN LockFreeLookupEnabled;      // Global only
+    BOOLEAN CryptoOffloadEnabled;       // Global only
     uint8_t MaxPartitionCount;          // Global only
     uint8_t MaxOperationsPerDrain;      // Global only
     uint16_t RetryMemoryLimit;          // Global only
     uint16_t LoadBalancingMode;         // Global only
+    uint16_t CongestionControlAlgorithm;
     uint32_t MaxWorkerQueueDelayUs;
     uint32_t MaxStatelessOperations;
     uint32_t InitialWindowPackets;
@@ -35,6 +39,9 @@ typedef struct QUIC_SETTINGS {
     struct {
         BOOLEAN PacingDefault : 1;
         BOOLEAN MigrationEnabled : 1;
+        BOOLEAN WorkStealingEnabled : 1;
+        BOOLEAN LockFreeLookupEnabled : 1;
+        BOOLEAN CryptoOffloadEnabled : 1;
         BOOLEAN MaxPartitionCount : 1;
         BOOLEAN MaxOperationsPerDrain : 1;
         BOOLEAN RetryMemoryLimit : 1;
@@ -57,6 +64,7 @@ typedef struct QUIC_SETTINGS {
         BOOLEAN StreamRecvBufferDefault : 1;
         BOOLEAN ConnFlowControlWindow : 1;
         BOOLEAN MaxBytesPerKey : 1;
+        BOOLEAN CongestionControlAlgorithm : 1;
     } AppSet;
 
 } QUIC_SETTINGS;
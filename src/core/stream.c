@@ -44,6 +44,8 @@ QuicStreamInitialize(
     Stream->RecvMaxLength = UINT64_MAX;
     Stream->RefCount = 1;
     Stream->SendRequestsTail = &Stream->SendRequests;
+    Stream->SendPriorityLevel = QUIC_DEFAULT_STREAM_PRIORITY_LEVEL;
+    Stream->SendPriorityWeight = QUIC_DEFAULT_STREAM_PRIORITY_WEIGHT;
     QuicDispatchLockInitialize(&Stream->ApiSendRequestLock);
     QuicRefInitialize(&Stream->RefCount);
 #if DEBUG
@@ -460,11 +462,47 @@ QuicStreamParamSet(
         const void* Buffer
     )
 {
-    UNREFERENCED_PARAMETER(Stream);
-    UNREFERENCED_PARAMETER(Param);
-    UNREFERENCED_PARAMETER(BufferLength);
-    UNREFERENCED_PARAMETER(Buffer);
-    return QUIC_STATUS_INVALID_PARAMETER;
+    QUIC_STATUS Status;
+
+    switch (Param)
+    {
+    case QUIC_PARAM_STREAM_PRIORITY: {
+
+        if (BufferLength != sizeof(QUIC_STREAM_PRIORITY)) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        const QUIC_STREAM_PRIORITY* Priority = (const QUIC_STREAM_PRIORITY*)Buffer;
+        if (Priority->Level >= QUIC_STREAM_PRIORITY_LEVEL_COUNT ||
+            Priority->Weight == 0) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        QuicTraceLogStreamInfo(
+            UpdatePriority,
+            Stream,
+            "New send priority level = %hhu, weight = %hhu",
+            Priority->Level,
+            Priority->Weight);
+
+        QuicSendSetStreamPriority(
+            &Stream->Connection->Send,
+            Stream,
+            Priority->Level,
+            Priority->Weight);
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    default:
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+        break;
+    }
+
+    return Status;
 }
 
 QUIC_STATUS
@@ -548,6 +586,26 @@ QuicStreamParamGet(
         Status = QUIC_STATUS_SUCCESS;
         break;
 
+    case QUIC_PARAM_STREAM_PRIORITY:
+
+        if (*BufferLength < sizeof(QUIC_STREAM_PRIORITY)) {
+            *BufferLength = sizeof(QUIC_STREAM_PRIORITY);
+            Status = QUIC_STATUS_BUFFER_TOO_SMALL;
+            break;
+        }
+
+        if (Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        *BufferLength = sizeof(QUIC_STREAM_PRIORITY);
+        ((QUIC_STREAM_PRIORITY*)Buffer)->Level = Stream->SendPriorityLevel;
+        ((QUIC_STREAM_PRIORITY*)Buffer)->Weight = Stream->SendPriorityWeight;
+
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+
     default:
         Status = QUIC_STATUS_INVALID_PARAMETER;
         break;
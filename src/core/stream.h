@@ -209,6 +209,13 @@ typedef struct QUIC_STREAM {
     //
     QUIC_LIST_ENTRY SendLink;
 
+    //
+    // The list entry in the output module's ready list for the stream's send
+    // priority level, or in its blocked list while the stream is blocked
+    // (see SendBlocked).
+    //
+    QUIC_LIST_ENTRY SendReadyLink;
+
     //
     // The parent connection for this stream.
     //
@@ -235,6 +242,18 @@ typedef struct QUIC_STREAM {
     //
     uint8_t OutFlowBlockedReasons; // Set of QUIC_FLOW_BLOCKED_* flags
 
+    //
+    // The send priority level, and the number of packets written on each turn
+    // in the round robin of the level.
+    //
+    uint8_t SendPriorityLevel;
+    uint8_t SendPriorityWeight;
+
+    //
+    // Indicates SendReadyLink is in the output module's blocked list.
+    //
+    BOOLEAN SendBlocked;
+
     //
     // Send State
     //
@@ -784,7 +803,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicStreamRecv(
     _In_ QUIC_STREAM* Stream,
-    _In_ BOOLEAN EncryptedWith0Rtt,
+    _In_ QUIC_RECV_PACKET* Packet,
     _In_ QUIC_FRAME_TYPE FrameType,
     _In_ uint16_t BufferLength,
     _In_reads_bytes_(BufferLength)
@@ -250,7 +250,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicStreamProcessStreamFrame(
     _In_ QUIC_STREAM* Stream,
-    _In_ BOOLEAN EncryptedWith0Rtt,
+    _In_ QUIC_RECV_PACKET* Packet,
     _In_ const QUIC_STREAM_EX* Frame
     )
 {
@@ -322,6 +322,8 @@ QuicStreamProcessStreamFrame(
         //
         // Write any nonduplicate data to the receive buffer.
         // QuicRecvBufferWrite will indicate if there is data to deliver.
+        // With zero-copy receive, in-order data is left in the datagram,
+        // which is held until the app is done with the data.
         //
         Status =
             QuicRecvBufferWrite(
@@ -329,6 +331,8 @@ QuicStreamProcessStreamFrame(
                 Frame->Offset,
                 (uint16_t)Frame->Length,
                 Frame->Data,
+                Stream->Connection->State.UseRecvZeroCopy ?
+                    QuicDataPathRecvPacketToRecvDatagram(Packet) : NULL,
                 &WriteLength,
                 &ReadyToDeliver);
         if (QUIC_FAILED(Status)) {
@@ -349,7 +353,7 @@ QuicStreamProcessStreamFrame(
                 "Flow control window exhausted!");
         }
 
-        if (EncryptedWith0Rtt) {
+        if (Packet->EncryptedWith0Rtt) {
             //
             // Keep track of the maximum length of the 0-RTT payload so that we
             // can indicate that appropriately to the API client.
@@ -408,7 +412,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicStreamRecv(
     _In_ QUIC_STREAM* Stream,
-    _In_ BOOLEAN EncryptedWith0Rtt,
+    _In_ QUIC_RECV_PACKET* Packet,
     _In_ QUIC_FRAME_TYPE FrameType,
     _In_ uint16_t BufferLength,
     _In_reads_bytes_(BufferLength)
@@ -483,6 +487,7 @@ QuicStreamRecv(
                 &Stream->Connection->Send,
                 Stream,
                 QUIC_STREAM_SEND_FLAG_DATA_BLOCKED);
+            QuicSendUnblockStream(&Stream->Connection->Send, Stream);
             QuicStreamSendDumpState(Stream);
 
             QuicSendQueueFlush(
@@ -522,7 +527,7 @@ QuicStreamRecv(
 
         Status =
             QuicStreamProcessStreamFrame(
-                Stream, EncryptedWith0Rtt, &Frame);
+                Stream, Packet, &Frame);
 
         break;
     }
@@ -659,11 +664,11 @@ QuicStreamRecvFlush(
     BOOLEAN FlushRecv = TRUE;
     while (FlushRecv) {
 
-        QUIC_BUFFER RecvBuffers[2];
+        QUIC_BUFFER RecvBuffers[QUIC_RECV_BUFFER_MAX_ZERO_COPY];
         QUIC_STREAM_EVENT Event = {0};
         Event.Type = QUIC_STREAM_EVENT_RECEIVE;
         Event.RECEIVE.Flags = 0;
-        Event.RECEIVE.BufferCount = 2;
+        Event.RECEIVE.BufferCount = ARRAYSIZE(RecvBuffers);
         Event.RECEIVE.Buffers = RecvBuffers;
 
         //
@@ -387,6 +387,8 @@ QuicStreamCompleteSendRequest(
         }
 
         (void)QuicStreamIndicateEvent(Stream, &Event);
+    } else if (SendRequest->Flags & QUIC_SEND_FLAG_TRANSFER_OWNERSHIP) {
+        Connection->SendBuffer.BufferedBytes -= SendRequest->TotalLength;
     } else {
         QuicSendBufferFree(
             &Connection->SendBuffer,
@@ -394,6 +396,21 @@ QuicStreamCompleteSendRequest(
             SendRequest->InternalBuffer.Length);
     }
 
+    if (SendRequest->Flags & QUIC_SEND_FLAG_TRANSFER_OWNERSHIP) {
+        //
+        // The app's buffers are no longer referenced.
+        //
+        QUIC_STREAM_EVENT Event;
+        Event.Type = QUIC_STREAM_EVENT_SEND_BUFFERS_RELEASED;
+        Event.SEND_BUFFERS_RELEASED.ClientContext = SendRequest->ClientContext;
+        QuicTraceLogStreamVerbose(
+            IndicateSendBuffersReleased,
+            Stream,
+            "Indicating QUIC_STREAM_EVENT_SEND_BUFFERS_RELEASED [%p]",
+            SendRequest);
+        (void)QuicStreamIndicateEvent(Stream, &Event);
+    }
+
     Stream->Connection->SendBuffer.PostedBytes -= SendRequest->TotalLength;
 
     if (Connection->State.UseSendBuffer) {
@@ -414,25 +431,34 @@ QuicStreamSendBufferRequest(
 
     QUIC_DBG_ASSERT(Req->TotalLength <= UINT32_MAX);
 
-    //
-    // Copy the request bytes into an internal buffer.
-    //
-    uint8_t* Buf =
-        QuicSendBufferAlloc(
-            &Connection->SendBuffer,
-            (uint32_t)Req->TotalLength);
-    if (Buf == NULL) {
-        return QUIC_STATUS_OUT_OF_MEMORY;
-    }
-    uint8_t* CurBuf = Buf;
-    for (uint32_t i = 0; i < Req->BufferCount; i++) {
-        QuicCopyMemory(CurBuf, Req->Buffers[i].Buffer, Req->Buffers[i].Length);
-        CurBuf += Req->Buffers[i].Length;
+    if (Req->Flags & QUIC_SEND_FLAG_TRANSFER_OWNERSHIP) {
+        //
+        // The app's buffers stay valid until they are released, so they are
+        // referenced in place. They still count as buffered bytes.
+        //
+        Connection->SendBuffer.BufferedBytes += Req->TotalLength;
+
+    } else {
+        //
+        // Copy the request bytes into an internal buffer.
+        //
+        uint8_t* Buf =
+            QuicSendBufferAlloc(
+                &Connection->SendBuffer,
+                (uint32_t)Req->TotalLength);
+        if (Buf == NULL) {
+            return QUIC_STATUS_OUT_OF_MEMORY;
+        }
+        uint8_t* CurBuf = Buf;
+        for (uint32_t i = 0; i < Req->BufferCount; i++) {
+            QuicCopyMemory(CurBuf, Req->Buffers[i].Buffer, Req->Buffers[i].Length);
+            CurBuf += Req->Buffers[i].Length;
+        }
+        Req->BufferCount = 1;
+        Req->Buffers = &Req->InternalBuffer;
+        Req->InternalBuffer.Buffer = Buf;
+        Req->InternalBuffer.Length = (uint32_t)Req->TotalLength;
     }
-    Req->BufferCount = 1;
-    Req->Buffers = &Req->InternalBuffer;
-    Req->InternalBuffer.Buffer = Buf;
-    Req->InternalBuffer.Length = (uint32_t)Req->TotalLength;
 
     Req->Flags |= QUIC_SEND_FLAG_BUFFERED;
     Stream->SendBufferBookmark = Req->Next;
@@ -454,7 +480,12 @@ QuicStreamSendBufferRequest(
         Req);
     (void)QuicStreamIndicateEvent(Stream, &Event);
 
-    Req->ClientContext = NULL;
+    //
+    // The context is indicated again when owned buffers are released.
+    //
+    if (!(Req->Flags & QUIC_SEND_FLAG_TRANSFER_OWNERSHIP)) {
+        Req->ClientContext = NULL;
+    }
 
     return QUIC_STATUS_SUCCESS;
 }
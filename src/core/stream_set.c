@@ -310,6 +310,11 @@ QuicStreamSetInitializeTransportParameters(
         QuicStreamSetIndicateStreamsAvailable(StreamSet);
     }
 
+    //
+    // The connection-wide flow control limit may have been updated too.
+    //
+    QuicSendUnblockAllStreams(&Connection->Send);
+
     if (MightBeUnblocked && FlushIfUnblocked) {
         //
         // We opened the window, so start send. Rather than checking
@@ -387,6 +392,7 @@ QuicStreamSetUpdateMaxStreams(
             //
             // Queue a flush, as we have unblocked a stream.
             //
+            QuicSendUnblockAllStreams(&Connection->Send);
             QuicSendQueueFlush(&Connection->Send, REASON_STREAM_ID_FLOW_CONTROL);
         }
     }
@@ -21,178 +21,299 @@ Abstract:
         The timer wheel itself doesn't care about anything other than that value
         from the connection.
 
-        Slots - This is a very simple hash table of time slots. Each slot holds
-        all connections with a next expiration time modulo the total slot count.
+        Levels - The timer wheel is a hashed, hierarchical timer wheel. Level 0
+        has one slot per millisecond; each slot of level N covers all the slots
+        of level N - 1. A connection is placed in the lowest level whose range
+        (relative to the wheel's current time) includes its expiration time.
 
-        Slot Entry - Each slot is made up of a sorted, doubly-linked list of
-        connections.
+        Slot Entry - Each slot is an unsorted, doubly-linked list of connections.
+        A bitmap per level tracks which slots are non-empty.
 
         Next Expiration - Along with all the connections in the timer wheel, the
-        timer wheel also explicitly keeps track of the next expiration time and
-        connection for quick next delay calculations.
+        timer wheel also explicitly keeps track of the next expiration time (and
+        connection, if known) for quick next delay calculations.
 
     With these parts, the timer wheel is able to support insertion, update and
     removal of any number of timers (and their associated connection).
 
     Insertion or update consists of getting the next expiration time from the
-    connection, calculating the correct slot and then doing an insert into the
-    slot's sorted list of connections. Additionally, the next expiration is
-    updated if the new timer is the soonest to expire.
+    connection, calculating the level and slot, and appending to the slot's
+    list; both are O(1). Additionally, the next expiration is updated if the new
+    timer is the soonest to expire.
 
     Removal consists of removing the connection from the doubly-linked list and
     updating the timer wheel's next expiration if this connection was currently
     next to expire.
 
+    Expiration advances the wheel's current time to now, returning expired
+    connections from the level 0 slots it passes. Whenever the current time
+    reaches the start of an occupied slot on a higher level, that slot is
+    cascaded: its connections are reinserted, which moves them to lower levels.
+    Empty stretches of time are skipped by using the occupancy bitmaps.
+
+    When the next timer is on a higher level, the next expiration time is the
+    start of its slot. That is earlier than the actual expiration, so the worker
+    may wake up once to cascade the slot before the timer really expires.
+
 --*/
 
 #include "precomp.h"
 
 //
-// The initial count of slots in the timer wheel.
+// The total range of the timer wheel, in ms.
 //
-#define QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT     32
+#define QUIC_TIMER_WHEEL_MAX_TICKS \
+    (1ull << (QUIC_TIMER_WHEEL_LEVEL_COUNT * QUIC_TIMER_WHEEL_SLOT_BITS))
 
 //
-// On average, the max number of connections per slot.
+// Helpers for a level's slot width (in ms) and a tick's slot index.
 //
-#define QUIC_TIMER_WHEEL_MAX_LOAD_FACTOR    32
+#define LEVEL_SHIFT(Level) ((Level) * QUIC_TIMER_WHEEL_SLOT_BITS)
+#define TICK_TO_SLOT_INDEX(Tick, Level) \
+    ((uint32_t)((Tick) >> LEVEL_SHIFT(Level)) & (QUIC_TIMER_WHEEL_SLOT_COUNT - 1))
+
+QUIC_STATIC_ASSERT(
+    QUIC_TIMER_WHEEL_SLOT_COUNT == 64,
+    "Occupied bitmaps are 64 bits");
 
 //
-// Helper to get the slot index for a given time.
+// Returns the index of the lowest set bit in a non-zero Mask.
 //
-#define TIME_TO_SLOT_INDEX(TimerWheel, TimeUs) \
-    ((US_TO_MS(TimeUs) / 1000) % TimerWheel->SlotCount)
+static
+uint32_t
+QuicTimerWheelLowestSetBit(
+    _In_ uint64_t Mask
+    )
+{
+    static const uint8_t DeBruijnIndex[64] = {
+         0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+    };
+    QUIC_DBG_ASSERT(Mask != 0);
+    return DeBruijnIndex[((Mask & (~Mask + 1)) * 0x03f79d71b4cb0a89ull) >> 58];
+}
 
-_IRQL_requires_max_(PASSIVE_LEVEL)
-QUIC_STATUS
-QuicTimerWheelInitialize(
-    _Inout_ QUIC_TIMER_WHEEL* TimerWheel
+//
+// Returns the distance (1 to QUIC_TIMER_WHEEL_SLOT_COUNT) from Index to the next
+// occupied slot of the level, wrapping around to Index itself last. Returns 0
+// if the level is empty.
+//
+static
+uint32_t
+QuicTimerWheelNextSlotOffset(
+    _In_ uint64_t Occupied,
+    _In_ uint32_t Index
     )
 {
-    TimerWheel->NextExpirationTime = UINT64_MAX;
-    TimerWheel->ConnectionCount = 0;
-    TimerWheel->NextConnection = NULL;
-    TimerWheel->SlotCount = QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT;
-    TimerWheel->Slots =
-        QUIC_ALLOC_NONPAGED(QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT * sizeof(QUIC_LIST_ENTRY));
-    if (TimerWheel->Slots == NULL) {
-        QuicTraceEvent(AllocFailure, "timerwheel slots",
-            QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT * sizeof(QUIC_LIST_ENTRY));
-        return QUIC_STATUS_OUT_OF_MEMORY;
+    if (Occupied == 0) {
+        return 0;
     }
+    uint32_t Shift = (Index + 1) & (QUIC_TIMER_WHEEL_SLOT_COUNT - 1);
+    uint64_t Rotated =
+        Shift == 0 ? Occupied : ((Occupied >> Shift) | (Occupied << (64 - Shift)));
+    return QuicTimerWheelLowestSetBit(Rotated) + 1;
+}
 
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
-        QuicListInitializeHead(&TimerWheel->Slots[i]);
+//
+// Returns the start of the next occupied slot on any level above 0, i.e. the
+// next tick at which connections need to be cascaded. Connections on those
+// levels don't expire earlier than this. Returns UINT64_MAX if there is none.
+//
+static
+uint64_t
+QuicTimerWheelNextCascadeTick(
+    _In_ const QUIC_TIMER_WHEEL* TimerWheel
+    )
+{
+    uint64_t NextTick = UINT64_MAX;
+
+    for (uint32_t Level = 1; Level < QUIC_TIMER_WHEEL_LEVEL_COUNT; ++Level) {
+        uint32_t Index = TICK_TO_SLOT_INDEX(TimerWheel->CurrentTick, Level);
+        uint32_t Offset =
+            QuicTimerWheelNextSlotOffset(TimerWheel->Occupied[Level], Index);
+        if (Offset != 0) {
+            uint64_t SlotStart =
+                ((TimerWheel->CurrentTick >> LEVEL_SHIFT(Level)) + Offset) << LEVEL_SHIFT(Level);
+            if (SlotStart < NextTick) {
+                NextTick = SlotStart;
+            }
+        }
     }
 
-    return QUIC_STATUS_SUCCESS;
+    return NextTick;
 }
 
-_IRQL_requires_max_(PASSIVE_LEVEL)
-void
-QuicTimerWheelUninitialize(
-    _Inout_ QUIC_TIMER_WHEEL* TimerWheel
+//
+// Returns the first tick after the current one at which the wheel has work to
+// do: either a level 0 slot with connections, or the start of a higher level
+// slot with connections to cascade. Returns UINT64_MAX if there is none.
+//
+static
+uint64_t
+QuicTimerWheelNextTick(
+    _In_ const QUIC_TIMER_WHEEL* TimerWheel
     )
 {
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
-        QUIC_LIST_ENTRY* ListHead = &TimerWheel->Slots[i];
-        QUIC_LIST_ENTRY* Entry = ListHead->Flink;
-        while (Entry != ListHead) {
-            QUIC_CONNECTION* Connection =
-                QUIC_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-            QuicTraceLogConnWarning(
-                StillInTimerWheel,
-                Connection,
-                "Still in timer wheel! Connection was likely leaked!");
-            Entry = Entry->Blink;
-        }
-        QUIC_TEL_ASSERT(QuicListIsEmpty(&TimerWheel->Slots[i]));
+    uint64_t NextTick = QuicTimerWheelNextCascadeTick(TimerWheel);
+
+    //
+    // Level 0 connections are all within QUIC_TIMER_WHEEL_SLOT_COUNT ticks, so
+    // the current slot can't hold anything for a later tick.
+    //
+    uint32_t Index = TICK_TO_SLOT_INDEX(TimerWheel->CurrentTick, 0);
+    uint32_t Offset =
+        QuicTimerWheelNextSlotOffset(
+            TimerWheel->Occupied[0] & ~(1ull << Index), Index);
+    if (Offset != 0 && TimerWheel->CurrentTick + Offset < NextTick) {
+        NextTick = TimerWheel->CurrentTick + Offset;
     }
-    QUIC_TEL_ASSERT(TimerWheel->ConnectionCount == 0);
-    QUIC_TEL_ASSERT(TimerWheel->NextConnection == NULL);
-    QUIC_TEL_ASSERT(TimerWheel->NextExpirationTime == UINT64_MAX);
 
-    QUIC_FREE(TimerWheel->Slots);
+    return NextTick;
 }
 
-_IRQL_requires_max_(PASSIVE_LEVEL)
+//
+// Places the connection in the slot for the given expiration time.
+//
+static
 void
-QuicTimerWheelResize(
-    _Inout_ QUIC_TIMER_WHEEL* TimerWheel
+QuicTimerWheelInsert(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _Inout_ QUIC_CONNECTION* Connection,
+    _In_ uint64_t ExpirationTime
     )
 {
-    uint32_t NewSlotCount = TimerWheel->SlotCount * 2;
-    if (NewSlotCount <= TimerWheel->SlotCount) {
+    uint64_t Tick = US_TO_MS(ExpirationTime);
+    if (Tick < TimerWheel->CurrentTick) {
         //
-        // Max size has been reached.
+        // Already expired. It goes in the current slot, which is processed next.
         //
-        return;
+        Tick = TimerWheel->CurrentTick;
+    } else if (Tick - TimerWheel->CurrentTick >= QUIC_TIMER_WHEEL_MAX_TICKS) {
+        //
+        // Beyond the range of the wheel. Park it in the last slot in range; it
+        // is reinserted from there once that slot is cascaded.
+        //
+        Tick = TimerWheel->CurrentTick + QUIC_TIMER_WHEEL_MAX_TICKS - 1;
     }
 
-    QUIC_LIST_ENTRY* NewSlots =
-        QUIC_ALLOC_NONPAGED(NewSlotCount * sizeof(QUIC_LIST_ENTRY));
-    if (NewSlots == NULL) {
-        QuicTraceEvent(AllocFailure, "timerwheel slots (realloc)",
-            NewSlotCount * sizeof(QUIC_LIST_ENTRY));
-        return;
+    uint64_t Delta = Tick - TimerWheel->CurrentTick;
+    uint32_t Level = 0;
+    while (Delta >> LEVEL_SHIFT(Level + 1) != 0) {
+        Level++;
     }
 
-    QuicTraceLogVerbose(
-        TimerWheelResize,
-        "[time][%p] Resizing timer wheel (new slot count = %u).",
-        TimerWheel,
-        NewSlotCount);
+    uint32_t Index = TICK_TO_SLOT_INDEX(Tick, Level);
+    QuicListInsertTail(&TimerWheel->Slots[Level][Index], &Connection->TimerLink);
+    TimerWheel->Occupied[Level] |= 1ull << Index;
+}
 
-    for (uint32_t i = 0; i < NewSlotCount; ++i) {
-        QuicListInitializeHead(&NewSlots[i]);
+//
+// Removes the connection from its slot, clearing the slot's occupied bit if
+// it is now empty.
+//
+static
+void
+QuicTimerWheelUnlink(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _Inout_ QUIC_CONNECTION* Connection
+    )
+{
+    QUIC_LIST_ENTRY* Next = Connection->TimerLink.Flink;
+    if (QuicListEntryRemove(&Connection->TimerLink)) {
+        //
+        // The list is now empty, so Next is the slot's list head.
+        //
+        uint32_t SlotNumber =
+            (uint32_t)(Next - &TimerWheel->Slots[0][0]);
+        QUIC_DBG_ASSERT(SlotNumber < QUIC_TIMER_WHEEL_LEVEL_COUNT * QUIC_TIMER_WHEEL_SLOT_COUNT);
+        TimerWheel->Occupied[SlotNumber / QUIC_TIMER_WHEEL_SLOT_COUNT] &=
+            ~(1ull << (SlotNumber % QUIC_TIMER_WHEEL_SLOT_COUNT));
     }
+}
 
-    uint32_t OldSlotCount = TimerWheel->SlotCount;
-    QUIC_LIST_ENTRY* OldSlots = TimerWheel->Slots;
+//
+// Reinserts all the connections in the slot of the level that starts at the
+// current tick, moving them to lower levels.
+//
+static
+void
+QuicTimerWheelCascade(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _In_ uint32_t Level
+    )
+{
+    uint32_t Index = TICK_TO_SLOT_INDEX(TimerWheel->CurrentTick, Level);
+    if (!(TimerWheel->Occupied[Level] & (1ull << Index))) {
+        return;
+    }
 
-    TimerWheel->SlotCount = NewSlotCount;
-    TimerWheel->Slots = NewSlots;
+    QUIC_LIST_ENTRY Cascading;
+    QuicListInitializeHead(&Cascading);
+    QuicListMoveItems(&TimerWheel->Slots[Level][Index], &Cascading);
+    TimerWheel->Occupied[Level] &= ~(1ull << Index);
+
+    while (!QuicListIsEmpty(&Cascading)) {
+        QUIC_CONNECTION* Connection =
+            QUIC_CONTAINING_RECORD(
+                QuicListRemoveHead(&Cascading),
+                QUIC_CONNECTION,
+                TimerLink);
+        QuicTimerWheelInsert(
+            TimerWheel,
+            Connection,
+            QuicConnGetNextExpirationTime(Connection));
+    }
+}
 
-    for (uint32_t i = 0; i < OldSlotCount; ++i) {
-        //
-        // Iterate through each old slot, remove all connections and add them
-        // to the new slots.
-        //
-        while (!QuicListIsEmpty(&OldSlots[i])) {
-            QUIC_CONNECTION* Connection =
-                QUIC_CONTAINING_RECORD(
-                    QuicListRemoveHead(&OldSlots[i]),
-                    QUIC_CONNECTION,
-                    TimerLink);
-            uint64_t ExpirationTime = QuicConnGetNextExpirationTime(Connection);
-            uint32_t SlotIndex = TIME_TO_SLOT_INDEX(TimerWheel, ExpirationTime);
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+QuicTimerWheelInitialize(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel
+    )
+{
+    TimerWheel->NextExpirationTime = UINT64_MAX;
+    TimerWheel->ConnectionCount = 0;
+    TimerWheel->NextConnection = NULL;
+    TimerWheel->CurrentTick = US_TO_MS(QuicTimeUs64());
 
-            //
-            // Insert the connection into the slot, in the correct order. We search
-            // the slot's list in reverse order, with the assumption that most new
-            // timers will on average be later than existing ones.
-            //
-            QUIC_LIST_ENTRY* ListHead = &TimerWheel->Slots[SlotIndex];
-            QUIC_LIST_ENTRY* Entry = ListHead->Blink;
+    for (uint32_t Level = 0; Level < QUIC_TIMER_WHEEL_LEVEL_COUNT; ++Level) {
+        TimerWheel->Occupied[Level] = 0;
+        for (uint32_t i = 0; i < QUIC_TIMER_WHEEL_SLOT_COUNT; ++i) {
+            QuicListInitializeHead(&TimerWheel->Slots[Level][i]);
+        }
+    }
 
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicTimerWheelUninitialize(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel
+    )
+{
+    for (uint32_t Level = 0; Level < QUIC_TIMER_WHEEL_LEVEL_COUNT; ++Level) {
+        for (uint32_t i = 0; i < QUIC_TIMER_WHEEL_SLOT_COUNT; ++i) {
+            QUIC_LIST_ENTRY* ListHead = &TimerWheel->Slots[Level][i];
+            QUIC_LIST_ENTRY* Entry = ListHead->Flink;
             while (Entry != ListHead) {
-                QUIC_CONNECTION* ConnectionEntry =
+                QUIC_CONNECTION* Connection =
                     QUIC_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-                uint64_t EntryExpirationTime = QuicConnGetNextExpirationTime(ConnectionEntry);
-
-                if (ExpirationTime > EntryExpirationTime) {
-                    break;
-                }
-
-                Entry = Entry->Blink;
+                QuicTraceLogConnWarning(
+                    StillInTimerWheel,
+                    Connection,
+                    "Still in timer wheel! Connection was likely leaked!");
+                Entry = Entry->Flink;
             }
-
-            //
-            // Insert after the current entry.
-            //
-            QuicListInsertHead(Entry, &Connection->TimerLink);
+            QUIC_TEL_ASSERT(QuicListIsEmpty(ListHead));
         }
+        QUIC_TEL_ASSERT(TimerWheel->Occupied[Level] == 0);
     }
+    QUIC_TEL_ASSERT(TimerWheel->ConnectionCount == 0);
+    QUIC_TEL_ASSERT(TimerWheel->NextConnection == NULL);
+    QUIC_TEL_ASSERT(TimerWheel->NextExpirationTime == UINT64_MAX);
 }
 
 //
@@ -208,26 +329,43 @@ QuicTimerWheelUpdate(
     TimerWheel->NextExpirationTime = UINT64_MAX;
     TimerWheel->NextConnection = NULL;
 
-    //
-    // Loop over the slots to find the connection with the earliest
-    // expiration time.
-    //
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
-        if (!QuicListIsEmpty(&TimerWheel->Slots[i])) {
+    uint32_t Index = TICK_TO_SLOT_INDEX(TimerWheel->CurrentTick, 0);
+    if (TimerWheel->Occupied[0] != 0) {
+        //
+        // Find the first occupied level 0 slot, starting with the current one,
+        // and scan it for the earliest connection.
+        //
+        uint32_t Offset =
+            (TimerWheel->Occupied[0] & (1ull << Index)) ?
+                0 : QuicTimerWheelNextSlotOffset(TimerWheel->Occupied[0], Index);
+        QUIC_LIST_ENTRY* ListHead =
+            &TimerWheel->Slots[0][(Index + Offset) % QUIC_TIMER_WHEEL_SLOT_COUNT];
+        for (QUIC_LIST_ENTRY* Entry = ListHead->Flink;
+            Entry != ListHead;
+            Entry = Entry->Flink) {
             QUIC_CONNECTION* ConnectionEntry =
-                QUIC_CONTAINING_RECORD(
-                    TimerWheel->Slots[i].Flink,
-                    QUIC_CONNECTION,
-                    TimerLink);
+                QUIC_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
             uint64_t EntryExpirationTime = QuicConnGetNextExpirationTime(ConnectionEntry);
             if (EntryExpirationTime < TimerWheel->NextExpirationTime) {
                 TimerWheel->NextExpirationTime = EntryExpirationTime;
                 TimerWheel->NextConnection = ConnectionEntry;
             }
         }
+
     }
 
-    if (TimerWheel->NextConnection == NULL) {
+    //
+    // Connections on higher levels may still expire earlier. If so, wake up at
+    // the start of the next occupied slot, so it gets cascaded.
+    //
+    uint64_t NextCascadeTick = QuicTimerWheelNextCascadeTick(TimerWheel);
+    if (NextCascadeTick != UINT64_MAX &&
+        MS_TO_US(NextCascadeTick) < TimerWheel->NextExpirationTime) {
+        TimerWheel->NextExpirationTime = MS_TO_US(NextCascadeTick);
+        TimerWheel->NextConnection = NULL;
+    }
+
+    if (TimerWheel->NextExpirationTime == UINT64_MAX) {
         QuicTraceLogVerbose(
             TimerWheelNextExpirationNull,
             "[time][%p] Next Expiration = {NULL}.",
@@ -259,11 +397,12 @@ QuicTimerWheelRemoveConnection(
             "[time][%p] Removing Connection %p.",
             TimerWheel,
             Connection);
-        QuicListEntryRemove(&Connection->TimerLink);
+        QuicTimerWheelUnlink(TimerWheel, Connection);
         Connection->TimerLink.Flink = NULL;
         TimerWheel->ConnectionCount--;
 
-        if (Connection == TimerWheel->NextConnection) {
+        if (Connection == TimerWheel->NextConnection ||
+            TimerWheel->ConnectionCount == 0) {
             QuicTimerWheelUpdate(TimerWheel);
         }
     }
@@ -282,7 +421,7 @@ QuicTimerWheelUpdateConnection(
         //
         // Connection is already in the timer wheel, so remove it first.
         //
-        QuicListEntryRemove(&Connection->TimerLink);
+        QuicTimerWheelUnlink(TimerWheel, Connection);
 
         if (ExpirationTime == UINT64_MAX) {
             TimerWheel->ConnectionCount--;
@@ -295,6 +434,16 @@ QuicTimerWheelUpdateConnection(
         // wheel.
         //
         if (ExpirationTime != UINT64_MAX) {
+            if (TimerWheel->ConnectionCount == 0) {
+                //
+                // Nothing to cascade, so catch the wheel's time up to now, in
+                // case it has been idle for a while.
+                //
+                uint64_t TimeNowTick = US_TO_MS(QuicTimeUs64());
+                if (TimeNowTick > TimerWheel->CurrentTick) {
+                    TimerWheel->CurrentTick = TimeNowTick;
+                }
+            }
             TimerWheel->ConnectionCount++;
         }
     }
@@ -310,38 +459,14 @@ QuicTimerWheelUpdateConnection(
             TimerWheel,
             Connection);
 
-        if (Connection == TimerWheel->NextConnection) {
+        if (Connection == TimerWheel->NextConnection ||
+            TimerWheel->ConnectionCount == 0) {
             QuicTimerWheelUpdate(TimerWheel);
         }
 
     } else {
 
-        uint32_t SlotIndex = TIME_TO_SLOT_INDEX(TimerWheel, ExpirationTime);
-
-        //
-        // Insert the connection into the slot, in the correct order. We search
-        // the slot's list in reverse order, with the assumption that most new
-        // timers will on average be later than existing ones.
-        //
-        QUIC_LIST_ENTRY* ListHead = &TimerWheel->Slots[SlotIndex];
-        QUIC_LIST_ENTRY* Entry = ListHead->Blink;
-
-        while (Entry != ListHead) {
-            QUIC_CONNECTION* ConnectionEntry =
-                QUIC_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-            uint64_t EntryExpirationTime = QuicConnGetNextExpirationTime(ConnectionEntry);
-
-            if (ExpirationTime > EntryExpirationTime) {
-                break;
-            }
-
-            Entry = Entry->Blink;
-        }
-
-        //
-        // Insert after the current entry.
-        //
-        QuicListInsertHead(Entry, &Connection->TimerLink);
+        QuicTimerWheelInsert(TimerWheel, Connection, ExpirationTime);
 
         QuicTraceLogVerbose(
             TimerWheelUpdateConnection,
@@ -364,15 +489,6 @@ QuicTimerWheelUpdateConnection(
         } else if (Connection == TimerWheel->NextConnection) {
             QuicTimerWheelUpdate(TimerWheel);
         }
-
-        //
-        // Resize the timer wheel if we have too many connections for the
-        // current size.
-        //
-        if (TimerWheel->ConnectionCount >
-            TimerWheel->SlotCount * QUIC_TIMER_WHEEL_MAX_LOAD_FACTOR) {
-            QuicTimerWheelResize(TimerWheel);
-        }
     }
 }
 
@@ -416,24 +532,61 @@ QuicTimerWheelGetExpired(
     _Inout_ QUIC_LIST_ENTRY* OutputListHead
     )
 {
-    //
-    // Iterate through every slot to find all the connections that now have
-    // expired timers.
-    //
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
-        QUIC_LIST_ENTRY* ListHead = &TimerWheel->Slots[i];
+    uint64_t TimeNowTick = US_TO_MS(TimeNow);
+
+    if (TimerWheel->ConnectionCount == 0) {
+        if (TimeNowTick > TimerWheel->CurrentTick) {
+            TimerWheel->CurrentTick = TimeNowTick;
+        }
+        return;
+    }
+
+    for (;;) {
+        //
+        // Move all the expired connections in the current slot to the output.
+        // Only the slot of the final tick can still have unexpired ones.
+        //
+        uint32_t Index = TICK_TO_SLOT_INDEX(TimerWheel->CurrentTick, 0);
+        QUIC_LIST_ENTRY* ListHead = &TimerWheel->Slots[0][Index];
         QUIC_LIST_ENTRY* Entry = ListHead->Flink;
         while (Entry != ListHead) {
             QUIC_CONNECTION* ConnectionEntry =
                 QUIC_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-            uint64_t EntryExpirationTime = QuicConnGetNextExpirationTime(ConnectionEntry);
-            if (EntryExpirationTime > TimeNow) {
-                break;
-            }
             Entry = Entry->Flink;
-            QuicListEntryRemove(&ConnectionEntry->TimerLink);
-            QuicListInsertTail(OutputListHead, &ConnectionEntry->TimerLink);
-            TimerWheel->ConnectionCount--;
+            if (QuicConnGetNextExpirationTime(ConnectionEntry) <= TimeNow) {
+                QuicListEntryRemove(&ConnectionEntry->TimerLink);
+                QuicListInsertTail(OutputListHead, &ConnectionEntry->TimerLink);
+                TimerWheel->ConnectionCount--;
+                if (ConnectionEntry == TimerWheel->NextConnection) {
+                    TimerWheel->NextConnection = NULL;
+                }
+            }
+        }
+        if (QuicListIsEmpty(ListHead)) {
+            TimerWheel->Occupied[0] &= ~(1ull << Index);
+        }
+
+        if (TimerWheel->CurrentTick >= TimeNowTick) {
+            break;
+        }
+
+        //
+        // Skip ahead to the next tick with work to do, cascading any higher
+        // level slots that start there.
+        //
+        uint64_t NextTick = QuicTimerWheelNextTick(TimerWheel);
+        if (NextTick > TimeNowTick) {
+            TimerWheel->CurrentTick = TimeNowTick;
+            continue;
+        }
+
+        TimerWheel->CurrentTick = NextTick;
+        for (uint32_t Level = QUIC_TIMER_WHEEL_LEVEL_COUNT - 1; Level > 0; --Level) {
+            if ((NextTick & ((1ull << LEVEL_SHIFT(Level)) - 1)) == 0) {
+                QuicTimerWheelCascade(TimerWheel, Level);
+            }
         }
     }
+
+    QuicTimerWheelUpdate(TimerWheel);
 }
@@ -7,10 +7,23 @@
 
 typedef struct QUIC_CONNECTION QUIC_CONNECTION;
 
+//
+// The timer wheel has QUIC_TIMER_WHEEL_LEVEL_COUNT levels of
+// QUIC_TIMER_WHEEL_SLOT_COUNT slots each. Level 0 slots are 1 ms wide and each
+// level up is QUIC_TIMER_WHEEL_SLOT_COUNT times coarser, for a total range of
+// 2^24 ms (~4.6 hours). Timers further out are parked in the last slot in range
+// and re-cascaded when it is reached.
+//
+#define QUIC_TIMER_WHEEL_LEVEL_COUNT    4
+#define QUIC_TIMER_WHEEL_SLOT_BITS      6
+#define QUIC_TIMER_WHEEL_SLOT_COUNT     (1 << QUIC_TIMER_WHEEL_SLOT_BITS)
+
 typedef struct QUIC_TIMER_WHEEL {
 
     //
-    // The expiration time (in us) for the next timer in the timer wheel.
+    // The expiration time (in us) for the next timer in the timer wheel. Exact
+    // if NextConnection is set, otherwise a lower bound (the start of the next
+    // occupied coarse slot).
     //
     uint64_t NextExpirationTime;
 
@@ -20,19 +33,25 @@ typedef struct QUIC_TIMER_WHEEL {
     uint64_t ConnectionCount;
 
     //
-    // The connection with the timer that expires next.
+    // The connection with the timer that expires next, if known.
     //
     QUIC_CONNECTION* NextConnection;
 
     //
-    // The number of slots in the Slots array.
+    // The current time of the wheel, in ms. All earlier ticks have already been
+    // processed.
+    //
+    uint64_t CurrentTick;
+
+    //
+    // Per level bitmap of the non-empty slots.
     //
-    uint32_t SlotCount;
+    uint64_t Occupied[QUIC_TIMER_WHEEL_LEVEL_COUNT];
 
     //
-    // An array of slots in the timer wheel.
+    // The slots. Each slot is an unsorted, doubly-linked list of connections.
     //
-    QUIC_LIST_ENTRY* Slots;
+    QUIC_LIST_ENTRY Slots[QUIC_TIMER_WHEEL_LEVEL_COUNT][QUIC_TIMER_WHEEL_SLOT_COUNT];
 
 } QUIC_TIMER_WHEEL;
 
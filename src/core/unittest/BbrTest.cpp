@@ -0,0 +1,362 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the BBR congestion control state machine, driven with
+    synthetic ACK and loss events.
+
+--*/
+
+#include "main.h"
+
+#define TEST_MTU 1280
+#define TEST_MIN_WINDOW (4 * TEST_MTU)
+#define TEST_MIN_RTT MS_TO_US(50)
+
+//
+// The connection is accessed through a view past the QUIC_HANDLE member C++
+// doesn't see (see PacingTest.cpp).
+//
+struct BbrController {
+    QUIC_CONNECTION* Connection;
+    QUIC_CONNECTION* View;
+    QUIC_CONGESTION_CONTROL* Cc;
+    QUIC_CONGESTION_CONTROL_BBR* Bbr;
+    uint64_t TotalBytesAcked;
+    uint64_t RoundStartBytesAcked;
+    uint64_t PacketNumber;
+    BbrController() : TotalBytesAcked(0), RoundStartBytesAcked(0), PacketNumber(0) {
+        Connection =
+            (QUIC_CONNECTION*)calloc(1, sizeof(QUIC_HANDLE) + sizeof(QUIC_CONNECTION));
+        View = (QUIC_CONNECTION*)((uint8_t*)Connection + sizeof(QUIC_HANDLE));
+        View->Paths[0].Mtu = TEST_MTU;
+        View->Paths[0].SmoothedRtt = TEST_MIN_RTT;
+        View->Paths[0].GotFirstRttSample = TRUE;
+        Cc = &View->CongestionControl;
+        Bbr = &Cc->Bbr;
+
+        QUIC_SETTINGS Settings;
+        QuicZeroMemory(&Settings, sizeof(Settings));
+        Settings.CongestionControlAlgorithm = QUIC_CONGESTION_CONTROL_ALGORITHM_BBR;
+        Settings.InitialWindowPackets = 10;
+        Settings.SendIdleTimeoutMs = 1000;
+        QuicCongestionControlInitialize(Cc, &Settings);
+    }
+    ~BbrController() {
+        free(Connection);
+    }
+    //
+    // Acknowledges Bytes delivered at DeliveryRate, leaving BytesInFlight in
+    // flight. A new round starts if NewRound is set, i.e. the sampled packet
+    // was sent after the previous round's packets were acknowledged.
+    //
+    void Ack(
+        uint32_t Bytes,
+        uint64_t DeliveryRate,
+        uint32_t BytesInFlight,
+        bool NewRound = true,
+        uint32_t MinRtt = TEST_MIN_RTT
+        ) {
+        QUIC_RATE_SAMPLE RateSample;
+        QuicZeroMemory(&RateSample, sizeof(RateSample));
+        RateSample.Valid = TRUE;
+        RateSample.Rtt = MinRtt;
+        if (NewRound) {
+            RoundStartBytesAcked = TotalBytesAcked;
+        }
+        RateSample.PriorTotalBytesAcked = RoundStartBytesAcked;
+        TotalBytesAcked += Bytes;
+        RateSample.TotalBytesAcked = TotalBytesAcked;
+        RateSample.DeliveryRate = DeliveryRate;
+
+        QUIC_ACK_EVENT AckEvent;
+        QuicZeroMemory(&AckEvent, sizeof(AckEvent));
+        AckEvent.TimeNow = (uint32_t)QuicTimeUs32();
+        AckEvent.LargestPacketNumberAcked = PacketNumber++;
+        AckEvent.NumRetransmittableBytes = Bytes;
+        AckEvent.SmoothedRtt = TEST_MIN_RTT;
+        AckEvent.MinRttValid = TRUE;
+        AckEvent.MinRtt = MinRtt;
+        AckEvent.RateSample = &RateSample;
+
+        Cc->BytesInFlight = BytesInFlight + Bytes;
+        QuicCongestionControlOnDataAcknowledged(Cc, &AckEvent);
+        ASSERT_EQ(BytesInFlight, Cc->BytesInFlight);
+    }
+    void Lose(uint32_t Bytes, uint32_t BytesInFlight) {
+        Cc->BytesInFlight = BytesInFlight + Bytes;
+        QuicCongestionControlOnDataLost(
+            Cc, PacketNumber, PacketNumber + 10, Bytes, FALSE);
+        PacketNumber += 11;
+    }
+    uint64_t Bandwidth() const {
+        return Bbr->BandwidthFilter.Samples[0].Bandwidth;
+    }
+    //
+    // Fills the pipe at 4.8 MB/s, which keeps the bandwidth-delay product
+    // (240 KB) below 400 KB in flight, so STARTUP ends in DRAIN.
+    //
+    void RunStartup() {
+        Ack(TEST_MTU, 1000000, 400000);
+        Ack(TEST_MTU, 2000000, 400000);
+        Ack(TEST_MTU, 4000000, 400000);
+        for (uint32_t i = 0; i < 3; ++i) {
+            Ack(TEST_MTU, 4800000, 400000);
+        }
+    }
+    //
+    // Drains below the bandwidth-delay product to enter PROBE_BW.
+    //
+    void RunDrain() {
+        Ack(TEST_MTU, 4800000, 100000, false);
+    }
+};
+
+TEST(BbrTest, Initialize)
+{
+    BbrController Cc;
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_STARTUP, Cc.Bbr->State);
+    ASSERT_EQ(10u * TEST_MTU, Cc.Cc->CongestionWindow);
+    ASSERT_EQ(UINT32_MAX, Cc.Cc->SlowStartThreshold);
+    ASSERT_FALSE(Cc.Bbr->BtlbwFound);
+    ASSERT_FALSE(Cc.Bbr->MinRttValid);
+    ASSERT_EQ(0u, Cc.Bandwidth());
+
+    //
+    // Without a bandwidth estimate, the window is paced over the smoothed RTT,
+    // at STARTUP's high gain.
+    //
+    ASSERT_GT(Cc.Cc->Vtbl->GetPacingRate(Cc.Cc), 10ull * TEST_MTU * 2 * S_TO_US(1) / TEST_MIN_RTT);
+}
+
+TEST(BbrTest, BandwidthFilterExpiry)
+{
+    //
+    // The max filter holds a sample for 10 rounds. A lower sample taken in
+    // the meantime becomes the max once the best one expires, and is itself
+    // replaced once it expires.
+    //
+    BbrController Cc;
+    for (uint32_t Round = 1; Round <= 16; ++Round) {
+        uint64_t Sample = Round == 1 ? 1000000 : Round == 5 ? 750000 : 500000;
+        Cc.Ack(TEST_MTU, Sample, 400000);
+        ASSERT_EQ(Round, Cc.Bbr->RoundTripCounter);
+        uint64_t Expected = Round <= 11 ? 1000000 : Round <= 15 ? 750000 : 500000;
+        ASSERT_EQ(Expected, Cc.Bandwidth()) << "Round " << Round;
+    }
+
+    //
+    // A new max replaces everything immediately.
+    //
+    Cc.Ack(TEST_MTU, 2000000, 400000);
+    ASSERT_EQ(2000000u, Cc.Bandwidth());
+}
+
+TEST(BbrTest, BandwidthFilterSameRound)
+{
+    //
+    // Samples within a round don't advance the round counter, so they don't
+    // age the filter.
+    //
+    BbrController Cc;
+    Cc.Ack(TEST_MTU, 1000000, 400000);
+    for (uint32_t i = 0; i < 20; ++i) {
+        Cc.Ack(TEST_MTU, 500000, 400000, false);
+    }
+    ASSERT_EQ(1u, Cc.Bbr->RoundTripCounter);
+    ASSERT_EQ(1000000u, Cc.Bandwidth());
+}
+
+TEST(BbrTest, StartupExit)
+{
+    BbrController Cc;
+
+    //
+    // Doubling each round keeps STARTUP going.
+    //
+    Cc.Ack(TEST_MTU, 1000000, 400000);
+    Cc.Ack(TEST_MTU, 2000000, 400000);
+    Cc.Ack(TEST_MTU, 4000000, 400000);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_STARTUP, Cc.Bbr->State);
+    ASSERT_EQ(0u, Cc.Bbr->SlowStartupRoundCounter);
+
+    //
+    // 20% growth isn't enough. The third such round in a row exits STARTUP.
+    //
+    Cc.Ack(TEST_MTU, 4800000, 400000);
+    ASSERT_EQ(1u, Cc.Bbr->SlowStartupRoundCounter);
+    Cc.Ack(TEST_MTU, 4800000, 400000, false);
+    ASSERT_EQ(1u, Cc.Bbr->SlowStartupRoundCounter);
+    Cc.Ack(TEST_MTU, 4800000, 400000);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_STARTUP, Cc.Bbr->State);
+    ASSERT_FALSE(Cc.Bbr->BtlbwFound);
+    Cc.Ack(TEST_MTU, 4800000, 400000);
+    ASSERT_TRUE(Cc.Bbr->BtlbwFound);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_DRAIN, Cc.Bbr->State);
+
+    //
+    // DRAIN paces below the bandwidth estimate.
+    //
+    ASSERT_LT(Cc.Cc->Vtbl->GetPacingRate(Cc.Cc), 4800000u);
+}
+
+TEST(BbrTest, StartupGrowthResets)
+{
+    //
+    // 25% growth after two slow rounds resets the count.
+    //
+    BbrController Cc;
+    Cc.Ack(TEST_MTU, 4000000, 400000);
+    Cc.Ack(TEST_MTU, 4000000, 400000);
+    Cc.Ack(TEST_MTU, 4000000, 400000);
+    ASSERT_EQ(2u, Cc.Bbr->SlowStartupRoundCounter);
+    Cc.Ack(TEST_MTU, 5000000, 400000);
+    ASSERT_EQ(0u, Cc.Bbr->SlowStartupRoundCounter);
+    Cc.Ack(TEST_MTU, 5000000, 400000);
+    Cc.Ack(TEST_MTU, 5000000, 400000);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_STARTUP, Cc.Bbr->State);
+    Cc.Ack(TEST_MTU, 5000000, 400000);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_DRAIN, Cc.Bbr->State);
+}
+
+TEST(BbrTest, DrainToProbeBw)
+{
+    BbrController Cc;
+    Cc.RunStartup();
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_DRAIN, Cc.Bbr->State);
+
+    //
+    // DRAIN holds while more than the bandwidth-delay product is in flight.
+    //
+    Cc.Ack(TEST_MTU, 4800000, 300000, false);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_DRAIN, Cc.Bbr->State);
+
+    Cc.RunDrain();
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_PROBE_BW, Cc.Bbr->State);
+
+    //
+    // PROBE_BW never starts in the draining phase of the gain cycle.
+    //
+    ASSERT_NE(1u, Cc.Bbr->PacingCycleIndex);
+    ASSERT_GE(Cc.Cc->Vtbl->GetPacingRate(Cc.Cc), 4800000u);
+    ASSERT_GT(Cc.Bbr->CwndGain, Cc.Bbr->PacingGain);
+}
+
+TEST(BbrTest, ProbeRtt)
+{
+    BbrController Cc;
+    Cc.RunStartup();
+    Cc.RunDrain();
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_PROBE_BW, Cc.Bbr->State);
+    Cc.Cc->CongestionWindow = 100000;
+
+    //
+    // A min RTT older than 10 seconds is replaced by the next sample, even a
+    // larger one, and PROBE_RTT cuts the window to the minimum.
+    //
+    Cc.Bbr->MinRttTimestamp = QuicTimeUs64() - S_TO_US(11);
+    Cc.Ack(TEST_MTU, 4800000, 100000, false, MS_TO_US(60));
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_PROBE_RTT, Cc.Bbr->State);
+    ASSERT_EQ((uint32_t)MS_TO_US(60), Cc.Bbr->MinRtt);
+    ASSERT_EQ(100000u, Cc.Bbr->PreviousCongestionWindow);
+    ASSERT_EQ((uint32_t)TEST_MIN_WINDOW, Cc.Cc->CongestionWindow);
+
+    //
+    // The probe only starts timing once the inflight data drains to the
+    // minimum window.
+    //
+    Cc.Ack(TEST_MTU, 4800000, 50000, false);
+    ASSERT_FALSE(Cc.Bbr->ProbeRttDoneTimeValid);
+    Cc.Ack(TEST_MTU, 4800000, TEST_MIN_WINDOW, false);
+    ASSERT_TRUE(Cc.Bbr->ProbeRttDoneTimeValid);
+    ASSERT_EQ((uint32_t)TEST_MIN_WINDOW, Cc.Cc->CongestionWindow);
+
+    //
+    // It lasts at least 200 ms and a round trip.
+    //
+    Cc.Ack(TEST_MTU, 4800000, TEST_MIN_WINDOW);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_PROBE_RTT, Cc.Bbr->State);
+    Cc.Bbr->ProbeRttDoneTime = QuicTimeUs64() - 1;
+    Cc.Ack(TEST_MTU, 4800000, TEST_MIN_WINDOW, false);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_PROBE_BW, Cc.Bbr->State);
+
+    //
+    // The window from before the probe is restored.
+    //
+    ASSERT_GE(Cc.Cc->CongestionWindow, 100000u);
+}
+
+TEST(BbrTest, ProbeRttRoundTrip)
+{
+    BbrController Cc;
+    Cc.RunStartup();
+    Cc.RunDrain();
+    Cc.Bbr->MinRttTimestamp = QuicTimeUs64() - S_TO_US(11);
+    Cc.Ack(TEST_MTU, 4800000, TEST_MIN_WINDOW, false);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_PROBE_RTT, Cc.Bbr->State);
+    ASSERT_TRUE(Cc.Bbr->ProbeRttDoneTimeValid);
+
+    //
+    // Even once the time is up, PROBE_RTT waits for the round to end.
+    //
+    Cc.Bbr->ProbeRttDoneTime = QuicTimeUs64() - 1;
+    Cc.Ack(TEST_MTU, 4800000, TEST_MIN_WINDOW, false);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_PROBE_RTT, Cc.Bbr->State);
+    Cc.Ack(TEST_MTU, 4800000, TEST_MIN_WINDOW);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_PROBE_BW, Cc.Bbr->State);
+}
+
+TEST(BbrTest, Recovery)
+{
+    BbrController Cc;
+    Cc.RunStartup();
+    Cc.RunDrain();
+    Cc.Cc->CongestionWindow = 100000;
+
+    //
+    // Loss caps the window at what is still in flight, and packet
+    // conservation grows it by what is acknowledged until recovery ends.
+    //
+    Cc.Lose(TEST_MTU, 20000);
+    ASSERT_TRUE(Cc.Bbr->IsInRecovery);
+    ASSERT_EQ(1u, Cc.View->Stats.Send.CongestionCount);
+    ASSERT_EQ(20000u, Cc.Cc->CongestionWindow);
+
+    Cc.PacketNumber = Cc.Bbr->EndOfRecovery;
+    Cc.Ack(TEST_MTU, 4800000, 20000, false);
+    ASSERT_TRUE(Cc.Bbr->IsInRecovery);
+    ASSERT_EQ(20000u + TEST_MTU, Cc.Cc->CongestionWindow);
+
+    Cc.Ack(TEST_MTU, 4800000, 20000, false);
+    ASSERT_FALSE(Cc.Bbr->IsInRecovery);
+    ASSERT_GE(Cc.Cc->CongestionWindow, 100000u);
+}
+
+TEST(BbrTest, Reset)
+{
+    BbrController Cc;
+    BbrController Fresh;
+    Cc.RunStartup();
+    Cc.RunDrain();
+    Cc.Lose(TEST_MTU, 20000);
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_PROBE_BW, Cc.Bbr->State);
+    ASSERT_TRUE(Cc.Bbr->IsInRecovery);
+
+    QuicCongestionControlReset(Cc.Cc);
+    ASSERT_EQ(0u, Cc.Cc->BytesInFlight);
+    ASSERT_EQ(Fresh.Cc->CongestionWindow, Cc.Cc->CongestionWindow);
+    ASSERT_EQ(Fresh.Cc->SlowStartThreshold, Cc.Cc->SlowStartThreshold);
+    ASSERT_EQ(Fresh.Cc->BytesInFlightMax, Cc.Cc->BytesInFlightMax);
+    ASSERT_EQ(0, memcmp(Fresh.Bbr, Cc.Bbr, sizeof(*Cc.Bbr)));
+
+    //
+    // And it runs STARTUP again from scratch.
+    //
+    Cc.TotalBytesAcked = Cc.RoundStartBytesAcked = 0;
+    Cc.RunStartup();
+    ASSERT_EQ((uint8_t)QUIC_BBR_STATE_DRAIN, Cc.Bbr->State);
+    ASSERT_EQ(6u, Cc.Bbr->RoundTripCounter);
+}
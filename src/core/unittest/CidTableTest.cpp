@@ -0,0 +1,273 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the QUIC_CID_TABLE interface.
+
+--*/
+
+#include "main.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static QUIC_CONNECTION* FakeConnection(size_t Index) {
+    return (QUIC_CONNECTION*)(uintptr_t)((Index + 1) * 16);
+}
+
+static uint32_t Hash(const QUIC_CID_HASH_ENTRY* Entry) {
+    return QuicHashSimple(Entry->CID.Length, Entry->CID.Data);
+}
+
+struct SmartCidTable {
+    QUIC_CID_TABLE Table;
+    std::vector<QUIC_CID_HASH_ENTRY*> Entries;
+    std::mt19937_64 Rng;
+    uint32_t RetiredCount {0};
+    SmartCidTable() : Rng(42) {
+        EXPECT_TRUE(QuicCidTableInitialize(&Table, QUIC_HASH_MIN_SIZE));
+    }
+    ~SmartCidTable() {
+        for (auto Entry : Entries) {
+            if (Entry->CID.IsInLookupTable) {
+                QuicCidTableRemove(&Table, Entry, Hash(Entry));
+            }
+            free(Entry);
+        }
+        QuicCidTableUninitialize(&Table);
+    }
+    QUIC_CID_HASH_ENTRY* New(uint8_t Length, const uint8_t* Prefix = nullptr, uint8_t PrefixLength = 0) {
+        auto Entry =
+            (QUIC_CID_HASH_ENTRY*)calloc(1, sizeof(QUIC_CID_HASH_ENTRY) + Length);
+        Entry->Connection = FakeConnection(Entries.size());
+        Entry->CID.Length = Length;
+        for (uint8_t i = 0; i < Length; ++i) {
+            Entry->CID.Data[i] = i < PrefixLength ? Prefix[i] : (uint8_t)Rng();
+        }
+        Entries.push_back(Entry);
+        return Entry;
+    }
+    void Insert(QUIC_CID_HASH_ENTRY* Entry) {
+        QUIC_CID_TABLE_STORAGE* Retired;
+        ASSERT_TRUE(QuicCidTableInsert(&Table, Entry, Hash(Entry), &Retired));
+        Entry->CID.IsInLookupTable = TRUE;
+        if (Retired != NULL) {
+            RetiredCount++;
+            QUIC_FREE(Retired);
+        }
+    }
+    void Remove(QUIC_CID_HASH_ENTRY* Entry) {
+        QuicCidTableRemove(&Table, Entry, Hash(Entry));
+        Entry->CID.IsInLookupTable = FALSE;
+    }
+    QUIC_CONNECTION* Lookup(const uint8_t* Cid, uint8_t Length) {
+        return QuicCidTableLookup(&Table, Cid, Length, QuicHashSimple(Length, Cid));
+    }
+    void Validate() {
+        uint32_t Count = 0;
+        for (auto Entry : Entries) {
+            QUIC_CONNECTION* Connection = Lookup(Entry->CID.Data, Entry->CID.Length);
+            if (Entry->CID.IsInLookupTable) {
+                ASSERT_EQ(Entry->Connection, Connection);
+                Count++;
+            } else {
+                ASSERT_EQ(nullptr, Connection);
+            }
+        }
+        ASSERT_EQ(Count, Table.Count);
+    }
+};
+
+TEST(CidTableTest, Empty)
+{
+    SmartCidTable Table;
+    uint8_t Cid[8] = {0};
+    ASSERT_EQ(nullptr, Table.Lookup(Cid, sizeof(Cid)));
+    uint32_t Index = 0;
+    ASSERT_EQ(nullptr, QuicCidTableEnumerateNext(&Table.Table, &Index));
+}
+
+TEST(CidTableTest, InsertLookupRemove)
+{
+    SmartCidTable Table;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        Table.Insert(Table.New(MSQUIC_CID_MIN_LENGTH + (uint8_t)(i % 6)));
+    }
+    Table.Validate();
+    ASSERT_NE(0u, Table.RetiredCount);
+
+    for (size_t i = 0; i < Table.Entries.size(); i += 2) {
+        Table.Remove(Table.Entries[i]);
+    }
+    Table.Validate();
+
+    //
+    // Lookups with the same bytes but a different length must not match.
+    //
+    auto Entry = Table.Entries[1];
+    ASSERT_EQ(nullptr, Table.Lookup(Entry->CID.Data, Entry->CID.Length - 1));
+
+    //
+    // Removed CIDs are purged when the storage is rebuilt.
+    //
+    for (uint32_t i = 0; i < 10000; ++i) {
+        Table.Insert(Table.New(MSQUIC_CID_MAX_LENGTH));
+    }
+    Table.Validate();
+}
+
+TEST(CidTableTest, LongCids)
+{
+    //
+    // CIDs longer than the inline prefix that only differ after it.
+    //
+    SmartCidTable Table;
+    uint8_t Prefix[QUIC_CID_TABLE_PREFIX_LENGTH] = {0};
+    for (uint32_t i = 0; i < 100; ++i) {
+        Table.Insert(
+            Table.New(
+                QUIC_MAX_CONNECTION_ID_LENGTH_V1,
+                Prefix,
+                sizeof(Prefix)));
+    }
+    Table.Validate();
+}
+
+TEST(CidTableTest, Enumerate)
+{
+    SmartCidTable Table;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        Table.Insert(Table.New(MSQUIC_CID_MIN_LENGTH));
+    }
+    for (size_t i = 0; i < Table.Entries.size(); i += 3) {
+        Table.Remove(Table.Entries[i]);
+    }
+
+    uint32_t Count = 0;
+    uint32_t Index = 0;
+    QUIC_CID_HASH_ENTRY* Entry;
+    while ((Entry = QuicCidTableEnumerateNext(&Table.Table, &Index)) != NULL) {
+        ASSERT_TRUE(Entry->CID.IsInLookupTable);
+        Count++;
+    }
+    ASSERT_EQ(Table.Table.Count, Count);
+}
+
+//
+// The layout of a CID entry in the generic hash table, as the lookup used it
+// before the CID table.
+//
+struct HashTableCidEntry {
+    QUIC_HASHTABLE_ENTRY Entry;
+    QUIC_CONNECTION* Connection;
+    uint8_t Length;
+    uint8_t Data[MSQUIC_CID_MAX_LENGTH];
+};
+
+static QUIC_CONNECTION* HashTableLookup(
+    QUIC_HASHTABLE* Table,
+    const uint8_t* Cid,
+    uint8_t Length
+    )
+{
+    QUIC_HASHTABLE_LOOKUP_CONTEXT Context;
+    QUIC_HASHTABLE_ENTRY* TableEntry =
+        QuicHashtableLookup(Table, QuicHashSimple(Length, Cid), &Context);
+    while (TableEntry != NULL) {
+        auto Entry = (HashTableCidEntry*)TableEntry;
+        if (Entry->Length == Length && memcmp(Cid, Entry->Data, Length) == 0) {
+            return Entry->Connection;
+        }
+        TableEntry = QuicHashtableLookupNext(Table, &Context);
+    }
+    return NULL;
+}
+
+//
+// Returns the average time, in nanoseconds, of a lookup of each CID in Order.
+//
+template<typename T>
+static uint64_t MeasureLookups(const std::vector<const uint8_t*>& Order, uint8_t Length, T Lookup) {
+    uintptr_t Found = 0;
+    auto Begin = std::chrono::steady_clock::now();
+    for (auto Cid : Order) {
+        Found |= (uintptr_t)Lookup(Cid, Length);
+    }
+    auto End = std::chrono::steady_clock::now();
+    EXPECT_NE(0u, Found);
+    return
+        std::chrono::duration_cast<std::chrono::nanoseconds>(End - Begin).count() /
+        Order.size();
+}
+
+//
+// Compares lookups of random CIDs with QUIC_HASHTABLE and QUIC_CID_TABLE. The
+// lookup used a QUIC_HASHTABLE of QUIC_HASH_MIN_SIZE buckets per partition,
+// which never resizes, so it is measured both that way and with one bucket per
+// CID (its best case).
+//
+TEST(CidTableTest, MicrobenchmarkPerf)
+{
+    const struct {
+        uint32_t Count;
+        uint32_t BucketCount;
+    } Configs[] = {
+        { 1 << 12, QUIC_HASH_MIN_SIZE },
+        { 1 << 12, 1 << 12 },
+        { 1 << 20, 1 << 20 },
+    };
+    const uint32_t LookupCount = 2000000;
+    const uint8_t Length = MSQUIC_CID_MIN_LENGTH + 1;
+
+    for (auto Config : Configs) {
+        SmartCidTable Table;
+        std::vector<HashTableCidEntry> HashEntries(Config.Count);
+        QUIC_HASHTABLE* HashTable = NULL;
+        ASSERT_TRUE(QuicHashtableInitialize(&HashTable, Config.BucketCount));
+
+        for (uint32_t i = 0; i < Config.Count; ++i) {
+            auto Entry = Table.New(Length);
+            Table.Insert(Entry);
+            HashEntries[i].Connection = Entry->Connection;
+            HashEntries[i].Length = Length;
+            memcpy(HashEntries[i].Data, Entry->CID.Data, Length);
+            QuicHashtableInsert(
+                HashTable, &HashEntries[i].Entry, Hash(Entry), NULL);
+        }
+
+        //
+        // Copies of the CIDs to look up, so both tables read their input the
+        // same way.
+        //
+        std::vector<uint8_t> Cids(Config.Count * Length);
+        for (uint32_t i = 0; i < Config.Count; ++i) {
+            memcpy(&Cids[i * Length], HashEntries[i].Data, Length);
+        }
+        std::vector<const uint8_t*> Order(LookupCount);
+        for (auto& Cid : Order) {
+            Cid = &Cids[(Table.Rng() % Config.Count) * Length];
+        }
+
+        uint64_t HashTableNs =
+            MeasureLookups(Order, Length, [&](const uint8_t* Cid, uint8_t Len) {
+                return HashTableLookup(HashTable, Cid, Len);
+            });
+        uint64_t CidTableNs =
+            MeasureLookups(Order, Length, [&](const uint8_t* Cid, uint8_t Len) {
+                return Table.Lookup(Cid, Len);
+            });
+
+        std::cout << Config.Count << " CIDs: QUIC_HASHTABLE (" << Config.BucketCount
+            << " buckets) " << HashTableNs << " ns/op, QUIC_CID_TABLE "
+            << CidTableNs << " ns/op" << std::endl;
+
+        for (auto& Entry : HashEntries) {
+            QuicHashtableRemove(HashTable, &Entry.Entry, NULL);
+        }
+        QuicHashtableUninitialize(HashTable);
+    }
+}
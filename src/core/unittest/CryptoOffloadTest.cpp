@@ -0,0 +1,289 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the crypto offload pool.
+
+--*/
+
+#include "main.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+extern "C" QUIC_THREAD_CALLBACK(QuicCryptoOffloadThread, Context);
+
+#define PACKET_LENGTH 1200
+#define PN_OFFSET 9 // 1 byte flags + 8 byte CID
+
+struct SmartPacketKey {
+    QUIC_PACKET_KEY Key;
+    SmartPacketKey() {
+        uint8_t RawKey[16];
+        QuicRandom(sizeof(RawKey), RawKey);
+        QuicZeroMemory(&Key, sizeof(Key));
+        QuicRandom(sizeof(Key.Iv), Key.Iv);
+        EXPECT_FALSE(QUIC_FAILED(QuicKeyCreate(QUIC_AEAD_AES_128_GCM, RawKey, &Key.PacketKey)));
+        EXPECT_FALSE(QUIC_FAILED(QuicHpKeyCreate(QUIC_AEAD_AES_128_GCM, RawKey, &Key.HeaderKey)));
+    }
+    ~SmartPacketKey() {
+        QuicKeyFree(Key.PacketKey);
+        QuicHpKeyFree(Key.HeaderKey);
+    }
+};
+
+//
+// A batch of random packets, along with a copy to protect separately. Each
+// batch has its own key, as a key may only be used by one thread at a time.
+//
+struct TestBatch {
+    SmartPacketKey Key;
+    std::vector<uint8_t> Packets;
+    std::vector<uint8_t> Expected;
+    QUIC_CRYPTO_BATCH Batch;
+    QUIC_CRYPTO_BATCH ExpectedBatch;
+    TestBatch(uint64_t PacketNumber, uint8_t Count, std::mt19937& Rng) :
+        Packets(Count * PACKET_LENGTH), Expected(Count * PACKET_LENGTH) {
+        for (auto& Byte : Packets) {
+            Byte = (uint8_t)Rng();
+        }
+        Expected = Packets;
+        QuicZeroMemory(&Batch, sizeof(Batch));
+        Batch.Key = &Key.Key;
+        Batch.PacketNumber = PacketNumber;
+        Batch.Count = Count;
+        Batch.PacketNumberOffset = PN_OFFSET;
+        Batch.PacketNumberLength = 4;
+        Batch.HeaderProtectionEnabled = TRUE;
+        ExpectedBatch = Batch;
+        for (uint8_t i = 0; i < Count; ++i) {
+            Batch.Headers[i] = Packets.data() + i * PACKET_LENGTH;
+            ExpectedBatch.Headers[i] = Expected.data() + i * PACKET_LENGTH;
+            Batch.PayloadLengths[i] = ExpectedBatch.PayloadLengths[i] =
+                PACKET_LENGTH - PN_OFFSET - 4;
+        }
+        EXPECT_FALSE(QUIC_FAILED(QuicCryptoBatchProtect(&ExpectedBatch)));
+    }
+    //
+    // The packets match the separately protected copy once the pool protected
+    // them. Protection always writes the AEAD tag over the random payload, so
+    // this holds for any provider.
+    //
+    bool Matches() const { return Packets == Expected; }
+};
+
+struct SmartOffloadPool {
+    QUIC_CRYPTO_OFFLOAD_POOL* Pool {nullptr};
+    uint8_t StoppedThreadCount {0};
+    SmartOffloadPool(uint8_t ThreadCount) {
+        EXPECT_FALSE(QUIC_FAILED(QuicCryptoOffloadPoolInitialize(ThreadCount, &Pool)));
+    }
+    ~SmartOffloadPool() {
+        if (Pool) {
+            QuicCryptoOffloadPoolUninitialize(Pool);
+        }
+    }
+    uint64_t Offloaded() {
+        QuicDispatchLockAcquire(&Pool->Lock);
+        uint64_t Count = Pool->OffloadedJobCount;
+        QuicDispatchLockRelease(&Pool->Lock);
+        return Count;
+    }
+    uint64_t Inline() {
+        QuicDispatchLockAcquire(&Pool->Lock);
+        uint64_t Count = Pool->InlineJobCount;
+        QuicDispatchLockRelease(&Pool->Lock);
+        return Count;
+    }
+    bool IsQueued(QUIC_CRYPTO_OFFLOAD_JOB* Job) {
+        QuicDispatchLockAcquire(&Pool->Lock);
+        bool Queued = Job->Queued;
+        QuicDispatchLockRelease(&Pool->Lock);
+        return Queued;
+    }
+    //
+    // Stops the threads after their current job, so jobs queued until
+    // StartThreads stay queued. The pool is left with no threads to clean up.
+    //
+    void StopThreads() {
+        QuicDispatchLockAcquire(&Pool->Lock);
+        Pool->Enabled = FALSE;
+        QuicDispatchLockRelease(&Pool->Lock);
+        QuicEventSet(Pool->Ready);
+        for (uint8_t i = 0; i < Pool->ThreadCount; ++i) {
+            QuicThreadWait(&Pool->Threads[i]);
+            QuicThreadDelete(&Pool->Threads[i]);
+        }
+        StoppedThreadCount = Pool->ThreadCount;
+        Pool->ThreadCount = 0;
+    }
+    void StartThreads() {
+        Pool->Enabled = TRUE;
+        for (; Pool->ThreadCount < StoppedThreadCount; ++Pool->ThreadCount) {
+            QUIC_THREAD_CONFIG ThreadConfig = {
+                0,
+                0,
+                "quic_crypto",
+                QuicCryptoOffloadThread,
+                Pool
+            };
+            ASSERT_FALSE(
+                QUIC_FAILED(QuicThreadCreate(&ThreadConfig, &Pool->Threads[Pool->ThreadCount])));
+        }
+    }
+};
+
+TEST(CryptoOffloadTest, MatchesInline)
+{
+    std::mt19937 Rng(42);
+    SmartOffloadPool Pool(4);
+
+    std::vector<std::unique_ptr<TestBatch>> Batches;
+    std::vector<QUIC_CRYPTO_OFFLOAD_JOB*> Jobs;
+    for (uint8_t i = 0; i < 16; ++i) {
+        Batches.emplace_back(
+            new TestBatch(i * QUIC_MAX_CRYPTO_BATCH_COUNT, QUIC_MAX_CRYPTO_BATCH_COUNT, Rng));
+        Jobs.push_back(QuicCryptoOffloadQueue(Pool.Pool, &Batches.back()->Batch));
+        ASSERT_NE(nullptr, Jobs.back());
+    }
+
+    for (size_t i = 0; i < Batches.size(); ++i) {
+        TEST_QUIC_SUCCEEDED(QuicCryptoOffloadComplete(Pool.Pool, Jobs[i]));
+        ASSERT_TRUE(Batches[i]->Matches());
+    }
+    ASSERT_EQ(Batches.size(), Pool.Offloaded() + Pool.Inline());
+}
+
+TEST(CryptoOffloadTest, QueueDepthBounded)
+{
+    std::mt19937 Rng(42);
+    SmartOffloadPool Pool(1);
+
+    std::vector<std::unique_ptr<TestBatch>> Batches;
+    for (uint32_t i = 0; i <= QUIC_MAX_CRYPTO_OFFLOAD_JOB_COUNT; ++i) {
+        Batches.emplace_back(new TestBatch(0, 1, Rng));
+    }
+
+    //
+    // Jobs stay in use until they are completed, so the pool must refuse more
+    // than its fixed number of them.
+    //
+    std::vector<QUIC_CRYPTO_OFFLOAD_JOB*> Jobs;
+    for (uint32_t i = 0; i < QUIC_MAX_CRYPTO_OFFLOAD_JOB_COUNT; ++i) {
+        Jobs.push_back(QuicCryptoOffloadQueue(Pool.Pool, &Batches[i]->Batch));
+        ASSERT_NE(nullptr, Jobs.back());
+    }
+    TestBatch* Extra = Batches.back().get();
+    ASSERT_EQ(nullptr, QuicCryptoOffloadQueue(Pool.Pool, &Extra->Batch));
+
+    for (uint32_t i = 0; i < QUIC_MAX_CRYPTO_OFFLOAD_JOB_COUNT; ++i) {
+        TEST_QUIC_SUCCEEDED(QuicCryptoOffloadComplete(Pool.Pool, Jobs[i]));
+        ASSERT_TRUE(Batches[i]->Matches());
+    }
+    auto Job = QuicCryptoOffloadQueue(Pool.Pool, &Extra->Batch);
+    ASSERT_NE(nullptr, Job);
+    TEST_QUIC_SUCCEEDED(QuicCryptoOffloadComplete(Pool.Pool, Job));
+    ASSERT_TRUE(Extra->Matches());
+    ASSERT_EQ(Batches.size(), Pool.Offloaded() + Pool.Inline());
+}
+
+TEST(CryptoOffloadTest, ExactlyOnce)
+{
+    //
+    // Whether a thread picks a job up or it's taken back, it is protected
+    // exactly once. Completing in reverse order makes take backs likely.
+    //
+    std::mt19937 Rng(42);
+    SmartOffloadPool Pool(4);
+    uint64_t Total = 0;
+
+    for (uint32_t Iteration = 0; Iteration < 10; ++Iteration) {
+        std::vector<std::unique_ptr<TestBatch>> Batches;
+        std::vector<QUIC_CRYPTO_OFFLOAD_JOB*> Jobs;
+        for (uint32_t i = 0; i < QUIC_MAX_CRYPTO_OFFLOAD_JOB_COUNT; ++i) {
+            Batches.emplace_back(new TestBatch(i, 1, Rng));
+            Jobs.push_back(QuicCryptoOffloadQueue(Pool.Pool, &Batches.back()->Batch));
+            ASSERT_NE(nullptr, Jobs.back());
+        }
+        for (size_t i = Jobs.size(); i > 0; --i) {
+            TEST_QUIC_SUCCEEDED(QuicCryptoOffloadComplete(Pool.Pool, Jobs[i - 1]));
+            ASSERT_TRUE(Batches[i - 1]->Matches());
+        }
+        Total += Jobs.size();
+        ASSERT_EQ(Total, Pool.Offloaded() + Pool.Inline());
+    }
+}
+
+TEST(CryptoOffloadTest, TakeBackInline)
+{
+    std::mt19937 Rng(42);
+    SmartOffloadPool Pool(1);
+    Pool.StopThreads();
+
+    std::vector<std::unique_ptr<TestBatch>> Batches;
+    std::vector<QUIC_CRYPTO_OFFLOAD_JOB*> Jobs;
+    for (uint8_t i = 0; i < 4; ++i) {
+        Batches.emplace_back(new TestBatch(i, 1, Rng));
+        Jobs.push_back(QuicCryptoOffloadQueue(Pool.Pool, &Batches.back()->Batch));
+        ASSERT_NE(nullptr, Jobs.back());
+    }
+
+    //
+    // No thread will get to the jobs, so completing them protects them inline
+    // rather than waiting forever.
+    //
+    for (size_t i = 0; i < Jobs.size(); ++i) {
+        ASSERT_TRUE(Pool.IsQueued(Jobs[i]));
+        ASSERT_FALSE(Batches[i]->Matches());
+        TEST_QUIC_SUCCEEDED(QuicCryptoOffloadComplete(Pool.Pool, Jobs[i]));
+        ASSERT_TRUE(Batches[i]->Matches());
+        ASSERT_EQ(i + 1, Pool.Inline());
+    }
+    ASSERT_EQ(0u, Pool.Offloaded());
+}
+
+TEST(CryptoOffloadTest, InOrder)
+{
+    //
+    // A single thread picks jobs up in the order they were queued, so at any
+    // time the jobs it has taken are a prefix of the queue. The thread is
+    // stopped while queueing, so it finds the whole queue at once, and the
+    // queue is checked between yields, so the thread gets to run in between.
+    //
+    std::mt19937 Rng(42);
+    SmartOffloadPool Pool(1);
+    Pool.StopThreads();
+
+    std::vector<std::unique_ptr<TestBatch>> Batches;
+    std::vector<QUIC_CRYPTO_OFFLOAD_JOB*> Jobs;
+    for (uint8_t i = 0; i < 32; ++i) {
+        Batches.emplace_back(new TestBatch(i * QUIC_MAX_CRYPTO_BATCH_COUNT, QUIC_MAX_CRYPTO_BATCH_COUNT, Rng));
+        Jobs.push_back(QuicCryptoOffloadQueue(Pool.Pool, &Batches.back()->Batch));
+        ASSERT_NE(nullptr, Jobs.back());
+    }
+    Pool.StartThreads();
+
+    size_t Taken;
+    do {
+        QuicDispatchLockAcquire(&Pool.Pool->Lock);
+        for (Taken = 0; Taken < Jobs.size() && !Jobs[Taken]->Queued; ++Taken) {
+        }
+        size_t StillQueued = 0;
+        for (size_t i = Taken; i < Jobs.size(); ++i) {
+            StillQueued += Jobs[i]->Queued ? 1 : 0;
+        }
+        QuicDispatchLockRelease(&Pool.Pool->Lock);
+        ASSERT_EQ(Jobs.size() - Taken, StillQueued);
+        QuicSleep(0);
+    } while (Taken < Jobs.size());
+
+    for (size_t i = 0; i < Jobs.size(); ++i) {
+        TEST_QUIC_SUCCEEDED(QuicCryptoOffloadComplete(Pool.Pool, Jobs[i]));
+        ASSERT_TRUE(Batches[i]->Matches());
+    }
+    ASSERT_EQ(Jobs.size(), Pool.Offloaded());
+    ASSERT_EQ(0u, Pool.Inline());
+}
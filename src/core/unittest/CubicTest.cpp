@@ -0,0 +1,331 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the CUBIC slow start, including HyStart++ (RFC9406), driven
+    with synthetic ACK and loss events.
+
+--*/
+
+#include "main.h"
+
+#define TEST_MTU 1280
+#define TEST_INITIAL_WINDOW (10 * TEST_MTU)
+
+//
+// Matches QUIC_HYSTART_N_RTT_SAMPLE: the RTT is only compared once a round
+// has this many samples.
+//
+#define TEST_RTT_SAMPLES 8
+
+//
+// The connection is accessed through a view past the QUIC_HANDLE member C++
+// doesn't see (see PacingTest.cpp).
+//
+struct CubicController {
+    QUIC_CONNECTION* Connection;
+    QUIC_CONNECTION* View;
+    QUIC_CONGESTION_CONTROL* Cc;
+    QUIC_CONGESTION_CONTROL_CUBIC* Cubic;
+    uint64_t NextPacketNumber;
+    CubicController() : NextPacketNumber(1) {
+        Connection =
+            (QUIC_CONNECTION*)calloc(1, sizeof(QUIC_HANDLE) + sizeof(QUIC_CONNECTION));
+        View = (QUIC_CONNECTION*)((uint8_t*)Connection + sizeof(QUIC_HANDLE));
+        View->Paths[0].Mtu = TEST_MTU;
+        View->Paths[0].SmoothedRtt = MS_TO_US(50);
+        View->Paths[0].GotFirstRttSample = TRUE;
+        Cc = &View->CongestionControl;
+        Cubic = &Cc->Cubic;
+
+        QUIC_SETTINGS Settings;
+        QuicZeroMemory(&Settings, sizeof(Settings));
+        Settings.CongestionControlAlgorithm = QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC;
+        Settings.InitialWindowPackets = 10;
+        Settings.SendIdleTimeoutMs = 1000;
+        QuicCongestionControlInitialize(Cc, &Settings);
+
+        //
+        // Keep the window from being limited by what was actually sent.
+        //
+        Cc->BytesInFlightMax = 0x40000000;
+    }
+    ~CubicController() {
+        free(Connection);
+    }
+    void Send(uint32_t Packets) {
+        View->LossDetection.LargestSentPacketNumber += Packets;
+    }
+    //
+    // Acknowledges the oldest unacknowledged packet and returns how much the
+    // window grew.
+    //
+    uint32_t Ack(uint32_t Rtt, uint32_t Bytes = TEST_MTU) {
+        uint32_t Window = Cc->CongestionWindow;
+
+        QUIC_ACK_EVENT AckEvent;
+        QuicZeroMemory(&AckEvent, sizeof(AckEvent));
+        AckEvent.TimeNow = (uint32_t)QuicTimeUs32();
+        AckEvent.LargestPacketNumberAcked = NextPacketNumber++;
+        AckEvent.NumRetransmittableBytes = Bytes;
+        AckEvent.SmoothedRtt = View->Paths[0].SmoothedRtt;
+        AckEvent.MinRttValid = TRUE;
+        AckEvent.MinRtt = Rtt;
+        AckEvent.LatestRttSampleValid = TRUE;
+        AckEvent.LatestRttSample = Rtt;
+
+        Cc->BytesInFlight = Bytes;
+        QuicCongestionControlOnDataAcknowledged(Cc, &AckEvent);
+        return Cc->CongestionWindow - Window;
+    }
+    //
+    // Sends and acknowledges one round trip's worth of samples.
+    //
+    void Round(uint32_t Rtt) {
+        Send(TEST_RTT_SAMPLES);
+        for (uint32_t i = 0; i < TEST_RTT_SAMPLES; ++i) {
+            Ack(Rtt);
+        }
+    }
+    //
+    // Sends a packet and declares it lost.
+    //
+    void Lose(BOOLEAN PersistentCongestion) {
+        Send(1);
+        Cc->BytesInFlight = TEST_MTU;
+        QuicCongestionControlOnDataLost(
+            Cc,
+            NextPacketNumber++,
+            View->LossDetection.LargestSentPacketNumber,
+            TEST_MTU,
+            PersistentCongestion);
+    }
+    uint8_t State() const {
+        return Cubic->HyStartState;
+    }
+};
+
+TEST(CubicTest, HyStartCssEntry)
+{
+    CubicController Cc;
+    Cc.Round(MS_TO_US(50));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_SLOW_START, Cc.State());
+
+    //
+    // The RTT is only compared once the round has enough samples.
+    //
+    Cc.Send(TEST_RTT_SAMPLES);
+    for (uint32_t i = 0; i < TEST_RTT_SAMPLES - 1; ++i) {
+        Cc.Ack(MS_TO_US(60));
+        ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_SLOW_START, Cc.State());
+    }
+    Cc.Ack(MS_TO_US(60));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE, Cc.State());
+    ASSERT_EQ((uint32_t)MS_TO_US(60), Cc.Cubic->CssBaselineMinRtt);
+    ASSERT_EQ(UINT32_MAX, Cc.Cc->SlowStartThreshold);
+}
+
+TEST(CubicTest, HyStartRttThreshold)
+{
+    //
+    // CSS is entered once the min RTT grows by an eighth, clamped to between
+    // 4 and 16 ms.
+    //
+    struct {
+        uint32_t LastRtt;
+        uint32_t CurrentRtt;
+        bool Conservative;
+    } Cases[] = {
+        { MS_TO_US(10),  MS_TO_US(14) - 1,  false },
+        { MS_TO_US(10),  MS_TO_US(14),      true },
+        { MS_TO_US(50),  56249,             false },
+        { MS_TO_US(50),  56250,             true },
+        { MS_TO_US(200), MS_TO_US(216) - 1, false },
+        { MS_TO_US(200), MS_TO_US(216),     true },
+    };
+    for (auto& Case : Cases) {
+        CubicController Cc;
+        Cc.Round(Case.LastRtt);
+        Cc.Round(Case.CurrentRtt);
+        uint8_t Expected =
+            Case.Conservative ?
+                QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE :
+                QUIC_CUBIC_HYSTART_STATE_SLOW_START;
+        ASSERT_EQ(Expected, Cc.State()) << Case.LastRtt << " -> " << Case.CurrentRtt;
+    }
+}
+
+TEST(CubicTest, HyStartResume)
+{
+    CubicController Cc;
+    Cc.Round(MS_TO_US(50));
+    Cc.Round(MS_TO_US(60));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE, Cc.State());
+
+    //
+    // A round whose min RTT drops below the CSS baseline means the increase
+    // was spurious, so slow start resumes at full growth.
+    //
+    Cc.Round(MS_TO_US(55));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_SLOW_START, Cc.State());
+    ASSERT_EQ(UINT32_MAX, Cc.Cc->SlowStartThreshold);
+    Cc.Send(1);
+    ASSERT_EQ((uint32_t)TEST_MTU, Cc.Ack(MS_TO_US(55)));
+    ASSERT_EQ(0u, Cc.View->Stats.Send.SlowStartExitRttIncreaseCount);
+}
+
+TEST(CubicTest, HyStartExit)
+{
+    CubicController Cc;
+    Cc.Round(MS_TO_US(50));
+    Cc.Round(MS_TO_US(60));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE, Cc.State());
+
+    for (uint32_t i = 1; i <= 4; ++i) {
+        Cc.Round(MS_TO_US(60));
+        ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE, Cc.State());
+        ASSERT_EQ(i, (uint32_t)Cc.Cubic->ConservativeSlowStartRounds);
+    }
+
+    //
+    // The start of the fifth CSS round ends slow start at the current window.
+    //
+    uint32_t Window = Cc.Cc->CongestionWindow;
+    Cc.Send(1);
+    ASSERT_EQ(0u, Cc.Ack(MS_TO_US(60)));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_DONE, Cc.State());
+    ASSERT_EQ(Window, Cc.Cc->SlowStartThreshold);
+    ASSERT_EQ(Window, Cc.Cubic->WindowMax);
+    ASSERT_EQ(1u, Cc.View->Stats.Send.SlowStartExitRttIncreaseCount);
+    ASSERT_EQ(0u, Cc.View->Stats.Send.SlowStartExitCongestionCount);
+    ASSERT_EQ(0u, Cc.View->Stats.Send.SlowStartExitThresholdCount);
+    ASSERT_EQ(0u, Cc.View->Stats.Send.CongestionCount);
+
+    //
+    // Congestion avoidance grows much slower.
+    //
+    Cc.Send(1);
+    ASSERT_LT(Cc.Ack(MS_TO_US(60)), (uint32_t)TEST_MTU / 4);
+}
+
+TEST(CubicTest, HyStartCssGrowth)
+{
+    CubicController Cc;
+    Cc.Send(1);
+    ASSERT_EQ((uint32_t)TEST_MTU, Cc.Ack(MS_TO_US(50)));
+    Cc.Round(MS_TO_US(50));
+    Cc.Round(MS_TO_US(60));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE, Cc.State());
+
+    //
+    // CSS grows the window at a quarter of the slow start rate.
+    //
+    Cc.Send(1);
+    ASSERT_EQ((uint32_t)TEST_MTU / 4, Cc.Ack(MS_TO_US(60)));
+}
+
+TEST(CubicTest, HyStartAckLimit)
+{
+    //
+    // Without pacing, a single ACK grows the window by at most 8 packets.
+    //
+    CubicController Cc;
+    Cc.Send(1);
+    ASSERT_EQ(8u * TEST_MTU, Cc.Ack(MS_TO_US(50), 20 * TEST_MTU));
+    Cc.Send(1);
+    ASSERT_EQ(5u * TEST_MTU, Cc.Ack(MS_TO_US(50), 5 * TEST_MTU));
+
+    //
+    // In CSS the limit applies before the growth divisor.
+    //
+    Cc.Round(MS_TO_US(50));
+    Cc.Round(MS_TO_US(60));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE, Cc.State());
+    Cc.Send(1);
+    ASSERT_EQ(2u * TEST_MTU, Cc.Ack(MS_TO_US(60), 20 * TEST_MTU));
+
+    //
+    // Paced sends don't burst, so they aren't limited.
+    //
+    CubicController Paced;
+    Paced.View->State.UsePacing = TRUE;
+    Paced.Send(1);
+    ASSERT_EQ(20u * TEST_MTU, Paced.Ack(MS_TO_US(50), 20 * TEST_MTU));
+}
+
+TEST(CubicTest, SlowStartExitCongestion)
+{
+    //
+    // Loss in slow start, even in CSS, ends it and HyStart++ for good.
+    //
+    CubicController Cc;
+    Cc.Round(MS_TO_US(50));
+    Cc.Round(MS_TO_US(60));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE, Cc.State());
+    Cc.Lose(FALSE);
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_DONE, Cc.State());
+    ASSERT_EQ(1u, Cc.View->Stats.Send.CongestionCount);
+    ASSERT_EQ(1u, Cc.View->Stats.Send.SlowStartExitCongestionCount);
+    ASSERT_EQ(0u, Cc.View->Stats.Send.SlowStartExitRttIncreaseCount);
+
+    //
+    // Later congestion in congestion avoidance isn't a slow start exit.
+    //
+    Cc.Send(1);
+    Cc.Ack(MS_TO_US(50));
+    ASSERT_FALSE(Cc.Cubic->IsInRecovery);
+    Cc.Lose(FALSE);
+    ASSERT_EQ(2u, Cc.View->Stats.Send.CongestionCount);
+    ASSERT_EQ(1u, Cc.View->Stats.Send.SlowStartExitCongestionCount);
+}
+
+TEST(CubicTest, SlowStartExitThreshold)
+{
+    //
+    // After persistent congestion, slow start runs up to the threshold set by
+    // the loss, without HyStart++.
+    //
+    CubicController Cc;
+    Cc.Lose(TRUE);
+    ASSERT_EQ(2u * TEST_MTU, Cc.Cc->CongestionWindow);
+    ASSERT_EQ((uint32_t)TEST_INITIAL_WINDOW * 7 / 10, Cc.Cc->SlowStartThreshold);
+    Cc.Send(1);
+    Cc.Ack(MS_TO_US(50));
+    ASSERT_FALSE(Cc.Cubic->IsInRecovery);
+
+    Cc.Send(TEST_RTT_SAMPLES);
+    for (uint32_t i = 0; i < 5; ++i) {
+        ASSERT_EQ(0u, Cc.View->Stats.Send.SlowStartExitThresholdCount);
+        ASSERT_EQ((uint32_t)TEST_MTU, Cc.Ack(MS_TO_US(200), TEST_MTU));
+    }
+    ASSERT_GE(Cc.Cc->CongestionWindow, Cc.Cc->SlowStartThreshold);
+    ASSERT_EQ(1u, Cc.View->Stats.Send.SlowStartExitThresholdCount);
+    ASSERT_EQ(0u, Cc.View->Stats.Send.SlowStartExitRttIncreaseCount);
+}
+
+TEST(CubicTest, ResetHyStart)
+{
+    CubicController Cc;
+    Cc.Round(MS_TO_US(50));
+    Cc.Round(MS_TO_US(60));
+    Cc.Lose(FALSE);
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_DONE, Cc.State());
+
+    QuicCongestionControlReset(Cc.Cc);
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_SLOW_START, Cc.State());
+    ASSERT_EQ(UINT32_MAX, Cc.Cc->SlowStartThreshold);
+    ASSERT_EQ((uint32_t)TEST_INITIAL_WINDOW, Cc.Cc->CongestionWindow);
+    ASSERT_EQ(UINT32_MAX, Cc.Cubic->MinRttInLastRound);
+    ASSERT_EQ(UINT32_MAX, Cc.Cubic->CssBaselineMinRtt);
+
+    //
+    // And HyStart++ runs again.
+    //
+    Cc.Cc->BytesInFlightMax = 0x40000000;
+    Cc.Round(MS_TO_US(50));
+    Cc.Round(MS_TO_US(60));
+    ASSERT_EQ((uint8_t)QUIC_CUBIC_HYSTART_STATE_CONSERVATIVE, Cc.State());
+}
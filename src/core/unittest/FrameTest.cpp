@@ -1226,3 +1226,41 @@ TEST_P(ConnectionCloseFrameDecodeTest, DecodeConnectionCloseFrameFail) {
 }
 
 INSTANTIATE_TEST_SUITE_P(FrameTest, ConnectionCloseFrameDecodeTest, ::testing::ValuesIn(ConnectionCloseFrameParams::GenerateDecodeFailParams()));
+
+TEST(FrameTest, DatagramFrameEncodeDecode)
+{
+    uint8_t Data[5] = { 1, 2, 3, 4, 5 };
+    QUIC_BUFFER Buffers[2] = {
+        { 2, Data },
+        { 3, Data + 2 }
+    };
+    QUIC_DATAGRAM_EX DecodedFrame;
+    uint8_t Buffer[7];
+    uint16_t Offset = 0;
+
+    ASSERT_TRUE(QuicDatagramFrameEncodeEx(Buffers, 2, sizeof(Data), &Offset, sizeof(Buffer), Buffer));
+    ASSERT_EQ(sizeof(Buffer), Offset);
+    ASSERT_EQ(QUIC_FRAME_DATAGRAM_1, Buffer[0]);
+    Offset = 1;
+    ASSERT_TRUE(QuicDatagramFrameDecode(QUIC_FRAME_DATAGRAM_1, sizeof(Buffer), Buffer, &Offset, &DecodedFrame));
+    ASSERT_EQ(sizeof(Buffer), Offset);
+    ASSERT_EQ(sizeof(Data), DecodedFrame.Length);
+    ASSERT_EQ(memcmp(Data, DecodedFrame.Data, sizeof(Data)), 0);
+
+    //
+    // Without an explicit length, the frame runs to the end of the packet.
+    //
+    Offset = 2;
+    ASSERT_TRUE(QuicDatagramFrameDecode(QUIC_FRAME_DATAGRAM, sizeof(Buffer), Buffer, &Offset, &DecodedFrame));
+    ASSERT_EQ(sizeof(Buffer), Offset);
+    ASSERT_EQ(sizeof(Data), DecodedFrame.Length);
+    ASSERT_EQ(memcmp(Data, DecodedFrame.Data, sizeof(Data)), 0);
+
+    //
+    // Not enough room to encode, or a length past the end of the packet.
+    //
+    Offset = 0;
+    ASSERT_FALSE(QuicDatagramFrameEncodeEx(Buffers, 2, sizeof(Data), &Offset, sizeof(Buffer) - 1, Buffer));
+    Offset = 1;
+    ASSERT_FALSE(QuicDatagramFrameDecode(QUIC_FRAME_DATAGRAM_1, sizeof(Buffer) - 1, Buffer, &Offset, &DecodedFrame));
+}
@@ -0,0 +1,153 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the congestion control pacing delay.
+
+--*/
+
+#include "main.h"
+
+#define TEST_MTU 1280
+#define TEST_MIN_CHUNK (QUIC_SEND_PACING_MIN_CHUNK * TEST_MTU)
+
+//
+// QUIC_CONNECTION starts with an anonymous QUIC_HANDLE member, which C++ does
+// not support, so every field offset seen from C++ is short by the size of
+// QUIC_HANDLE. The connection is accessed through this view, at the offsets
+// the C code uses.
+//
+struct SmartCongestionControl {
+    QUIC_CONNECTION* Connection;
+    QUIC_CONNECTION* View;
+    QUIC_CONGESTION_CONTROL* Cc;
+    SmartCongestionControl(uint16_t Algorithm, uint32_t SmoothedRtt) {
+        Connection =
+            (QUIC_CONNECTION*)calloc(1, sizeof(QUIC_HANDLE) + sizeof(QUIC_CONNECTION));
+        View = (QUIC_CONNECTION*)((uint8_t*)Connection + sizeof(QUIC_HANDLE));
+        View->Paths[0].Mtu = TEST_MTU;
+        View->Paths[0].SmoothedRtt = SmoothedRtt;
+        View->Paths[0].GotFirstRttSample = TRUE;
+        Cc = &View->CongestionControl;
+
+        QUIC_SETTINGS Settings;
+        QuicZeroMemory(&Settings, sizeof(Settings));
+        Settings.CongestionControlAlgorithm = Algorithm;
+        Settings.InitialWindowPackets = 10;
+        Settings.SendIdleTimeoutMs = 1000;
+        QuicCongestionControlInitialize(Cc, &Settings);
+    }
+    ~SmartCongestionControl() {
+        free(Connection);
+    }
+    uint64_t Rate() {
+        return Cc->Vtbl->GetPacingRate(Cc);
+    }
+    uint64_t Delay() {
+        return QuicCongestionControlGetPacingDelay(Cc);
+    }
+};
+
+TEST(PacingTest, ZeroRate)
+{
+    SmartCongestionControl Cc(QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC, MS_TO_US(100));
+    Cc.Cc->CongestionWindow = 0;
+    ASSERT_EQ(0u, Cc.Rate());
+    ASSERT_EQ((uint64_t)QUIC_SEND_PACING_INTERVAL, Cc.Delay());
+}
+
+TEST(PacingTest, MinChunk)
+{
+    //
+    // 10 packets over 100 ms, at the slow start gain, is 256 KB/s. A chunk of
+    // the interval's worth would be smaller than the minimum chunk, so the
+    // delay is however long the minimum chunk takes: 20 ms.
+    //
+    SmartCongestionControl Cc(QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC, MS_TO_US(100));
+    ASSERT_EQ(10u * TEST_MTU, Cc.Cc->CongestionWindow);
+    ASSERT_EQ(256000u, Cc.Rate());
+    ASSERT_EQ(20u, Cc.Delay());
+
+    //
+    // In congestion avoidance the gain is lower, so the same window paces at
+    // 160 KB/s and the delay is 32 ms.
+    //
+    Cc.Cc->SlowStartThreshold = Cc.Cc->CongestionWindow;
+    ASSERT_EQ(160000u, Cc.Rate());
+    ASSERT_EQ(32u, Cc.Delay());
+}
+
+TEST(PacingTest, RoundsUp)
+{
+    //
+    // 284444 B/s needs just over 18 ms for the minimum chunk. Firing any
+    // earlier would find the allowance short of a chunk.
+    //
+    SmartCongestionControl Cc(QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC, MS_TO_US(90));
+    ASSERT_EQ(284444u, Cc.Rate());
+    ASSERT_EQ(19u, Cc.Delay());
+}
+
+TEST(PacingTest, Interval)
+{
+    //
+    // Between the minimum and maximum chunk sizes, a chunk is the interval's
+    // worth of data, so the timer fires every interval.
+    //
+    SmartCongestionControl Cc(QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC, MS_TO_US(100));
+    Cc.Cc->CongestionWindow = 1000000;
+    ASSERT_EQ(20000000u, Cc.Rate());
+    ASSERT_EQ((uint64_t)QUIC_SEND_PACING_INTERVAL, Cc.Delay());
+}
+
+TEST(PacingTest, MaxChunk)
+{
+    //
+    // At 2 GB/s the maximum chunk is sent in well under a millisecond, but
+    // the timer can't fire sooner than the interval.
+    //
+    SmartCongestionControl Cc(QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC, MS_TO_US(1));
+    Cc.Cc->CongestionWindow = 1000000;
+    ASSERT_EQ(2000000000u, Cc.Rate());
+    ASSERT_EQ((uint64_t)QUIC_SEND_PACING_INTERVAL, Cc.Delay());
+}
+
+TEST(PacingTest, Sweep)
+{
+    //
+    // For any window and RTT, with either algorithm, the delay is at least the
+    // interval, the rate accrues at least a minimum chunk (or a maximum chunk,
+    // if smaller) over the delay, and the delay isn't longer than needed.
+    //
+    const uint16_t Algorithms[] = {
+        QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC,
+        QUIC_CONGESTION_CONTROL_ALGORITHM_BBR
+    };
+    const uint32_t RttsUs[] = { 100, 1000, 7500, 25000, 100000, 1000000 };
+    const uint32_t Windows[] = { TEST_MTU, 10 * TEST_MTU, 100000, 10000000 };
+    for (auto Algorithm : Algorithms) {
+        for (auto Rtt : RttsUs) {
+            for (auto Window : Windows) {
+                SmartCongestionControl Cc(Algorithm, Rtt);
+                Cc.Cc->CongestionWindow = Window;
+                uint64_t Rate = Cc.Rate();
+                ASSERT_NE(0u, Rate);
+                uint64_t Delay = Cc.Delay();
+                ASSERT_GE(Delay, (uint64_t)QUIC_SEND_PACING_INTERVAL);
+                uint64_t MinAccrued = TEST_MIN_CHUNK;
+                if (MinAccrued > QUIC_SEND_PACING_MAX_CHUNK) {
+                    MinAccrued = QUIC_SEND_PACING_MAX_CHUNK;
+                }
+                if (MinAccrued > Rate * QUIC_SEND_PACING_INTERVAL / S_TO_MS(1)) {
+                    ASSERT_GE(Rate * Delay, MinAccrued * S_TO_MS(1));
+                    ASSERT_LT(Rate * (Delay - 1), MinAccrued * S_TO_MS(1));
+                } else {
+                    ASSERT_EQ((uint64_t)QUIC_SEND_PACING_INTERVAL, Delay);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,405 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the QUIC_SENT_PACKET_RING interface.
+
+--*/
+
+#include "main.h"
+#include <chrono>
+#include <iostream>
+
+//
+// Not declared in a header, since only QuicLossDetectionProcessAckFrame calls
+// it outside of tests.
+//
+extern "C"
+void
+QuicLossDetectionProcessAckBlocks(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _In_ QUIC_PATH* Path,
+    _In_ QUIC_ENCRYPT_LEVEL EncryptLevel,
+    _In_ uint64_t AckDelay,
+    _In_ QUIC_RANGE* AckBlocks,
+    _Out_ BOOLEAN* InvalidAckBlock
+    );
+
+struct SmartSentPacketRing {
+    QUIC_SENT_PACKET_POOL Pool;
+    QUIC_SENT_PACKET_RING Ring;
+    SmartSentPacketRing() {
+        QuicSentPacketPoolInitialize(&Pool);
+        QuicSentPacketRingInitialize(&Ring);
+    }
+    ~SmartSentPacketRing() {
+        while (Ring.Count != 0) {
+            QuicSentPacketRingRemove(
+                &Ring, &Pool, QuicSentPacketRingGetSlot(&Ring, Ring.FirstPacketNumber));
+        }
+        QuicSentPacketRingUninitialize(&Ring);
+        QuicSentPacketPoolUninitialize(&Pool);
+    }
+    QUIC_SENT_PACKET_METADATA* Insert(uint64_t PacketNumber, uint8_t FrameCount = 1) {
+        QUIC_MAX_SENT_PACKET_METADATA Storage;
+        QUIC_SENT_PACKET_METADATA* Metadata = &Storage.Metadata;
+        QuicZeroMemory(&Storage, sizeof(Storage));
+        Metadata->PacketNumber = PacketNumber;
+        Metadata->SentTime = (uint32_t)PacketNumber;
+        Metadata->PacketLength = 1200;
+        Metadata->FrameCount = FrameCount;
+        for (uint8_t i = 0; i < FrameCount; ++i) {
+            Metadata->Frames[i].Type = QUIC_FRAME_PING;
+        }
+        return QuicSentPacketRingInsert(&Ring, &Pool, Metadata);
+    }
+    bool Remove(uint64_t PacketNumber) {
+        QUIC_SENT_PACKET_SLOT* Slot = QuicSentPacketRingGetSlot(&Ring, PacketNumber);
+        if (Slot == NULL || Slot->State == QUIC_SENT_PACKET_STATE_EMPTY) {
+            return false;
+        }
+        QuicSentPacketRingRemove(&Ring, &Pool, Slot);
+        return true;
+    }
+};
+
+TEST(SentPacketRingTest, InsertLookup)
+{
+    SmartSentPacketRing Ring;
+    for (uint64_t i = 0; i < 100; ++i) {
+        uint8_t FrameCount = (uint8_t)(i % QUIC_MAX_FRAMES_PER_PACKET) + 1;
+        auto Packet = Ring.Insert(i, FrameCount);
+        ASSERT_NE(nullptr, Packet);
+        ASSERT_EQ(i, Packet->PacketNumber);
+    }
+    ASSERT_EQ(100u, Ring.Ring.Count);
+    ASSERT_EQ(128u, Ring.Ring.Capacity);
+    for (uint64_t i = 0; i < 100; ++i) {
+        auto Slot = QuicSentPacketRingGetSlot(&Ring.Ring, i);
+        ASSERT_NE(nullptr, Slot);
+        ASSERT_EQ(QUIC_SENT_PACKET_STATE_OUTSTANDING, Slot->State);
+        auto Packet = QuicSentPacketSlotGetMetadata(Slot);
+        ASSERT_EQ(i, Packet->PacketNumber);
+        ASSERT_EQ((uint8_t)(i % QUIC_MAX_FRAMES_PER_PACKET) + 1, Packet->FrameCount);
+        ASSERT_EQ(Packet->FrameCount > QUIC_SENT_PACKET_INLINE_FRAMES, (bool)Slot->IsExternal);
+    }
+    ASSERT_EQ(nullptr, QuicSentPacketRingGetSlot(&Ring.Ring, 100));
+}
+
+TEST(SentPacketRingTest, Gaps)
+{
+    SmartSentPacketRing Ring;
+    ASSERT_NE(nullptr, Ring.Insert(10));
+    ASSERT_NE(nullptr, Ring.Insert(15));
+    ASSERT_EQ(10u, Ring.Ring.FirstPacketNumber);
+    ASSERT_EQ(6u, Ring.Ring.Count);
+    for (uint64_t i = 11; i < 15; ++i) {
+        ASSERT_EQ(
+            QUIC_SENT_PACKET_STATE_EMPTY,
+            QuicSentPacketRingGetSlot(&Ring.Ring, i)->State);
+    }
+    ASSERT_EQ(nullptr, QuicSentPacketRingGetSlot(&Ring.Ring, 9));
+
+    //
+    // Removing the first packet drops the empty slots after it too.
+    //
+    ASSERT_TRUE(Ring.Remove(10));
+    ASSERT_EQ(15u, Ring.Ring.FirstPacketNumber);
+    ASSERT_EQ(1u, Ring.Ring.Count);
+    ASSERT_TRUE(Ring.Remove(15));
+    ASSERT_EQ(0u, Ring.Ring.Count);
+}
+
+TEST(SentPacketRingTest, RemoveOutOfOrder)
+{
+    SmartSentPacketRing Ring;
+    for (uint64_t i = 0; i < 8; ++i) {
+        ASSERT_NE(nullptr, Ring.Insert(i));
+    }
+    ASSERT_TRUE(Ring.Remove(3));
+    ASSERT_TRUE(Ring.Remove(5));
+    ASSERT_FALSE(Ring.Remove(5));
+    ASSERT_EQ(0u, Ring.Ring.FirstPacketNumber);
+    ASSERT_EQ(8u, Ring.Ring.Count);
+    ASSERT_TRUE(Ring.Remove(1));
+    ASSERT_TRUE(Ring.Remove(2));
+    ASSERT_TRUE(Ring.Remove(0));
+    ASSERT_EQ(4u, Ring.Ring.FirstPacketNumber);
+    ASSERT_EQ(4u, Ring.Ring.Count);
+    ASSERT_TRUE(Ring.Remove(4));
+    ASSERT_EQ(6u, Ring.Ring.FirstPacketNumber);
+}
+
+TEST(SentPacketRingTest, WrapAround)
+{
+    SmartSentPacketRing Ring;
+    const uint32_t InFlight = 10;
+    for (uint64_t i = 0; i < InFlight; ++i) {
+        ASSERT_NE(nullptr, Ring.Insert(i, (uint8_t)(i % 4) + 1));
+    }
+    for (uint64_t i = InFlight; i < 1000; ++i) {
+        ASSERT_TRUE(Ring.Remove(i - InFlight));
+        ASSERT_NE(nullptr, Ring.Insert(i, (uint8_t)(i % 4) + 1));
+        ASSERT_EQ(InFlight, Ring.Ring.Count);
+        ASSERT_EQ((uint32_t)QUIC_SENT_PACKET_RING_INITIAL_SIZE, Ring.Ring.Capacity);
+    }
+    for (uint64_t i = 1000 - InFlight; i < 1000; ++i) {
+        auto Slot = QuicSentPacketRingGetSlot(&Ring.Ring, i);
+        ASSERT_NE(nullptr, Slot);
+        ASSERT_EQ(i, QuicSentPacketSlotGetMetadata(Slot)->PacketNumber);
+    }
+}
+
+TEST(SentPacketRingTest, GrowAfterWrap)
+{
+    SmartSentPacketRing Ring;
+    for (uint64_t i = 0; i < 12; ++i) {
+        ASSERT_NE(nullptr, Ring.Insert(i));
+    }
+    for (uint64_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(Ring.Remove(i));
+    }
+    for (uint64_t i = 12; i < 100; ++i) {
+        ASSERT_NE(nullptr, Ring.Insert(i, 3));
+    }
+    ASSERT_EQ(8u, Ring.Ring.FirstPacketNumber);
+    ASSERT_EQ(92u, Ring.Ring.Count);
+    for (uint64_t i = 8; i < 100; ++i) {
+        ASSERT_EQ(
+            i,
+            QuicSentPacketSlotGetMetadata(
+                QuicSentPacketRingGetSlot(&Ring.Ring, i))->PacketNumber);
+    }
+
+    //
+    // The memory from the burst is freed once everything is acknowledged.
+    //
+    for (uint64_t i = 8; i < 100; ++i) {
+        ASSERT_TRUE(Ring.Remove(i));
+    }
+    ASSERT_EQ(0u, Ring.Ring.Count);
+    ASSERT_EQ(0u, Ring.Ring.Capacity);
+}
+
+TEST(SentPacketRingTest, NextSkipsEmptyRuns)
+{
+    //
+    // Remove packets in a scattered order while sending more, so the ring
+    // wraps, and check after each removal that QuicSentPacketRingNext agrees
+    // with a slot by slot scan from every packet number.
+    //
+    SmartSentPacketRing Ring;
+    uint64_t NextPacketNumber = 0;
+    for (; NextPacketNumber < 200; ++NextPacketNumber) {
+        if (NextPacketNumber % 7 != 3) {
+            ASSERT_NE(nullptr, Ring.Insert(NextPacketNumber));
+        }
+    }
+    uint32_t Random = 1;
+    while (Ring.Ring.Count != 0) {
+        Random = Random * 1103515245 + 12345;
+        uint64_t PacketNumber =
+            Ring.Ring.FirstPacketNumber + (Random >> 16) % Ring.Ring.Count;
+        if (!Ring.Remove(PacketNumber)) {
+            continue;
+        }
+        if (NextPacketNumber < 2000) {
+            if (++NextPacketNumber % 7 == 3) {
+                ++NextPacketNumber;
+            }
+            ASSERT_NE(nullptr, Ring.Insert(NextPacketNumber));
+        }
+        uint64_t End = QuicSentPacketRingEnd(&Ring.Ring);
+        uint64_t Expected = End;
+        for (uint64_t i = End; i-- > Ring.Ring.FirstPacketNumber;) {
+            auto Slot = QuicSentPacketRingGetSlot(&Ring.Ring, i);
+            if (Slot->State != QUIC_SENT_PACKET_STATE_EMPTY) {
+                Expected = i;
+            }
+            ASSERT_EQ(Expected, QuicSentPacketRingNext(&Ring.Ring, i));
+        }
+        ASSERT_EQ(Expected, QuicSentPacketRingNext(&Ring.Ring, 0));
+        ASSERT_EQ(End, QuicSentPacketRingNext(&Ring.Ring, End));
+    }
+    ASSERT_LT(1000u, NextPacketNumber);
+}
+
+//
+// A connection with just enough state for loss detection to process ACK
+// blocks: one validated path, CUBIC with a window that never blocks, and a
+// flush already pending so nothing is queued to a worker. The connection is
+// closed locally, so the loss detection timer is only ever canceled. See
+// PacingTest.cpp for why the connection is accessed through View.
+//
+struct SmartLossDetection {
+    QUIC_CONNECTION* Connection;
+    QUIC_CONNECTION* View;
+    QUIC_WORKER* Worker;
+    QUIC_PACKET_SPACE* PacketSpace;
+    QUIC_LOSS_DETECTION* LossDetection;
+    QUIC_RANGE AckBlocks;
+    uint64_t NextPacketNumber {0};
+    SmartLossDetection() {
+        Connection =
+            (QUIC_CONNECTION*)calloc(1, sizeof(QUIC_HANDLE) + sizeof(QUIC_CONNECTION));
+        View = (QUIC_CONNECTION*)((uint8_t*)Connection + sizeof(QUIC_HANDLE));
+        ((QUIC_HANDLE*)Connection)->Type = QUIC_HANDLE_TYPE_CHILD;
+        Worker = (QUIC_WORKER*)calloc(1, sizeof(QUIC_WORKER));
+        QuicSentPacketPoolInitialize(&Worker->SentPacketPool);
+        View->Worker = Worker;
+        PacketSpace = (QUIC_PACKET_SPACE*)calloc(1, sizeof(QUIC_PACKET_SPACE));
+        View->Packets[QUIC_ENCRYPT_LEVEL_1_RTT] = PacketSpace;
+        for (uint32_t i = 0; i < ARRAYSIZE(View->Timers); ++i) {
+            View->Timers[i].Type = (QUIC_CONN_TIMER_TYPE)i;
+            View->Timers[i].ExpirationTime = UINT64_MAX;
+        }
+        View->State.ClosedLocally = TRUE;
+        View->Send.FlushOperationPending = TRUE;
+        View->PathsCount = 1;
+        View->Paths[0].Mtu = 1280;
+        View->Paths[0].IsPeerValidated = TRUE;
+        View->Paths[0].MinRtt = UINT32_MAX;
+        View->PeerTransportParams.MaxAckDelay = QUIC_TP_MAX_ACK_DELAY_DEFAULT;
+
+        QUIC_SETTINGS Settings;
+        QuicZeroMemory(&Settings, sizeof(Settings));
+        Settings.CongestionControlAlgorithm = QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC;
+        Settings.InitialWindowPackets = 10;
+        Settings.SendIdleTimeoutMs = 1000;
+        QuicCongestionControlInitialize(&View->CongestionControl, &Settings);
+        View->CongestionControl.CongestionWindow = 0x40000000;
+
+        LossDetection = &View->LossDetection;
+        QuicLossDetectionInitialize(LossDetection);
+        QuicRangeInitialize(QUIC_MAX_RANGE_DECODE_ACKS, &AckBlocks);
+    }
+    ~SmartLossDetection() {
+        QuicRangeUninitialize(&AckBlocks);
+        QuicLossDetectionUninitialize(LossDetection);
+        QuicSentPacketPoolUninitialize(&Worker->SentPacketPool);
+        free(PacketSpace);
+        free(Worker);
+        free(Connection);
+    }
+    bool Send(uint32_t Count) {
+        for (uint32_t i = 0; i < Count; ++i) {
+            QUIC_MAX_SENT_PACKET_METADATA Storage;
+            QUIC_SENT_PACKET_METADATA* Metadata = &Storage.Metadata;
+            QuicZeroMemory(&Storage, sizeof(Storage));
+            Metadata->PacketNumber = NextPacketNumber++;
+            Metadata->SentTime = QuicTimeUs32();
+            Metadata->PacketLength = 1200;
+            Metadata->Flags.KeyType = QUIC_PACKET_KEY_1_RTT;
+            Metadata->Flags.IsRetransmittable = TRUE;
+            Metadata->FrameCount = 1;
+            Metadata->Frames[0].Type = QUIC_FRAME_PING;
+            if (QUIC_FAILED(
+                    QuicLossDetectionOnPacketSent(
+                        LossDetection, &View->Paths[0], Metadata))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool Ack(uint64_t Low, uint64_t High) {
+        BOOLEAN RangeUpdated, InvalidAckBlock;
+        QuicRangeReset(&AckBlocks);
+        QuicRangeAddRange(&AckBlocks, Low, High - Low + 1, &RangeUpdated);
+        QuicLossDetectionProcessAckBlocks(
+            LossDetection,
+            &View->Paths[0],
+            QUIC_ENCRYPT_LEVEL_1_RTT,
+            0,
+            &AckBlocks,
+            &InvalidAckBlock);
+        return !InvalidAckBlock;
+    }
+};
+
+TEST(SentPacketRingTest, AckAroundLostPacket)
+{
+    SmartLossDetection Conn;
+    ASSERT_TRUE(Conn.Send(32));
+
+    //
+    // Acknowledging the packets after the first marks it lost, but it stays
+    // at the front of the ring in case it's acknowledged late.
+    //
+    ASSERT_TRUE(Conn.Ack(1, 4));
+    ASSERT_EQ(1u, Conn.LossDetection->LostPacketCount);
+    ASSERT_EQ(27u, Conn.LossDetection->OutstandingPacketCount);
+    ASSERT_EQ(0u, Conn.LossDetection->SentPackets.FirstPacketNumber);
+    ASSERT_EQ(32u, Conn.LossDetection->SentPackets.Count);
+
+    //
+    // Every ACK repeats the acknowledged packets before the new ones.
+    //
+    for (uint64_t High = 8; High < 32; High += 4) {
+        ASSERT_TRUE(Conn.Ack(1, High));
+        ASSERT_EQ(31u - High, Conn.LossDetection->OutstandingPacketCount);
+        ASSERT_EQ(32u, Conn.LossDetection->SentPackets.Count);
+    }
+    ASSERT_TRUE(Conn.Ack(1, 31));
+    ASSERT_EQ(0u, Conn.LossDetection->OutstandingPacketCount);
+    ASSERT_EQ(1u, Conn.LossDetection->LostPacketCount);
+    ASSERT_EQ(0u, Conn.View->Stats.Send.SpuriousLostPackets);
+
+    //
+    // The late ACK for the lost packet empties the ring.
+    //
+    ASSERT_TRUE(Conn.Ack(0, 31));
+    ASSERT_EQ(0u, Conn.LossDetection->LostPacketCount);
+    ASSERT_EQ(1u, Conn.View->Stats.Send.SpuriousLostPackets);
+    ASSERT_EQ(0u, Conn.LossDetection->SentPackets.Count);
+}
+
+TEST(SentPacketRingTest, MicrobenchmarkPerf)
+{
+    //
+    // Steady state with a fixed number of packets in flight, while a lost
+    // packet holds the front of the ring, as it does for up to 2 PTOs. Each
+    // ACK frame acknowledges everything since the lost packet, as ACK frames
+    // do until they are acknowledged themselves, and as many new packets are
+    // sent. The cost per ACK frame should not depend on how long ago the
+    // packet was lost.
+    //
+    const uint32_t InFlightCounts[] = { 1 << 10, 1 << 14 };
+    const uint32_t AckCount = 16384;
+    const uint32_t PacketsPerAck = 8;
+
+    for (auto InFlight : InFlightCounts) {
+        SmartLossDetection Conn;
+        ASSERT_TRUE(Conn.Send(InFlight));
+        ASSERT_TRUE(Conn.Ack(1, QUIC_PACKET_REORDER_THRESHOLD + 1));
+        ASSERT_EQ(1u, Conn.LossDetection->LostPacketCount);
+
+        uint64_t High = QUIC_PACKET_REORDER_THRESHOLD + 1;
+        int64_t Ns[4] = { 0 };
+        for (uint32_t i = 0; i < AckCount; ++i) {
+            //
+            // Don't let the lost packet age out. The ring may have moved it.
+            //
+            QuicSentPacketSlotGetMetadata(
+                QuicSentPacketRingGetSlot(&Conn.LossDetection->SentPackets, 0))->
+                    SentTime = QuicTimeUs32();
+            High += PacketsPerAck;
+            auto Start = std::chrono::steady_clock::now();
+            ASSERT_TRUE(Conn.Ack(1, High));
+            Ns[i * ARRAYSIZE(Ns) / AckCount] +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - Start).count();
+            ASSERT_TRUE(Conn.Send(PacketsPerAck));
+        }
+
+        ASSERT_EQ(1u, Conn.LossDetection->LostPacketCount);
+        ASSERT_EQ(0u, Conn.LossDetection->SentPackets.FirstPacketNumber);
+        std::cout << "[          ] " << InFlight << " packets in flight: ";
+        for (auto Quarter : Ns) {
+            std::cout << (double)Quarter * ARRAYSIZE(Ns) / AckCount << " ";
+        }
+        std::cout << "ns/ACK frame by quarter" << std::endl;
+    }
+}
@@ -0,0 +1,236 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test for the QUIC_TIMER_WHEEL interface.
+
+--*/
+
+#include "main.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//
+// QUIC_CONNECTION starts with an anonymous QUIC_HANDLE member, which C++ does
+// not support, so every field offset seen from C++ is short by the size of
+// QUIC_HANDLE. These helpers access the fields used by the timer wheel at the
+// offsets the C code uses.
+//
+static QUIC_CONNECTION* CppView(QUIC_CONNECTION* Connection) {
+    return (QUIC_CONNECTION*)((uint8_t*)Connection + sizeof(QUIC_HANDLE));
+}
+static uint64_t& ExpirationTime(QUIC_CONNECTION* Connection) {
+    return CppView(Connection)->Timers[0].ExpirationTime;
+}
+static bool InTimerWheel(QUIC_CONNECTION* Connection) {
+    return CppView(Connection)->TimerLink.Flink != NULL;
+}
+static QUIC_CONNECTION* FromTimerLink(QUIC_LIST_ENTRY* Entry) {
+    return (QUIC_CONNECTION*)
+        ((uint8_t*)QUIC_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink) - sizeof(QUIC_HANDLE));
+}
+
+struct SmartTimerWheel {
+    QUIC_TIMER_WHEEL Wheel;
+    std::vector<QUIC_CONNECTION*> Connections;
+    SmartTimerWheel(uint32_t ConnectionCount) {
+        EXPECT_EQ(QUIC_STATUS_SUCCESS, QuicTimerWheelInitialize(&Wheel));
+        for (uint32_t i = 0; i < ConnectionCount; ++i) {
+            //
+            // The timer wheel only uses the connection's TimerLink and
+            // next expiration time.
+            //
+            auto Connection =
+                (QUIC_CONNECTION*)calloc(1, sizeof(QUIC_HANDLE) + sizeof(QUIC_CONNECTION));
+            ExpirationTime(Connection) = UINT64_MAX;
+            Connections.push_back(Connection);
+        }
+    }
+    ~SmartTimerWheel() {
+        for (auto Connection : Connections) {
+            Set(Connection, UINT64_MAX);
+            free(Connection);
+        }
+        QuicTimerWheelUninitialize(&Wheel);
+    }
+    void Set(QUIC_CONNECTION* Connection, uint64_t Time) {
+        ExpirationTime(Connection) = Time;
+        QuicTimerWheelUpdateConnection(&Wheel, Connection);
+    }
+    uint64_t MinExpirationTime() {
+        uint64_t Min = UINT64_MAX;
+        for (auto Connection : Connections) {
+            if (InTimerWheel(Connection) && ExpirationTime(Connection) < Min) {
+                Min = ExpirationTime(Connection);
+            }
+        }
+        return Min;
+    }
+    //
+    // Returns the connections expired at TimeNow, validating that they really
+    // expired and that none were missed.
+    //
+    uint32_t Expire(uint64_t TimeNow) {
+        QUIC_LIST_ENTRY Expired;
+        QuicListInitializeHead(&Expired);
+        QuicTimerWheelGetExpired(&Wheel, TimeNow, &Expired);
+        uint32_t Count = 0;
+        while (!QuicListIsEmpty(&Expired)) {
+            QUIC_LIST_ENTRY* Entry = QuicListRemoveHead(&Expired);
+            Entry->Flink = NULL;
+            auto Connection = FromTimerLink(Entry);
+            EXPECT_LE(ExpirationTime(Connection), TimeNow);
+            ExpirationTime(Connection) = UINT64_MAX;
+            Count++;
+        }
+        uint64_t Min = MinExpirationTime();
+        EXPECT_GT(Min, TimeNow);
+        EXPECT_LE(Wheel.NextExpirationTime, Min);
+        return Count;
+    }
+};
+
+TEST(TimerWheelTest, Empty)
+{
+    SmartTimerWheel Wheel(0);
+    ASSERT_EQ(UINT64_MAX, QuicTimerWheelGetWaitTime(&Wheel.Wheel));
+    ASSERT_EQ(0u, Wheel.Expire(QuicTimeUs64()));
+}
+
+TEST(TimerWheelTest, ExpireAcrossLevels)
+{
+    const uint64_t Offsets[] = {
+        0,                      // Already due
+        1500,                   // Level 0
+        MS_TO_US(70ull),           // Level 1
+        MS_TO_US(5000ull),         // Level 2
+        MS_TO_US(300000ull),       // Level 3
+        MS_TO_US(20000000ull),     // Beyond the wheel's range
+    };
+    const uint32_t Count = sizeof(Offsets) / sizeof(Offsets[0]);
+    SmartTimerWheel Wheel(Count);
+    uint64_t Start = QuicTimeUs64();
+
+    for (uint32_t i = Count; i > 0; --i) {
+        Wheel.Set(Wheel.Connections[i - 1], Start + Offsets[i - 1]);
+    }
+    ASSERT_EQ(Count, Wheel.Wheel.ConnectionCount);
+    ASSERT_EQ(Start, Wheel.Wheel.NextExpirationTime);
+    ASSERT_EQ(Wheel.Connections[0], Wheel.Wheel.NextConnection);
+    ASSERT_EQ(0u, QuicTimerWheelGetWaitTime(&Wheel.Wheel));
+
+    for (uint32_t i = 0; i < Count; ++i) {
+        uint64_t Expiration = Start + Offsets[i];
+        if (i != 0) {
+            ASSERT_EQ(0u, Wheel.Expire(Expiration - 1));
+        }
+        ASSERT_EQ(1u, Wheel.Expire(Expiration));
+    }
+    ASSERT_EQ(0u, Wheel.Wheel.ConnectionCount);
+    ASSERT_EQ(UINT64_MAX, Wheel.Wheel.NextExpirationTime);
+}
+
+TEST(TimerWheelTest, UpdateAndRemove)
+{
+    SmartTimerWheel Wheel(3);
+    uint64_t Start = QuicTimeUs64();
+
+    Wheel.Set(Wheel.Connections[0], Start + MS_TO_US(10ull));
+    Wheel.Set(Wheel.Connections[1], Start + MS_TO_US(20ull));
+    Wheel.Set(Wheel.Connections[2], Start + MS_TO_US(100000ull));
+    ASSERT_EQ(Wheel.Connections[0], Wheel.Wheel.NextConnection);
+
+    //
+    // Push the next timer out past the others.
+    //
+    Wheel.Set(Wheel.Connections[0], Start + MS_TO_US(50ull));
+    ASSERT_EQ(Start + MS_TO_US(20ull), Wheel.Wheel.NextExpirationTime);
+    ASSERT_EQ(Wheel.Connections[1], Wheel.Wheel.NextConnection);
+
+    QuicTimerWheelRemoveConnection(&Wheel.Wheel, Wheel.Connections[1]);
+    ExpirationTime(Wheel.Connections[1]) = UINT64_MAX;
+    ASSERT_EQ(2u, Wheel.Wheel.ConnectionCount);
+    ASSERT_LE(Wheel.Wheel.NextExpirationTime, Start + MS_TO_US(50ull));
+
+    ASSERT_EQ(1u, Wheel.Expire(Start + MS_TO_US(50ull)));
+    ASSERT_EQ(1u, Wheel.Wheel.ConnectionCount);
+
+    //
+    // The remaining timer is on a higher level, so the next expiration time is
+    // only a lower bound.
+    //
+    ASSERT_LE(Wheel.Wheel.NextExpirationTime, Start + MS_TO_US(100000ull));
+    ASSERT_EQ(1u, Wheel.Expire(Start + MS_TO_US(100000ull)));
+}
+
+TEST(TimerWheelTest, Random)
+{
+    const uint32_t Count = 2000;
+    SmartTimerWheel Wheel(Count);
+    std::mt19937_64 Rng(42);
+    uint64_t Now = QuicTimeUs64();
+    uint32_t Expired = 0;
+
+    for (uint32_t Round = 0; Round < 200; ++Round) {
+        for (uint32_t i = 0; i < 100; ++i) {
+            auto Connection = Wheel.Connections[Rng() % Count];
+            switch (Rng() % 4) {
+            case 0:
+                Wheel.Set(Connection, UINT64_MAX);
+                break;
+            case 1:
+                Wheel.Set(Connection, Now + Rng() % MS_TO_US(100ull));
+                break;
+            case 2:
+                Wheel.Set(Connection, Now + Rng() % MS_TO_US(60000ull));
+                break;
+            default:
+                Wheel.Set(Connection, Now + Rng() % MS_TO_US(10000000ull));
+                break;
+            }
+        }
+        ASSERT_LE(Wheel.Wheel.NextExpirationTime, Wheel.MinExpirationTime());
+        Now += Rng() % MS_TO_US(Round % 2 ? 50 : 100000);
+        Expired += Wheel.Expire(Now);
+    }
+
+    ASSERT_NE(0u, Expired);
+}
+
+//
+// Compares the cost of timer updates with many connections in the wheel, in
+// the pattern of idle and keep alive timers being pushed out on every packet.
+//
+TEST(TimerWheelTest, MicrobenchmarkPerf)
+{
+    const uint32_t Count = 20000;
+    const uint32_t UpdateCount = 1000000;
+    SmartTimerWheel Wheel(Count);
+    std::mt19937_64 Rng(42);
+    uint64_t Now = QuicTimeUs64();
+
+    auto Begin = std::chrono::steady_clock::now();
+    for (auto Connection : Wheel.Connections) {
+        Wheel.Set(Connection, Now + MS_TO_US(1000ull) + Rng() % MS_TO_US(30000ull));
+    }
+    for (uint32_t i = 0; i < UpdateCount; ++i) {
+        Wheel.Set(
+            Wheel.Connections[Rng() % Count],
+            Now + MS_TO_US(1000ull) + Rng() % MS_TO_US(30000ull));
+    }
+    for (auto Connection : Wheel.Connections) {
+        QuicTimerWheelRemoveConnection(&Wheel.Wheel, Connection);
+        ExpirationTime(Connection) = UINT64_MAX;
+    }
+    auto End = std::chrono::steady_clock::now();
+
+    auto Ns = std::chrono::duration_cast<std::chrono::nanoseconds>(End - Begin).count();
+    std::cout << Count << " connections, " << UpdateCount << " updates: "
+        << Ns / (Count * 2 + UpdateCount) << " ns/op" << std::endl;
+    ASSERT_EQ(0u, Wheel.Wheel.ConnectionCount);
+}
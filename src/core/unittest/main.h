@@ -74,6 +74,10 @@ std::ostream& operator << (std::ostream& o, const QUIC_FRAME_TYPE& type) {
             return o << "QUIC_FRAME_CONNECTION_CLOSE_1";
         case QUIC_FRAME_HANDSHAKE_DONE:
             return o << "QUIC_FRAME_HANDSHAKE_DONE";
+        case QUIC_FRAME_DATAGRAM:
+            return o << "QUIC_FRAME_DATAGRAM";
+        case QUIC_FRAME_DATAGRAM_1:
+            return o << "QUIC_FRAME_DATAGRAM_1";
         default:
             return o << "UNRECOGNIZED_FRAME_TYPE(" << (uint32_t) type << ")";
     }
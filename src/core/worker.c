@@ -15,7 +15,9 @@ Abstract:
     active timers running.
 
     Each connection is assigned to a single worker, and is queued whenever it
-    has operations to be processed.
+    has operations to be processed. When work stealing is enabled, an idle
+    worker may take queued connections from an overloaded worker in the same
+    pool.
 
 --*/
 
@@ -279,6 +281,146 @@ QuicWorkerResetQueueDelay(
     QuicTraceEvent(WorkerQueueDelayUpdated, Worker, Worker->AverageQueueDelay);
 }
 
+//
+// Called by an idle worker to take one queued connection from an overloaded
+// sibling in the same pool. The sibling still owns the connection's timers, so
+// the connection is only parked here; the sibling completes the move in
+// QuicWorkerHandOffStolenConnection.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerStealConnection(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    QUIC_WORKER_POOL* Pool = Worker->Pool;
+    if (!MsQuicLib.Settings.WorkStealingEnabled ||
+        Pool == NULL || Pool->WorkerCount < 2) {
+        return;
+    }
+
+    uint8_t Index = (uint8_t)(Worker - Pool->Workers);
+    for (uint8_t i = 1; i < Pool->WorkerCount; ++i) {
+        QUIC_WORKER* Sibling = &Pool->Workers[(Index + i) % Pool->WorkerCount];
+        if (!Sibling->Enabled || !QuicWorkerIsOverloaded(Sibling)) {
+            continue;
+        }
+
+        QUIC_CONNECTION* Connection = NULL;
+        QuicDispatchLockAcquire(&Sibling->Lock);
+        if (Sibling->StolenConnection == NULL &&
+            !QuicListIsEmpty(&Sibling->Connections)) {
+            //
+            // Take the tail, as it would otherwise wait the longest.
+            //
+            QUIC_CONNECTION* Candidate =
+                QUIC_CONTAINING_RECORD(
+                    Sibling->Connections.Blink, QUIC_CONNECTION, WorkerLink);
+            if (!Candidate->State.UpdateWorker &&
+                !Candidate->State.Uninitialized) {
+                QuicListEntryRemove(&Candidate->WorkerLink);
+                Sibling->StolenConnection = Candidate;
+                Sibling->StealingWorker = Worker;
+                Connection = Candidate;
+            }
+        }
+        QuicDispatchLockRelease(&Sibling->Lock);
+
+        if (Connection != NULL) {
+            QuicTraceLogInfo(
+                WorkerStealConnection,
+                "[wrkr][%p] Stealing connection %p from worker %p (queue delay %u us)",
+                Worker,
+                Connection,
+                Sibling,
+                Sibling->AverageQueueDelay);
+            QuicEventSet(Sibling->Ready);
+            break;
+        }
+    }
+}
+
+//
+// Completes moving a connection taken by an idle sibling. Must be called on the
+// worker that currently owns the connection's timers.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerHandOffStolenConnection(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    QuicDispatchLockAcquire(&Worker->Lock);
+    QUIC_CONNECTION* Connection = Worker->StolenConnection;
+    QUIC_WORKER* NewWorker = Worker->StealingWorker;
+    Worker->StolenConnection = NULL;
+    Worker->StealingWorker = NULL;
+    if (Connection != NULL && !NewWorker->Enabled) {
+        //
+        // The stealing worker is shutting down. Keep the connection here.
+        //
+        QuicListInsertHead(&Worker->Connections, &Connection->WorkerLink);
+        Connection = NULL;
+    }
+    QuicDispatchLockRelease(&Worker->Lock);
+
+    if (Connection == NULL) {
+        return;
+    }
+
+    QuicTraceLogVerbose(
+        WorkerHandOffConnection,
+        "[wrkr][%p] Handing off connection %p to worker %p",
+        Worker,
+        Connection,
+        NewWorker);
+
+    //
+    // Use the same path as a partition change: remove the timers from this
+    // worker, and the new worker adds them to its own timer wheel when it first
+    // processes the connection.
+    //
+    QuicTimerWheelRemoveConnection(&Worker->TimerWheel, Connection);
+    QuicWorkerAssignConnection(NewWorker, Connection);
+    Connection->State.UpdateWorker = TRUE;
+    QuicWorkerMoveConnection(NewWorker, Connection);
+    QuicConnRelease(Connection, QUIC_CONN_REF_WORKER);
+}
+
+//
+// Called by an overloaded worker to wake an idle sibling, so that it can steal
+// some of the queued connections.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerWakeIdleSibling(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    QUIC_WORKER_POOL* Pool = Worker->Pool;
+    if (!MsQuicLib.Settings.WorkStealingEnabled ||
+        Pool == NULL || Pool->WorkerCount < 2 ||
+        !QuicWorkerIsOverloaded(Worker) ||
+        QuicListIsEmpty(&Worker->Connections)) {
+        return;
+    }
+
+    uint8_t Index = (uint8_t)(Worker - Pool->Workers);
+    for (uint8_t i = 1; i < Pool->WorkerCount; ++i) {
+        QUIC_WORKER* Sibling = &Pool->Workers[(Index + i) % Pool->WorkerCount];
+        if (Sibling->Enabled && !Sibling->IsActive) {
+            QuicTraceLogVerbose(
+                WorkerWakeForSteal,
+                "[wrkr][%p] Overloaded (queue delay %u us), waking worker %p",
+                Worker,
+                Worker->AverageQueueDelay,
+                Sibling);
+            QuicEventSet(Sibling->Ready);
+            break;
+        }
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_CONNECTION*
 QuicWorkerGetNextConnection(
@@ -504,9 +646,14 @@ QUIC_THREAD_CALLBACK(QuicWorkerThread, Context)
         // timers (which just queue more operations on connections).
         //
 
+        if (Worker->StolenConnection != NULL) {
+            QuicWorkerHandOffStolenConnection(Worker);
+        }
+
         QUIC_CONNECTION* Connection = QuicWorkerGetNextConnection(Worker);
         if (Connection != NULL) {
             QuicWorkerProcessConnection(Worker, Connection);
+            QuicWorkerWakeIdleSibling(Worker);
         }
 
         QUIC_OPERATION* Operation = QuicWorkerGetNextOperation(Worker);
@@ -548,6 +695,7 @@ QUIC_THREAD_CALLBACK(QuicWorkerThread, Context)
             if (Delay >= (uint64_t)UINT32_MAX) {
                 Delay = UINT32_MAX - 1; // Max has special meaning for most platforms.
             }
+            QuicWorkerStealConnection(Worker);
             QuicWorkerToggleActivityState(Worker, (uint32_t)Delay);
             QuicWorkerResetQueueDelay(Worker);
             BOOLEAN ReadySet =
@@ -562,6 +710,7 @@ QUIC_THREAD_CALLBACK(QuicWorkerThread, Context)
             //
             // No active timers running, so just wait for the ready event.
             //
+            QuicWorkerStealConnection(Worker);
             QuicWorkerToggleActivityState(Worker, UINT32_MAX);
             QuicWorkerResetQueueDelay(Worker);
             QuicEventWaitForever(Worker->Ready);
@@ -576,6 +725,11 @@ QUIC_THREAD_CALLBACK(QuicWorkerThread, Context)
     // in it's list by the time clean up started. So it needs to release any
     // remaining references on connections.
     //
+    if (Worker->StolenConnection != NULL) {
+        QuicListInsertTail(&Worker->Connections, &Worker->StolenConnection->WorkerLink);
+        Worker->StolenConnection = NULL;
+        Worker->StealingWorker = NULL;
+    }
     while (!QuicListIsEmpty(&Worker->Connections)) {
         QUIC_CONNECTION* Connection =
             QUIC_CONTAINING_RECORD(
@@ -637,6 +791,7 @@ QuicWorkerPoolInitialize(
     //
 
     for (uint8_t i = 0; i < WorkerCount; i++) {
+        WorkerPool->Workers[i].Pool = WorkerPool;
         Status = QuicWorkerInitialize(Owner, ThreadFlags, i, &WorkerPool->Workers[i]);
         if (QUIC_FAILED(Status)) {
             for (uint8_t j = 0; j < i; j++) {
@@ -67,6 +67,20 @@ typedef struct QUIC_CACHEALIGN QUIC_WORKER {
     uint32_t OperationCount;
     uint64_t DroppedOperationCount;
 
+    //
+    // The pool this worker belongs to. Used to find siblings when work
+    // stealing is enabled.
+    //
+    struct QUIC_WORKER_POOL* Pool;
+
+    //
+    // A queued connection taken by an idle sibling (StealingWorker). Since its
+    // timers still live in this worker's timer wheel, this worker must complete
+    // the hand off. Protected by Lock.
+    //
+    QUIC_CONNECTION* StolenConnection;
+    struct QUIC_WORKER* StealingWorker;
+
     QUIC_POOL StreamPool; // QUIC_STREAM
     QUIC_POOL SendRequestPool; // QUIC_SEND_REQUEST
     QUIC_SENT_PACKET_POOL SentPacketPool; // QUIC_SENT_PACKET_METADATA
@@ -80,6 +80,11 @@ typedef enum QUIC_LOAD_BALANCING_MODE {
     QUIC_LOAD_BALANCING_SERVER_ID_IP            // Encodes IP address in Server ID
 } QUIC_LOAD_BALANCING_MODE;
 
+typedef enum QUIC_CONGESTION_CONTROL_ALGORITHM {
+    QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC,    // Default
+    QUIC_CONGESTION_CONTROL_ALGORITHM_BBR
+} QUIC_CONGESTION_CONTROL_ALGORITHM;
+
 typedef enum QUIC_SEC_CONFIG_FLAGS {
     QUIC_SEC_CONFIG_FLAG_NONE                   = 0x00000000,
     QUIC_SEC_CONFIG_FLAG_CERTIFICATE_HASH       = 0x00000001,
@@ -145,7 +150,8 @@ DEFINE_ENUM_FLAG_OPERATORS(QUIC_RECEIVE_FLAGS);
 typedef enum QUIC_SEND_FLAGS {
     QUIC_SEND_FLAG_NONE                     = 0x0000,
     QUIC_SEND_FLAG_ALLOW_0_RTT              = 0x0001,   // Allows the use of encrypting with 0-RTT key.
-    QUIC_SEND_FLAG_FIN                      = 0x0002    // Indicates the request is the one last sent on the stream.
+    QUIC_SEND_FLAG_FIN                      = 0x0002,   // Indicates the request is the one last sent on the stream.
+    QUIC_SEND_FLAG_TRANSFER_OWNERSHIP       = 0x0004    // Buffers are referenced until QUIC_STREAM_EVENT_SEND_BUFFERS_RELEASED instead of being copied.
 } QUIC_SEND_FLAGS;
 
 DEFINE_ENUM_FLAG_OPERATORS(QUIC_SEND_FLAGS);
@@ -246,6 +252,15 @@ typedef struct QUIC_STATISTICS {
     struct {
         uint32_t KeyUpdateCount;
     } Misc;
+    //
+    // Fields below were appended later. They are only filled in if the buffer
+    // passed to QUIC_PARAM_CONN_STATISTICS is large enough to hold them.
+    //
+    struct {
+        uint32_t CongestionCount;       // Slow start ended by a congestion event
+        uint32_t RttIncreaseCount;      // Slow start ended by HyStart++ on RTT increase
+        uint32_t ThresholdCount;        // Slow start ended by reaching the slow start threshold
+    } SlowStartExit;
 } QUIC_STATISTICS;
 
 typedef struct QUIC_LISTENER_STATISTICS {
@@ -328,6 +343,7 @@ typedef enum QUIC_PARAM_LEVEL {
 #define QUIC_PARAM_SESSION_DISCONNECT_TIMEOUT           4   // uint32_t - milliseconds
 #define QUIC_PARAM_SESSION_MAX_BYTES_PER_KEY            5   // uint64_t - bytes
 #define QUIC_PARAM_SESSION_MIGRATION_ENABLED            6   // uint8_t (BOOLEAN)
+#define QUIC_PARAM_SESSION_CONGESTION_CONTROL_ALGORITHM 7   // uint16_t - QUIC_CONGESTION_CONTROL_ALGORITHM
 
 //
 // Parameters for QUIC_PARAM_LEVEL_LISTENER.
@@ -358,6 +374,9 @@ typedef enum QUIC_PARAM_LEVEL {
 #define QUIC_PARAM_CONN_SHARE_UDP_BINDING               17  // uint8_t (BOOLEAN)
 #define QUIC_PARAM_CONN_IDEAL_PROCESSOR                 18  // uint8_t
 #define QUIC_PARAM_CONN_MAX_STREAM_IDS                  19  // uint64_t[4]
+#define QUIC_PARAM_CONN_RECV_ZERO_COPY                  20  // uint8_t (BOOLEAN)
+#define QUIC_PARAM_CONN_DATAGRAM_RECEIVE_ENABLED        21  // uint8_t (BOOLEAN)
+#define QUIC_PARAM_CONN_DATAGRAM_SEND_ENABLED           22  // uint8_t (BOOLEAN) - get only
 
 #ifdef WIN32 // Windows certificate validation ignore flags.
 #define QUIC_CERTIFICATE_FLAG_IGNORE_REVOCATION                 0x00000080
@@ -385,6 +404,12 @@ typedef struct QUIC_SCHANNEL_CONTEXT_ATTRIBUTE_W {
 #define QUIC_PARAM_STREAM_ID                            0   // QUIC_UINT62
 #define QUIC_PARAM_STREAM_0RTT_LENGTH                   1   // uint64_t
 #define QUIC_PARAM_STREAM_IDEAL_SEND_BUFFER_SIZE        2   // uint64_t - bytes
+#define QUIC_PARAM_STREAM_PRIORITY                      3   // QUIC_STREAM_PRIORITY
+
+typedef struct QUIC_STREAM_PRIORITY {
+    uint8_t Level;      // 0 (first) to 7 (last). Lower levels are always sent first. Default 3.
+    uint8_t Weight;     // 1 to 255. Relative share of the sends within the level. Default 4.
+} QUIC_STREAM_PRIORITY;
 
 typedef
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -619,9 +644,24 @@ typedef enum QUIC_CONNECTION_EVENT_TYPE {
     QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED               = 6,
     QUIC_CONNECTION_EVENT_STREAMS_AVAILABLE                 = 7,
     QUIC_CONNECTION_EVENT_PEER_NEEDS_STREAMS                = 8,
-    QUIC_CONNECTION_EVENT_IDEAL_PROCESSOR_CHANGED           = 9
+    QUIC_CONNECTION_EVENT_IDEAL_PROCESSOR_CHANGED           = 9,
+    QUIC_CONNECTION_EVENT_DATAGRAM_STATE_CHANGED            = 10,   // Datagram sending was enabled/disabled, or its max length changed.
+    QUIC_CONNECTION_EVENT_DATAGRAM_RECEIVED                 = 11,
+    QUIC_CONNECTION_EVENT_DATAGRAM_SEND_STATE_CHANGED       = 12    // A previous DatagramSend call's state changed.
 } QUIC_CONNECTION_EVENT_TYPE;
 
+typedef enum QUIC_DATAGRAM_SEND_STATE {
+    QUIC_DATAGRAM_SEND_SENT,                    // Sent; the app's buffers are no longer referenced.
+    QUIC_DATAGRAM_SEND_LOST_SUSPECT,            // Suspected lost; may still be acknowledged.
+    QUIC_DATAGRAM_SEND_LOST_DISCARDED,          // Lost and will never be acknowledged. Final.
+    QUIC_DATAGRAM_SEND_ACKNOWLEDGED,            // Acknowledged by the peer. Final.
+    QUIC_DATAGRAM_SEND_ACKNOWLEDGED_SPURIOUS,   // Acknowledged after being suspected lost. Final.
+    QUIC_DATAGRAM_SEND_CANCELED                 // Never sent; the app's buffers are no longer referenced. Final.
+} QUIC_DATAGRAM_SEND_STATE;
+
+#define QUIC_DATAGRAM_SEND_STATE_IS_FINAL(State) \
+    ((State) >= QUIC_DATAGRAM_SEND_LOST_DISCARDED)
+
 typedef struct QUIC_CONNECTION_EVENT {
     QUIC_CONNECTION_EVENT_TYPE Type;
     union {
@@ -657,6 +697,18 @@ typedef struct QUIC_CONNECTION_EVENT {
         struct {
             uint8_t IdealProcessor;
         } IDEAL_PROCESSOR_CHANGED;
+        struct {
+            BOOLEAN SendEnabled;
+            uint16_t MaxSendLength;
+        } DATAGRAM_STATE_CHANGED;
+        struct {
+            const QUIC_BUFFER* Buffer;
+            QUIC_RECEIVE_FLAGS Flags;
+        } DATAGRAM_RECEIVED;
+        struct {
+            void* ClientContext;
+            QUIC_DATAGRAM_SEND_STATE State;
+        } DATAGRAM_SEND_STATE_CHANGED;
     };
 } QUIC_CONNECTION_EVENT;
 
@@ -740,7 +792,8 @@ typedef enum QUIC_STREAM_EVENT_TYPE {
     QUIC_STREAM_EVENT_PEER_RECEIVE_ABORTED      = 5,
     QUIC_STREAM_EVENT_SEND_SHUTDOWN_COMPLETE    = 6,
     QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE         = 7,
-    QUIC_STREAM_EVENT_IDEAL_SEND_BUFFER_SIZE    = 8
+    QUIC_STREAM_EVENT_IDEAL_SEND_BUFFER_SIZE    = 8,
+    QUIC_STREAM_EVENT_SEND_BUFFERS_RELEASED     = 9
 } QUIC_STREAM_EVENT_TYPE;
 
 typedef struct QUIC_STREAM_EVENT {
@@ -775,6 +828,9 @@ typedef struct QUIC_STREAM_EVENT {
         struct {
             uint64_t ByteCount;
         } IDEAL_SEND_BUFFER_SIZE;
+        struct {
+            void* ClientContext;
+        } SEND_BUFFERS_RELEASED;
     };
 } QUIC_STREAM_EVENT;
 
@@ -877,6 +933,27 @@ QUIC_STATUS
     _In_ BOOLEAN IsEnabled
     );
 
+//
+// Datagrams
+//
+
+//
+// Sends an unreliable datagram on the connection. The buffers are referenced,
+// not copied, until QUIC_CONNECTION_EVENT_DATAGRAM_SEND_STATE_CHANGED
+// indicates QUIC_DATAGRAM_SEND_SENT or QUIC_DATAGRAM_SEND_CANCELED.
+//
+typedef
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+(QUIC_API * QUIC_DATAGRAM_SEND_FN)(
+    _In_ _Pre_defensive_ HQUIC Connection,
+    _In_reads_(BufferCount) _Pre_defensive_
+        const QUIC_BUFFER* const Buffers,
+    _In_ uint32_t BufferCount,
+    _In_ QUIC_SEND_FLAGS Flags,
+    _In_opt_ void* ClientSendContext
+    );
+
 //
 // API Function Table.
 //
@@ -917,6 +994,8 @@ typedef struct QUIC_API_TABLE {
     QUIC_STREAM_RECEIVE_COMPLETE_FN     StreamReceiveComplete;
     QUIC_STREAM_RECEIVE_SET_ENABLED_FN  StreamReceiveSetEnabled;
 
+    QUIC_DATAGRAM_SEND_FN               DatagramSend;
+
 } QUIC_API_TABLE;
 
 //
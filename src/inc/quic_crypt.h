@@ -291,6 +291,56 @@ QuicDecrypt(
         uint8_t* Buffer
     );
 
+//
+// A single packet in a batched encrypt or decrypt. The fields match the
+// parameters of QuicEncrypt/QuicDecrypt.
+//
+typedef struct QUIC_CRYPT_BATCH_ENTRY {
+
+    const uint8_t* AuthData;
+    uint8_t* Buffer;
+    uint8_t Iv[QUIC_IV_LENGTH];
+    uint16_t AuthDataLength;
+    uint16_t BufferLength;
+
+    //
+    // Output: the result for this packet.
+    //
+    QUIC_STATUS Status;
+
+} QUIC_CRYPT_BATCH_ENTRY;
+
+//
+// Encrypts a batch of packets with the given key. Stops at, and returns, the
+// first failure.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicEncryptBatch(
+    _In_ QUIC_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize)
+        QUIC_CRYPT_BATCH_ENTRY* Entries
+    );
+
+//
+// Decrypts a batch of packets with the given key. Every packet is processed,
+// even if some fail to authenticate; check each entry's Status. Returns the
+// first failure, if any.
+//
+// This is provider API only for now: the receive path still decrypts one
+// packet at a time, since each packet's key phase and duplicate check depend
+// on the packets decrypted before it.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicDecryptBatch(
+    _In_ QUIC_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize)
+        QUIC_CRYPT_BATCH_ENTRY* Entries
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
 QuicHpKeyCreate(
@@ -81,6 +81,10 @@ Usage examples:
 #ifndef QUIC_HASHTABLE_
 #define QUIC_HASHTABLE_
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 #pragma warning(disable:4201)  // nonstandard extension used: nameless struct/union
 
 #define QUIC_HASH_ALLOCATED_HEADER 0x00000001
@@ -260,4 +264,8 @@ QuicHashSimple(
     return Hash;
 }
 
+#if defined(__cplusplus)
+}
+#endif
+
 #endif // QUIC_HASHTABLE_
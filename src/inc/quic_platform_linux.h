@@ -41,6 +41,7 @@ Environment:
 #include <msquic_linux.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <sched.h>
 #include <errno.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
@@ -176,6 +177,52 @@ InterlockedIncrement64(
     return __sync_add_and_fetch(Addend, (int64_t)1);
 }
 
+inline
+long
+ReadAcquire(
+    _In_ _Interlocked_operand_ long const volatile *Source
+    )
+{
+    return __atomic_load_n(Source, __ATOMIC_ACQUIRE);
+}
+
+inline
+void
+WriteRelease8(
+    _Out_ _Interlocked_operand_ char volatile *Destination,
+    _In_ char Value
+    )
+{
+    __atomic_store_n(Destination, Value, __ATOMIC_RELEASE);
+}
+
+inline
+void*
+ReadPointerAcquire(
+    _In_ _Interlocked_operand_ void* const volatile *Source
+    )
+{
+    return __atomic_load_n(Source, __ATOMIC_ACQUIRE);
+}
+
+inline
+void
+WritePointerRelease(
+    _Out_ _Interlocked_operand_ void* volatile *Destination,
+    _In_ void* Value
+    )
+{
+    __atomic_store_n(Destination, Value, __ATOMIC_RELEASE);
+}
+
+#define MemoryBarrier() __sync_synchronize()
+
+//
+// User mode threads can be preempted while another thread spins on them, so
+// give up the processor instead of just pausing.
+//
+#define YieldProcessor() sched_yield()
+
 //
 // String utils.
 //
@@ -264,29 +311,72 @@ QuicFree(
 #define QUIC_FREE(Mem) QuicFree((void*)Mem)
 
 //
-// Represents a QUIC memory pool used for fixed sized allocations.
+// Per processor cache of free entries for a pool. Padded to a cache line to
+// prevent false sharing between processors.
 //
 
-typedef struct QUIC_POOL {
+#define QUIC_POOL_DEPOT_ALIGNMENT 64
+
+typedef struct QUIC_POOL_DEPOT {
 
     //
-    // List of free entries.
+    // List of free entries owned by whoever holds the Busy flag.
     //
 
-    QUIC_SINGLE_LIST_ENTRY ListHead;
+    QUIC_SINGLE_LIST_ENTRY* LocalHead;
 
     //
-    // Number of free entries in the list.
+    // Number of free entries in the local list.
     //
 
-    uint16_t ListDepth;
+    long LocalDepth;
 
     //
-    // Lock to synchronize access to the List.
-    // LINUX_TODO: Check how to make this lock free?
+    // Try-lock flag for the local list. It is never waited on; a contended
+    // depot is bypassed.
     //
 
-    pthread_mutex_t Lock;
+    long Busy;
+
+    //
+    // Lock-free list of entries returned while the depot was busy. Entries are
+    // only ever pushed individually and removed all at once, so it is not
+    // subject to ABA.
+    //
+
+    QUIC_SINGLE_LIST_ENTRY* ReturnHead;
+
+    //
+    // Approximate number of entries in the return list.
+    //
+
+    long ReturnDepth;
+
+    uint8_t Padding[
+        QUIC_POOL_DEPOT_ALIGNMENT -
+        2 * sizeof(QUIC_SINGLE_LIST_ENTRY*) -
+        3 * sizeof(long)];
+
+} QUIC_POOL_DEPOT;
+
+//
+// Represents a QUIC memory pool used for fixed sized allocations.
+//
+
+typedef struct QUIC_POOL {
+
+    //
+    // Per processor free entry caches. NULL if they couldn't be allocated, in
+    // which case the pool passes through to the heap.
+    //
+
+    QUIC_POOL_DEPOT* Depots;
+
+    //
+    // Number of elements in Depots.
+    //
+
+    uint32_t DepotCount;
 
     //
     // Size of entries.
@@ -294,6 +384,18 @@ typedef struct QUIC_POOL {
 
     uint32_t Size;
 
+    //
+    // Maximum number of free entries cached per depot.
+    //
+
+    uint16_t MaxDepth;
+
+    //
+    // QUIC_POOL_FLAG_* flags the pool was initialized with.
+    //
+
+    uint16_t Flags;
+
     //
     // The memory tag to use for any allocation from this pool.
     //
@@ -304,6 +406,21 @@ typedef struct QUIC_POOL {
 
 #define QUIC_POOL_MAXIMUM_DEPTH   256 // Copied from EX_MAXIMUM_LOOKASIDE_DEPTH_BASE
 
+//
+// Entries larger than this are cached less deeply, to bound the memory held
+// by idle pools.
+//
+
+#define QUIC_POOL_LARGE_ENTRY_SIZE      4096
+#define QUIC_POOL_LARGE_MAXIMUM_DEPTH   32
+
+//
+// Skips zeroing entries on allocation. Callers must initialize the memory
+// themselves.
+//
+
+#define QUIC_POOL_FLAG_NO_ZERO  0x0001
+
 void
 QuicPoolInitialize(
     _In_ BOOLEAN IsPaged,
@@ -311,6 +428,14 @@ QuicPoolInitialize(
     _Inout_ QUIC_POOL* Pool
     );
 
+void
+QuicPoolInitializeEx(
+    _In_ BOOLEAN IsPaged,
+    _In_ uint32_t Size,
+    _In_ uint16_t Flags,
+    _Inout_ QUIC_POOL* Pool
+    );
+
 void
 QuicPoolUninitialize(
     _Inout_ QUIC_POOL* Pool
@@ -458,17 +583,12 @@ QuicRefDecrement(
 typedef struct QUIC_EVENT_OBJECT {
 
     //
-    // Mutex and condition.
-    //
-
-    pthread_mutex_t Mutex;
-    pthread_cond_t Cond;
-
-    //
-    // Denotes if the event object is in signaled state.
+    // Futex word. The low bit denotes if the event object is in signaled
+    // state and the remaining bits count the threads waiting on it, so that
+    // setting an event nobody is waiting on never makes a syscall.
     //
 
-    BOOLEAN Signaled;
+    int32_t State;
 
     //
     // Denotes if the event object should be auto reset after it's signaled.
@@ -138,6 +138,10 @@
 #define _Outptr_result_buffer_maybenull_(...)
 #endif
 
+#ifndef _Inout_updates_
+#define _Inout_updates_(...)
+#endif
+
 #ifndef _Inout_updates_bytes_
 #define _Inout_updates_bytes_(...)
 #endif
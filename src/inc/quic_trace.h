@@ -92,7 +92,8 @@ typedef enum QUIC_TRACE_API_TYPE {
     QUIC_TRACE_API_STREAM_SHUTDOWN,
     QUIC_TRACE_API_STREAM_SEND,
     QUIC_TRACE_API_STREAM_RECEIVE_COMPLETE,
-    QUIC_TRACE_API_STREAM_RECEIVE_SET_ENABLED
+    QUIC_TRACE_API_STREAM_RECEIVE_SET_ENABLED,
+    QUIC_TRACE_API_DATAGRAM_SEND
 } QUIC_TRACE_API_TYPE;
 
 typedef enum QUIC_TRACE_LEVEL {
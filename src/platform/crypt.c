@@ -0,0 +1,69 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Batched packet protection, common to all TLS/crypto providers.
+
+Notes:
+
+    None of the current providers expose a multi-stream AEAD primitive (e.g.
+    several interleaved AES-GCM streams), so a batch is sealed or opened one
+    packet at a time with the provider's single packet routines. Callers still
+    benefit from handing over a whole burst at once, and a provider that gains
+    a real batched implementation only needs to replace these two functions.
+
+--*/
+
+#include "platform_internal.h"
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicEncryptBatch(
+    _In_ QUIC_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize) QUIC_CRYPT_BATCH_ENTRY* Entries
+    )
+{
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        Entries[i].Status =
+            QuicEncrypt(
+                Key,
+                Entries[i].Iv,
+                Entries[i].AuthDataLength,
+                Entries[i].AuthData,
+                Entries[i].BufferLength,
+                Entries[i].Buffer);
+        if (QUIC_FAILED(Entries[i].Status)) {
+            return Entries[i].Status;
+        }
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QuicDecryptBatch(
+    _In_ QUIC_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize) QUIC_CRYPT_BATCH_ENTRY* Entries
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        Entries[i].Status =
+            QuicDecrypt(
+                Key,
+                Entries[i].Iv,
+                Entries[i].AuthDataLength,
+                Entries[i].AuthData,
+                Entries[i].BufferLength,
+                Entries[i].Buffer);
+        if (QUIC_FAILED(Entries[i].Status) && QUIC_SUCCEEDED(Status)) {
+            Status = Entries[i].Status;
+        }
+    }
+    return Status;
+}
@@ -20,18 +20,60 @@ Environment:
 #include <inttypes.h>
 #include <linux/in6.h>
 #include <arpa/inet.h>
+#include <netinet/udp.h>
+#include <linux/filter.h>
 #include "quic_platform_dispatch.h"
 
 QUIC_STATIC_ASSERT((SIZEOF_STRUCT_MEMBER(QUIC_BUFFER, Length) <= sizeof(size_t)), "(sizeof(QUIC_BUFFER.Length) == sizeof(size_t) must be TRUE.");
 QUIC_STATIC_ASSERT((SIZEOF_STRUCT_MEMBER(QUIC_BUFFER, Buffer) == sizeof(void*)), "(sizeof(QUIC_BUFFER.Buffer) == sizeof(void*) must be TRUE.");
 
 //
-// TODO: Support batching.
+// The maximum number of UDP datagrams that can be sent with one call.
 //
-#define QUIC_MAX_BATCH_SEND 1
+#define QUIC_MAX_BATCH_SEND 10
 
 //
-// A receive block to receive a UDP packet over the sockets.
+// The maximum number of UDP datagrams that can be received with one call.
+//
+#define QUIC_MAX_BATCH_RECV 8
+
+//
+// Not available in older kernel/glibc headers. The value is part of the
+// kernel ABI (since 4.18), so it's safe to define here.
+//
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+
+//
+// The maximum UDP receive coalescing payload.
+//
+#define MAX_URO_PAYLOAD_LENGTH (UINT16_MAX - QUIC_UDP_HEADER_SIZE)
+
+//
+// The maximum number of UDP datagrams to preallocate for a coalesced receive.
+//
+#define URO_MAX_DATAGRAMS_PER_INDICATION 64
+
+//
+// 60K is the largest buffer most NICs can offload without any software
+// segmentation. Current generation NICs advertise (60K < limit <= 64K).
+//
+#define QUIC_LARGE_SEND_BUFFER_SIZE 0xF000
+
+//
+// A receive block to receive a UDP packet (or a set of coalesced packets)
+// over the sockets. The layout of the allocation is as follows:
+//
+//  QUIC_DATAPATH_RECV_BLOCK
+//  Datapath->RecvDatagramCount * [QUIC_DATAPATH_RECV_DATAGRAM + QUIC_RECV_PACKET]
+//  UDP payload buffer (at Datapath->RecvPayloadOffset)
 //
 typedef struct QUIC_DATAPATH_RECV_BLOCK {
     //
@@ -40,27 +82,38 @@ typedef struct QUIC_DATAPATH_RECV_BLOCK {
     QUIC_POOL* OwningPool;
 
     //
-    // The recv buffer used by MsQuic.
+    // The number of datagrams indicated up that still reference this block.
     //
-    QUIC_RECV_DATAGRAM RecvPacket;
+    int64_t ReferenceCount;
 
     //
     // Represents the address (source and destination) information of the
-    // packet.
+    // packets.
     //
     QUIC_TUPLE Tuple;
 
+} QUIC_DATAPATH_RECV_BLOCK;
+
+//
+// Per datagram state for a datagram indicated up from a receive block.
+//
+typedef struct QUIC_DATAPATH_RECV_DATAGRAM {
     //
-    // Buffer that actually stores the UDP payload.
+    // The recv buffer used by MsQuic.
     //
-    uint8_t Buffer[MAX_UDP_PAYLOAD_LENGTH];
+    QUIC_RECV_DATAGRAM RecvPacket;
 
     //
-    // This follows the recv block.
+    // The receive block owning the payload buffer.
+    //
+    QUIC_DATAPATH_RECV_BLOCK* RecvBlock;
+
+    //
+    // This follows the recv datagram.
     //
     // QUIC_RECV_PACKET RecvContext;
 
-} QUIC_DATAPATH_RECV_BLOCK;
+} QUIC_DATAPATH_RECV_DATAGRAM;
 
 //
 // Send context.
@@ -97,6 +150,16 @@ typedef struct QUIC_DATAPATH_SEND_CONTEXT {
     //
     struct QUIC_DATAPATH_PROC_CONTEXT *Owner;
 
+    //
+    // The send segmentation size; zero if segmentation is not performed.
+    //
+    uint16_t SegmentSize;
+
+    //
+    // The QUIC_BUFFER returned to the client for segmented sends.
+    //
+    QUIC_BUFFER ClientBuffer;
+
     //
     // BufferCount - The buffer count in use.
     //
@@ -126,6 +189,11 @@ typedef struct QUIC_SOCKET_CONTEXT {
     //
     QUIC_DATAPATH_BINDING* Binding;
 
+    //
+    // The processor context whose epoll thread services this socket.
+    //
+    struct QUIC_DATAPATH_PROC_CONTEXT* ProcContext;
+
     //
     // The socket FD used by this socket context.
     //
@@ -149,24 +217,28 @@ typedef struct QUIC_SOCKET_CONTEXT {
     BOOLEAN SendWaiting;
 
     //
-    // The I/O vector for receive datagrams.
+    // The I/O vectors for receive datagrams.
     //
-    struct iovec RecvIov;
+    struct iovec RecvIov[QUIC_MAX_BATCH_RECV];
 
     //
-    // The control buffer used in RecvMsgHdr.
+    // The control buffers used in RecvMsgHdr.
     //
-    char RecvMsgControl[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+    char RecvMsgControl[QUIC_MAX_BATCH_RECV][
+        CMSG_SPACE(sizeof(struct in6_pktinfo)) +
+        CMSG_SPACE(sizeof(int))];
 
     //
-    // The buffer used to receive msg headers on socket.
+    // The buffers used to receive msg headers on socket with recvmmsg.
     //
-    struct msghdr RecvMsgHdr;
+    struct mmsghdr RecvMsgHdr[QUIC_MAX_BATCH_RECV];
 
     //
-    // The receive block currently being used for receives on this socket.
+    // The receive blocks currently being used for receives on this socket.
+    // A NULL entry has been indicated up and needs to be replaced before the
+    // next receive.
     //
-    QUIC_DATAPATH_RECV_BLOCK* CurrentRecvBlock;
+    QUIC_DATAPATH_RECV_BLOCK* CurrentRecvBlocks[QUIC_MAX_BATCH_RECV];
 
     //
     // The head of list containg all pending sends on this socket.
@@ -221,7 +293,13 @@ typedef struct QUIC_DATAPATH_BINDING {
     uint16_t Mtu;
 
     //
-    // Set of socket contexts one per proc.
+    // The number of socket contexts. Connected (client) bindings only use a
+    // single socket; all others have one per proc.
+    //
+    uint32_t SocketCount;
+
+    //
+    // Set of socket contexts.
     //
     QUIC_SOCKET_CONTEXT SocketContexts[];
 
@@ -268,6 +346,12 @@ typedef struct QUIC_DATAPATH_PROC_CONTEXT {
     //
     QUIC_POOL SendBufferPool;
 
+    //
+    // Pool of large segmented send buffers to be shared by all sockets on this
+    // core.
+    //
+    QUIC_POOL LargeSendBufferPool;
+
     //
     // Pool of send contexts to be shared by all sockets on this core.
     //
@@ -280,6 +364,11 @@ typedef struct QUIC_DATAPATH_PROC_CONTEXT {
 //
 
 typedef struct QUIC_DATAPATH {
+    //
+    // Set of supported features.
+    //
+    uint32_t Features;
+
     //
     // If datapath is shutting down.
     //
@@ -287,7 +376,6 @@ typedef struct QUIC_DATAPATH {
 
     //
     // The max send batch size.
-    // TODO: See how send batching can be enabled.
     //
     uint8_t MaxSendBatchSize;
 
@@ -311,6 +399,28 @@ typedef struct QUIC_DATAPATH {
     //
     size_t ClientRecvContextLength;
 
+    //
+    // The size of each receive datagram array element, including client
+    // context and padding.
+    //
+    uint32_t DatagramStride;
+
+    //
+    // The number of datagrams preallocated in each receive block.
+    //
+    uint32_t RecvDatagramCount;
+
+    //
+    // The offset of the receive payload buffer from the start of the receive
+    // block.
+    //
+    uint32_t RecvPayloadOffset;
+
+    //
+    // The size of the receive payload buffer.
+    //
+    uint32_t RecvPayloadLength;
+
     //
     // The proc count to create per proc datapath state.
     //
@@ -353,11 +463,28 @@ QuicProcessorContextInitialize(
     QUIC_DBG_ASSERT(Datapath != NULL);
 
     RecvPacketLength =
-        sizeof(QUIC_DATAPATH_RECV_BLOCK) + Datapath->ClientRecvContextLength;
+        Datapath->RecvPayloadOffset + Datapath->RecvPayloadLength;
 
     ProcContext->Index = Index;
-    QuicPoolInitialize(TRUE, RecvPacketLength, &ProcContext->RecvBlockPool);
-    QuicPoolInitialize(TRUE, MAX_UDP_PAYLOAD_LENGTH, &ProcContext->SendBufferPool);
+    //
+    // Receive blocks and send buffers are (mostly) large and fully written
+    // before use, so skip zeroing them on allocation.
+    //
+    QuicPoolInitializeEx(
+        TRUE,
+        RecvPacketLength,
+        QUIC_POOL_FLAG_NO_ZERO,
+        &ProcContext->RecvBlockPool);
+    QuicPoolInitializeEx(
+        TRUE,
+        MAX_UDP_PAYLOAD_LENGTH,
+        QUIC_POOL_FLAG_NO_ZERO,
+        &ProcContext->SendBufferPool);
+    QuicPoolInitializeEx(
+        TRUE,
+        QUIC_LARGE_SEND_BUFFER_SIZE,
+        QUIC_POOL_FLAG_NO_ZERO,
+        &ProcContext->LargeSendBufferPool);
     QuicPoolInitialize(
         TRUE,
         sizeof(QUIC_DATAPATH_SEND_CONTEXT),
@@ -403,15 +530,32 @@ QuicProcessorContextInitialize(
     // ProcContext members.
     //
 
+    //
+    // Affinitize the worker to its processor, so that packets steered to this
+    // context's sockets by incoming CPU are also processed on that CPU.
+    //
     QUIC_THREAD_CONFIG ThreadConfig = {
-        0,
-        0,
+        Index < 64 ? QUIC_THREAD_FLAG_SET_IDEAL_PROC | QUIC_THREAD_FLAG_SET_AFFINITIZE : 0,
+        (uint8_t)Index,
         NULL,
         QuicDataPathWorkerThread,
         ProcContext
     };
 
     Status = QuicThreadCreate(&ThreadConfig, &ProcContext->EpollWaitThread);
+    if (QUIC_FAILED(Status) && ThreadConfig.Flags != 0) {
+        //
+        // The processor may not be in the process' allowed CPU set (e.g. in a
+        // container), so fall back to an unaffinitized thread.
+        //
+        QuicTraceLogWarning(
+            DatapathWorkerAffinitizeFailed,
+            "[ udp] Failed to affinitize worker %u, 0x%x",
+            Index,
+            Status);
+        ThreadConfig.Flags = 0;
+        Status = QuicThreadCreate(&ThreadConfig, &ProcContext->EpollWaitThread);
+    }
     if (QUIC_FAILED(Status)) {
         QuicTraceEvent(LibraryErrorStatus, Status, "QuicThreadCreate failed");
         goto Exit;
@@ -431,6 +575,7 @@ Exit:
         }
         QuicPoolUninitialize(&ProcContext->RecvBlockPool);
         QuicPoolUninitialize(&ProcContext->SendBufferPool);
+        QuicPoolUninitialize(&ProcContext->LargeSendBufferPool);
         QuicPoolUninitialize(&ProcContext->SendContextPool);
     }
 
@@ -453,9 +598,73 @@ QuicProcessorContextUninitialize(
 
     QuicPoolUninitialize(&ProcContext->RecvBlockPool);
     QuicPoolUninitialize(&ProcContext->SendBufferPool);
+    QuicPoolUninitialize(&ProcContext->LargeSendBufferPool);
     QuicPoolUninitialize(&ProcContext->SendContextPool);
 }
 
+void
+QuicDataPathQuerySockoptSupport(
+    _Inout_ QUIC_DATAPATH* Datapath
+    )
+{
+    int Result;
+    socklen_t OptionLength;
+
+    int UdpSocket = socket(AF_INET6, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP);
+    if (UdpSocket == INVALID_SOCKET_FD) {
+        QuicTraceLogWarning(
+            DatapathOpenUdpSocketFailed,
+            "[ udp] UDP send segmentation helper socket failed to open, 0x%x",
+            errno);
+        return;
+    }
+
+    //
+    // The option is only known to kernels that support UDP GSO.
+    //
+    int SegmentSize;
+    OptionLength = sizeof(SegmentSize);
+    Result =
+        getsockopt(
+            UdpSocket,
+            SOL_UDP,
+            UDP_SEGMENT,
+            &SegmentSize,
+            &OptionLength);
+    if (Result == SOCKET_ERROR) {
+        QuicTraceLogWarning(
+            DatapathQueryUdpSegmentFailed,
+            "[ udp] Query for UDP_SEGMENT failed, 0x%x",
+            errno);
+    } else {
+        Datapath->Features |= QUIC_DATAPATH_FEATURE_SEND_SEGMENTATION;
+    }
+
+    //
+    // Likewise, UDP_GRO is only known to kernels that support coalescing
+    // received UDP datagrams.
+    //
+    int GroEnabled;
+    OptionLength = sizeof(GroEnabled);
+    Result =
+        getsockopt(
+            UdpSocket,
+            SOL_UDP,
+            UDP_GRO,
+            &GroEnabled,
+            &OptionLength);
+    if (Result == SOCKET_ERROR) {
+        QuicTraceLogWarning(
+            DatapathQueryUdpGroFailed,
+            "[ udp] Query for UDP_GRO failed, 0x%x",
+            errno);
+    } else {
+        Datapath->Features |= QUIC_DATAPATH_FEATURE_RECV_COALESCING;
+    }
+
+    close(UdpSocket);
+}
+
 QUIC_STATUS
 QuicDataPathInitialize(
     _In_ uint32_t ClientRecvContextLength,
@@ -499,6 +708,23 @@ QuicDataPathInitialize(
     Datapath->MaxSendBatchSize = QUIC_MAX_BATCH_SEND;
     QuicRundownInitialize(&Datapath->BindingsRundown);
 
+    QuicDataPathQuerySockoptSupport(Datapath);
+
+    Datapath->RecvDatagramCount =
+        (Datapath->Features & QUIC_DATAPATH_FEATURE_RECV_COALESCING)
+            ? URO_MAX_DATAGRAMS_PER_INDICATION : 1;
+    Datapath->DatagramStride =
+        (uint32_t)
+        ((sizeof(QUIC_DATAPATH_RECV_DATAGRAM) +
+          ClientRecvContextLength +
+          sizeof(void*) - 1) & ~(sizeof(void*) - 1));
+    Datapath->RecvPayloadOffset =
+        sizeof(QUIC_DATAPATH_RECV_BLOCK) +
+        Datapath->RecvDatagramCount * Datapath->DatagramStride;
+    Datapath->RecvPayloadLength =
+        (Datapath->Features & QUIC_DATAPATH_FEATURE_RECV_COALESCING) ?
+            MAX_URO_PAYLOAD_LENGTH : MAX_UDP_PAYLOAD_LENGTH;
+
     //
     // Initialize the per processor contexts.
     //
@@ -557,8 +783,7 @@ QuicDataPathGetSupportedFeatures(
     _In_ QUIC_DATAPATH* Datapath
     )
 {
-    UNREFERENCED_PARAMETER(Datapath);
-    return 0;
+    return Datapath->Features;
 }
 
 BOOLEAN
@@ -569,12 +794,11 @@ QuicDataPathIsPaddingPreferred(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->DatapathIsPaddingPreferred(Datapath);
 #else
-    UNREFERENCED_PARAMETER(Datapath);
     //
-    // The windows implementation returns TRUE only if GSO is supported and
-    // this DAL implementation doesn't support GSO currently.
+    // Padding is only preferred when multiple datagrams are packed into a
+    // single contiguous buffer for segmentation offload.
     //
-    return FALSE;
+    return !!(Datapath->Features & QUIC_DATAPATH_FEATURE_SEND_SEGMENTATION);
 #endif
 }
 
@@ -591,8 +815,6 @@ QuicDataPathAllocRecvBlock(
     } else {
         QuicZeroMemory(RecvBlock, sizeof(*RecvBlock));
         RecvBlock->OwningPool = &Datapath->ProcContexts[ProcIndex].RecvBlockPool;
-        RecvBlock->RecvPacket.Buffer = RecvBlock->Buffer;
-        RecvBlock->RecvPacket.Allocated = TRUE;
     }
     return RecvBlock;
 }
@@ -859,6 +1081,26 @@ QuicSocketContextInitialize(
         goto Exit;
     }
 
+    //
+    // Enable coalescing of received datagrams from the same flow, if
+    // supported.
+    //
+    if (Binding->Datapath->Features & QUIC_DATAPATH_FEATURE_RECV_COALESCING) {
+        Option = TRUE;
+        Result =
+            setsockopt(
+                SocketContext->SocketFd,
+                SOL_UDP,
+                UDP_GRO,
+                (const void*)&Option,
+                sizeof(Option));
+        if (Result == SOCKET_ERROR) {
+            Status = errno;
+            QuicTraceEvent(DatapathErrorStatus, Binding, Status, "setsockopt(UDP_GRO) failed");
+            goto Exit;
+        }
+    }
+
     //
     // The socket is shared by multiple QUIC endpoints, so increase the receive
     // buffer size.
@@ -894,6 +1136,26 @@ QuicSocketContextInitialize(
         goto Exit;
     }
 
+    if (RemoteAddress == NULL) {
+        //
+        // Server sockets are put in a reuseport group, so that incoming
+        // packets can be steered to the socket of the receiving processor.
+        //
+        Option = TRUE;
+        Result =
+            setsockopt(
+                SocketContext->SocketFd,
+                SOL_SOCKET,
+                SO_REUSEPORT,
+                (const void*)&Option,
+                sizeof(Option));
+        if (Result == SOCKET_ERROR) {
+            Status = errno;
+            QuicTraceEvent(DatapathErrorStatus, Binding, Status, "setsockopt(SO_REUSEPORT) failed");
+            goto Exit;
+        }
+    }
+
     Result =
         bind(
             SocketContext->SocketFd,
@@ -953,6 +1215,47 @@ Exit:
     return Status;
 }
 
+void
+QuicDataPathBindingAttachCpuSteering(
+    _In_ QUIC_DATAPATH_BINDING* Binding,
+    _In_ uint32_t SocketCount
+    )
+{
+    //
+    // The sockets were added to the reuseport group in processor order, so
+    // the group index of each socket matches its processor context. The
+    // classic BPF program selects the socket by the CPU the packet was
+    // received on.
+    //
+    struct sock_filter Code[] = {
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t)(SKF_AD_OFF + SKF_AD_CPU) },
+        { BPF_ALU | BPF_MOD | BPF_K, 0, 0, SocketCount },
+        { BPF_RET | BPF_A, 0, 0, 0 }
+    };
+    struct sock_fprog Program = {
+        .len = ARRAYSIZE(Code),
+        .filter = Code
+    };
+
+    int Result =
+        setsockopt(
+            Binding->SocketContexts[0].SocketFd,
+            SOL_SOCKET,
+            SO_ATTACH_REUSEPORT_CBPF,
+            (const void*)&Program,
+            sizeof(Program));
+    if (Result == SOCKET_ERROR) {
+        //
+        // Not fatal; the kernel falls back to hashing flows across the group.
+        //
+        QuicTraceLogWarning(
+            DatapathCpuSteeringFailed,
+            "[ udp][%p] setsockopt(SO_ATTACH_REUSEPORT_CBPF) failed, 0x%x",
+            Binding,
+            errno);
+    }
+}
+
 void
 QuicSocketContextUninitialize(
     _In_ QUIC_SOCKET_CONTEXT* SocketContext,
@@ -971,8 +1274,12 @@ QuicSocketContextUninitializeComplete(
     _In_ QUIC_DATAPATH_PROC_CONTEXT* ProcContext
     )
 {
-    if (SocketContext->CurrentRecvBlock != NULL) {
-        QuicDataPathBindingReturnRecvDatagrams(&SocketContext->CurrentRecvBlock->RecvPacket);
+    for (uint32_t i = 0; i < QUIC_MAX_BATCH_RECV; ++i) {
+        if (SocketContext->CurrentRecvBlocks[i] != NULL) {
+            QuicPoolFree(
+                SocketContext->CurrentRecvBlocks[i]->OwningPool,
+                SocketContext->CurrentRecvBlocks[i]);
+        }
     }
 
     while (!QuicListIsEmpty(&SocketContext->PendingSendContextHead)) {
@@ -996,32 +1303,41 @@ QuicSocketContextPrepareReceive(
     _In_ QUIC_SOCKET_CONTEXT* SocketContext
     )
 {
-    if (SocketContext->CurrentRecvBlock == NULL) {
-        SocketContext->CurrentRecvBlock =
+    //
+    // Only the slots whose receive blocks were indicated up by the last
+    // recvmmsg need to be replenished and reset.
+    //
+    for (uint32_t i = 0; i < QUIC_MAX_BATCH_RECV; ++i) {
+        if (SocketContext->CurrentRecvBlocks[i] != NULL) {
+            continue;
+        }
+
+        QUIC_DATAPATH_RECV_BLOCK* RecvBlock =
             QuicDataPathAllocRecvBlock(
                 SocketContext->Binding->Datapath,
                 QuicProcCurrentNumber());
-        if (SocketContext->CurrentRecvBlock == NULL) {
+        if (RecvBlock == NULL) {
             QuicTraceEvent(AllocFailure, "QUIC_DATAPATH_RECV_BLOCK", 0);
             return QUIC_STATUS_OUT_OF_MEMORY;
         }
+        SocketContext->CurrentRecvBlocks[i] = RecvBlock;
+
+        SocketContext->RecvIov[i].iov_base =
+            (uint8_t*)RecvBlock + SocketContext->Binding->Datapath->RecvPayloadOffset;
+
+        struct msghdr* MsgHdr = &SocketContext->RecvMsgHdr[i].msg_hdr;
+        QuicZeroMemory(&SocketContext->RecvMsgHdr[i], sizeof(SocketContext->RecvMsgHdr[i]));
+        QuicZeroMemory(SocketContext->RecvMsgControl[i], sizeof(SocketContext->RecvMsgControl[i]));
+
+        MsgHdr->msg_name = &RecvBlock->Tuple.RemoteAddress;
+        MsgHdr->msg_namelen = sizeof(RecvBlock->Tuple.RemoteAddress);
+        MsgHdr->msg_iov = &SocketContext->RecvIov[i];
+        MsgHdr->msg_iovlen = 1;
+        MsgHdr->msg_control = SocketContext->RecvMsgControl[i];
+        MsgHdr->msg_controllen = sizeof(SocketContext->RecvMsgControl[i]);
+        MsgHdr->msg_flags = 0;
     }
 
-    SocketContext->RecvIov.iov_base = SocketContext->CurrentRecvBlock->RecvPacket.Buffer;
-    SocketContext->CurrentRecvBlock->RecvPacket.BufferLength = SocketContext->RecvIov.iov_len;
-    SocketContext->CurrentRecvBlock->RecvPacket.Tuple = (QUIC_TUPLE*)&SocketContext->CurrentRecvBlock->Tuple;
-
-    QuicZeroMemory(&SocketContext->RecvMsgHdr, sizeof(SocketContext->RecvMsgHdr));
-    QuicZeroMemory(&SocketContext->RecvMsgControl, sizeof(SocketContext->RecvMsgControl));
-
-    SocketContext->RecvMsgHdr.msg_name = &SocketContext->CurrentRecvBlock->RecvPacket.Tuple->RemoteAddress;
-    SocketContext->RecvMsgHdr.msg_namelen = sizeof(SocketContext->CurrentRecvBlock->RecvPacket.Tuple->RemoteAddress);
-    SocketContext->RecvMsgHdr.msg_iov = &SocketContext->RecvIov;
-    SocketContext->RecvMsgHdr.msg_iovlen = 1;
-    SocketContext->RecvMsgHdr.msg_control = SocketContext->RecvMsgControl;
-    SocketContext->RecvMsgHdr.msg_controllen = sizeof(SocketContext->RecvMsgControl);
-    SocketContext->RecvMsgHdr.msg_flags = 0;
-
     return QUIC_STATUS_SUCCESS;
 }
 
@@ -1069,69 +1385,157 @@ void
 QuicSocketContextRecvComplete(
     _In_ QUIC_SOCKET_CONTEXT* SocketContext,
     _In_ QUIC_DATAPATH_PROC_CONTEXT* ProcContext,
-    _In_ ssize_t BytesTransferred
+    _In_ int MessageCount
     )
 {
     QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    QUIC_DATAPATH* Datapath = SocketContext->Binding->Datapath;
+    QUIC_RECV_DATAGRAM* DatagramChain = NULL;
+    QUIC_RECV_DATAGRAM** DatagramChainTail = &DatagramChain;
 
-    QUIC_DBG_ASSERT(SocketContext->CurrentRecvBlock != NULL);
-    QUIC_RECV_DATAGRAM* RecvPacket = &SocketContext->CurrentRecvBlock->RecvPacket;
-    SocketContext->CurrentRecvBlock = NULL;
-
-    BOOLEAN FoundLocalAddr = FALSE;
-    QUIC_ADDR* LocalAddr = &RecvPacket->Tuple->LocalAddress;
-    QUIC_ADDR* RemoteAddr = &RecvPacket->Tuple->RemoteAddress;
-    QuicConvertFromMappedV6(RemoteAddr, RemoteAddr);
-
-    struct cmsghdr *CMsg;
-    for (CMsg = CMSG_FIRSTHDR(&SocketContext->RecvMsgHdr);
-         CMsg != NULL;
-         CMsg = CMSG_NXTHDR(&SocketContext->RecvMsgHdr, CMsg)) {
-
-        if (CMsg->cmsg_level == IPPROTO_IPV6 &&
-            CMsg->cmsg_type == IPV6_PKTINFO) {
-            struct in6_pktinfo* PktInfo6 = (struct in6_pktinfo*) CMSG_DATA(CMsg);
-            LocalAddr->si_family = AF_INET6;
-            LocalAddr->Ipv6.sin6_addr = PktInfo6->ipi6_addr;
-            LocalAddr->Ipv6.sin6_port = SocketContext->Binding->LocalAddress.Ipv6.sin6_port;
-            QuicConvertFromMappedV6(LocalAddr, LocalAddr);
-
-            LocalAddr->Ipv6.sin6_scope_id = PktInfo6->ipi6_ifindex;
-            FoundLocalAddr = TRUE;
-            break;
+    QUIC_DBG_ASSERT(MessageCount > 0 && MessageCount <= QUIC_MAX_BATCH_RECV);
+
+    for (int i = 0; i < MessageCount; ++i) {
+
+        QUIC_DBG_ASSERT(SocketContext->CurrentRecvBlocks[i] != NULL);
+        QUIC_DATAPATH_RECV_BLOCK* RecvBlock = SocketContext->CurrentRecvBlocks[i];
+        SocketContext->CurrentRecvBlocks[i] = NULL;
+
+        struct msghdr* MsgHdr = &SocketContext->RecvMsgHdr[i].msg_hdr;
+        uint32_t BytesTransferred = SocketContext->RecvMsgHdr[i].msg_len;
+        uint32_t MessageLength = BytesTransferred;
+        BOOLEAN IsCoalesced = FALSE;
+
+        BOOLEAN FoundLocalAddr = FALSE;
+        QUIC_ADDR* LocalAddr = &RecvBlock->Tuple.LocalAddress;
+        QUIC_ADDR* RemoteAddr = &RecvBlock->Tuple.RemoteAddress;
+        QuicConvertFromMappedV6(RemoteAddr, RemoteAddr);
+
+        //
+        // Dual-mode sockets receive both packet info types; only the first one
+        // is used, but the whole list is walked to find the GRO segment size.
+        //
+        struct cmsghdr *CMsg;
+        for (CMsg = CMSG_FIRSTHDR(MsgHdr);
+             CMsg != NULL;
+             CMsg = CMSG_NXTHDR(MsgHdr, CMsg)) {
+
+            if (!FoundLocalAddr &&
+                CMsg->cmsg_level == IPPROTO_IPV6 &&
+                CMsg->cmsg_type == IPV6_PKTINFO) {
+                struct in6_pktinfo* PktInfo6 = (struct in6_pktinfo*) CMSG_DATA(CMsg);
+                LocalAddr->si_family = AF_INET6;
+                LocalAddr->Ipv6.sin6_addr = PktInfo6->ipi6_addr;
+                LocalAddr->Ipv6.sin6_port = SocketContext->Binding->LocalAddress.Ipv6.sin6_port;
+                QuicConvertFromMappedV6(LocalAddr, LocalAddr);
+
+                LocalAddr->Ipv6.sin6_scope_id = PktInfo6->ipi6_ifindex;
+                FoundLocalAddr = TRUE;
+
+            } else if (!FoundLocalAddr &&
+                       CMsg->cmsg_level == IPPROTO_IP &&
+                       CMsg->cmsg_type == IP_PKTINFO) {
+                struct in_pktinfo* PktInfo = (struct in_pktinfo*)CMSG_DATA(CMsg);
+                LocalAddr->si_family = AF_INET;
+                LocalAddr->Ipv4.sin_addr = PktInfo->ipi_addr;
+                LocalAddr->Ipv4.sin_port = SocketContext->Binding->LocalAddress.Ipv6.sin6_port;
+                LocalAddr->Ipv6.sin6_scope_id = PktInfo->ipi_ifindex;
+                FoundLocalAddr = TRUE;
+
+            } else if (CMsg->cmsg_level == SOL_UDP && CMsg->cmsg_type == UDP_GRO) {
+                //
+                // The kernel coalesced multiple datagrams from the same flow;
+                // all but the last are exactly this size.
+                //
+                MessageLength = (uint32_t)*(int*)CMSG_DATA(CMsg);
+                IsCoalesced = TRUE;
+            }
         }
 
-        if (CMsg->cmsg_level == IPPROTO_IP && CMsg->cmsg_type == IP_PKTINFO) {
-            struct in_pktinfo* PktInfo = (struct in_pktinfo*)CMSG_DATA(CMsg);
-            LocalAddr->si_family = AF_INET;
-            LocalAddr->Ipv4.sin_addr = PktInfo->ipi_addr;
-            LocalAddr->Ipv4.sin_port = SocketContext->Binding->LocalAddress.Ipv6.sin6_port;
-            LocalAddr->Ipv6.sin6_scope_id = PktInfo->ipi_ifindex;
-            FoundLocalAddr = TRUE;
-            break;
+        QUIC_FRE_ASSERT(FoundLocalAddr);
+
+        if (BytesTransferred == 0 || MessageLength == 0) {
+            QuicTraceLogWarning(
+                DatapathRecvEmpty,
+                "[ udp][%p] Dropping datagram with empty payload.",
+                SocketContext->Binding);
+            QuicPoolFree(RecvBlock->OwningPool, RecvBlock);
+            continue;
         }
-    }
 
-    QUIC_FRE_ASSERT(FoundLocalAddr);
+        QuicTraceEvent(
+            DatapathRecv,
+            SocketContext->Binding,
+            BytesTransferred,
+            MessageLength,
+            LOG_ADDR_LEN(*LocalAddr), LOG_ADDR_LEN(*RemoteAddr),
+            (uint8_t*)LocalAddr, (uint8_t*)RemoteAddr);
+
+        QUIC_DBG_ASSERT(BytesTransferred <= SocketContext->RecvIov[i].iov_len);
+
+        //
+        // Split the payload into its datagrams, each of which points into the
+        // shared receive block.
+        //
+        uint8_t* RecvPayload = (uint8_t*)RecvBlock + Datapath->RecvPayloadOffset;
+        QUIC_DATAPATH_RECV_DATAGRAM* RecvDatagram =
+            (QUIC_DATAPATH_RECV_DATAGRAM*)(RecvBlock + 1);
+        uint32_t DatagramCount = 0;
+
+        for ( ;
+            BytesTransferred != 0;
+            BytesTransferred -= MessageLength) {
+
+            if (DatagramCount == Datapath->RecvDatagramCount) {
+                QUIC_DBG_ASSERT(IsCoalesced);
+                QuicTraceLogWarning(
+                    DatapathUroPreallocExceeded,
+                    "[ udp][%p] Exceeded URO preallocation capacity.",
+                    SocketContext->Binding);
+                break;
+            }
+
+            if (MessageLength > BytesTransferred) {
+                //
+                // The last message is smaller than all the rest.
+                //
+                MessageLength = BytesTransferred;
+            }
 
-    QuicTraceEvent(
-        DatapathRecv,
-        SocketContext->Binding,
-        (uint32_t)BytesTransferred,
-        (uint32_t)BytesTransferred,
-        LOG_ADDR_LEN(*LocalAddr), LOG_ADDR_LEN(*RemoteAddr),
-        (uint8_t*)LocalAddr, (uint8_t*)RemoteAddr);
+            QUIC_RECV_DATAGRAM* Datagram = &RecvDatagram->RecvPacket;
+            RecvDatagram->RecvBlock = RecvBlock;
 
-    QUIC_DBG_ASSERT(BytesTransferred <= RecvPacket->BufferLength);
-    RecvPacket->BufferLength = BytesTransferred;
+            Datagram->Next = NULL;
+            Datagram->Buffer = RecvPayload;
+            Datagram->BufferLength = (uint16_t)MessageLength;
+            Datagram->Tuple = &RecvBlock->Tuple;
+            Datagram->PartitionIndex = (uint8_t)ProcContext->Index;
+            Datagram->Allocated = TRUE;
+            Datagram->QueuedOnConnection = FALSE;
 
-    RecvPacket->PartitionIndex = ProcContext->Index;
+            RecvPayload += MessageLength;
 
-    QUIC_DBG_ASSERT(SocketContext->Binding->Datapath->RecvHandler);
-    SocketContext->Binding->Datapath->RecvHandler(
-        SocketContext->Binding,
-        SocketContext->Binding->ClientContext,
-        RecvPacket);
+            //
+            // Add the datagram to the end of the current chain.
+            //
+            *DatagramChainTail = Datagram;
+            DatagramChainTail = &Datagram->Next;
+            RecvBlock->ReferenceCount++;
+            DatagramCount++;
+
+            RecvDatagram =
+                (QUIC_DATAPATH_RECV_DATAGRAM*)
+                    ((uint8_t*)RecvDatagram + Datapath->DatagramStride);
+        }
+    }
+
+    if (DatagramChain != NULL) {
+        QUIC_DBG_ASSERT(Datapath->RecvHandler);
+        Datapath->RecvHandler(
+            SocketContext->Binding,
+            SocketContext->Binding->ClientContext,
+            DatagramChain);
+    }
 
     Status = QuicSocketContextPrepareReceive(SocketContext);
 
@@ -1322,18 +1726,24 @@ QuicSocketContextProcessEvents(
 
     if (EPOLLIN & Events) {
         while (TRUE) {
-            QUIC_DBG_ASSERT(SocketContext->CurrentRecvBlock != NULL);
-
-            ssize_t Ret =
-                recvmsg(
+            //
+            // Pull as many datagrams as are queued (up to the batch size) with
+            // a single syscall and indicate them up as one chain.
+            //
+            int Ret =
+                recvmmsg(
                     SocketContext->SocketFd,
-                    &SocketContext->RecvMsgHdr,
-                    0);
+                    SocketContext->RecvMsgHdr,
+                    QUIC_MAX_BATCH_RECV,
+                    0,
+                    NULL);
             if (Ret < 0) {
                 if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                    QuicTraceEvent(LibraryErrorStatus, errno, "recvmsg failed");
+                    QuicTraceEvent(LibraryErrorStatus, errno, "recvmmsg failed");
                 }
                 break;
+            } else if (Ret == 0) {
+                break;
             } else {
                 QuicSocketContextRecvComplete(SocketContext, ProcContext, Ret);
             }
@@ -1369,7 +1779,14 @@ QuicDataPathBindingCreate(
 #else
     QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
 
-    uint32_t SocketCount = Datapath->ProcCount; // TODO - Only use 1 for client (RemoteAddress != NULL) bindings?
+    //
+    // Connected bindings only ever receive from a single remote address, so
+    // one socket is enough. It is serviced by the proc context of the calling
+    // thread, which is generally the connection's worker, running on its
+    // ideal processor.
+    //
+    uint32_t SocketCount = RemoteAddress != NULL ? 1 : Datapath->ProcCount;
+    uint32_t ClientProcIndex = QuicProcCurrentNumber() % Datapath->ProcCount;
     size_t BindingLength =
         sizeof(QUIC_DATAPATH_BINDING) +
         SocketCount * sizeof(QUIC_SOCKET_CONTEXT);
@@ -1391,6 +1808,7 @@ QuicDataPathBindingCreate(
     Binding->Datapath = Datapath;
     Binding->ClientContext = RecvCallbackContext;
     Binding->Mtu = QUIC_MAX_MTU;
+    Binding->SocketCount = SocketCount;
     QuicRundownInitialize(&Binding->Rundown);
     if (LocalAddress) {
         QuicConvertToMappedV6(LocalAddress, &Binding->LocalAddress);
@@ -1399,9 +1817,15 @@ QuicDataPathBindingCreate(
     }
     for (uint32_t i = 0; i < SocketCount; i++) {
         Binding->SocketContexts[i].Binding = Binding;
+        Binding->SocketContexts[i].ProcContext =
+            &Datapath->ProcContexts[RemoteAddress != NULL ? ClientProcIndex : i];
         Binding->SocketContexts[i].SocketFd = INVALID_SOCKET_FD;
-        Binding->SocketContexts[i].RecvIov.iov_len =
-            Binding->Mtu - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE;
+        for (uint32_t j = 0; j < QUIC_MAX_BATCH_RECV; j++) {
+            Binding->SocketContexts[i].RecvIov[j].iov_len =
+                (Datapath->Features & QUIC_DATAPATH_FEATURE_RECV_COALESCING) ?
+                    Datapath->RecvPayloadLength :
+                    (uint32_t)(Binding->Mtu - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE);
+        }
         QuicListInitializeHead(&Binding->SocketContexts[i].PendingSendContextHead);
         QuicRundownAcquire(&Binding->Rundown);
     }
@@ -1412,7 +1836,7 @@ QuicDataPathBindingCreate(
         Status =
             QuicSocketContextInitialize(
                 &Binding->SocketContexts[i],
-                &Datapath->ProcContexts[i],
+                Binding->SocketContexts[i].ProcContext,
                 LocalAddress,
                 RemoteAddress);
         if (QUIC_FAILED(Status)) {
@@ -1420,6 +1844,10 @@ QuicDataPathBindingCreate(
         }
     }
 
+    if (RemoteAddress == NULL && SocketCount > 1) {
+        QuicDataPathBindingAttachCpuSteering(Binding, SocketCount);
+    }
+
     QuicConvertFromMappedV6(&Binding->LocalAddress, &Binding->LocalAddress);
     Binding->LocalAddress.Ipv6.sin6_scope_id = 0;
 
@@ -1435,11 +1863,11 @@ QuicDataPathBindingCreate(
     //
     *NewBinding = Binding;
 
-    for (uint32_t i = 0; i < Binding->Datapath->ProcCount; i++) {
+    for (uint32_t i = 0; i < SocketCount; i++) {
         Status =
             QuicSocketContextStartReceive(
                 &Binding->SocketContexts[i],
-                Datapath->ProcContexts[i].EpollFd);
+                Binding->SocketContexts[i].ProcContext->EpollFd);
         if (QUIC_FAILED(Status)) {
             goto Exit;
         }
@@ -1485,10 +1913,10 @@ QuicDataPathBindingDelete(
     //
 
     Binding->Shutdown = TRUE;
-    for (uint32_t i = 0; i < Binding->Datapath->ProcCount; ++i) {
+    for (uint32_t i = 0; i < Binding->SocketCount; ++i) {
         QuicSocketContextUninitialize(
             &Binding->SocketContexts[i],
-            &Binding->Datapath->ProcContexts[i]);
+            Binding->SocketContexts[i].ProcContext);
     }
 
     QuicRundownReleaseAndWait(&Binding->Rundown);
@@ -1583,11 +2011,11 @@ QuicDataPathRecvPacketToRecvDatagram(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->DatapathRecvContextToRecvPacket(RecvContext);
 #else
-    QUIC_DATAPATH_RECV_BLOCK* RecvBlock =
-        (QUIC_DATAPATH_RECV_BLOCK*)
-            ((char *)RecvContext - sizeof(QUIC_DATAPATH_RECV_BLOCK));
+    QUIC_DATAPATH_RECV_DATAGRAM* RecvDatagram =
+        (QUIC_DATAPATH_RECV_DATAGRAM*)
+            ((char *)RecvContext - sizeof(QUIC_DATAPATH_RECV_DATAGRAM));
 
-    return &RecvBlock->RecvPacket;
+    return &RecvDatagram->RecvPacket;
 #endif
 }
 
@@ -1599,10 +2027,10 @@ QuicDataPathRecvDatagramToRecvPacket(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->DatapathRecvPacketToRecvContext(RecvPacket);
 #else
-    QUIC_DATAPATH_RECV_BLOCK* RecvBlock =
-        QUIC_CONTAINING_RECORD(RecvPacket, QUIC_DATAPATH_RECV_BLOCK, RecvPacket);
+    QUIC_DATAPATH_RECV_DATAGRAM* RecvDatagram =
+        QUIC_CONTAINING_RECORD(RecvPacket, QUIC_DATAPATH_RECV_DATAGRAM, RecvPacket);
 
-    return (QUIC_RECV_PACKET*)(RecvBlock + 1);
+    return (QUIC_RECV_PACKET*)(RecvDatagram + 1);
 #endif
 }
 
@@ -1617,11 +2045,40 @@ QuicDataPathBindingReturnRecvDatagrams(
     }
 #else
     QUIC_RECV_DATAGRAM* Datagram;
+
+    //
+    // Consecutive datagrams from the same receive block are released with a
+    // single interlocked operation.
+    //
+    int64_t BatchedBufferCount = 0;
+    QUIC_DATAPATH_RECV_BLOCK* BatchedRecvBlock = NULL;
+
     while ((Datagram = DatagramChain) != NULL) {
         DatagramChain = DatagramChain->Next;
+
         QUIC_DATAPATH_RECV_BLOCK* RecvBlock =
-            QUIC_CONTAINING_RECORD(Datagram, QUIC_DATAPATH_RECV_BLOCK, RecvPacket);
-        QuicPoolFree(RecvBlock->OwningPool, RecvBlock);
+            QUIC_CONTAINING_RECORD(Datagram, QUIC_DATAPATH_RECV_DATAGRAM, RecvPacket)->RecvBlock;
+
+        if (BatchedRecvBlock == RecvBlock) {
+            BatchedBufferCount++;
+        } else {
+            if (BatchedRecvBlock != NULL &&
+                InterlockedExchangeAdd64(
+                    &BatchedRecvBlock->ReferenceCount,
+                    -BatchedBufferCount) == BatchedBufferCount) {
+                QuicPoolFree(BatchedRecvBlock->OwningPool, BatchedRecvBlock);
+            }
+
+            BatchedRecvBlock = RecvBlock;
+            BatchedBufferCount = 1;
+        }
+    }
+
+    if (BatchedRecvBlock != NULL &&
+        InterlockedExchangeAdd64(
+            &BatchedRecvBlock->ReferenceCount,
+            -BatchedBufferCount) == BatchedBufferCount) {
+        QuicPoolFree(BatchedRecvBlock->OwningPool, BatchedRecvBlock);
     }
 #endif
 }
@@ -1638,7 +2095,6 @@ QuicDataPathBindingAllocSendContext(
             Binding,
             MaxPacketSize);
 #else
-    UNREFERENCED_PARAMETER(MaxPacketSize);
     QUIC_DBG_ASSERT(Binding != NULL);
 
     QUIC_DATAPATH_PROC_CONTEXT* ProcContext =
@@ -1652,6 +2108,9 @@ QuicDataPathBindingAllocSendContext(
 
     QuicZeroMemory(SendContext, sizeof(*SendContext));
     SendContext->Owner = ProcContext;
+    SendContext->SegmentSize =
+        (Binding->Datapath->Features & QUIC_DATAPATH_FEATURE_SEND_SEGMENTATION)
+            ? MaxPacketSize : 0;
 
 Exit:
 
@@ -1667,11 +2126,14 @@ QuicDataPathBindingFreeSendContext(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     PlatDispatch->DatapathBindingFreeSendContext(SendContext);
 #else
+    QUIC_POOL* BufferPool =
+        SendContext->SegmentSize > 0 ?
+            &SendContext->Owner->LargeSendBufferPool :
+            &SendContext->Owner->SendBufferPool;
+
     size_t i = 0;
     for (i = 0; i < SendContext->BufferCount; ++i) {
-        QuicPoolFree(
-            &SendContext->Owner->SendBufferPool,
-            SendContext->Buffers[i].Buffer);
+        QuicPoolFree(BufferPool, SendContext->Buffers[i].Buffer);
         SendContext->Buffers[i].Buffer = NULL;
     }
 
@@ -1679,6 +2141,149 @@ QuicDataPathBindingFreeSendContext(
 #endif
 }
 
+static
+BOOLEAN
+QuicSendContextCanAllocSendSegment(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+    QUIC_DBG_ASSERT(SendContext->SegmentSize > 0);
+    QUIC_DBG_ASSERT(SendContext->BufferCount > 0);
+    QUIC_DBG_ASSERT(SendContext->BufferCount <= SendContext->Owner->Datapath->MaxSendBatchSize);
+
+    size_t BytesAvailable =
+        QUIC_LARGE_SEND_BUFFER_SIZE -
+            SendContext->Buffers[SendContext->BufferCount - 1].Length -
+            SendContext->ClientBuffer.Length;
+
+    return MaxBufferLength <= BytesAvailable;
+}
+
+static
+BOOLEAN
+QuicSendContextCanAllocSend(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+    return
+        (SendContext->BufferCount < SendContext->Owner->Datapath->MaxSendBatchSize) ||
+        ((SendContext->SegmentSize > 0) &&
+            QuicSendContextCanAllocSendSegment(SendContext, MaxBufferLength));
+}
+
+static
+void
+QuicSendContextFinalizeSendBuffer(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext
+    )
+{
+    if (SendContext->ClientBuffer.Length == 0) {
+        //
+        // There is no buffer segment outstanding at the client.
+        //
+        return;
+    }
+
+    QUIC_DBG_ASSERT(SendContext->SegmentSize > 0 && SendContext->BufferCount > 0);
+    QUIC_DBG_ASSERT(SendContext->ClientBuffer.Length > 0 && SendContext->ClientBuffer.Length <= SendContext->SegmentSize);
+    QUIC_DBG_ASSERT(QuicSendContextCanAllocSendSegment(SendContext, 0));
+
+    //
+    // Append the client's buffer segment to our internal send buffer.
+    //
+    SendContext->Buffers[SendContext->BufferCount - 1].Length +=
+        SendContext->ClientBuffer.Length;
+
+    if (SendContext->ClientBuffer.Length == SendContext->SegmentSize) {
+        SendContext->ClientBuffer.Buffer += SendContext->SegmentSize;
+        SendContext->ClientBuffer.Length = 0;
+    } else {
+        //
+        // The next segment allocation must create a new backing buffer.
+        //
+        SendContext->ClientBuffer.Buffer = NULL;
+        SendContext->ClientBuffer.Length = 0;
+    }
+}
+
+_Success_(return != NULL)
+static
+QUIC_BUFFER*
+QuicSendContextAllocBuffer(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ QUIC_POOL* BufferPool
+    )
+{
+    QUIC_DBG_ASSERT(SendContext->BufferCount < SendContext->Owner->Datapath->MaxSendBatchSize);
+
+    QUIC_BUFFER* Buffer = &SendContext->Buffers[SendContext->BufferCount];
+    Buffer->Buffer = QuicPoolAlloc(BufferPool);
+    if (Buffer->Buffer == NULL) {
+        QuicTraceEvent(AllocFailure, "Send Buffer", 0);
+        return NULL;
+    }
+    ++SendContext->BufferCount;
+
+    return Buffer;
+}
+
+_Success_(return != NULL)
+static
+QUIC_BUFFER*
+QuicSendContextAllocPacketBuffer(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+    QUIC_BUFFER* Buffer =
+        QuicSendContextAllocBuffer(SendContext, &SendContext->Owner->SendBufferPool);
+    if (Buffer != NULL) {
+        Buffer->Length = MaxBufferLength;
+    }
+    return Buffer;
+}
+
+_Success_(return != NULL)
+static
+QUIC_BUFFER*
+QuicSendContextAllocSegmentBuffer(
+    _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+    QUIC_DBG_ASSERT(SendContext->SegmentSize > 0);
+    QUIC_DBG_ASSERT(MaxBufferLength <= SendContext->SegmentSize);
+
+    if (SendContext->ClientBuffer.Buffer != NULL &&
+        QuicSendContextCanAllocSendSegment(SendContext, MaxBufferLength)) {
+
+        //
+        // All clear to return the next segment of our contiguous buffer.
+        //
+        SendContext->ClientBuffer.Length = MaxBufferLength;
+        return &SendContext->ClientBuffer;
+    }
+
+    QUIC_BUFFER* Buffer =
+        QuicSendContextAllocBuffer(SendContext, &SendContext->Owner->LargeSendBufferPool);
+    if (Buffer == NULL) {
+        return NULL;
+    }
+
+    //
+    // Provide a virtual QUIC_BUFFER to the client. Once the client has
+    // committed to a final send size, we'll append it to our internal backing
+    // buffer.
+    //
+    Buffer->Length = 0;
+    SendContext->ClientBuffer.Buffer = Buffer->Buffer;
+    SendContext->ClientBuffer.Length = MaxBufferLength;
+
+    return &SendContext->ClientBuffer;
+}
+
 QUIC_BUFFER*
 QuicDataPathBindingAllocSendDatagram(
     _In_ QUIC_DATAPATH_SEND_CONTEXT* SendContext,
@@ -1691,36 +2296,21 @@ QuicDataPathBindingAllocSendDatagram(
             SendContext,
             MaxBufferLength);
 #else
-    QUIC_BUFFER* Buffer = NULL;
-
     QUIC_DBG_ASSERT(SendContext != NULL);
     QUIC_DBG_ASSERT(MaxBufferLength <= QUIC_MAX_MTU - QUIC_MIN_IPV4_HEADER_SIZE - QUIC_UDP_HEADER_SIZE);
 
-    if (SendContext->BufferCount ==
-            SendContext->Owner->Datapath->MaxSendBatchSize) {
+    QuicSendContextFinalizeSendBuffer(SendContext);
+
+    if (!QuicSendContextCanAllocSend(SendContext, MaxBufferLength)) {
         QuicTraceEvent(LibraryError, "Max batch size limit hit");
-        goto Exit;
+        return NULL;
     }
 
-    Buffer = &SendContext->Buffers[SendContext->BufferCount];
-    QuicZeroMemory(Buffer, sizeof(*Buffer));
-
-    Buffer->Buffer = QuicPoolAlloc(&SendContext->Owner->SendBufferPool);
-    if (Buffer->Buffer == NULL) {
-        QuicTraceEvent(AllocFailure, "Send Buffer", 0);
-        goto Exit;
+    if (SendContext->SegmentSize == 0) {
+        return QuicSendContextAllocPacketBuffer(SendContext, MaxBufferLength);
+    } else {
+        return QuicSendContextAllocSegmentBuffer(SendContext, MaxBufferLength);
     }
-
-    Buffer->Length = MaxBufferLength;
-
-    SendContext->Iovs[SendContext->BufferCount].iov_base = Buffer->Buffer;
-    SendContext->Iovs[SendContext->BufferCount].iov_len = Buffer->Length;
-
-    ++SendContext->BufferCount;
-
-Exit:
-
-    return Buffer;
 #endif
 }
 
@@ -1733,12 +2323,29 @@ QuicDataPathBindingFreeSendDatagram(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     PlatDispatch->DatapathBindingFreeSendBuffer(SendContext, Datagram);
 #else
-    QuicPoolFree(&SendContext->Owner->SendBufferPool, Datagram->Buffer);
-    Datagram->Buffer == NULL;
+    //
+    // This must be the final send buffer; intermediate buffers cannot be freed.
+    //
+    QUIC_BUFFER* TailBuffer = &SendContext->Buffers[SendContext->BufferCount - 1];
+
+    if (SendContext->SegmentSize == 0) {
+        QUIC_DBG_ASSERT(Datagram == TailBuffer);
 
-    QUIC_DBG_ASSERT(Datagram == &SendContext->Buffers[SendContext->BufferCount - 1]);
+        QuicPoolFree(&SendContext->Owner->SendBufferPool, Datagram->Buffer);
+        Datagram->Buffer = NULL;
+        --SendContext->BufferCount;
+    } else {
+        QUIC_DBG_ASSERT(Datagram->Buffer == TailBuffer->Buffer + TailBuffer->Length);
+
+        if (TailBuffer->Length == 0) {
+            QuicPoolFree(&SendContext->Owner->LargeSendBufferPool, TailBuffer->Buffer);
+            TailBuffer->Buffer = NULL;
+            --SendContext->BufferCount;
+        }
 
-    --SendContext->BufferCount;
+        SendContext->ClientBuffer.Buffer = NULL;
+        SendContext->ClientBuffer.Length = 0;
+    }
 #endif
 }
 
@@ -1753,9 +2360,8 @@ QuicDataPathBindingSend(
     QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
     QUIC_SOCKET_CONTEXT* SocketContext = NULL;
     QUIC_DATAPATH_PROC_CONTEXT* ProcContext = NULL;
-    ssize_t SentByteCount = 0;
+    int SentMessageCount = 0;
     size_t i = 0;
-    socklen_t RemoteAddrLen = 0;
     QUIC_ADDR MappedRemoteAddress = {0};
     struct cmsghdr *CMsg = NULL;
     struct in_pktinfo *PktInfo = NULL;
@@ -1763,91 +2369,64 @@ QuicDataPathBindingSend(
     BOOLEAN SendPending = FALSE;
 
     static_assert(CMSG_SPACE(sizeof(struct in6_pktinfo)) >= CMSG_SPACE(sizeof(struct in_pktinfo)), "sizeof(struct in6_pktinfo) >= sizeof(struct in_pktinfo) failed");
-    char ControlBuffer[CMSG_SPACE(sizeof(struct in6_pktinfo))] = {0};
+    char ControlBuffer[
+        CMSG_SPACE(sizeof(struct in6_pktinfo)) +
+        CMSG_SPACE(sizeof(uint16_t))] = {0};
+    struct mmsghdr Mhdrs[QUIC_MAX_BATCH_SEND];
 
     QUIC_DBG_ASSERT(Binding != NULL && RemoteAddress != NULL && SendContext != NULL);
 
-    SocketContext = &Binding->SocketContexts[QuicProcCurrentNumber()];
-    ProcContext = &Binding->Datapath->ProcContexts[QuicProcCurrentNumber()];
+    QuicSendContextFinalizeSendBuffer(SendContext);
+
+    QUIC_DBG_ASSERT(SendContext->CurrentIndex < SendContext->BufferCount);
+
+    SocketContext =
+        &Binding->SocketContexts[QuicProcCurrentNumber() % Binding->SocketCount];
+    ProcContext = SocketContext->ProcContext;
 
-    RemoteAddrLen =
-        (AF_INET == RemoteAddress->si_family) ?
-            sizeof(RemoteAddress->Ipv4) : sizeof(RemoteAddress->Ipv6);
+    //
+    // All datagrams in the batch share the same addressing information, so
+    // the name and control buffer are set up once and referenced by each
+    // message header.
+    //
+    void* MsgName;
+    socklen_t MsgNameLength;
+    size_t MsgControlLength = 0;
+    struct msghdr ControlMhdr = {
+        .msg_control = ControlBuffer,
+        .msg_controllen = sizeof(ControlBuffer)
+    };
+    CMsg = CMSG_FIRSTHDR(&ControlMhdr);
+
+    uint32_t TotalSize = 0;
+    for (i = SendContext->CurrentIndex; i < SendContext->BufferCount; ++i) {
+        TotalSize += SendContext->Buffers[i].Length;
+    }
 
     if (LocalAddress == NULL) {
         QUIC_DBG_ASSERT(Binding->RemoteAddress.Ipv4.sin_port != 0);
 
-        for (i = SendContext->CurrentIndex;
-            i < SendContext->BufferCount;
-            ++i, SendContext->CurrentIndex++) {
-
-            QuicTraceEvent(
-                DatapathSendTo,
-                Binding,
-                SendContext->Buffers[i].Length,
-                1,
-                SendContext->Buffers[i].Length,
-                LOG_ADDR_LEN(*RemoteAddress), (uint8_t*)RemoteAddress);
+        QuicTraceEvent(
+            DatapathSendTo,
+            Binding,
+            TotalSize,
+            SendContext->BufferCount - SendContext->CurrentIndex,
+            SendContext->SegmentSize,
+            LOG_ADDR_LEN(*RemoteAddress), (uint8_t*)RemoteAddress);
 
-            SentByteCount =
-                sendto(
-                    SocketContext->SocketFd,
-                    SendContext->Buffers[i].Buffer,
-                    SendContext->Buffers[i].Length,
-                    0,
-                    (struct sockaddr *)RemoteAddress,
-                    RemoteAddrLen);
-
-            if (SentByteCount < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    Status =
-                        QuicSocketContextPendSend(
-                            SocketContext,
-                            SendContext,
-                            ProcContext,
-                            LocalAddress,
-                            RemoteAddress);
-                    if (QUIC_FAILED(Status)) {
-                        goto Exit;
-                    }
-
-                    SendPending = TRUE;
-                    goto Exit;
-                } else {
-                    //
-                    // Completed with error.
-                    //
+        MsgName = (void*)RemoteAddress;
+        MsgNameLength =
+            (AF_INET == RemoteAddress->si_family) ?
+                sizeof(RemoteAddress->Ipv4) : sizeof(RemoteAddress->Ipv6);
 
-                    Status = errno;
-                    QuicTraceEvent(DatapathErrorStatus, SocketContext->Binding, Status, "sendto failed");
-                    goto Exit;
-                }
-            } else {
-                //
-                // Completed synchronously.
-                //
-                QuicTraceLogVerbose(
-                    DatapathSendToCompleted,
-                    "[ udp][%p] sendto succeeded, bytes transferred %d",
-                    SocketContext->Binding,
-                    SentByteCount);
-            }
-        }
     } else {
 
-        uint32_t TotalSize = 0;
-        for (i = 0; i < SendContext->BufferCount; ++i) {
-            SendContext->Iovs[i].iov_base = SendContext->Buffers[i].Buffer;
-            SendContext->Iovs[i].iov_len = SendContext->Buffers[i].Length;
-            TotalSize += SendContext->Buffers[i].Length;
-        }
-
         QuicTraceEvent(
             DatapathSendFromTo,
             Binding,
             TotalSize,
-            SendContext->BufferCount,
-            SendContext->Buffers[0].Length,
+            SendContext->BufferCount - SendContext->CurrentIndex,
+            SendContext->SegmentSize,
             LOG_ADDR_LEN(*RemoteAddress), LOG_ADDR_LEN(*LocalAddress),
             (uint8_t*)RemoteAddress, (uint8_t*)LocalAddress);
 
@@ -1855,22 +2434,12 @@ QuicDataPathBindingSend(
         // Map V4 address to dual-stack socket format.
         //
         QuicConvertToMappedV6(RemoteAddress, &MappedRemoteAddress);
-
-        struct msghdr Mhdr = {
-            .msg_name = &MappedRemoteAddress,
-            .msg_namelen = sizeof(MappedRemoteAddress),
-            .msg_iov = SendContext->Iovs,
-            .msg_iovlen = SendContext->BufferCount,
-            .msg_flags = 0
-        };
-
-        // TODO: Avoid allocating both.
+        MsgName = &MappedRemoteAddress;
+        MsgNameLength = sizeof(MappedRemoteAddress);
 
         if (LocalAddress->si_family == AF_INET) {
-            Mhdr.msg_control = ControlBuffer;
-            Mhdr.msg_controllen = CMSG_SPACE(sizeof(struct in_pktinfo));
+            MsgControlLength += CMSG_SPACE(sizeof(struct in_pktinfo));
 
-            CMsg = CMSG_FIRSTHDR(&Mhdr);
             CMsg->cmsg_level = IPPROTO_IP;
             CMsg->cmsg_type = IP_PKTINFO;
             CMsg->cmsg_len = CMSG_LEN(sizeof(struct in_pktinfo));
@@ -1880,10 +2449,8 @@ QuicDataPathBindingSend(
             PktInfo->ipi_ifindex = LocalAddress->Ipv6.sin6_scope_id;
             PktInfo->ipi_addr = LocalAddress->Ipv4.sin_addr;
         } else {
-            Mhdr.msg_control = ControlBuffer;
-            Mhdr.msg_controllen = CMSG_SPACE(sizeof(struct in6_pktinfo));
+            MsgControlLength += CMSG_SPACE(sizeof(struct in6_pktinfo));
 
-            CMsg = CMSG_FIRSTHDR(&Mhdr);
             CMsg->cmsg_level = IPPROTO_IPV6;
             CMsg->cmsg_type = IPV6_PKTINFO;
             CMsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
@@ -1893,10 +2460,58 @@ QuicDataPathBindingSend(
             PktInfo6->ipi6_addr = LocalAddress->Ipv6.sin6_addr;
         }
 
-        SentByteCount = sendmsg(SocketContext->SocketFd, &Mhdr, 0);
+        CMsg = CMSG_NXTHDR(&ControlMhdr, CMsg);
+    }
+
+    if (SendContext->SegmentSize > 0) {
+        //
+        // Let the kernel (or NIC) split each buffer into SegmentSize sized
+        // datagrams. The last datagram in a buffer may be shorter.
+        //
+        QUIC_DBG_ASSERT(CMsg != NULL);
+        MsgControlLength += CMSG_SPACE(sizeof(uint16_t));
+
+        CMsg->cmsg_level = SOL_UDP;
+        CMsg->cmsg_type = UDP_SEGMENT;
+        CMsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        *(uint16_t*)CMSG_DATA(CMsg) = SendContext->SegmentSize;
+    }
+
+    //
+    // Each buffer is its own message (one datagram, or a train of segments
+    // when GSO is in use), so they can all be flushed to the socket with a
+    // single sendmmsg call.
+    //
+    for (i = SendContext->CurrentIndex; i < SendContext->BufferCount; ++i) {
+        SendContext->Iovs[i].iov_base = SendContext->Buffers[i].Buffer;
+        SendContext->Iovs[i].iov_len = SendContext->Buffers[i].Length;
+
+        struct msghdr* Mhdr = &Mhdrs[i].msg_hdr;
+        Mhdr->msg_name = MsgName;
+        Mhdr->msg_namelen = MsgNameLength;
+        Mhdr->msg_iov = &SendContext->Iovs[i];
+        Mhdr->msg_iovlen = 1;
+        Mhdr->msg_control = MsgControlLength != 0 ? ControlBuffer : NULL;
+        Mhdr->msg_controllen = MsgControlLength;
+        Mhdr->msg_flags = 0;
+        Mhdrs[i].msg_len = 0;
+    }
 
-        if (SentByteCount < 0) {
+    while (SendContext->CurrentIndex < SendContext->BufferCount) {
+
+        SentMessageCount =
+            sendmmsg(
+                SocketContext->SocketFd,
+                &Mhdrs[SendContext->CurrentIndex],
+                (unsigned int)(SendContext->BufferCount - SendContext->CurrentIndex),
+                0);
+
+        if (SentMessageCount < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                //
+                // The remaining (unsent) datagrams are retried, starting from
+                // CurrentIndex, once the socket is writable again.
+                //
                 Status =
                     QuicSocketContextPendSend(
                         SocketContext,
@@ -1911,20 +2526,26 @@ QuicDataPathBindingSend(
                 SendPending = TRUE;
                 goto Exit;
             } else {
+                //
+                // Completed with error.
+                //
+
                 Status = errno;
-                QuicTraceEvent(DatapathErrorStatus, SocketContext->Binding, Status, "sendmsg failed");
+                QuicTraceEvent(DatapathErrorStatus, SocketContext->Binding, Status, "sendmmsg failed");
                 goto Exit;
             }
-        } else {
-            //
-            // Completed synchronously.
-            //
-            QuicTraceLogVerbose(
-                DatapathSendToCompleted,
-                "[ udp][%p] sendmsg succeeded, bytes transferred %d",
-                SocketContext->Binding,
-                SentByteCount);
         }
+
+        //
+        // Completed synchronously, though possibly only partially.
+        //
+        QuicTraceLogVerbose(
+            DatapathSendToCompleted,
+            "[ udp][%p] sendmmsg succeeded, datagrams transferred %d",
+            SocketContext->Binding,
+            SentMessageCount);
+
+        SendContext->CurrentIndex += (size_t)SentMessageCount;
     }
 
     Status = QUIC_STATUS_SUCCESS;
@@ -2061,6 +2682,6 @@ QuicDataPathBindingIsSendContextFull(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->DatapathBindingIsSendContextFull(SendContext);
 #else
-    return SendContext->BufferCount == SendContext->Owner->Datapath->MaxSendBatchSize;
+    return !QuicSendContextCanAllocSend(SendContext, SendContext->SegmentSize);
 #endif
 }
@@ -110,7 +110,7 @@ Return Value:
         return 0;
     }
 
-    for (ii = (sizeof(uint32_t) * 8); ii >= 0; --ii) {
+    for (ii = (sizeof(uint32_t) * 8) - 1; ii >= 0; --ii) {
         TempMask = 1 << ii;
 
         if ((Mask & TempMask) != 0) {
@@ -116,6 +116,28 @@ InterlockedIncrement64(
     _Inout_ _Interlocked_operand_ int64_t volatile *Addend
     );
 
+long
+ReadAcquire(
+    _In_ _Interlocked_operand_ long const volatile *Source
+    );
+
+void
+WriteRelease8(
+    _Out_ _Interlocked_operand_ char volatile *Destination,
+    _In_ char Value
+    );
+
+void*
+ReadPointerAcquire(
+    _In_ _Interlocked_operand_ void* const volatile *Source
+    );
+
+void
+WritePointerRelease(
+    _Out_ _Interlocked_operand_ void* volatile *Destination,
+    _In_ void* Value
+    );
+
 _Must_inspect_result_
 _Success_(return != 0)
 BOOLEAN
@@ -23,6 +23,8 @@ Environment:
 #include <fcntl.h>
 #include <syslog.h>
 #include <arpa/inet.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include "quic_trace.h"
 #include "quic_platform_dispatch.h"
 
@@ -124,21 +126,108 @@ QuicFree(
 #endif
 }
 
+QUIC_STATIC_ASSERT(sizeof(QUIC_POOL_DEPOT) == QUIC_POOL_DEPOT_ALIGNMENT, "QUIC_POOL_DEPOT must be one cache line");
+
 void
 QuicPoolInitialize(
     _In_ BOOLEAN IsPaged,
     _In_ uint32_t Size,
     _Inout_ QUIC_POOL* Pool
     )
+{
+    QuicPoolInitializeEx(IsPaged, Size, 0, Pool);
+}
+
+void
+QuicPoolInitializeEx(
+    _In_ BOOLEAN IsPaged,
+    _In_ uint32_t Size,
+    _In_ uint16_t Flags,
+    _Inout_ QUIC_POOL* Pool
+    )
 {
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
+    UNREFERENCED_PARAMETER(Flags);
     PlatDispatch->PoolInitialize(IsPaged, Size, Pool);
 #else
     UNREFERENCED_PARAMETER(IsPaged);
+    QUIC_DBG_ASSERT(Size >= sizeof(QUIC_SINGLE_LIST_ENTRY));
     Pool->Size = Size;
+    Pool->Flags = Flags;
+    Pool->MaxDepth =
+        Size > QUIC_POOL_LARGE_ENTRY_SIZE ?
+            QUIC_POOL_LARGE_MAXIMUM_DEPTH : QUIC_POOL_MAXIMUM_DEPTH;
+    Pool->DepotCount = QuicProcMaxCount();
+    Pool->Depots = NULL;
+
+    void* Depots = NULL;
+    if (posix_memalign(
+            &Depots,
+            QUIC_POOL_DEPOT_ALIGNMENT,
+            Pool->DepotCount * sizeof(QUIC_POOL_DEPOT)) != 0) {
+        //
+        // Not fatal; the pool just passes through to the heap.
+        //
+        QuicTraceEvent(
+            AllocFailure,
+            "QUIC_POOL_DEPOT",
+            Pool->DepotCount * sizeof(QUIC_POOL_DEPOT));
+        Pool->DepotCount = 0;
+        return;
+    }
+
+    QuicZeroMemory(Depots, Pool->DepotCount * sizeof(QUIC_POOL_DEPOT));
+    Pool->Depots = (QUIC_POOL_DEPOT*)Depots;
 #endif
 }
 
+#ifndef QUIC_PLATFORM_DISPATCH_TABLE
+
+static
+void
+QuicPoolFreeList(
+    _In_opt_ QUIC_SINGLE_LIST_ENTRY* Head
+    )
+{
+    while (Head != NULL) {
+        QUIC_SINGLE_LIST_ENTRY* Next = Head->Next;
+        QuicFree(Head);
+        Head = Next;
+    }
+}
+
+static
+inline
+QUIC_POOL_DEPOT*
+QuicPoolGetDepot(
+    _In_ QUIC_POOL* Pool
+    )
+{
+    return &Pool->Depots[QuicProcCurrentNumber() % Pool->DepotCount];
+}
+
+static
+inline
+BOOLEAN
+QuicPoolDepotTryAcquire(
+    _In_ QUIC_POOL_DEPOT* Depot
+    )
+{
+    return __atomic_exchange_n(&Depot->Busy, 1, __ATOMIC_ACQUIRE) == 0;
+}
+
+static
+inline
+void
+QuicPoolDepotRelease(
+    _In_ QUIC_POOL_DEPOT* Depot
+    )
+{
+    __atomic_store_n(&Depot->Busy, 0, __ATOMIC_RELEASE);
+}
+
+#endif
+
 void
 QuicPoolUninitialize(
     _Inout_ QUIC_POOL* Pool
@@ -147,7 +236,13 @@ QuicPoolUninitialize(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     PlatDispatch->PoolUninitialize(Pool);
 #else
-    UNREFERENCED_PARAMETER(Pool);
+    for (uint32_t i = 0; i < Pool->DepotCount; ++i) {
+        QuicPoolFreeList(Pool->Depots[i].LocalHead);
+        QuicPoolFreeList(Pool->Depots[i].ReturnHead);
+    }
+    free(Pool->Depots);
+    Pool->Depots = NULL;
+    Pool->DepotCount = 0;
 #endif
 }
 
@@ -159,9 +254,43 @@ QuicPoolAlloc(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     return PlatDispatch->PoolAlloc(Pool);
 #else
-    void*Entry = QuicAlloc(Pool->Size);
+    QUIC_SINGLE_LIST_ENTRY* Entry = NULL;
+
+    if (Pool->Depots != NULL) {
+        QUIC_POOL_DEPOT* Depot = QuicPoolGetDepot(Pool);
+        if (QuicPoolDepotTryAcquire(Depot)) {
+            if (Depot->LocalHead == NULL &&
+                __atomic_load_n(&Depot->ReturnHead, __ATOMIC_RELAXED) != NULL) {
+                //
+                // Take ownership of everything returned while the depot was
+                // busy.
+                //
+                Depot->LocalHead =
+                    __atomic_exchange_n(&Depot->ReturnHead, NULL, __ATOMIC_ACQUIRE);
+                Depot->LocalDepth =
+                    __atomic_exchange_n(&Depot->ReturnDepth, 0, __ATOMIC_RELAXED);
+            }
+
+            Entry = Depot->LocalHead;
+            if (Entry != NULL) {
+                Depot->LocalHead = Entry->Next;
+                if (Depot->LocalDepth > 0) {
+                    Depot->LocalDepth--;
+                }
+            }
+
+            QuicPoolDepotRelease(Depot);
+        }
+    }
 
-    if (Entry != NULL) {
+    if (Entry == NULL) {
+        Entry = (QUIC_SINGLE_LIST_ENTRY*)QuicAlloc(Pool->Size);
+        if (Entry == NULL) {
+            return NULL;
+        }
+    }
+
+    if (!(Pool->Flags & QUIC_POOL_FLAG_NO_ZERO)) {
         QuicZeroMemory(Entry, Pool->Size);
     }
 
@@ -178,7 +307,44 @@ QuicPoolFree(
 #ifdef QUIC_PLATFORM_DISPATCH_TABLE
     PlatDispatch->PoolFree(Pool, Entry);
 #else
-    UNREFERENCED_PARAMETER(Pool);
+    if (Pool->Depots != NULL) {
+        QUIC_SINGLE_LIST_ENTRY* FreeEntry = (QUIC_SINGLE_LIST_ENTRY*)Entry;
+        QUIC_POOL_DEPOT* Depot = QuicPoolGetDepot(Pool);
+
+        if (QuicPoolDepotTryAcquire(Depot)) {
+            BOOLEAN Cached = FALSE;
+            if (Depot->LocalDepth < Pool->MaxDepth) {
+                FreeEntry->Next = Depot->LocalHead;
+                Depot->LocalHead = FreeEntry;
+                Depot->LocalDepth++;
+                Cached = TRUE;
+            }
+            QuicPoolDepotRelease(Depot);
+            if (Cached) {
+                return;
+            }
+
+        } else if (__atomic_load_n(&Depot->ReturnDepth, __ATOMIC_RELAXED) < Pool->MaxDepth) {
+            //
+            // Another thread (preempted on, or racing for, this processor)
+            // holds the depot, so push onto the lock-free return list instead.
+            //
+            QUIC_SINGLE_LIST_ENTRY* Head =
+                __atomic_load_n(&Depot->ReturnHead, __ATOMIC_RELAXED);
+            do {
+                FreeEntry->Next = Head;
+            } while (!__atomic_compare_exchange_n(
+                        &Depot->ReturnHead,
+                        &Head,
+                        FreeEntry,
+                        TRUE,
+                        __ATOMIC_RELEASE,
+                        __ATOMIC_RELAXED));
+            __atomic_add_fetch(&Depot->ReturnDepth, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+
     QuicFree(Entry);
 #endif
 }
@@ -307,6 +473,115 @@ QuicRundownReleaseAndWait(
     }
 }
 
+//
+// QUIC_EVENT_OBJECT State bits.
+//
+#define QUIC_EVENT_SIGNALED     0x1
+#define QUIC_EVENT_WAITER       0x2
+
+static
+long
+QuicFutex(
+    _In_ int32_t* Address,
+    _In_ int Op,
+    _In_ int32_t Value,
+    _In_opt_ const struct timespec* Timeout
+    )
+{
+    return syscall(SYS_futex, Address, Op, Value, Timeout, NULL, FUTEX_BITSET_MATCH_ANY);
+}
+
+//
+// Consumes the signal (for auto reset events) if the event is signaled.
+//
+static
+BOOLEAN
+QuicEventTryConsume(
+    _Inout_ QUIC_EVENT_OBJECT* EventObj
+    )
+{
+    int32_t State = __atomic_load_n(&EventObj->State, __ATOMIC_ACQUIRE);
+
+    if (!EventObj->AutoReset) {
+        return (State & QUIC_EVENT_SIGNALED) != 0;
+    }
+
+    while (State & QUIC_EVENT_SIGNALED) {
+        if (__atomic_compare_exchange_n(
+                &EventObj->State,
+                &State,
+                State & ~QUIC_EVENT_SIGNALED,
+                FALSE,
+                __ATOMIC_ACQUIRE,
+                __ATOMIC_ACQUIRE)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+//
+// Waits for the event until the absolute CLOCK_MONOTONIC Deadline, or forever
+// if Deadline is NULL.
+//
+static
+BOOLEAN
+QuicEventWaitUntil(
+    _Inout_ QUIC_EVENT_OBJECT* EventObj,
+    _In_opt_ const struct timespec* Deadline
+    )
+{
+    if (QuicEventTryConsume(EventObj)) {
+        return TRUE;
+    }
+
+    //
+    // Register as a waiter before sleeping. The kernel only puts the thread to
+    // sleep if the futex word still has the expected value, so a racing Set
+    // either sees the waiter (and wakes it) or changes the word (and the wait
+    // returns immediately). The registration also keeps the event from being
+    // uninitialized until this thread is done accessing it.
+    //
+
+    BOOLEAN Signaled = FALSE;
+    BOOLEAN TimedOut = FALSE;
+    int32_t State =
+        __atomic_add_fetch(&EventObj->State, QUIC_EVENT_WAITER, __ATOMIC_SEQ_CST);
+
+    for (;;) {
+        if (State & QUIC_EVENT_SIGNALED) {
+            if (!EventObj->AutoReset ||
+                __atomic_compare_exchange_n(
+                    &EventObj->State,
+                    &State,
+                    State & ~QUIC_EVENT_SIGNALED,
+                    FALSE,
+                    __ATOMIC_ACQUIRE,
+                    __ATOMIC_ACQUIRE)) {
+                Signaled = TRUE;
+                break;
+            }
+            continue;
+        }
+
+        if (TimedOut) {
+            break;
+        }
+
+        if (QuicFutex(&EventObj->State, FUTEX_WAIT_BITSET_PRIVATE, State, Deadline) != 0) {
+            QUIC_DBG_ASSERT(errno == ETIMEDOUT || errno == EAGAIN || errno == EINTR);
+            TimedOut = errno == ETIMEDOUT;
+        }
+
+        State = __atomic_load_n(&EventObj->State, __ATOMIC_ACQUIRE);
+    }
+
+    __atomic_sub_fetch(&EventObj->State, QUIC_EVENT_WAITER, __ATOMIC_RELEASE);
+
+    return Signaled;
+}
+
 void
 QuicEventInitialize(
     _Out_ QUIC_EVENT* Event,
@@ -315,7 +590,6 @@ QuicEventInitialize(
     )
 {
     QUIC_EVENT_OBJECT* EventObj = NULL;
-    pthread_condattr_t Attr = {0};
 
     //
     // LINUX_TODO: Tag allocation would be useful here.
@@ -330,13 +604,7 @@ QuicEventInitialize(
     QUIC_DBG_ASSERT(EventObj != NULL);
 
     EventObj->AutoReset = !ManualReset;
-    EventObj->Signaled = InitialState;
-
-    QUIC_FRE_ASSERT(pthread_mutex_init(&EventObj->Mutex, NULL) == 0);
-    QUIC_FRE_ASSERT(pthread_condattr_init(&Attr) == 0);
-    QUIC_FRE_ASSERT(pthread_condattr_setclock(&Attr, CLOCK_MONOTONIC) == 0);
-    QUIC_FRE_ASSERT(pthread_cond_init(&EventObj->Cond, &Attr) == 0);
-    QUIC_FRE_ASSERT(pthread_condattr_destroy(&Attr) == 0);
+    EventObj->State = InitialState ? QUIC_EVENT_SIGNALED : 0;
 
     (*Event) = EventObj;
 }
@@ -348,8 +616,13 @@ QuicEventUninitialize(
 {
     QUIC_EVENT_OBJECT* EventObj = Event;
 
-    QUIC_FRE_ASSERT(pthread_cond_destroy(&EventObj->Cond) == 0);
-    QUIC_FRE_ASSERT(pthread_mutex_destroy(&EventObj->Mutex) == 0);
+    //
+    // Waiters woken by the final set may still be unregistering.
+    //
+
+    while (__atomic_load_n(&EventObj->State, __ATOMIC_ACQUIRE) >= QUIC_EVENT_WAITER) {
+        sched_yield();
+    }
 
     QuicFree(EventObj);
     EventObj = NULL;
@@ -361,18 +634,25 @@ QuicEventSet(
     )
 {
     QUIC_EVENT_OBJECT* EventObj = Event;
-
-    QUIC_FRE_ASSERT(pthread_mutex_lock(&EventObj->Mutex) == 0);
-
-    EventObj->Signaled = true;
-
-    QUIC_FRE_ASSERT(pthread_mutex_unlock(&EventObj->Mutex) == 0);
+    const int32_t WakeCount = EventObj->AutoReset ? 1 : INT32_MAX;
 
     //
-    // Signal the condition.
+    // Fast path: if the event is already signaled or nobody is waiting (e.g.
+    // the worker thread is still awake), this is a single atomic operation.
+    // The event memory must not be touched after this point, since a waiter
+    // may free it as soon as it observes the signal.
     //
 
-    QUIC_FRE_ASSERT(pthread_cond_broadcast(&EventObj->Cond) == 0);
+    int32_t State =
+        __atomic_fetch_or(&EventObj->State, QUIC_EVENT_SIGNALED, __ATOMIC_SEQ_CST);
+
+    if (!(State & QUIC_EVENT_SIGNALED) && State >= QUIC_EVENT_WAITER) {
+        (void)QuicFutex(
+            &EventObj->State,
+            FUTEX_WAKE_PRIVATE,
+            WakeCount,
+            NULL);
+    }
 }
 
 void
@@ -382,9 +662,7 @@ QuicEventReset(
 {
     QUIC_EVENT_OBJECT* EventObj = Event;
 
-    QUIC_FRE_ASSERT(pthread_mutex_lock(&EventObj->Mutex) == 0);
-    EventObj->Signaled = false;
-    QUIC_FRE_ASSERT(pthread_mutex_unlock(&EventObj->Mutex) == 0);
+    __atomic_and_fetch(&EventObj->State, ~QUIC_EVENT_SIGNALED, __ATOMIC_RELEASE);
 }
 
 void
@@ -392,24 +670,7 @@ QuicEventWaitForever(
     _Inout_ QUIC_EVENT Event
     )
 {
-    QUIC_EVENT_OBJECT* EventObj = Event;
-
-    QUIC_FRE_ASSERT(pthread_mutex_lock(&Event->Mutex) == 0);
-
-    //
-    // Spurious wake ups from pthread_cond_wait can occur. So the function needs
-    // to be called in a loop until the predicate 'Signalled' is satisfied.
-    //
-
-    while (!EventObj->Signaled) {
-        QUIC_FRE_ASSERT(pthread_cond_wait(&EventObj->Cond, &EventObj->Mutex) == 0);
-    }
-
-    if(EventObj->AutoReset) {
-        EventObj->Signaled = false;
-    }
-
-    QUIC_FRE_ASSERT(pthread_mutex_unlock(&EventObj->Mutex) == 0);
+    (void)QuicEventWaitUntil(Event, NULL);
 }
 
 BOOLEAN
@@ -418,10 +679,7 @@ QuicEventWaitWithTimeout(
     _In_ uint32_t TimeoutMs
     )
 {
-    QUIC_EVENT_OBJECT* EventObj = Event;
-    BOOLEAN WaitSatisfied = FALSE;
     struct timespec Ts = {0};
-    int Result = 0;
 
     //
     // Get absolute time.
@@ -429,32 +687,7 @@ QuicEventWaitWithTimeout(
 
     QuicGetAbsoluteTime(TimeoutMs, &Ts);
 
-    QUIC_FRE_ASSERT(pthread_mutex_lock(&EventObj->Mutex) == 0);
-
-    while (!EventObj->Signaled) {
-
-        Result = pthread_cond_timedwait(&EventObj->Cond, &EventObj->Mutex, &Ts);
-
-        if (Result == ETIMEDOUT) {
-            WaitSatisfied = FALSE;
-            goto Exit;
-        }
-
-        QUIC_DBG_ASSERT(Result == 0);
-        UNREFERENCED_PARAMETER(Result);
-    }
-
-    if (EventObj->AutoReset) {
-        EventObj->Signaled = FALSE;
-    }
-
-    WaitSatisfied = TRUE;
-
-Exit:
-
-    QUIC_FRE_ASSERT(pthread_mutex_unlock(&EventObj->Mutex) == 0);
-
-    return WaitSatisfied;
+    return QuicEventWaitUntil(Event, &Ts);
 }
 
 uint64_t
@@ -128,6 +128,13 @@ typedef struct QUIC_KEY {
     size_t BufferLen;
     uint8_t Buffer[64];
 
+    //
+    // Cipher context keyed with Buffer, so that each packet only needs to set
+    // the nonce.
+    //
+
+    EVP_CIPHER_CTX *CipherCtx;
+
 } QUIC_KEY;
 
 //
@@ -156,7 +163,8 @@ typedef struct QUIC_HASH {
 
 typedef struct QUIC_HP_KEY {
     //
-    // The cipher to use for encryption/decryption.
+    // The cipher to use for encryption/decryption. AES keys use ECB, since
+    // the AES mask is just the encrypted sample; ChaCha20 keys use ChaCha20.
     //
     const EVP_CIPHER *Aead;
 
@@ -166,6 +174,12 @@ typedef struct QUIC_HP_KEY {
     int BufferLen;
     uint8_t Buffer[64];
 
+    //
+    // Cipher context keyed with Buffer, so that each sample only needs to set
+    // the counter/nonce.
+    //
+    EVP_CIPHER_CTX *CipherCtx;
+
 } QUIC_HP_KEY;
 
 //
@@ -346,6 +360,13 @@ QuicTlsAeadTagLength(
     _In_ const EVP_CIPHER *Aead
     );
 
+static
+EVP_CIPHER_CTX *
+QuicTlsCipherCtxCreate(
+    _In_ const EVP_CIPHER *Cipher,
+    _In_reads_bytes_(EVP_CIPHER_key_length(Cipher)) const uint8_t *Key
+    );
+
 static
 int
 QuicTlsEncrypt(
@@ -353,13 +374,10 @@ QuicTlsEncrypt(
     _In_ size_t OutputBufferLen,
     _In_reads_bytes_(PlainTextLen) const uint8_t *PlainText,
     _In_ size_t PlainTextLen,
-    _In_reads_bytes_(KeyLen) const uint8_t *Key,
-    _In_ size_t KeyLen,
-    _In_reads_bytes_(NonceLen) const uint8_t *Nonce,
-    _In_ size_t NonceLen,
+    _In_ QUIC_KEY *Key,
+    _In_reads_bytes_(QUIC_IV_LENGTH) const uint8_t *Nonce,
     _In_reads_bytes_(AuthDataLen) const uint8_t *Authdata,
-    _In_ size_t AuthDataLen,
-    _In_ const EVP_CIPHER *Aead
+    _In_ size_t AuthDataLen
     );
 
 static
@@ -369,23 +387,18 @@ QuicTlsDecrypt(
     _In_ size_t OutputBufferLen,
     _In_reads_bytes_(CipherTextLen) const uint8_t *CipherText,
     _In_ size_t CipherTextLen,
-    _In_reads_bytes_(KeyLen) const uint8_t *Key,
-    _In_ size_t KeyLen,
-    _In_reads_bytes_(NonceLen) const uint8_t *Nonce,
-    _In_ size_t NonceLen,
+    _In_ QUIC_KEY *Key,
+    _In_reads_bytes_(QUIC_IV_LENGTH) const uint8_t *Nonce,
     _In_reads_bytes_(AuthDataLen) const uint8_t *AuthData,
-    _In_ size_t AuthDataLen,
-    _In_ const EVP_CIPHER *Aead
+    _In_ size_t AuthDataLen
     );
 
 static
 BOOLEAN
 QuicTlsHeaderMask(
     _Out_writes_bytes_(5) uint8_t *OutputBuffer,
-    _In_reads_bytes_(keylen) const uint8_t *Key,
-    _In_ size_t keylen,
-    _In_reads_bytes_(16) const uint8_t *Sample,
-    _In_ const EVP_CIPHER *Aead
+    _In_ QUIC_HP_KEY *Key,
+    _In_reads_bytes_(16) const uint8_t *Sample
     );
 
 static
@@ -1495,7 +1508,7 @@ QuicPacketKeyCreateInitial(
         }
 
         TempWriteKey->PacketKey->Aead = EVP_aes_128_gcm();
-        TempWriteKey->HeaderKey->Aead = EVP_aes_128_ctr();
+        TempWriteKey->HeaderKey->Aead = EVP_aes_128_ecb();
 
         if (!QuicTlsHkdfExtract(
                 InitialSecret,
@@ -1576,7 +1589,7 @@ QuicPacketKeyCreateInitial(
         }
 
         TempReadKey->PacketKey->Aead = EVP_aes_128_gcm();
-        TempReadKey->HeaderKey->Aead = EVP_aes_128_ctr();
+        TempReadKey->HeaderKey->Aead = EVP_aes_128_ecb();
 
         if (!QuicTlsHkdfExtract(
                 InitialSecret,
@@ -1770,6 +1783,8 @@ QuicKeyCreate(
         goto Exit;
     }
 
+    Key->CipherCtx = NULL;
+
     switch (AeadType) {
     case QUIC_AEAD_AES_128_GCM:
         Key->Aead = EVP_aes_128_gcm();
@@ -1789,6 +1804,12 @@ QuicKeyCreate(
 
     memcpy(Key->Buffer, RawKey, Key->BufferLen);
 
+    Key->CipherCtx = QuicTlsCipherCtxCreate(Key->Aead, Key->Buffer);
+    if (Key->CipherCtx == NULL) {
+        Status = QUIC_STATUS_TLS_ERROR;
+        goto Exit;
+    }
+
     *NewKey = Key;
     Key = NULL;
 
@@ -1805,6 +1826,7 @@ QuicKeyFree(
     )
 {
     if (Key != NULL) {
+        EVP_CIPHER_CTX_free(Key->CipherCtx);
         QuicFree(Key);
         Key = NULL;
     }
@@ -1829,13 +1851,10 @@ QuicEncrypt(
             BufferLength,
             Buffer,
             BufferLength - QUIC_ENCRYPTION_OVERHEAD,
-            Key->Buffer,
-            Key->BufferLen,
+            Key,
             Iv,
-            QUIC_IV_LENGTH,
             AuthData,
-            AuthDataLength,
-            Key->Aead);
+            AuthDataLength);
     return (Ret < 0) ? QUIC_STATUS_TLS_ERROR : QUIC_STATUS_SUCCESS;
 }
 
@@ -1856,13 +1875,10 @@ QuicDecrypt(
             BufferLength,
             Buffer,
             BufferLength,
-            Key->Buffer,
-            Key->BufferLen,
+            Key,
             Iv,
-            QUIC_IV_LENGTH,
             AuthData,
-            AuthDataLength,
-            Key->Aead);
+            AuthDataLength);
     return (Ret < 0) ? QUIC_STATUS_TLS_ERROR : QUIC_STATUS_SUCCESS;
 }
 
@@ -1877,23 +1893,25 @@ QuicHpKeyCreate(
     )
 {
     QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
-    QUIC_HP_KEY* Key = QUIC_ALLOC_NONPAGED(sizeof(QUIC_KEY));
+    QUIC_HP_KEY* Key = QUIC_ALLOC_NONPAGED(sizeof(QUIC_HP_KEY));
 
     if (Key == NULL) {
-        QuicTraceEvent(AllocFailure, "QUIC_KEY", sizeof(QUIC_KEY));
+        QuicTraceEvent(AllocFailure, "QUIC_HP_KEY", sizeof(QUIC_HP_KEY));
         Status = QUIC_STATUS_OUT_OF_MEMORY;
         goto Exit;
     }
 
+    Key->CipherCtx = NULL;
+
     switch (AeadType) {
     case QUIC_AEAD_AES_128_GCM:
-        Key->Aead = EVP_aes_128_ctr();
+        Key->Aead = EVP_aes_128_ecb();
         break;
     case QUIC_AEAD_AES_256_GCM:
-        Key->Aead = EVP_aes_256_ctr();
+        Key->Aead = EVP_aes_256_ecb();
         break;
     case QUIC_AEAD_CHACHA20_POLY1305:
-        Key->Aead = EVP_chacha20_poly1305();
+        Key->Aead = EVP_chacha20();
         break;
     default:
         Status = QUIC_STATUS_NOT_SUPPORTED;
@@ -1903,6 +1921,12 @@ QuicHpKeyCreate(
     Key->BufferLen = EVP_CIPHER_key_length(Key->Aead);
     QuicCopyMemory(Key->Buffer, RawKey, Key->BufferLen);
 
+    Key->CipherCtx = QuicTlsCipherCtxCreate(Key->Aead, Key->Buffer);
+    if (Key->CipherCtx == NULL) {
+        Status = QUIC_STATUS_TLS_ERROR;
+        goto Exit;
+    }
+
     *NewKey = Key;
     Key = NULL;
 
@@ -1919,6 +1943,7 @@ QuicHpKeyFree(
     )
 {
     if (Key != NULL) {
+        EVP_CIPHER_CTX_free(Key->CipherCtx);
         QuicFree(Key);
         Key = NULL;
     }
@@ -1932,13 +1957,35 @@ QuicHpComputeMask(
     _Out_writes_bytes_(QUIC_HP_SAMPLE_LENGTH * BatchSize) uint8_t* Mask
     )
 {
+    if (EVP_CIPHER_mode(Key->Aead) == EVP_CIPH_ECB_MODE) {
+        //
+        // The AES mask is the first AES-CTR block with the sample as the
+        // counter, i.e. the sample encrypted with AES-ECB. Encrypt the whole
+        // batch in one call so the blocks are pipelined through AES-NI.
+        //
+        int Len = 0;
+        if (EVP_EncryptUpdate(
+                Key->CipherCtx,
+                Mask,
+                &Len,
+                Cipher,
+                QUIC_HP_SAMPLE_LENGTH * BatchSize) != 1) {
+            QuicTraceEvent(LibraryError, "EVP_EncryptUpdate failed");
+            return QUIC_STATUS_TLS_ERROR;
+        }
+        QUIC_DBG_ASSERT(Len == QUIC_HP_SAMPLE_LENGTH * BatchSize);
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    //
+    // ChaCha20 uses each sample as its own counter and nonce, so each one
+    // needs its own cipher setup.
+    //
     for (uint8_t i = 0; i < BatchSize; i++) {
         if (!QuicTlsHeaderMask(
                 Mask + i * QUIC_HP_SAMPLE_LENGTH,
-                Key->Buffer,
-                Key->BufferLen,
-                Cipher + i * QUIC_HP_SAMPLE_LENGTH,
-                Key->Aead)) {
+                Key,
+                Cipher + i * QUIC_HP_SAMPLE_LENGTH)) {
             return QUIC_STATUS_TLS_ERROR;
         }
     }
@@ -2069,13 +2116,13 @@ QuicTlsKeySetAead(
     case QUIC_AEAD_AES_128_GCM:
         Key->PacketKey->Aead = EVP_aes_128_gcm();
         if (Key->HeaderKey != NULL) {
-            Key->HeaderKey->Aead = EVP_aes_128_ctr();
+            Key->HeaderKey->Aead = EVP_aes_128_ecb();
         }
         break;
     case QUIC_AEAD_AES_256_GCM:
         Key->PacketKey->Aead = EVP_aes_256_gcm();
         if (Key->HeaderKey != NULL) {
-            Key->HeaderKey->Aead = EVP_aes_256_ctr();
+            Key->HeaderKey->Aead = EVP_aes_256_ecb();
         }
         break;
     case QUIC_AEAD_CHACHA20_POLY1305:
@@ -2357,6 +2404,7 @@ QuicAllocatePacketKey(
             QuicTraceEvent(AllocFailure, "QUIC_PACKET_KEY", sizeof(QUIC_HP_KEY));
             goto Error;
         }
+        TempKey->HeaderKey->CipherCtx = NULL;
     }
 
     TempKey->PacketKey = QuicAlloc(sizeof(QUIC_KEY));
@@ -2364,6 +2412,7 @@ QuicAllocatePacketKey(
         QuicTraceEvent(AllocFailure, "QUIC_KEY", sizeof(QUIC_KEY));
         goto Error;
     }
+    TempKey->PacketKey->CipherCtx = NULL;
 
     *Key = TempKey;
     
@@ -2406,6 +2455,14 @@ QuicTlsDerivePacketProtectionKey(
         return QUIC_STATUS_TLS_ERROR;
     }
 
+    QuicKey->PacketKey->CipherCtx =
+        QuicTlsCipherCtxCreate(
+            QuicKey->PacketKey->Aead,
+            QuicKey->PacketKey->Buffer);
+    if (QuicKey->PacketKey->CipherCtx == NULL) {
+        return QUIC_STATUS_TLS_ERROR;
+    }
+
     return QUIC_STATUS_SUCCESS;
 }
 
@@ -2469,6 +2526,14 @@ QuicTlsDeriveHeaderProtectionKey(
         return QUIC_STATUS_TLS_ERROR;
     }
 
+    QuicKey->HeaderKey->CipherCtx =
+        QuicTlsCipherCtxCreate(
+            QuicKey->HeaderKey->Aead,
+            QuicKey->HeaderKey->Buffer);
+    if (QuicKey->HeaderKey->CipherCtx == NULL) {
+        return QUIC_STATUS_TLS_ERROR;
+    }
+
     return QUIC_STATUS_SUCCESS;
 }
 
@@ -2692,6 +2757,54 @@ QuicTlsAeadTagLength(
     return 0;
 }
 
+static
+EVP_CIPHER_CTX *
+QuicTlsCipherCtxCreate(
+    _In_ const EVP_CIPHER *Cipher,
+    _In_reads_bytes_(EVP_CIPHER_key_length(Cipher)) const uint8_t *Key
+    )
+{
+    //
+    // Runs the key schedule once, up front. Each packet (or sample) then only
+    // reinitializes the context with its nonce.
+    //
+    EVP_CIPHER_CTX *CipherCtx = EVP_CIPHER_CTX_new();
+    if (CipherCtx == NULL) {
+        QuicTraceEvent(LibraryError, "EVP_CIPHER_CTX_new failed");
+        goto Error;
+    }
+
+    if (EVP_EncryptInit_ex(CipherCtx, Cipher, NULL, NULL, NULL) != 1) {
+        QuicTraceEvent(LibraryError, "EVP_EncryptInit_ex failed");
+        goto Error;
+    }
+
+    if (EVP_CIPHER_flags(Cipher) & EVP_CIPH_FLAG_AEAD_CIPHER) {
+        if (EVP_CIPHER_CTX_ctrl(CipherCtx, EVP_CTRL_AEAD_SET_IVLEN, QUIC_IV_LENGTH, NULL) != 1) {
+            QuicTraceEvent(LibraryError, "EVP_CIPHER_CTX_ctrl failed");
+            goto Error;
+        }
+    } else if (EVP_CIPHER_mode(Cipher) == EVP_CIPH_ECB_MODE) {
+        if (EVP_CIPHER_CTX_set_padding(CipherCtx, 0) != 1) {
+            QuicTraceEvent(LibraryError, "EVP_CIPHER_CTX_set_padding failed");
+            goto Error;
+        }
+    }
+
+    if (EVP_EncryptInit_ex(CipherCtx, NULL, NULL, Key, NULL) != 1) {
+        QuicTraceEvent(LibraryError, "EVP_EncryptInit_ex failed");
+        goto Error;
+    }
+
+    return CipherCtx;
+
+Error:
+
+    EVP_CIPHER_CTX_free(CipherCtx);
+
+    return NULL;
+}
+
 static
 int
 QuicTlsEncrypt(
@@ -2699,19 +2812,14 @@ QuicTlsEncrypt(
     _In_ size_t OutputBufferLen,
     _In_reads_bytes_(PlainTextLen) const uint8_t *PlainText,
     _In_ size_t PlainTextLen,
-    _In_reads_bytes_(KeyLen) const uint8_t *Key,
-    _In_ size_t KeyLen,
-    _In_reads_bytes_(NonceLen) const uint8_t *Nonce,
-    _In_ size_t NonceLen,
+    _In_ QUIC_KEY *Key,
+    _In_reads_bytes_(QUIC_IV_LENGTH) const uint8_t *Nonce,
     _In_reads_bytes_(AuthDataLen) const uint8_t *Authdata,
-    _In_ size_t AuthDataLen,
-    _In_ const EVP_CIPHER *Aead
+    _In_ size_t AuthDataLen
     )
 {
-    UNREFERENCED_PARAMETER(KeyLen);
-    int Ret = 0;
-    size_t TagLen = QuicTlsAeadTagLength(Aead);
-    EVP_CIPHER_CTX *CipherCtx = NULL;
+    size_t TagLen = QuicTlsAeadTagLength(Key->Aead);
+    EVP_CIPHER_CTX *CipherCtx = Key->CipherCtx;
     size_t OutLen = 0;
     int Len = 0;
 
@@ -2719,55 +2827,31 @@ QuicTlsEncrypt(
 
     if (OutputBufferLen < PlainTextLen + TagLen) {
         QuicTraceEvent(LibraryErrorStatus, OutputBufferLen, "Incorrect output buffer length");
-        Ret = -1;
-        goto Exit;
-    }
-
-    CipherCtx = EVP_CIPHER_CTX_new();
-    if (CipherCtx == NULL) {
-        QuicTraceEvent(LibraryError, "CipherCtx alloc failed");
-        Ret = -1;
-        goto Exit;
-    }
-
-    if (EVP_EncryptInit_ex(CipherCtx, Aead, NULL, NULL, NULL) != 1) {
-        QuicTraceEvent(LibraryError, "EVP_EncryptInit_ex failed");
-        Ret = -1;
-        goto Exit;
-    }
-
-    if (EVP_CIPHER_CTX_ctrl(CipherCtx, EVP_CTRL_AEAD_SET_IVLEN, NonceLen, NULL) != 1) {
-        QuicTraceEvent(LibraryError, "EVP_CIPHER_CTX_ctrl failed");
-        Ret = -1;
-        goto Exit;
+        return -1;
     }
 
-    if (EVP_EncryptInit_ex(CipherCtx, NULL, NULL, Key, Nonce) != 1) {
-        QuicTraceEvent(LibraryError, "EVP_EncryptInit_ex failed");
-        Ret = -1;
-        goto Exit;
+    if (EVP_CipherInit_ex(CipherCtx, NULL, NULL, NULL, Nonce, 1) != 1) {
+        QuicTraceEvent(LibraryError, "EVP_CipherInit_ex failed");
+        return -1;
     }
 
     if (Authdata != NULL) {
         if (EVP_EncryptUpdate(CipherCtx, NULL, &Len, Authdata, AuthDataLen) != 1) {
             QuicTraceEvent(LibraryError, "EVP_EncryptUpdate failed");
-            Ret = -1;
-            goto Exit;
+            return -1;
         }
     }
 
     if (EVP_EncryptUpdate(CipherCtx, OutputBuffer, &Len, PlainText, PlainTextLen) != 1) {
         QuicTraceEvent(LibraryError, "EVP_EncryptUpdate failed");
-        Ret = -1;
-        goto Exit;
+        return -1;
     }
 
     OutLen = Len;
 
     if (EVP_EncryptFinal_ex(CipherCtx, OutputBuffer + OutLen, &Len) != 1) {
         QuicTraceEvent(LibraryError, "EVP_EncryptFinal_ex failed");
-        Ret = -1;
-        goto Exit;
+        return -1;
     }
 
     OutLen += Len;
@@ -2775,21 +2859,12 @@ QuicTlsEncrypt(
     QUIC_FRE_ASSERT(OutLen + TagLen <= OutputBufferLen);
 
     if (EVP_CIPHER_CTX_ctrl(CipherCtx, EVP_CTRL_AEAD_GET_TAG, TagLen, OutputBuffer + OutLen) != 1) {
-        Ret = -1;
-        goto Exit;
+        return -1;
     }
 
     OutLen += TagLen;
-    Ret = OutLen;
-
-Exit:
-
-    if (CipherCtx != NULL) {
-        EVP_CIPHER_CTX_free(CipherCtx);
-        CipherCtx = NULL;
-    }
 
-    return Ret;
+    return (int)OutLen;
 }
 
 static
@@ -2799,49 +2874,28 @@ QuicTlsDecrypt(
     _In_ size_t OutputBufferLen,
     _In_reads_bytes_(CipherTextLen) const uint8_t *CipherText,
     _In_ size_t CipherTextLen,
-    _In_reads_bytes_(KeyLen) const uint8_t *Key,
-    _In_ size_t KeyLen,
-    _In_reads_bytes_(NonceLen) const uint8_t *Nonce,
-    _In_ size_t NonceLen,
+    _In_ QUIC_KEY *Key,
+    _In_reads_bytes_(QUIC_IV_LENGTH) const uint8_t *Nonce,
     _In_reads_bytes_(AuthDataLen) const uint8_t *AuthData,
-    _In_ size_t AuthDataLen,
-    _In_ const EVP_CIPHER *Aead
+    _In_ size_t AuthDataLen
     )
 {
-    UNREFERENCED_PARAMETER(KeyLen);
-    size_t TagLen = QuicTlsAeadTagLength(Aead);
-    int Ret = -1;
-    EVP_CIPHER_CTX *CipherCtx = NULL;
+    size_t TagLen = QuicTlsAeadTagLength(Key->Aead);
+    EVP_CIPHER_CTX *CipherCtx = Key->CipherCtx;
 
     QUIC_FRE_ASSERT(TagLen == QUIC_ENCRYPTION_OVERHEAD);
 
     if (TagLen > CipherTextLen || OutputBufferLen + TagLen < CipherTextLen) {
         QuicTraceEvent(LibraryError, "Incorrect buffer length");
-        goto Exit;
+        return -1;
     }
 
     CipherTextLen -= TagLen;
     uint8_t *Tag = (uint8_t *)CipherText + CipherTextLen;
 
-    CipherCtx = EVP_CIPHER_CTX_new();
-    if (CipherCtx == NULL) {
-        QuicTraceEvent(LibraryError, "EVP_CIPHER_CTX_new failed");
-        goto Exit;
-    }
-
-    if (EVP_DecryptInit_ex(CipherCtx, Aead, NULL, NULL, NULL) != 1) {
-        QuicTraceEvent(LibraryErrorStatus, ERR_get_error(), "EVP_DecryptInit_ex failed");
-        goto Exit;
-    }
-
-    if (EVP_CIPHER_CTX_ctrl(CipherCtx, EVP_CTRL_AEAD_SET_IVLEN, NonceLen, NULL) != 1) {
-        QuicTraceEvent(LibraryErrorStatus, ERR_get_error(), "EVP_CIPHER_CTX_ctrl failed");
-        goto Exit;
-    }
-
-    if (EVP_DecryptInit_ex(CipherCtx, NULL, NULL, Key, Nonce) != 1) {
-        QuicTraceEvent(LibraryErrorStatus, ERR_get_error(), "EVP_DecryptInit_ex failed");
-        goto Exit;
+    if (EVP_CipherInit_ex(CipherCtx, NULL, NULL, NULL, Nonce, 0) != 1) {
+        QuicTraceEvent(LibraryErrorStatus, ERR_get_error(), "EVP_CipherInit_ex failed");
+        return -1;
     }
 
     size_t OutLen;
@@ -2850,91 +2904,65 @@ QuicTlsDecrypt(
     if (AuthData != NULL) {
         if (EVP_DecryptUpdate(CipherCtx, NULL, &Len, AuthData, AuthDataLen) != 1) {
             QuicTraceEvent(LibraryErrorStatus, ERR_get_error(), "EVP_DecryptUpdate (AD) failed");
-            goto Exit;
+            return -1;
         }
     }
 
     if (EVP_DecryptUpdate(CipherCtx, OutputBuffer, &Len, CipherText, CipherTextLen) != 1) {
         QuicTraceEvent(LibraryErrorStatus, ERR_get_error(), "EVP_DecryptUpdate (Cipher) failed");
-        goto Exit;
+        return -1;
     }
 
     OutLen = Len;
 
     if (EVP_CIPHER_CTX_ctrl(CipherCtx, EVP_CTRL_AEAD_SET_TAG, TagLen, Tag) != 1) {
         QuicTraceEvent(LibraryErrorStatus, ERR_get_error(), "EVP_CIPHER_CTX_ctrl failed");
-        goto Exit;
+        return -1;
     }
 
     if (EVP_DecryptFinal_ex(CipherCtx, OutputBuffer + OutLen, &Len) != 1) {
         QuicTraceEvent(LibraryErrorStatus, ERR_get_error(), "EVP_DecryptFinal_ex failed");
-        goto Exit;
+        return -1;
     }
 
     OutLen += Len;
-    Ret = OutLen;
-
-Exit:
-
-    if (CipherCtx != NULL) {
-        EVP_CIPHER_CTX_free(CipherCtx);
-        CipherCtx = NULL;
-    }
 
-    return Ret;
+    return (int)OutLen;
 }
 
 static
 BOOLEAN
 QuicTlsHeaderMask(
     _Out_writes_bytes_(5) uint8_t *OutputBuffer,
-    _In_reads_bytes_(keylen) const uint8_t *Key,
-    _In_ size_t KeyLen,
-    _In_reads_bytes_(16) const uint8_t *Cipher,
-    _In_ const EVP_CIPHER *Aead
+    _In_ QUIC_HP_KEY *Key,
+    _In_reads_bytes_(16) const uint8_t *Cipher
     )
 {
-    UNREFERENCED_PARAMETER(KeyLen);
-    BOOLEAN Ret = FALSE;
     uint8_t Temp[16] = {0};
     int OutputLen = 0;
     int Len = 0;
     static const uint8_t PLAINTEXT[] = "\x00\x00\x00\x00\x00";
 
-    EVP_CIPHER_CTX *CipherCtx = EVP_CIPHER_CTX_new();
-    if (CipherCtx == NULL) {
-        QuicTraceEvent(LibraryError, "Cipherctx alloc failed");
-        goto Exit;
-    }
-
-    if (EVP_EncryptInit_ex(CipherCtx, Aead, NULL, Key, Cipher) != 1) {
+    if (EVP_EncryptInit_ex(Key->CipherCtx, NULL, NULL, NULL, Cipher) != 1) {
         QuicTraceEvent(LibraryError, "EVP_EncryptInit_ex failed");
-        goto Exit;
+        return FALSE;
     }
 
-    if (EVP_EncryptUpdate(CipherCtx, Temp, &Len, PLAINTEXT, sizeof(PLAINTEXT) - 1) != 1) {
+    if (EVP_EncryptUpdate(Key->CipherCtx, Temp, &Len, PLAINTEXT, sizeof(PLAINTEXT) - 1) != 1) {
         QuicTraceEvent(LibraryError, "EVP_EncryptUpdate failed");
-        goto Exit;
+        return FALSE;
     }
 
     QUIC_FRE_ASSERT(Len == 5);
     OutputLen += Len;
 
-    if (EVP_EncryptFinal_ex(CipherCtx, Temp + OutputLen, &Len) != 1) {
+    if (EVP_EncryptFinal_ex(Key->CipherCtx, Temp + OutputLen, &Len) != 1) {
         QuicTraceEvent(LibraryError, "EVP_EncryptFinal_ex failed");
-        goto Exit;
+        return FALSE;
     }
 
     QUIC_FRE_ASSERT(Len == 0);
     QuicCopyMemory(OutputBuffer, Temp, OutputLen);
-    Ret = TRUE;
 
-Exit:
-
-    if (CipherCtx != NULL) {
-        EVP_CIPHER_CTX_free(CipherCtx);
-        CipherCtx = NULL;
-    }
-
-    return Ret;
+    return TRUE;
 }
@@ -11,6 +11,8 @@
 
 #include "msquichelper.h"
 
+#include <chrono>
+
 #ifndef QUIC_TLS_STUB
 
 void
@@ -96,6 +98,24 @@ struct CryptTest : public ::testing::TestWithParam<int32_t>
         }
     };
 
+    struct QuicHpKey
+    {
+        QUIC_HP_KEY* Ptr;
+        QuicHpKey(QUIC_AEAD_TYPE AeadType, const uint8_t* const RawKey) : Ptr(NULL) {
+            QUIC_STATUS Status = QuicHpKeyCreate(AeadType, RawKey, &Ptr);
+            if (Status == QUIC_STATUS_NOT_SUPPORTED) {
+                GTEST_SKIP_NO_RETURN_(": AEAD Type unsupported");
+                return;
+            }
+            EXPECT_EQ(Status, QUIC_STATUS_SUCCESS);
+            EXPECT_NE(Ptr, nullptr);
+        }
+
+        ~QuicHpKey() {
+            QuicHpKeyFree(Ptr);
+        }
+    };
+
     struct QuicHash
     {
         QUIC_HASH* Ptr;
@@ -303,6 +323,139 @@ TEST_P(CryptTest, Encryption)
     ASSERT_FALSE(Key.Decrypt(Iv, sizeof(AuthData), AuthData, sizeof(Buffer), Buffer));
 }
 
+TEST_P(CryptTest, HpMaskBatch)
+{
+    int AEAD = GetParam();
+    const uint8_t BatchSize = 32;
+
+    uint8_t RawKey[32];
+    uint8_t Cipher[QUIC_HP_SAMPLE_LENGTH * BatchSize];
+    uint8_t BatchMask[QUIC_HP_SAMPLE_LENGTH * BatchSize];
+    uint8_t Mask[QUIC_HP_SAMPLE_LENGTH];
+    QuicRandom(sizeof(RawKey), RawKey);
+    QuicRandom(sizeof(Cipher), Cipher);
+
+    QuicHpKey HpKey((QUIC_AEAD_TYPE)AEAD, RawKey);
+    if (HpKey.Ptr == NULL) return;
+
+    //
+    // A batch must produce the same masks as one sample at a time.
+    //
+    VERIFY_QUIC_SUCCESS(QuicHpComputeMask(HpKey.Ptr, BatchSize, Cipher, BatchMask));
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        VERIFY_QUIC_SUCCESS(
+            QuicHpComputeMask(HpKey.Ptr, 1, Cipher + i * QUIC_HP_SAMPLE_LENGTH, Mask));
+        ASSERT_EQ(0, memcmp(Mask, BatchMask + i * QUIC_HP_SAMPLE_LENGTH, 5));
+    }
+}
+
+TEST_P(CryptTest, EncryptionBatch)
+{
+    int AEAD = GetParam();
+    const uint8_t BatchSize = 8;
+
+    uint8_t RawKey[32];
+    uint8_t AuthData[BatchSize][12];
+    uint8_t Buffer[BatchSize][128];
+    uint8_t Expected[BatchSize][128];
+    QUIC_CRYPT_BATCH_ENTRY Entries[BatchSize];
+    QuicRandom(sizeof(RawKey), RawKey);
+    QuicRandom(sizeof(AuthData), AuthData);
+    QuicRandom(sizeof(Buffer), Buffer);
+
+    QuicKey Key((QUIC_AEAD_TYPE)AEAD, RawKey);
+    if (Key.Ptr == NULL) return;
+
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        Entries[i].AuthData = AuthData[i];
+        Entries[i].AuthDataLength = sizeof(AuthData[i]);
+        Entries[i].Buffer = Buffer[i];
+        Entries[i].BufferLength = sizeof(Buffer[i]);
+        QuicRandom(sizeof(Entries[i].Iv), Entries[i].Iv);
+        memcpy(Expected[i], Buffer[i], sizeof(Buffer[i]));
+        ASSERT_TRUE(Key.Encrypt(Entries[i].Iv, sizeof(AuthData[i]), AuthData[i], sizeof(Expected[i]), Expected[i]));
+    }
+
+    //
+    // A batch must produce the same cipher text as one packet at a time.
+    //
+    VERIFY_QUIC_SUCCESS(QuicEncryptBatch(Key.Ptr, BatchSize, Entries));
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        ASSERT_EQ(QUIC_STATUS_SUCCESS, Entries[i].Status);
+        ASSERT_EQ(0, memcmp(Expected[i], Buffer[i], sizeof(Buffer[i])));
+    }
+
+    //
+    // A packet failing to decrypt must not affect the rest of the batch.
+    //
+    Buffer[3][0] ^= 1;
+    ASSERT_TRUE(QUIC_FAILED(QuicDecryptBatch(Key.Ptr, BatchSize, Entries)));
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        if (i == 3) {
+            ASSERT_TRUE(QUIC_FAILED(Entries[i].Status));
+        } else {
+            ASSERT_EQ(QUIC_STATUS_SUCCESS, Entries[i].Status);
+        }
+    }
+}
+
+//
+// Measures the per-packet cost of packet protection with a single long-lived
+// key, the way a connection uses it: seal a full-sized packet, then compute
+// its header protection mask.
+//
+TEST_P(CryptTest, MicrobenchmarkPerf)
+{
+    int AEAD = GetParam();
+    const uint32_t PacketCount = 100000;
+
+    uint8_t RawKey[32];
+    uint8_t Iv[QUIC_IV_LENGTH];
+    uint8_t AuthData[20];
+    uint8_t Buffer[1200 + QUIC_ENCRYPTION_OVERHEAD];
+    uint8_t Mask[QUIC_HP_SAMPLE_LENGTH];
+    QuicRandom(sizeof(RawKey), RawKey);
+    QuicRandom(sizeof(Iv), Iv);
+    QuicRandom(sizeof(AuthData), AuthData);
+    QuicRandom(sizeof(Buffer), Buffer);
+
+    QuicKey Key((QUIC_AEAD_TYPE)AEAD, RawKey);
+    if (Key.Ptr == NULL) return;
+
+    QuicHpKey HpKey((QUIC_AEAD_TYPE)AEAD, RawKey);
+    if (HpKey.Ptr == NULL) return;
+
+    auto Begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < PacketCount; ++i) {
+        Iv[QUIC_IV_LENGTH - 1] = (uint8_t)i;
+        ASSERT_TRUE(Key.Encrypt(Iv, sizeof(AuthData), AuthData, sizeof(Buffer), Buffer));
+    }
+    auto Middle = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < PacketCount; ++i) {
+        VERIFY_QUIC_SUCCESS(QuicHpComputeMask(HpKey.Ptr, 1, Buffer + (i % 64), Mask));
+    }
+    auto End = std::chrono::steady_clock::now();
+
+    //
+    // Header protection is batched over short header packets.
+    //
+    const uint8_t BatchSize = 32;
+    uint8_t BatchMask[QUIC_HP_SAMPLE_LENGTH * BatchSize];
+    auto BatchBegin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < PacketCount; i += BatchSize) {
+        VERIFY_QUIC_SUCCESS(QuicHpComputeMask(HpKey.Ptr, BatchSize, Buffer + (i % 64), BatchMask));
+    }
+    auto BatchEnd = std::chrono::steady_clock::now();
+
+    std::cout << "AEAD " << AEAD << ": encrypt "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(Middle - Begin).count() / PacketCount
+        << " ns/packet, header mask "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(End - Middle).count() / PacketCount
+        << " ns/packet, batched header mask "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(BatchEnd - BatchBegin).count() / PacketCount
+        << " ns/packet" << std::endl;
+}
+
 TEST_P(CryptTest, HashWellKnown)
 {
     int HASH = GetParam();
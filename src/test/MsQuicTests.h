@@ -213,6 +213,26 @@ QuicTestReceiveResumeNoData(
     _In_ QUIC_RECEIVE_RESUME_SHUTDOWN_TYPE ShutdownType
     );
 
+void
+QuicTestStreamPriority(
+    _In_ int Family
+    );
+
+void
+QuicTestTransferOwnership(
+    _In_ int Family
+    );
+
+void
+QuicTestRecvZeroCopy(
+    _In_ int Family
+    );
+
+void
+QuicTestDatagramSend(
+    _In_ int Family
+    );
+
 //
 // QuicDrill tests
 //
@@ -516,4 +536,20 @@ typedef struct {
 #define IOCTL_QUIC_RUN_START_LISTENER_MULTI_ALPN \
     QUIC_CTL_CODE(38, METHOD_BUFFERED, FILE_WRITE_DATA)
 
-#define QUIC_MAX_IOCTL_FUNC_CODE 38
+#define IOCTL_QUIC_RUN_STREAM_PRIORITY \
+    QUIC_CTL_CODE(39, METHOD_BUFFERED, FILE_WRITE_DATA)
+    // int - Family
+
+#define IOCTL_QUIC_RUN_TRANSFER_OWNERSHIP \
+    QUIC_CTL_CODE(40, METHOD_BUFFERED, FILE_WRITE_DATA)
+    // int - Family
+
+#define IOCTL_QUIC_RUN_RECV_ZERO_COPY \
+    QUIC_CTL_CODE(41, METHOD_BUFFERED, FILE_WRITE_DATA)
+    // int - Family
+
+#define IOCTL_QUIC_RUN_DATAGRAM_SEND \
+    QUIC_CTL_CODE(42, METHOD_BUFFERED, FILE_WRITE_DATA)
+    // int - Family
+
+#define QUIC_MAX_IOCTL_FUNC_CODE 42
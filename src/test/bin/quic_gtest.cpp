@@ -824,6 +824,42 @@ TEST_P(WithReceiveResumeNoDataArgs, ReceiveResumeNoData) {
     }
 }
 
+TEST_P(WithFamilyArgs, StreamPriority) {
+    TestLoggerT<ParamType> Logger("QuicTestStreamPriority", GetParam());
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_STREAM_PRIORITY, GetParam().Family));
+    } else {
+        QuicTestStreamPriority(GetParam().Family);
+    }
+}
+
+TEST_P(WithFamilyArgs, TransferOwnership) {
+    TestLoggerT<ParamType> Logger("QuicTestTransferOwnership", GetParam());
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_TRANSFER_OWNERSHIP, GetParam().Family));
+    } else {
+        QuicTestTransferOwnership(GetParam().Family);
+    }
+}
+
+TEST_P(WithFamilyArgs, RecvZeroCopy) {
+    TestLoggerT<ParamType> Logger("QuicTestRecvZeroCopy", GetParam());
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_RECV_ZERO_COPY, GetParam().Family));
+    } else {
+        QuicTestRecvZeroCopy(GetParam().Family);
+    }
+}
+
+TEST_P(WithFamilyArgs, DatagramSend) {
+    TestLoggerT<ParamType> Logger("QuicTestDatagramSend", GetParam());
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_DATAGRAM_SEND, GetParam().Family));
+    } else {
+        QuicTestDatagramSend(GetParam().Family);
+    }
+}
+
 TEST(Drill, VarIntEncoder) {
     TestLogger Logger("QuicDrillTestVarIntEncoder");
     if (TestingKernelMode) {
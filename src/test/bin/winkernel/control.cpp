@@ -506,7 +506,11 @@ size_t QUIC_IOCTL_BUFFER_SIZES[] =
     0,
     sizeof(QUIC_RUN_DRILL_INITIAL_PACKET_CID_PARAMS),
     sizeof(INT32),
-    0
+    0,
+    sizeof(INT32),
+    sizeof(INT32),
+    sizeof(INT32),
+    sizeof(INT32)
 };
 
 static_assert(
@@ -841,6 +845,26 @@ QuicTestCtlEvtIoDeviceControl(
         QuicTestCtlRun(QuicTestStartListenerMultiAlpns());
         break;
 
+    case IOCTL_QUIC_RUN_STREAM_PRIORITY:
+        QUIC_FRE_ASSERT(Params != nullptr);
+        QuicTestCtlRun(QuicTestStreamPriority(Params->Family));
+        break;
+
+    case IOCTL_QUIC_RUN_TRANSFER_OWNERSHIP:
+        QUIC_FRE_ASSERT(Params != nullptr);
+        QuicTestCtlRun(QuicTestTransferOwnership(Params->Family));
+        break;
+
+    case IOCTL_QUIC_RUN_RECV_ZERO_COPY:
+        QUIC_FRE_ASSERT(Params != nullptr);
+        QuicTestCtlRun(QuicTestRecvZeroCopy(Params->Family));
+        break;
+
+    case IOCTL_QUIC_RUN_DATAGRAM_SEND:
+        QUIC_FRE_ASSERT(Params != nullptr);
+        QuicTestCtlRun(QuicTestDatagramSend(Params->Family));
+        break;
+
     default:
         Status = STATUS_NOT_IMPLEMENTED;
         break;
@@ -2881,3 +2881,1345 @@ QuicTestReceiveResumeNoData(
         }
     }
 }
+
+//
+// Helpers for the tests below, which handle the raw connection and stream
+// events themselves. The contexts must outlive the connection handles, so the
+// handles are declared after them.
+//
+
+struct RawConnContext {
+    EventScope Connected;
+    EventScope ShutdownComplete;
+};
+
+struct RawListenerContext {
+    QUIC_CONNECTION_CALLBACK_HANDLER Handler;
+    void* Context;
+    ConnectionScope* Connection;
+    //
+    // Enables datagram receive on the server connection, before its transport
+    // parameters are sent.
+    //
+    bool DatagramReceiveEnabled;
+    RawListenerContext() :
+        Handler(nullptr), Context(nullptr), Connection(nullptr),
+        DatagramReceiveEnabled(false) { }
+};
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_LISTENER_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicRawListenerHandler(
+    _In_ HQUIC /* QuicListener */,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_LISTENER_EVENT* Event
+    )
+{
+    RawListenerContext* ListenerContext = (RawListenerContext*)Context;
+    switch (Event->Type) {
+        case QUIC_LISTENER_EVENT_NEW_CONNECTION:
+            ListenerContext->Connection->Handle = Event->NEW_CONNECTION.Connection;
+            if (ListenerContext->DatagramReceiveEnabled) {
+                uint8_t Value = TRUE;
+                QUIC_STATUS Status =
+                    MsQuic->SetParam(
+                        Event->NEW_CONNECTION.Connection,
+                        QUIC_PARAM_LEVEL_CONNECTION,
+                        QUIC_PARAM_CONN_DATAGRAM_RECEIVE_ENABLED,
+                        sizeof(Value),
+                        &Value);
+                if (QUIC_FAILED(Status)) {
+                    TEST_FAILURE("MsQuic->SetParam(DATAGRAM_RECEIVE_ENABLED) failed, 0x%x.", Status);
+                    return Status;
+                }
+            }
+            MsQuic->SetCallbackHandler(
+                Event->NEW_CONNECTION.Connection,
+                (void*)ListenerContext->Handler,
+                ListenerContext->Context);
+            Event->NEW_CONNECTION.SecurityConfig = SecurityConfig;
+            return QUIC_STATUS_SUCCESS;
+        default:
+            TEST_FAILURE(
+                "Invalid listener event! Context: 0x%p, Event: %d",
+                Context,
+                Event->Type);
+            return QUIC_STATUS_INVALID_STATE;
+    }
+}
+
+//
+// Handles the connection events no test below cares about. Returns false if
+// the caller needs to handle the event.
+//
+static
+bool
+QuicRawConnHandleCommonEvent(
+    _In_ RawConnContext* Context,
+    _Inout_ QUIC_CONNECTION_EVENT* Event
+    )
+{
+    switch (Event->Type) {
+        case QUIC_CONNECTION_EVENT_CONNECTED:
+            QuicEventSet(Context->Connected.Handle);
+            return true;
+        case QUIC_CONNECTION_EVENT_SHUTDOWN_COMPLETE:
+            QuicEventSet(Context->ShutdownComplete.Handle);
+            return true;
+        case QUIC_CONNECTION_EVENT_SHUTDOWN_INITIATED_BY_TRANSPORT:
+        case QUIC_CONNECTION_EVENT_SHUTDOWN_INITIATED_BY_PEER:
+        case QUIC_CONNECTION_EVENT_IDEAL_PROCESSOR_CHANGED:
+        case QUIC_CONNECTION_EVENT_STREAMS_AVAILABLE:
+        case QUIC_CONNECTION_EVENT_PEER_NEEDS_STREAMS:
+        case QUIC_CONNECTION_EVENT_DATAGRAM_STATE_CHANGED:
+            return true;
+        default:
+            return false;
+    }
+}
+
+//
+// Starts a listener and connects a client to it. The server connection is
+// given ListenerContext's handler and context.
+//
+static
+bool
+QuicRawConnect(
+    _In_ MsQuicSession& Session,
+    _In_ int Family,
+    _Inout_ ListenerScope& Listener,
+    _In_ RawListenerContext* ListenerContext,
+    _In_ RawConnContext* ServerContext,
+    _Inout_ ConnectionScope& Client,
+    _In_ RawConnContext* ClientContext,
+    _In_ QUIC_CONNECTION_CALLBACK_HANDLER ClientHandler,
+    _In_opt_ void* ClientHandlerContext
+    )
+{
+    const uint32_t TimeoutMs = 2000;
+    QUIC_ADDRESS_FAMILY QuicAddrFamily = (Family == 4) ? AF_INET : AF_INET6;
+    QuicAddr ServerLocalAddr;
+
+    QUIC_STATUS Status =
+        MsQuic->ListenerOpen(
+            Session,
+            QuicRawListenerHandler,
+            ListenerContext,
+            &Listener.Handle);
+    if (QUIC_FAILED(Status)) {
+        TEST_FAILURE("MsQuic->ListenerOpen failed, 0x%x.", Status);
+        return false;
+    }
+
+    Status = MsQuic->ListenerStart(Listener.Handle, nullptr);
+    if (QUIC_FAILED(Status)) {
+        TEST_FAILURE("MsQuic->ListenerStart failed, 0x%x.", Status);
+        return false;
+    }
+
+    uint32_t Size = sizeof(ServerLocalAddr.SockAddr);
+    Status =
+        MsQuic->GetParam(
+            Listener.Handle,
+            QUIC_PARAM_LEVEL_LISTENER,
+            QUIC_PARAM_LISTENER_LOCAL_ADDRESS,
+            &Size,
+            &ServerLocalAddr.SockAddr);
+    if (QUIC_FAILED(Status)) {
+        TEST_FAILURE("MsQuic->GetParam failed, 0x%x.", Status);
+        return false;
+    }
+
+    Status =
+        MsQuic->ConnectionOpen(
+            Session,
+            ClientHandler,
+            ClientHandlerContext,
+            &Client.Handle);
+    if (QUIC_FAILED(Status)) {
+        TEST_FAILURE("MsQuic->ConnectionOpen failed, 0x%x.", Status);
+        return false;
+    }
+
+    uint32_t CertFlags =
+        QUIC_CERTIFICATE_FLAG_IGNORE_UNKNOWN_CA |
+        QUIC_CERTIFICATE_FLAG_IGNORE_CERTIFICATE_CN_INVALID;
+    Status =
+        MsQuic->SetParam(
+            Client.Handle,
+            QUIC_PARAM_LEVEL_CONNECTION,
+            QUIC_PARAM_CONN_CERT_VALIDATION_FLAGS,
+            sizeof(CertFlags),
+            &CertFlags);
+    if (QUIC_FAILED(Status)) {
+        TEST_FAILURE("MsQuic->SetParam(CERT_VALIDATION_FLAGS) failed, 0x%x.", Status);
+        return false;
+    }
+
+    Status =
+        MsQuic->ConnectionStart(
+            Client.Handle,
+            QuicAddrFamily,
+            QUIC_LOCALHOST_FOR_AF(QuicAddrFamily),
+            QuicAddrGetPort(&ServerLocalAddr.SockAddr));
+    if (QUIC_FAILED(Status)) {
+        TEST_FAILURE("MsQuic->ConnectionStart failed, 0x%x.", Status);
+        return false;
+    }
+
+    if (!QuicEventWaitWithTimeout(ClientContext->Connected.Handle, TimeoutMs)) {
+        TEST_FAILURE("Client failed to get connected before timeout!");
+        return false;
+    }
+    if (!QuicEventWaitWithTimeout(ServerContext->Connected.Handle, TimeoutMs)) {
+        TEST_FAILURE("Server failed to get connected before timeout!");
+        return false;
+    }
+
+    return true;
+}
+
+const uint32_t PriorityTestMaxStreams = 4;
+
+struct PriorityTestContext;
+
+struct PriorityTestStream {
+    PriorityTestContext* Context;
+    uint32_t FirstReceive;
+    uint32_t Complete;
+    uint64_t BytesReceived;
+};
+
+struct PriorityTestContext {
+    RawConnContext Conn;
+    EventScope AllComplete;
+    uint32_t StreamCount;
+    uint32_t CompleteCount;
+    uint32_t EventCount;
+    PriorityTestStream Streams[PriorityTestMaxStreams];
+    PriorityTestContext(uint32_t StreamCount) :
+        StreamCount(StreamCount), CompleteCount(0), EventCount(0) {
+        for (uint32_t i = 0; i < PriorityTestMaxStreams; ++i) {
+            Streams[i].Context = this;
+            Streams[i].FirstReceive = UINT32_MAX;
+            Streams[i].Complete = UINT32_MAX;
+            Streams[i].BytesReceived = 0;
+        }
+    }
+};
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_STREAM_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicPriorityServerStreamHandler(
+    _In_ HQUIC QuicStream,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_STREAM_EVENT* Event
+    )
+{
+    PriorityTestStream* Stream = (PriorityTestStream*)Context;
+    switch (Event->Type) {
+        case QUIC_STREAM_EVENT_RECEIVE:
+            if (Event->RECEIVE.TotalBufferLength != 0) {
+                if (Stream->FirstReceive == UINT32_MAX) {
+                    Stream->FirstReceive = Stream->Context->EventCount;
+                }
+                Stream->BytesReceived += Event->RECEIVE.TotalBufferLength;
+                Stream->Context->EventCount++;
+            }
+            break;
+        case QUIC_STREAM_EVENT_PEER_SEND_SHUTDOWN:
+            Stream->Complete = Stream->Context->EventCount++;
+            if (++Stream->Context->CompleteCount == Stream->Context->StreamCount) {
+                QuicEventSet(Stream->Context->AllComplete.Handle);
+            }
+            break;
+        case QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE:
+            MsQuic->StreamClose(QuicStream);
+            break;
+        default:
+            break;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_CONNECTION_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicPriorityServerConnHandler(
+    _In_ HQUIC /* QuicConnection */,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_CONNECTION_EVENT* Event
+    )
+{
+    PriorityTestContext* TestContext = (PriorityTestContext*)Context;
+    if (QuicRawConnHandleCommonEvent(&TestContext->Conn, Event)) {
+        return QUIC_STATUS_SUCCESS;
+    }
+    if (Event->Type == QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED) {
+        QUIC_UINT62 StreamId = 0;
+        uint32_t Size = sizeof(StreamId);
+        QUIC_STATUS Status =
+            MsQuic->GetParam(
+                Event->PEER_STREAM_STARTED.Stream,
+                QUIC_PARAM_LEVEL_STREAM,
+                QUIC_PARAM_STREAM_ID,
+                &Size,
+                &StreamId);
+        if (QUIC_FAILED(Status) || (StreamId >> 2) >= TestContext->StreamCount) {
+            TEST_FAILURE("Unexpected peer stream, 0x%x.", Status);
+            return QUIC_STATUS_INVALID_STATE;
+        }
+        MsQuic->SetCallbackHandler(
+            Event->PEER_STREAM_STARTED.Stream,
+            (void*)QuicPriorityServerStreamHandler,
+            &TestContext->Streams[StreamId >> 2]);
+        return QUIC_STATUS_SUCCESS;
+    }
+    TEST_FAILURE(
+        "Invalid Connection event! Context: 0x%p, Event: %d",
+        Context,
+        Event->Type);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_CONNECTION_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicPriorityClientConnHandler(
+    _In_ HQUIC /* QuicConnection */,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_CONNECTION_EVENT* Event
+    )
+{
+    RawConnContext* ConnContext = (RawConnContext*)Context;
+    if (QuicRawConnHandleCommonEvent(ConnContext, Event)) {
+        return QUIC_STATUS_SUCCESS;
+    }
+    TEST_FAILURE(
+        "Invalid Connection event! Context: 0x%p, Event: %d",
+        Context,
+        Event->Type);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_STREAM_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicPriorityClientStreamHandler(
+    _In_ HQUIC /* QuicStream */,
+    _In_opt_ void* /* Context */,
+    _Inout_ QUIC_STREAM_EVENT* /* Event */
+    )
+{
+    return QUIC_STATUS_SUCCESS;
+}
+
+//
+// Opens a unidirectional stream for each priority and sends Length bytes on
+// it. The server hasn't allowed any unidirectional streams yet, so they are
+// all blocked until it does, and then they all become ready at once.
+//
+static
+bool
+QuicTestStreamPriorityRun(
+    _In_ int Family,
+    _In_ uint32_t StreamCount,
+    _In_reads_(StreamCount) const QUIC_STREAM_PRIORITY* Priorities,
+    _In_ uint32_t Length,
+    _Inout_ PriorityTestContext& ServerContext
+    )
+{
+    const uint32_t TimeoutMs = 5000;
+    MsQuicSession Session;
+    if (!Session.IsValid()) {
+        TEST_FAILURE("Session open failed.");
+        return false;
+    }
+
+    RawConnContext ClientContext;
+    RawListenerContext ListenerContext;
+    QuicBufferScope Buffer(Length);
+
+    ListenerScope Listener;
+    ConnectionScope Client;
+    ConnectionScope Server;
+    StreamScope Streams[PriorityTestMaxStreams];
+
+    ListenerContext.Handler = QuicPriorityServerConnHandler;
+    ListenerContext.Context = &ServerContext;
+    ListenerContext.Connection = &Server;
+
+    if (!QuicRawConnect(
+            Session,
+            Family,
+            Listener,
+            &ListenerContext,
+            &ServerContext.Conn,
+            Client,
+            &ClientContext,
+            QuicPriorityClientConnHandler,
+            &ClientContext)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < StreamCount; ++i) {
+        QUIC_STATUS Status =
+            MsQuic->StreamOpen(
+                Client.Handle,
+                QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL,
+                QuicPriorityClientStreamHandler,
+                nullptr,
+                &Streams[i].Handle);
+        if (QUIC_FAILED(Status)) {
+            TEST_FAILURE("MsQuic->StreamOpen failed, 0x%x.", Status);
+            return false;
+        }
+
+        Status =
+            MsQuic->SetParam(
+                Streams[i].Handle,
+                QUIC_PARAM_LEVEL_STREAM,
+                QUIC_PARAM_STREAM_PRIORITY,
+                sizeof(Priorities[i]),
+                &Priorities[i]);
+        if (QUIC_FAILED(Status)) {
+            TEST_FAILURE("MsQuic->SetParam(STREAM_PRIORITY) failed, 0x%x.", Status);
+            return false;
+        }
+
+        Status = MsQuic->StreamStart(Streams[i].Handle, QUIC_STREAM_START_FLAG_NONE);
+        if (QUIC_FAILED(Status)) {
+            TEST_FAILURE("MsQuic->StreamStart failed, 0x%x.", Status);
+            return false;
+        }
+
+        Status =
+            MsQuic->StreamSend(
+                Streams[i].Handle,
+                Buffer,
+                1,
+                QUIC_SEND_FLAG_FIN,
+                nullptr);
+        if (QUIC_FAILED(Status)) {
+            TEST_FAILURE("MsQuic->StreamSend failed, 0x%x.", Status);
+            return false;
+        }
+    }
+
+    //
+    // Give the client time to process the sends, and find all the streams
+    // blocked.
+    //
+    QuicSleep(100);
+    if (ServerContext.EventCount != 0) {
+        TEST_FAILURE("Server received data before allowing any streams!");
+        return false;
+    }
+
+    uint16_t AllowedStreams = (uint16_t)StreamCount;
+    QUIC_STATUS Status =
+        MsQuic->SetParam(
+            Server.Handle,
+            QUIC_PARAM_LEVEL_CONNECTION,
+            QUIC_PARAM_CONN_PEER_UNIDI_STREAM_COUNT,
+            sizeof(AllowedStreams),
+            &AllowedStreams);
+    if (QUIC_FAILED(Status)) {
+        TEST_FAILURE("MsQuic->SetParam(PEER_UNIDI_STREAM_COUNT) failed, 0x%x.", Status);
+        return false;
+    }
+
+    if (!QuicEventWaitWithTimeout(ServerContext.AllComplete.Handle, TimeoutMs)) {
+        TEST_FAILURE("Server failed to receive all streams before timeout!");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < StreamCount; ++i) {
+        if (ServerContext.Streams[i].BytesReceived != Length) {
+            TEST_FAILURE("Stream %u received %llu bytes, expected %u.", i, ServerContext.Streams[i].BytesReceived, Length);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+QuicTestStreamPriority(
+    _In_ int Family
+    )
+{
+    //
+    // Each level is sent in full before the next one starts, whatever order
+    // the streams were started in.
+    //
+    {
+        TestScopeLogger logScope("StrictLevels");
+        const QUIC_STREAM_PRIORITY Priorities[] = { { 2, 4 }, { 0, 4 }, { 1, 4 } };
+        PriorityTestContext ServerContext(ARRAYSIZE(Priorities));
+        if (!QuicTestStreamPriorityRun(Family, ARRAYSIZE(Priorities), Priorities, 8000, ServerContext)) {
+            return;
+        }
+        TEST_TRUE(ServerContext.Streams[1].Complete < ServerContext.Streams[2].FirstReceive);
+        TEST_TRUE(ServerContext.Streams[2].Complete < ServerContext.Streams[0].FirstReceive);
+    }
+
+    //
+    // Streams of the same level take turns, each sending its weight in packets
+    // at a time. The heavier stream finishes first, but the lighter one isn't
+    // starved until then.
+    //
+    {
+        TestScopeLogger logScope("WeightedRoundRobin");
+        const QUIC_STREAM_PRIORITY Priorities[] = { { 3, 1 }, { 3, 8 } };
+        PriorityTestContext ServerContext(ARRAYSIZE(Priorities));
+        if (!QuicTestStreamPriorityRun(Family, ARRAYSIZE(Priorities), Priorities, 20000, ServerContext)) {
+            return;
+        }
+        TEST_TRUE(ServerContext.Streams[1].Complete < ServerContext.Streams[0].Complete);
+        TEST_TRUE(ServerContext.Streams[0].FirstReceive < ServerContext.Streams[1].Complete);
+    }
+}
+
+typedef enum QUIC_SEND_OWNERSHIP_TEST_TYPE {
+    SendOwnershipComplete,
+    SendOwnershipAbort,
+    SendOwnershipConnClose
+} QUIC_SEND_OWNERSHIP_TEST_TYPE;
+
+const uint32_t OwnershipTestSendCount = 8;
+const uint32_t OwnershipTestSendLength = 32 * 1024;
+
+struct OwnershipTestContext {
+    RawConnContext ClientConn;
+    RawConnContext ServerConn;
+    EventScope ClientStreamShutdown;
+    bool ServerConsumes;
+    bool ReleasedBeforeComplete;
+    uint32_t CompleteCount[OwnershipTestSendCount];
+    uint32_t ReleaseCount[OwnershipTestSendCount];
+    //
+    // The buffers, and the QUIC_BUFFER array describing them, must stay valid
+    // until they are released.
+    //
+    QuicBufferScope Data;
+    QUIC_BUFFER Buffers[OwnershipTestSendCount];
+    OwnershipTestContext(bool ServerConsumes) :
+        ServerConsumes(ServerConsumes), ReleasedBeforeComplete(false),
+        Data(OwnershipTestSendLength) {
+        for (uint32_t i = 0; i < OwnershipTestSendCount; ++i) {
+            CompleteCount[i] = 0;
+            ReleaseCount[i] = 0;
+            Buffers[i].Buffer = Data.Buffer->Buffer;
+            Buffers[i].Length = OwnershipTestSendLength;
+        }
+    }
+};
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_STREAM_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicOwnershipClientStreamHandler(
+    _In_ HQUIC /* QuicStream */,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_STREAM_EVENT* Event
+    )
+{
+    OwnershipTestContext* TestContext = (OwnershipTestContext*)Context;
+    switch (Event->Type) {
+        case QUIC_STREAM_EVENT_SEND_COMPLETE:
+            TestContext->CompleteCount[(size_t)Event->SEND_COMPLETE.ClientContext - 1]++;
+            break;
+        case QUIC_STREAM_EVENT_SEND_BUFFERS_RELEASED: {
+            size_t Index = (size_t)Event->SEND_BUFFERS_RELEASED.ClientContext - 1;
+            if (TestContext->CompleteCount[Index] == 0) {
+                TestContext->ReleasedBeforeComplete = true;
+            }
+            TestContext->ReleaseCount[Index]++;
+            break;
+        }
+        case QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE:
+            QuicEventSet(TestContext->ClientStreamShutdown.Handle);
+            break;
+        default:
+            break;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_STREAM_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicOwnershipServerStreamHandler(
+    _In_ HQUIC QuicStream,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_STREAM_EVENT* Event
+    )
+{
+    OwnershipTestContext* TestContext = (OwnershipTestContext*)Context;
+    switch (Event->Type) {
+        case QUIC_STREAM_EVENT_RECEIVE:
+            if (!TestContext->ServerConsumes) {
+                //
+                // Leave the data unconsumed, so the sends back up on flow
+                // control.
+                //
+                Event->RECEIVE.TotalBufferLength = 0;
+            }
+            break;
+        case QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE:
+            MsQuic->StreamClose(QuicStream);
+            break;
+        default:
+            break;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_CONNECTION_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicOwnershipServerConnHandler(
+    _In_ HQUIC /* QuicConnection */,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_CONNECTION_EVENT* Event
+    )
+{
+    OwnershipTestContext* TestContext = (OwnershipTestContext*)Context;
+    if (QuicRawConnHandleCommonEvent(&TestContext->ServerConn, Event)) {
+        return QUIC_STATUS_SUCCESS;
+    }
+    if (Event->Type == QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED) {
+        MsQuic->SetCallbackHandler(
+            Event->PEER_STREAM_STARTED.Stream,
+            (void*)QuicOwnershipServerStreamHandler,
+            Context);
+        return QUIC_STATUS_SUCCESS;
+    }
+    TEST_FAILURE(
+        "Invalid Connection event! Context: 0x%p, Event: %d",
+        Context,
+        Event->Type);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_CONNECTION_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicOwnershipClientConnHandler(
+    _In_ HQUIC /* QuicConnection */,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_CONNECTION_EVENT* Event
+    )
+{
+    OwnershipTestContext* TestContext = (OwnershipTestContext*)Context;
+    if (QuicRawConnHandleCommonEvent(&TestContext->ClientConn, Event)) {
+        return QUIC_STATUS_SUCCESS;
+    }
+    TEST_FAILURE(
+        "Invalid Connection event! Context: 0x%p, Event: %d",
+        Context,
+        Event->Type);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+static
+void
+QuicTestTransferOwnershipRun(
+    _In_ int Family,
+    _In_ QUIC_SEND_OWNERSHIP_TEST_TYPE Type,
+    _In_ bool UseSendBuffer
+    )
+{
+    const uint32_t TimeoutMs = 5000;
+    MsQuicSession Session;
+    TEST_TRUE(Session.IsValid());
+    TEST_QUIC_SUCCEEDED(Session.SetPeerUnidiStreamCount(1));
+
+    OwnershipTestContext TestContext(Type == SendOwnershipComplete);
+    RawListenerContext ListenerContext;
+
+    ListenerScope Listener;
+    ConnectionScope Client;
+    ConnectionScope Server;
+    StreamScope Stream;
+
+    ListenerContext.Handler = QuicOwnershipServerConnHandler;
+    ListenerContext.Context = &TestContext;
+    ListenerContext.Connection = &Server;
+
+    if (!QuicRawConnect(
+            Session,
+            Family,
+            Listener,
+            &ListenerContext,
+            &TestContext.ServerConn,
+            Client,
+            &TestContext.ClientConn,
+            QuicOwnershipClientConnHandler,
+            &TestContext)) {
+        return;
+    }
+
+    uint8_t Value = UseSendBuffer ? TRUE : FALSE;
+    TEST_QUIC_SUCCEEDED(
+        MsQuic->SetParam(
+            Client.Handle,
+            QUIC_PARAM_LEVEL_CONNECTION,
+            QUIC_PARAM_CONN_SEND_BUFFERING,
+            sizeof(Value),
+            &Value));
+
+    TEST_QUIC_SUCCEEDED(
+        MsQuic->StreamOpen(
+            Client.Handle,
+            QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL,
+            QuicOwnershipClientStreamHandler,
+            &TestContext,
+            &Stream.Handle));
+    TEST_QUIC_SUCCEEDED(MsQuic->StreamStart(Stream.Handle, QUIC_STREAM_START_FLAG_NONE));
+
+    for (uint32_t i = 0; i < OwnershipTestSendCount; ++i) {
+        QUIC_SEND_FLAGS Flags = QUIC_SEND_FLAG_TRANSFER_OWNERSHIP;
+        if (i == OwnershipTestSendCount - 1 && Type == SendOwnershipComplete) {
+            Flags |= QUIC_SEND_FLAG_FIN;
+        }
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->StreamSend(
+                Stream.Handle,
+                &TestContext.Buffers[i],
+                1,
+                Flags,
+                (void*)(size_t)(i + 1)));
+    }
+
+    if (Type != SendOwnershipComplete) {
+        //
+        // Let the stream fill the peer's flow control window, so some of the
+        // sends are in flight and the rest are still queued.
+        //
+        QuicSleep(100);
+        if (Type == SendOwnershipAbort) {
+            TEST_QUIC_SUCCEEDED(
+                MsQuic->StreamShutdown(
+                    Stream.Handle,
+                    QUIC_STREAM_SHUTDOWN_FLAG_ABORT_SEND,
+                    0));
+        } else {
+            MsQuic->ConnectionShutdown(
+                Client.Handle,
+                QUIC_CONNECTION_SHUTDOWN_FLAG_NONE,
+                0);
+        }
+    }
+
+    if (!QuicEventWaitWithTimeout(TestContext.ClientStreamShutdown.Handle, TimeoutMs)) {
+        TEST_FAILURE("Client stream failed to shut down before timeout!");
+        return;
+    }
+
+    //
+    // Every send is completed and then released exactly once, however the
+    // stream ended.
+    //
+    TEST_FALSE(TestContext.ReleasedBeforeComplete);
+    for (uint32_t i = 0; i < OwnershipTestSendCount; ++i) {
+        TEST_EQUAL(1, TestContext.CompleteCount[i]);
+        TEST_EQUAL(1, TestContext.ReleaseCount[i]);
+    }
+}
+
+void
+QuicTestTransferOwnership(
+    _In_ int Family
+    )
+{
+    const QUIC_SEND_OWNERSHIP_TEST_TYPE Types[] = {
+        SendOwnershipComplete,
+        SendOwnershipAbort,
+        SendOwnershipConnClose
+    };
+    for (auto Type : Types) {
+        QuicTestTransferOwnershipRun(Family, Type, false);
+        QuicTestTransferOwnershipRun(Family, Type, true);
+    }
+}
+
+const uint32_t ZeroCopyTestHeldStreams = 4;
+const uint32_t ZeroCopyTestStreamCount = ZeroCopyTestHeldStreams + 1;
+const uint32_t ZeroCopyTestHeldLength = 4000;
+const uint32_t ZeroCopyTestFillerLength = 256 * 1024;
+const uint32_t ZeroCopyTestMaxBuffers = 8;
+
+static
+uint8_t
+QuicZeroCopyTestPattern(
+    _In_ uint64_t Offset
+    )
+{
+    return (uint8_t)(Offset ^ (Offset >> 8));
+}
+
+static
+bool
+QuicZeroCopyTestCheck(
+    _In_ uint64_t Offset,
+    _In_ uint32_t BufferCount,
+    _In_reads_(BufferCount) const QUIC_BUFFER* Buffers
+    )
+{
+    for (uint32_t i = 0; i < BufferCount; ++i) {
+        for (uint32_t j = 0; j < Buffers[i].Length; ++j) {
+            if (Buffers[i].Buffer[j] != QuicZeroCopyTestPattern(Offset++)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+struct ZeroCopyTestContext;
+
+struct ZeroCopyTestStream {
+    ZeroCopyTestContext* Context;
+    HQUIC Handle;
+    bool Hold;
+    bool Held;
+    bool Corrupted;
+    uint64_t BytesReceived;
+    uint64_t HeldOffset;
+    uint64_t HeldLength;
+    uint32_t HeldBufferCount;
+    QUIC_BUFFER HeldBuffers[ZeroCopyTestMaxBuffers];
+};
+
+struct ZeroCopyTestContext {
+    RawConnContext ServerConn;
+    EventScope AllHeld;
+    EventScope FillerReceived;
+    EventScope AllReceived;
+    uint32_t HeldCount;
+    uint32_t CompleteCount;
+    ZeroCopyTestStream Streams[ZeroCopyTestStreamCount];
+    ZeroCopyTestContext() : HeldCount(0), CompleteCount(0) {
+        for (uint32_t i = 0; i < ZeroCopyTestStreamCount; ++i) {
+            QuicZeroMemory(&Streams[i], sizeof(Streams[i]));
+            Streams[i].Context = this;
+            Streams[i].Hold = i < ZeroCopyTestHeldStreams;
+        }
+    }
+};
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_STREAM_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicZeroCopyServerStreamHandler(
+    _In_ HQUIC QuicStream,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_STREAM_EVENT* Event
+    )
+{
+    ZeroCopyTestStream* Stream = (ZeroCopyTestStream*)Context;
+    switch (Event->Type) {
+        case QUIC_STREAM_EVENT_RECEIVE:
+            if (!QuicZeroCopyTestCheck(
+                    Event->RECEIVE.AbsoluteOffset,
+                    Event->RECEIVE.BufferCount,
+                    Event->RECEIVE.Buffers)) {
+                Stream->Corrupted = true;
+            }
+            if (Stream->Hold && !Stream->Held &&
+                Event->RECEIVE.TotalBufferLength != 0 &&
+                Event->RECEIVE.BufferCount <= ZeroCopyTestMaxBuffers) {
+                //
+                // Keep a copy of the buffer array (which is only valid during
+                // the callback), and hold on to the data itself.
+                //
+                Stream->Held = true;
+                Stream->HeldOffset = Event->RECEIVE.AbsoluteOffset;
+                Stream->HeldLength = Event->RECEIVE.TotalBufferLength;
+                Stream->HeldBufferCount = Event->RECEIVE.BufferCount;
+                QuicCopyMemory(
+                    Stream->HeldBuffers,
+                    Event->RECEIVE.Buffers,
+                    Event->RECEIVE.BufferCount * sizeof(QUIC_BUFFER));
+                if (++Stream->Context->HeldCount == ZeroCopyTestHeldStreams) {
+                    QuicEventSet(Stream->Context->AllHeld.Handle);
+                }
+                return QUIC_STATUS_PENDING;
+            }
+            Stream->BytesReceived += Event->RECEIVE.TotalBufferLength;
+            break;
+        case QUIC_STREAM_EVENT_PEER_SEND_SHUTDOWN:
+            if (!Stream->Hold) {
+                QuicEventSet(Stream->Context->FillerReceived.Handle);
+            }
+            if (++Stream->Context->CompleteCount == ZeroCopyTestStreamCount) {
+                QuicEventSet(Stream->Context->AllReceived.Handle);
+            }
+            break;
+        case QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE:
+            MsQuic->StreamClose(QuicStream);
+            break;
+        default:
+            break;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_CONNECTION_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicZeroCopyServerConnHandler(
+    _In_ HQUIC /* QuicConnection */,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_CONNECTION_EVENT* Event
+    )
+{
+    ZeroCopyTestContext* TestContext = (ZeroCopyTestContext*)Context;
+    if (QuicRawConnHandleCommonEvent(&TestContext->ServerConn, Event)) {
+        return QUIC_STATUS_SUCCESS;
+    }
+    if (Event->Type == QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED) {
+        QUIC_UINT62 StreamId = 0;
+        uint32_t Size = sizeof(StreamId);
+        QUIC_STATUS Status =
+            MsQuic->GetParam(
+                Event->PEER_STREAM_STARTED.Stream,
+                QUIC_PARAM_LEVEL_STREAM,
+                QUIC_PARAM_STREAM_ID,
+                &Size,
+                &StreamId);
+        if (QUIC_FAILED(Status) || (StreamId >> 2) >= ZeroCopyTestStreamCount) {
+            TEST_FAILURE("Unexpected peer stream, 0x%x.", Status);
+            return QUIC_STATUS_INVALID_STATE;
+        }
+        TestContext->Streams[StreamId >> 2].Handle = Event->PEER_STREAM_STARTED.Stream;
+        MsQuic->SetCallbackHandler(
+            Event->PEER_STREAM_STARTED.Stream,
+            (void*)QuicZeroCopyServerStreamHandler,
+            &TestContext->Streams[StreamId >> 2]);
+        return QUIC_STATUS_SUCCESS;
+    }
+    TEST_FAILURE(
+        "Invalid Connection event! Context: 0x%p, Event: %d",
+        Context,
+        Event->Type);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+//
+// Opens ZeroCopyTestHeldStreams unidirectional streams, whose first receive
+// the server holds on to, and then a larger one the server consumes inline, so
+// the datapath's receive buffers are reused while the others are held. Then
+// either releases the held receives out of order, or closes the connection
+// while they are still held.
+//
+static
+void
+QuicTestRecvZeroCopyRun(
+    _In_ int Family,
+    _In_ bool CloseWhileHeld
+    )
+{
+    const uint32_t TimeoutMs = 5000;
+    MsQuicSession Session;
+    TEST_TRUE(Session.IsValid());
+    TEST_QUIC_SUCCEEDED(Session.SetPeerUnidiStreamCount(ZeroCopyTestStreamCount));
+
+    ZeroCopyTestContext ServerContext;
+    RawConnContext ClientContext;
+    RawListenerContext ListenerContext;
+    QuicBufferScope Buffer(ZeroCopyTestFillerLength);
+    for (uint32_t i = 0; i < ZeroCopyTestFillerLength; ++i) {
+        Buffer.Buffer->Buffer[i] = QuicZeroCopyTestPattern(i);
+    }
+    QUIC_BUFFER HeldBuffer = { ZeroCopyTestHeldLength, Buffer.Buffer->Buffer };
+
+    ListenerScope Listener;
+    ConnectionScope Client;
+    ConnectionScope Server;
+    StreamScope Streams[ZeroCopyTestStreamCount];
+
+    ListenerContext.Handler = QuicZeroCopyServerConnHandler;
+    ListenerContext.Context = &ServerContext;
+    ListenerContext.Connection = &Server;
+
+    if (!QuicRawConnect(
+            Session,
+            Family,
+            Listener,
+            &ListenerContext,
+            &ServerContext.ServerConn,
+            Client,
+            &ClientContext,
+            QuicPriorityClientConnHandler,
+            &ClientContext)) {
+        return;
+    }
+
+    uint8_t Value = TRUE;
+    TEST_QUIC_SUCCEEDED(
+        MsQuic->SetParam(
+            Server.Handle,
+            QUIC_PARAM_LEVEL_CONNECTION,
+            QUIC_PARAM_CONN_RECV_ZERO_COPY,
+            sizeof(Value),
+            &Value));
+
+    for (uint32_t i = 0; i < ZeroCopyTestStreamCount; ++i) {
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->StreamOpen(
+                Client.Handle,
+                QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL,
+                QuicPriorityClientStreamHandler,
+                nullptr,
+                &Streams[i].Handle));
+        TEST_QUIC_SUCCEEDED(MsQuic->StreamStart(Streams[i].Handle, QUIC_STREAM_START_FLAG_NONE));
+        TEST_QUIC_SUCCEEDED(
+            MsQuic->StreamSend(
+                Streams[i].Handle,
+                i < ZeroCopyTestHeldStreams ? &HeldBuffer : Buffer.Buffer,
+                1,
+                QUIC_SEND_FLAG_FIN,
+                nullptr));
+    }
+
+    if (!QuicEventWaitWithTimeout(ServerContext.AllHeld.Handle, TimeoutMs)) {
+        TEST_FAILURE("Server failed to hold all receives before timeout!");
+        return;
+    }
+    if (!QuicEventWaitWithTimeout(ServerContext.FillerReceived.Handle, TimeoutMs)) {
+        TEST_FAILURE("Server failed to receive the filler stream before timeout!");
+        return;
+    }
+
+    //
+    // The held data must be untouched, even though many more datagrams were
+    // received since it was indicated.
+    //
+    for (uint32_t i = 0; i < ZeroCopyTestHeldStreams; ++i) {
+        ZeroCopyTestStream* Stream = &ServerContext.Streams[i];
+        TEST_TRUE(
+            QuicZeroCopyTestCheck(
+                Stream->HeldOffset,
+                Stream->HeldBufferCount,
+                Stream->HeldBuffers));
+    }
+
+    if (CloseWhileHeld) {
+        //
+        // The held datagrams are returned when the streams are freed.
+        //
+        MsQuic->ConnectionShutdown(
+            Server.Handle,
+            QUIC_CONNECTION_SHUTDOWN_FLAG_NONE,
+            0);
+        TEST_TRUE(QuicEventWaitWithTimeout(ServerContext.ServerConn.ShutdownComplete.Handle, TimeoutMs));
+        return;
+    }
+
+    const uint32_t ReleaseOrder[ZeroCopyTestHeldStreams] = { 2, 0, 3, 1 };
+    for (uint32_t i = 0; i < ZeroCopyTestHeldStreams; ++i) {
+        ZeroCopyTestStream* Stream = &ServerContext.Streams[ReleaseOrder[i]];
+        Stream->BytesReceived += Stream->HeldLength;
+        MsQuic->StreamReceiveComplete(Stream->Handle, Stream->HeldLength);
+    }
+
+    if (!QuicEventWaitWithTimeout(ServerContext.AllReceived.Handle, TimeoutMs)) {
+        TEST_FAILURE("Server failed to receive all streams before timeout!");
+        return;
+    }
+    for (uint32_t i = 0; i < ZeroCopyTestStreamCount; ++i) {
+        TEST_FALSE(ServerContext.Streams[i].Corrupted);
+        TEST_EQUAL(
+            (i < ZeroCopyTestHeldStreams ?
+                ZeroCopyTestHeldLength : ZeroCopyTestFillerLength),
+            ServerContext.Streams[i].BytesReceived);
+    }
+}
+
+void
+QuicTestRecvZeroCopy(
+    _In_ int Family
+    )
+{
+    {
+        TestScopeLogger logScope("OutOfOrderRelease");
+        QuicTestRecvZeroCopyRun(Family, false);
+    }
+    {
+        TestScopeLogger logScope("CloseWhileHeld");
+        QuicTestRecvZeroCopyRun(Family, true);
+    }
+}
+
+const uint32_t DatagramTestCount = 4;
+const uint16_t DatagramTestLength = 100;
+
+struct DatagramTestContext {
+    RawConnContext ClientConn;
+    RawConnContext ServerConn;
+    EventScope ClientSendEnabled;
+    EventScope AllReceived;
+    EventScope AllFinal;
+    bool ClientCanSend;
+    uint16_t ClientMaxSendLength;
+    bool ServerCanSend;
+    bool Failed;
+    uint32_t ReceivedCount;
+    uint32_t FinalCount;
+    uint32_t SentCount[DatagramTestCount];
+    QUIC_DATAGRAM_SEND_STATE FinalState[DatagramTestCount];
+    //
+    // The payloads, each sent as two buffers, must stay valid until they are
+    // indicated as sent.
+    //
+    uint8_t Data[DatagramTestCount][DatagramTestLength];
+    QUIC_BUFFER Buffers[DatagramTestCount][2];
+    DatagramTestContext() :
+        ClientCanSend(false), ClientMaxSendLength(0), ServerCanSend(false),
+        Failed(false), ReceivedCount(0), FinalCount(0) {
+        for (uint32_t i = 0; i < DatagramTestCount; ++i) {
+            SentCount[i] = 0;
+            FinalState[i] = QUIC_DATAGRAM_SEND_CANCELED;
+            for (uint32_t j = 0; j < DatagramTestLength; ++j) {
+                Data[i][j] = (uint8_t)(i + j);
+            }
+            Buffers[i][0].Buffer = Data[i];
+            Buffers[i][0].Length = DatagramTestLength / 2;
+            Buffers[i][1].Buffer = Data[i] + DatagramTestLength / 2;
+            Buffers[i][1].Length = DatagramTestLength - DatagramTestLength / 2;
+        }
+    }
+};
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_CONNECTION_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicDatagramServerConnHandler(
+    _In_ HQUIC /* QuicConnection */,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_CONNECTION_EVENT* Event
+    )
+{
+    DatagramTestContext* TestContext = (DatagramTestContext*)Context;
+    switch (Event->Type) {
+        case QUIC_CONNECTION_EVENT_DATAGRAM_STATE_CHANGED:
+            TestContext->ServerCanSend = Event->DATAGRAM_STATE_CHANGED.SendEnabled != FALSE;
+            return QUIC_STATUS_SUCCESS;
+        case QUIC_CONNECTION_EVENT_DATAGRAM_RECEIVED: {
+            const QUIC_BUFFER* Buffer = Event->DATAGRAM_RECEIVED.Buffer;
+            if (Buffer->Length != DatagramTestLength) {
+                TestContext->Failed = true;
+            } else {
+                for (uint32_t j = 0; j < DatagramTestLength; ++j) {
+                    if (Buffer->Buffer[j] != (uint8_t)(Buffer->Buffer[0] + j)) {
+                        TestContext->Failed = true;
+                    }
+                }
+            }
+            if (++TestContext->ReceivedCount == DatagramTestCount) {
+                QuicEventSet(TestContext->AllReceived.Handle);
+            }
+            return QUIC_STATUS_SUCCESS;
+        }
+        default:
+            break;
+    }
+    if (QuicRawConnHandleCommonEvent(&TestContext->ServerConn, Event)) {
+        return QUIC_STATUS_SUCCESS;
+    }
+    TEST_FAILURE(
+        "Invalid Connection event! Context: 0x%p, Event: %d",
+        Context,
+        Event->Type);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+_Function_class_(QUIC_CONNECTION_CALLBACK)
+static
+QUIC_STATUS
+QUIC_API
+QuicDatagramClientConnHandler(
+    _In_ HQUIC /* QuicConnection */,
+    _In_opt_ void* Context,
+    _Inout_ QUIC_CONNECTION_EVENT* Event
+    )
+{
+    DatagramTestContext* TestContext = (DatagramTestContext*)Context;
+    switch (Event->Type) {
+        case QUIC_CONNECTION_EVENT_DATAGRAM_STATE_CHANGED:
+            TestContext->ClientCanSend = Event->DATAGRAM_STATE_CHANGED.SendEnabled != FALSE;
+            TestContext->ClientMaxSendLength = Event->DATAGRAM_STATE_CHANGED.MaxSendLength;
+            if (TestContext->ClientCanSend) {
+                QuicEventSet(TestContext->ClientSendEnabled.Handle);
+            }
+            return QUIC_STATUS_SUCCESS;
+        case QUIC_CONNECTION_EVENT_DATAGRAM_SEND_STATE_CHANGED: {
+            size_t Index = (size_t)Event->DATAGRAM_SEND_STATE_CHANGED.ClientContext - 1;
+            QUIC_DATAGRAM_SEND_STATE State = Event->DATAGRAM_SEND_STATE_CHANGED.State;
+            if (Index >= DatagramTestCount) {
+                TestContext->Failed = true;
+            } else if (State == QUIC_DATAGRAM_SEND_SENT) {
+                //
+                // Sent exactly once, before any other state.
+                //
+                if (TestContext->SentCount[Index]++ != 0) {
+                    TestContext->Failed = true;
+                }
+            } else if (TestContext->SentCount[Index] == 0) {
+                TestContext->Failed = true;
+            } else if (QUIC_DATAGRAM_SEND_STATE_IS_FINAL(State)) {
+                TestContext->FinalState[Index] = State;
+                if (++TestContext->FinalCount == DatagramTestCount) {
+                    QuicEventSet(TestContext->AllFinal.Handle);
+                }
+            }
+            return QUIC_STATUS_SUCCESS;
+        }
+        default:
+            break;
+    }
+    if (QuicRawConnHandleCommonEvent(&TestContext->ClientConn, Event)) {
+        return QUIC_STATUS_SUCCESS;
+    }
+    TEST_FAILURE(
+        "Invalid Connection event! Context: 0x%p, Event: %d",
+        Context,
+        Event->Type);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
+void
+QuicTestDatagramSend(
+    _In_ int Family
+    )
+{
+    const uint32_t TimeoutMs = 5000;
+    MsQuicSession Session;
+    TEST_TRUE(Session.IsValid());
+
+    DatagramTestContext TestContext;
+    RawListenerContext ListenerContext;
+
+    ListenerScope Listener;
+    ConnectionScope Client;
+    ConnectionScope Server;
+
+    //
+    // Only the server advertises max_datagram_frame_size, so only the client
+    // may send datagrams.
+    //
+    ListenerContext.Handler = QuicDatagramServerConnHandler;
+    ListenerContext.Context = &TestContext;
+    ListenerContext.Connection = &Server;
+    ListenerContext.DatagramReceiveEnabled = true;
+
+    if (!QuicRawConnect(
+            Session,
+            Family,
+            Listener,
+            &ListenerContext,
+            &TestContext.ServerConn,
+            Client,
+            &TestContext.ClientConn,
+            QuicDatagramClientConnHandler,
+            &TestContext)) {
+        return;
+    }
+
+    if (!QuicEventWaitWithTimeout(TestContext.ClientSendEnabled.Handle, TimeoutMs)) {
+        TEST_FAILURE("Client datagram send wasn't enabled before timeout!");
+        return;
+    }
+    TEST_TRUE(TestContext.ClientMaxSendLength >= DatagramTestLength);
+
+    uint8_t SendEnabled = TRUE;
+    uint32_t Size = sizeof(SendEnabled);
+    TEST_QUIC_SUCCEEDED(
+        MsQuic->GetParam(
+            Server.Handle,
+            QUIC_PARAM_LEVEL_CONNECTION,
+            QUIC_PARAM_CONN_DATAGRAM_SEND_ENABLED,
+            &Size,
+            &SendEnabled));
+    TEST_FALSE(SendEnabled);
+    TEST_FALSE(TestContext.ServerCanSend);
+    TEST_QUIC_STATUS(
+        QUIC_STATUS_INVALID_STATE,
+        MsQuic->DatagramSend(
+            Server.Handle,
+            TestContext.Buffers[0],
+            2,
+            QUIC_SEND_FLAG_NONE,
+            nullptr));
+
+    //
+    // Sends larger than the indicated maximum fail immediately.
+    //
+    QuicBufferScope Oversized((uint32_t)TestContext.ClientMaxSendLength + 1);
+    TEST_QUIC_STATUS(
+        QUIC_STATUS_INVALID_PARAMETER,
+        MsQuic->DatagramSend(
+            Client.Handle,
+            Oversized,
+            1,
+            QUIC_SEND_FLAG_NONE,
+            nullptr));
+
+    for (uint32_t i = 0; i < DatagramTestCount; ++i) {
+        TEST_QUIC_STATUS(
+            QUIC_STATUS_PENDING,
+            MsQuic->DatagramSend(
+                Client.Handle,
+                TestContext.Buffers[i],
+                2,
+                QUIC_SEND_FLAG_NONE,
+                (void*)(size_t)(i + 1)));
+    }
+
+    if (!QuicEventWaitWithTimeout(TestContext.AllReceived.Handle, TimeoutMs)) {
+        TEST_FAILURE("Server failed to receive all datagrams before timeout!");
+        return;
+    }
+    if (!QuicEventWaitWithTimeout(TestContext.AllFinal.Handle, TimeoutMs)) {
+        TEST_FAILURE("Client datagram sends failed to complete before timeout!");
+        return;
+    }
+
+    TEST_FALSE(TestContext.Failed);
+    for (uint32_t i = 0; i < DatagramTestCount; ++i) {
+        TEST_EQUAL(1, TestContext.SentCount[i]);
+        TEST_TRUE(
+            TestContext.FinalState[i] == QUIC_DATAGRAM_SEND_ACKNOWLEDGED ||
+            TestContext.FinalState[i] == QUIC_DATAGRAM_SEND_ACKNOWLEDGED_SPURIOUS);
+    }
+}
@@ -71,14 +71,14 @@ EXT_COMMAND(
             Conn.TypeStr());
     } else {
         for (UCHAR i = 0; i < PartitionCount; i++) {
-            HashTable Hash(Lookup.GetLookupTable(i).GetTablePtr());
-            Dml("\t<link cmd=\"dt msquic!QUIC_HASHTABLE 0x%I64X\">Hash Table %d</link> (%u entries)\n",
-                Hash.Addr,
+            CidTable Table(Lookup.GetLookupTable(i).GetTable());
+            Dml("\t<link cmd=\"dt msquic!QUIC_CID_TABLE 0x%I64X\">CID Table %d</link> (%u entries)\n",
+                Table.Addr,
                 i,
-                Hash.NumEntries());
+                Table.NumEntries());
             ULONG64 EntryPtr;
-            while (!CheckControlC() && Hash.GetNextEntry(&EntryPtr)) {
-                CidHashEntry Entry = CidHashEntry::FromEntry(EntryPtr);
+            while (!CheckControlC() && Table.GetNextEntry(&EntryPtr)) {
+                CidHashEntry Entry(EntryPtr);
                 Cid Cid(Entry.GetCid());
                 Connection Conn(Entry.GetConnection());
                 Dml("\t  <link cmd=\"!quicconnection 0x%I64X\">Connection 0x%I64X</link> [%s] [%s]\n",
@@ -214,19 +214,25 @@ EXT_COMMAND(
     Dml("\tOutstanding Packets  ");
 
     auto Loss = Conn.GetLossDetection();
-    auto SendPackets = Loss.GetSendPackets();
+    auto SentPackets = Loss.GetSentPackets();
+    bool HasAtLeastOnePacket = false;
 
-    if (SendPackets == 0) {
+    for (UINT32 i = 0; i < SentPackets.Count() && !CheckControlC(); ++i) {
+        auto Slot = SentPackets.GetSlot(i);
+        if (Slot.State() != QUIC_SENT_PACKET_STATE_OUTSTANDING) {
+            continue;
+        }
+        auto Packet = Slot.GetPacket();
+        Dml("<link cmd=\"!quicpacket 0x%I64X\">%I64u</link>\n"
+            "\t                     ",
+            Packet.Addr,
+            Packet.PacketNumber());
+        HasAtLeastOnePacket = true;
+    }
+
+    if (!HasAtLeastOnePacket) {
         Dml("NONE\n");
     } else {
-        while (SendPackets && !CheckControlC()) {
-            auto Packet = SentPacketMetadata(SendPackets);
-            Dml("<link cmd=\"!quicpacket 0x%I64X\">%I64u</link>\n"
-                "\t                     ",
-                Packet.Addr,
-                Packet.PacketNumber());
-            SendPackets = Packet.Next();
-        }
         Dml("\n");
     }
 
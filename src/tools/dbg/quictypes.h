@@ -395,10 +395,6 @@ struct CidHashEntry : Struct {
 
     CidHashEntry(ULONG64 Addr) : Struct("msquic!QUIC_CID_HASH_ENTRY", Addr) { }
 
-    static CidHashEntry FromEntry(ULONG64 EntryAddr) {
-        return CidHashEntry(LinkEntryToType(EntryAddr, "msquic!QUIC_CID_HASH_ENTRY", "Entry"));
-    }
-
     static CidHashEntry FromLink(ULONG64 LinkAddr) {
         return CidHashEntry(LinkEntryToType(LinkAddr, "msquic!QUIC_CID_HASH_ENTRY", "Link"));
     }
@@ -412,6 +408,53 @@ struct CidHashEntry : Struct {
     }
 };
 
+#define KDEXT_CID_TABLE_GROUP_SIZE  16     // QUIC_CID_TABLE_GROUP_SIZE
+#define KDEXT_CID_TABLE_FULL        0x80   // Control byte flag of a full slot
+
+struct CidTable : Struct {
+
+    ULONG64 Storage;
+    ULONG SlotCount;
+    ULONG64 ControlAddr;
+    ULONG64 SlotsAddr;
+    ULONG SlotSize;
+    ULONG Index;
+
+    CidTable(ULONG64 Addr) : Struct("msquic!QUIC_CID_TABLE", Addr) {
+        Storage = ReadPointer("Storage");
+        SlotCount = 0;
+        Index = 0;
+        if (Storage != 0) {
+            Struct StorageStruct("msquic!QUIC_CID_TABLE_STORAGE", Storage);
+            SlotCount =
+                (StorageStruct.ReadType<ULONG>("GroupMask") + 1) *
+                KDEXT_CID_TABLE_GROUP_SIZE;
+            ControlAddr = StorageStruct.AddrOf("Control");
+            SlotsAddr = StorageStruct.ReadPointer("Slots");
+            SlotSize = GetTypeSize("msquic!QUIC_CID_TABLE_SLOT");
+        }
+    }
+
+    ULONG NumEntries() {
+        return ReadType<ULONG>("Count");
+    }
+
+    bool GetNextEntry(ULONG64* EntryAddress) {
+        for (; Index < SlotCount; Index++) {
+            UCHAR Control;
+            if (!ReadTypeAtAddr(ControlAddr + Index, &Control)) {
+                return false;
+            }
+            if (Control & KDEXT_CID_TABLE_FULL) {
+                Struct Slot("msquic!QUIC_CID_TABLE_SLOT", SlotsAddr + Index++ * SlotSize);
+                *EntryAddress = Slot.ReadPointer("Entry");
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
 struct QuicHandle : Struct {
 
     QuicHandle(ULONG64 Addr) : Struct("msquic!QUIC_HANDLE", Addr) { }
@@ -838,10 +881,6 @@ struct SentPacketMetadata : Struct {
 
     SentPacketMetadata(ULONG64 Addr) : Struct("msquic!QUIC_SENT_PACKET_METADATA", Addr) { }
 
-    ULONG64 Next() {
-        return ReadPointer("Next");
-    }
-
     UINT64 PacketNumber() {
         return ReadType<UINT64>("PacketNumber");
     }
@@ -870,6 +909,46 @@ struct SentPacketMetadata : Struct {
     }
 };
 
+typedef enum QUIC_SENT_PACKET_STATE {
+
+    QUIC_SENT_PACKET_STATE_EMPTY,
+    QUIC_SENT_PACKET_STATE_OUTSTANDING,
+    QUIC_SENT_PACKET_STATE_LOST
+
+} QUIC_SENT_PACKET_STATE;
+
+struct SentPacketSlot : Struct {
+
+    SentPacketSlot(ULONG64 Addr) : Struct("msquic!QUIC_SENT_PACKET_SLOT", Addr) { }
+
+    QUIC_SENT_PACKET_STATE State() {
+        return (QUIC_SENT_PACKET_STATE)ReadType<UINT8>("State");
+    }
+
+    SentPacketMetadata GetPacket() {
+        if (ReadType<UINT8>("IsExternal")) {
+            return SentPacketMetadata(ReadPointer("External"));
+        }
+        return SentPacketMetadata(AddrOf("Inline"));
+    }
+};
+
+struct SentPacketRing : Struct {
+
+    SentPacketRing(ULONG64 Addr) : Struct("msquic!QUIC_SENT_PACKET_RING", Addr) { }
+
+    UINT32 Count() {
+        return ReadType<UINT32>("Count");
+    }
+
+    SentPacketSlot GetSlot(UINT32 i) {
+        UINT32 Capacity = ReadType<UINT32>("Capacity");
+        UINT32 Head = ReadType<UINT32>("Head");
+        ULONG64 Size = GetTypeSize("msquic!QUIC_SENT_PACKET_SLOT");
+        return SentPacketSlot(ReadPointer("Slots") + Size * ((Head + i) & (Capacity - 1)));
+    }
+};
+
 struct LossDetection : Struct {
 
     LossDetection(ULONG64 Addr) : Struct("msquic!QUIC_LOSS_DETECTION", Addr) { }
@@ -882,12 +961,8 @@ struct LossDetection : Struct {
         return ReadType<UINT32>("RttVariance"); // Microseconds
     }
 
-    ULONG64 GetSendPackets() {
-        return ReadPointer("SentPackets");
-    }
-
-    ULONG64 GetLostPackets() {
-        return ReadPointer("LostPackets");
+    SentPacketRing GetSentPackets() {
+        return SentPacketRing(AddrOf("SentPackets"));
     }
 };
 
@@ -1282,8 +1357,8 @@ struct LookupHashTable : Struct {
 
     LookupHashTable(ULONG64 Addr) : Struct("msquic!QUIC_PARTITIONED_HASHTABLE", Addr) { }
 
-    ULONG64 GetTablePtr() {
-        return AddrOf("Table"); // TODO - Need Hash Table Enumeration.
+    CidTable GetTable() {
+        return CidTable(AddrOf("Table"));
     }
 };
 
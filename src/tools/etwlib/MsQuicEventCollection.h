@@ -158,7 +158,8 @@ enum QuicApiType {
     QuicApiStreamShutdown,
     QuicApiStreamSend,
     QuicApiStreamReceiveComplete,
-    QuicApiStreamReceiveSetEnabled
+    QuicApiStreamReceiveSetEnabled,
+    QuicApiDatagramSend
 };
 
 //
@@ -354,6 +354,10 @@ PingConnection::ProcessEvent(
             printf("[%p]     Stream Bytes:           %llu\n", QuicConnection, Stats.Send.TotalStreamBytes);
             printf("[%p]     Congestion Events:      %u\n", QuicConnection, Stats.Send.CongestionCount);
             printf("[%p]     Pers Congestion Events: %u\n", QuicConnection, Stats.Send.PersistentCongestionCount);
+            printf("[%p]     Slow Start Exits:       %u congestion, %u RTT increase, %u threshold\n", QuicConnection,
+                Stats.SlowStartExit.CongestionCount,
+                Stats.SlowStartExit.RttIncreaseCount,
+                Stats.SlowStartExit.ThresholdCount);
             printf("[%p]   Recv:\n", QuicConnection);
             printf("[%p]     Total Packets:          %llu\n", QuicConnection, Stats.Recv.TotalPackets);
             printf("[%p]     Reordered Packets:      %llu\n", QuicConnection, Stats.Recv.ReorderedPackets);
@@ -281,7 +281,7 @@ void SpinQuicSetRandomConnectionParam(HQUIC Connection)
     int ParamFlag = -1;
 
    // Move this to the enum
-    switch (rand() % 13) {
+    switch (rand() % 14) {
     case 0: // QUIC_PARAM_CONN_IDLE_TIMEOUT                    3   // uint64_t - milliseconds
         ParamFlag = QUIC_PARAM_CONN_IDLE_TIMEOUT;
         ParamSize = 8;
@@ -346,6 +346,11 @@ void SpinQuicSetRandomConnectionParam(HQUIC Connection)
         ParamSize = 1;
         Param.u8 = (rand() % 254);
         break;
+    case 13: // QUIC_PARAM_CONN_RECV_ZERO_COPY                  20  // uint8_t (BOOLEAN)
+        ParamFlag = QUIC_PARAM_CONN_RECV_ZERO_COPY;
+        ParamSize = 1;
+        Param.u8 = (rand() % 2);
+        break;
     default:
         break;
     }
@@ -452,7 +457,8 @@ void Spin(LockableVector<HQUIC>& Connections, bool IsServer)
                 auto Stream = ctx->TryGetStream();
                 if (Stream == nullptr) continue;
                 PRINT("MsQuic->StreamSend(%p, ...) = ", Stream);
-                QUIC_STATUS Status = MsQuic->StreamSend(Stream, Buffers, ARRAYSIZE(Buffers), QUIC_SEND_FLAG_NONE, nullptr);
+                QUIC_SEND_FLAGS Flags = (rand() % 2) ? QUIC_SEND_FLAG_TRANSFER_OWNERSHIP : QUIC_SEND_FLAG_NONE;
+                QUIC_STATUS Status = MsQuic->StreamSend(Stream, Buffers, ARRAYSIZE(Buffers), Flags, nullptr);
                 PRINT("0x%x\n", Status);
                 UNREFERENCED_PARAMETER(Status);
             }